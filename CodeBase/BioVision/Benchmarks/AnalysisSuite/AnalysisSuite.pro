@@ -0,0 +1,30 @@
+#-------------------------------------------------
+#
+# End to end analysis benchmark suite.
+# Writes synthetic videos and reports decode, analyze and encode time, the time of each analysis stage, the overhead of
+# stage profiling, allocations and peak memory for every scenario as CSV.
+# profiling_overhead_percent compares a run timed by a StageProfiler with one without a profiler.  Built with
+# CONFIG += no_stage_profiling (and biovision-core built the same way) the timers are compiled out and the column is
+# only noise, the analyze_ns of that build against a default build shows what the timers cost without a profiler.
+#
+#-------------------------------------------------
+
+QT       = core
+
+TARGET = AnalysisSuite
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+# the analysis engine and OpenCV
+BIOVISION_TOP = ../..
+include(../../BioVisionCore/BioVisionCore.pri)
+
+# peak working set
+win32: LIBS += -lpsapi
+
+SOURCES += main.cpp \
+    SyntheticVideo.cpp
+
+HEADERS += \
+    SyntheticVideo.h
@@ -0,0 +1,230 @@
+#include "SyntheticVideo.h"
+#include "opencv2/highgui/highgui.hpp"
+#include "opencv2/imgproc/imgproc.hpp"
+#include <math.h>
+
+static const double PI = 3.14159265358979323846;
+
+//multiplier mixing the frame number into the noise seed, so neighbouring frames get unrelated noise
+static const unsigned int NOISE_SEED_MULTIPLIER = 2654435761u;
+
+/*!
+ * Constructor, places the blobs and shades the background from the settings
+ *
+ * \param settings: What the video looks like
+ */
+SyntheticVideo::SyntheticVideo(const videoSettings &settings)
+{
+    _settings = settings;
+
+    cv::RNG rng(settings.seed);
+
+    for(int i = 0; i < settings.blobCount; i++)
+    {
+        blob newBlob;
+        newBlob.startX = rng.uniform(0.0, (double)settings.width);
+        newBlob.startY = rng.uniform(0.0, (double)settings.height);
+
+        //a few pixels per frame, like an animal crossing a well in a few seconds
+        newBlob.speedX = rng.uniform(-4.0, 4.0);
+        newBlob.speedY = rng.uniform(-4.0, 4.0);
+
+        int brightness = rng.uniform(200, 256);
+        newBlob.color = cv::Scalar(brightness, brightness, brightness);
+
+        _blobs.push_back(newBlob);
+    }
+
+    //a gentle gradient, so the background is not one flat value
+    _background.create(settings.height, settings.width, CV_8UC3);
+
+    for(int y = 0; y < settings.height; y++)
+    {
+        unsigned char* row = _background.ptr<unsigned char>(y);
+
+        for(int x = 0; x < settings.width; x++)
+        {
+            unsigned char value = (unsigned char)(50 + (x * 40) / settings.width + (y * 20) / settings.height);
+            row[x * 3] = value;
+            row[x * 3 + 1] = value;
+            row[x * 3 + 2] = value;
+        }
+    }
+}
+
+/*!
+ * Destructor
+ */
+SyntheticVideo::~SyntheticVideo()
+{
+
+}
+
+/*!
+ * Get function for the settings of a typical recording: 720p at 30 frames per second, three animals, light noise
+ * and no flicker
+ *
+ * \return Returns the default settings
+ */
+SyntheticVideo::videoSettings SyntheticVideo::getDefaultSettings()
+{
+    videoSettings settings;
+
+    settings.width = 1280;
+    settings.height = 720;
+    settings.frameRate = 30.0;
+    settings.frameCount = 300;
+    settings.blobCount = 3;
+    settings.blobRadius = 24;
+    settings.noiseLevel = 4;
+    settings.flickerLevel = 0;
+    settings.flickerFrequency = 2.0;
+    settings.seed = 12345;
+
+    return settings;
+}
+
+/*!
+ * Renders one frame of the video
+ *
+ * \param frameNumber: The frame to render
+ * \param frame: Receives the frame as a 3 channel BGR image, its buffer is reused if it has the size of the video
+ */
+void SyntheticVideo::renderFrame(int frameNumber, cv::Mat &frame) const
+{
+    _background.copyTo(frame);
+
+    //the flicker brightens and darkens the whole frame, as a light on a mains supply or a passing cloud would
+    if(_settings.flickerLevel > 0)
+    {
+        double seconds = frameNumber / _settings.frameRate;
+        double flicker = _settings.flickerLevel * sin(2.0 * PI * _settings.flickerFrequency * seconds);
+
+        frame += cv::Scalar(flicker, flicker, flicker);
+    }
+
+    for(unsigned int i = 0; i < _blobs.size(); i++)
+    {
+        const blob &currentBlob = _blobs[i];
+
+        double x = bounce(currentBlob.startX + currentBlob.speedX * frameNumber, _settings.blobRadius, _settings.width - _settings.blobRadius);
+        double y = bounce(currentBlob.startY + currentBlob.speedY * frameNumber, _settings.blobRadius, _settings.height - _settings.blobRadius);
+
+        cv::circle(frame, cv::Point((int)x, (int)y), _settings.blobRadius, currentBlob.color, -1);
+    }
+
+    if(_settings.noiseLevel > 0)
+    {
+        cv::RNG rng(_settings.seed + (unsigned int)frameNumber * NOISE_SEED_MULTIPLIER);
+        cv::Mat noise(frame.size(), CV_8UC3);
+
+        rng.fill(noise, cv::RNG::UNIFORM, 0, _settings.noiseLevel + 1);
+        frame += noise;
+    }
+}
+
+/*!
+ * Writes the video to a Motion JPEG .avi file, so the benchmarks can decode it the way an analysis reads a recording
+ *
+ * \param videoFilePath: The path of the video to write
+ *
+ * \return Returns false if openCV has no Motion JPEG encoder or the file cannot be written
+ */
+bool SyntheticVideo::writeVideo(const std::string &videoFilePath) const
+{
+    cv::VideoWriter writer(videoFilePath, CV_FOURCC('M', 'J', 'P', 'G'), _settings.frameRate, cv::Size(_settings.width, _settings.height), true);
+
+    if(writer.isOpened() == false)
+    {
+        return false;
+    }
+
+    cv::Mat frame;
+
+    for(int frameNumber = 0; frameNumber < _settings.frameCount; frameNumber++)
+    {
+        renderFrame(frameNumber, frame);
+        writer << frame;
+    }
+
+    return true;
+}
+
+/*!
+ * Get function for the settings of the video
+ *
+ * \return Returns the settings the video was made with
+ */
+const SyntheticVideo::videoSettings& SyntheticVideo::getSettings() const
+{
+    return _settings;
+}
+
+/*!
+ * Lays out a grid of equally sized wells covering the frame
+ *
+ * \param numberOfWells: How many wells to create, 0 for none
+ * \param frameWidth: The width of the frame
+ * \param frameHeight: The height of the frame
+ * \param threshold: The threshold of every well, in percent
+ *
+ * \return Returns the wells in row order
+ */
+std::vector<AnalysisEngine::region> SyntheticVideo::createWellLayout(int numberOfWells, int frameWidth, int frameHeight, int threshold)
+{
+    std::vector<AnalysisEngine::region> wells;
+
+    if(numberOfWells <= 0)
+    {
+        return wells;
+    }
+
+    int columns = 1;
+    while(columns * columns < numberOfWells)
+    {
+        columns++;
+    }
+    int rows = (numberOfWells + columns - 1) / columns;
+
+    int wellWidth = frameWidth / columns;
+    int wellHeight = frameHeight / rows;
+
+    for(int i = 0; i < numberOfWells; i++)
+    {
+        AnalysisEngine::region well;
+        well.name = "well";
+        well.x = (i % columns) * wellWidth;
+        well.y = (i / columns) * wellHeight;
+        well.width = wellWidth - 1;
+        well.height = wellHeight - 1;
+        well.threshold = threshold;
+
+        wells.push_back(well);
+    }
+
+    return wells;
+}
+
+/*!
+ * Folds a position on a straight path back between two walls, as a blob bouncing between them moves
+ *
+ * \return Returns the position between low and high
+ */
+double SyntheticVideo::bounce(double position, double low, double high)
+{
+    double span = high - low;
+
+    if(span <= 0)
+    {
+        return low;
+    }
+
+    double offset = fmod(position - low, 2.0 * span);
+
+    if(offset < 0)
+    {
+        offset += 2.0 * span;
+    }
+
+    return (offset <= span) ? low + offset : low + 2.0 * span - offset;
+}
@@ -0,0 +1,80 @@
+/*!
+ * \class SyntheticVideo
+ *
+ * Generates test videos for the analysis benchmarks: a shaded background with bright blobs moving across it, pixel
+ * noise and a lighting flicker, all set by videoSettings.
+ *
+ * Every frame is a function of the settings and its frame number alone.  The blobs bounce off the frame edges along
+ * straight paths, the flicker is a sine wave and the noise of each frame comes from a random generator seeded with the
+ * frame number, so the same settings give the same video on every machine and any frame can be rendered on its own.
+ *
+ * Region layouts for the videos are grids of wells covering the frame, like multi-well plates.  Every benchmark takes
+ * its frames and wells from here, so their results describe the same recordings.
+ */
+
+#ifndef SYNTHETICVIDEO_H
+#define SYNTHETICVIDEO_H
+
+#include "AnalysisEngine.h"
+#include "opencv2/core/core.hpp"
+#include <vector>
+#include <string>
+
+class SyntheticVideo
+{
+
+public:
+    //what the generated video looks like
+    struct videoSettings
+    {
+        int width;
+        int height;
+        double frameRate;
+        int frameCount;
+
+        //moving bright blobs, and their radius in pixels
+        int blobCount;
+        int blobRadius;
+
+        //largest value added to a pixel channel by noise, 0 for none
+        int noiseLevel;
+
+        //largest brightness change of the whole frame by the flicker, and how often it repeats per second
+        int flickerLevel;
+        double flickerFrequency;
+
+        unsigned int seed;
+    };
+
+    SyntheticVideo(const videoSettings &settings);
+    ~SyntheticVideo();
+
+    static videoSettings getDefaultSettings();
+
+    void renderFrame(int frameNumber, cv::Mat &frame) const;
+    bool writeVideo(const std::string &videoFilePath) const;
+
+    const videoSettings& getSettings() const;
+
+    static std::vector<AnalysisEngine::region> createWellLayout(int numberOfWells, int frameWidth, int frameHeight, int threshold);
+
+private:
+    //a blob's place at frame 0, its speed in pixels per frame and its color
+    struct blob
+    {
+        double startX;
+        double startY;
+        double speedX;
+        double speedY;
+        cv::Scalar color;
+    };
+
+    videoSettings _settings;
+    std::vector<blob> _blobs;
+
+    /*! The shaded background every frame is drawn on. */
+    cv::Mat _background;
+
+    static double bounce(double position, double low, double high);
+};
+#endif
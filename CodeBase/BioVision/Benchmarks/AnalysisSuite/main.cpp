@@ -0,0 +1,618 @@
+///////////////////////////////////////////////////////////
+//  main.cpp
+//  End to end analysis benchmark suite
+///////////////////////////////////////////////////////////
+
+#include "SyntheticVideo.h"
+#include "AnalysisEngine.h"
+#include "MotionKernel.h"
+#include "RegionEngine.h"
+#include "OpenCV.h"
+#include "StageProfiler.h"
+#include "opencv2/core/core.hpp"
+#include "opencv2/highgui/highgui.hpp"
+#include <QAtomicInt>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+//quality flagged frames are encoded with, the default of the options window
+static const int JPEG_QUALITY = 95;
+
+//the sensitivity every scenario runs with, the middle of the options window's slider
+static const int MOTION_SENSITIVITY = 49;
+
+//threshold of every well in percent
+static const int WELL_THRESHOLD = 1;
+
+//the most time stage profiling may add to decoding and analyzing, in percent
+static const double PROFILING_OVERHEAD_BUDGET = 1.0;
+
+//calls to operator new from every thread, the benchmark replaces the global operator new to count them
+static QAtomicInt newCallCount;
+
+void* operator new(size_t size) throw(std::bad_alloc)
+{
+    newCallCount.fetchAndAddRelaxed(1);
+
+    void* memory = malloc(size == 0 ? 1 : size);
+    if(memory == NULL)
+    {
+        throw std::bad_alloc();
+    }
+
+    return memory;
+}
+
+void* operator new[](size_t size) throw(std::bad_alloc)
+{
+    return operator new(size);
+}
+
+void operator delete(void* memory) throw()
+{
+    free(memory);
+}
+
+void operator delete[](void* memory) throw()
+{
+    free(memory);
+}
+
+//one run of the suite: a synthetic video, the wells laid over it and the analysis threads
+struct scenario
+{
+    std::string name;
+    SyntheticVideo::videoSettings video;
+    int wells;
+    int threads;
+};
+
+//the measurements of one scenario, times are in nanoseconds per frame
+struct scenarioResult
+{
+    bool isDecoded;
+    int framesAnalyzed;
+    int flaggedFrames;
+    double decodeTime;
+    double analyzeTime;
+    double encodeTime;
+    double backgroundMaskTime;
+    double countingTime;
+    double overlayTime;
+    double profilingOverhead;
+    double newCallsPerFrame;
+    double bufferAllocationsPerFrame;
+    long peakResidentKilobytes;
+};
+
+//encodes the drawn flagged frames the way an analysis saves them, and times the encoding
+class flaggedFrameEncoder : public AnalysisEngine::frameListener
+{
+public:
+    flaggedFrameEncoder()
+    {
+        flaggedFrames = 0;
+        encodeTicks = 0;
+
+        jpegParameters.push_back(CV_IMWRITE_JPEG_QUALITY);
+        jpegParameters.push_back(JPEG_QUALITY);
+    }
+
+    void frameAnalyzed(const AnalysisEngine::frameResult &result)
+    {
+        if(result.isThreshHoldPassed)
+        {
+            flaggedFrames++;
+        }
+
+        if(result.frameWithDifference != NULL)
+        {
+            int64 startTicks = cv::getTickCount();
+            cv::imencode(".jpg", *result.frameWithDifference, jpegBuffer, jpegParameters);
+            encodeTicks += cv::getTickCount() - startTicks;
+        }
+    }
+
+    int flaggedFrames;
+    int64 encodeTicks;
+
+private:
+    std::vector<int> jpegParameters;
+    std::vector<unsigned char> jpegBuffer;
+};
+
+/*!
+ * Converts a tick count of cv::getTickCount() to nanoseconds per frame
+ *
+ * \return Returns the nanoseconds per frame, 0 when no frames were timed
+ */
+static double ticksToNanosecondsPerFrame(int64 ticks, int frames)
+{
+    if(frames <= 0)
+    {
+        return 0;
+    }
+
+    return (ticks * 1000000000.0) / cv::getTickFrequency() / frames;
+}
+
+/*!
+ * Get function for the largest resident memory of the process so far
+ *
+ * \return Returns the peak resident memory in kilobytes, -1 if it cannot be read
+ */
+static long getPeakResidentKilobytes()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+
+    if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) == 0)
+    {
+        return -1;
+    }
+
+    return (long)(counters.PeakWorkingSetSize / 1024);
+#else
+    struct rusage usage;
+
+    if(getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return -1;
+    }
+
+#if defined(__APPLE__)
+    //bytes on OS X, kilobytes on Linux
+    return (long)(usage.ru_maxrss / 1024);
+#else
+    return (long)usage.ru_maxrss;
+#endif
+#endif
+}
+
+/*!
+ * Opens the written video as the source of the engine, or the generator's frames when the video could not be written
+ *
+ * \return Returns true if the frames are decoded from the video
+ */
+static bool openSource(AnalysisEngine &engine, const SyntheticVideo &video, const std::string &videoFilePath)
+{
+    if(videoFilePath.empty() == false && engine.openSource(videoFilePath) == true)
+    {
+        return true;
+    }
+
+    engine.openSource(video.getSettings().width, video.getSettings().height, video.getSettings().frameRate);
+
+    return false;
+}
+
+/*!
+ * Gets the next frame of a scenario, decoded from the video or rendered by the generator
+ *
+ * \param frameIndex: The number of frames read before this one
+ * \param frame: Receives the frame
+ * \param frameNumber: Receives the frame number of the frame
+ *
+ * \return Returns false at the end of the video
+ */
+static bool readNextFrame(AnalysisEngine &engine, const SyntheticVideo &video, bool isDecoded, int frameIndex, cv::Mat &frame, int &frameNumber)
+{
+    if(frameIndex >= video.getSettings().frameCount)
+    {
+        return false;
+    }
+
+    if(isDecoded == true)
+    {
+        return engine.readFrame(frame, frameNumber);
+    }
+
+    video.renderFrame(frameIndex, frame);
+    frameNumber = frameIndex;
+
+    return true;
+}
+
+/*!
+ * Runs a scenario through the engine the way an analysis does: decode, analyze, draw and encode the flagged frames
+ *
+ * \param isDrawing: False to skip drawing and encoding the flagged frames, to time the overlay by difference
+ * \param stageProfiler: The profiler the stages are timed with, NULL to run without profiling
+ * \param result: Receives the decode, analyze and encode times, the flagged frames and the allocations
+ *
+ * \return Returns the analyze time in nanoseconds per frame
+ */
+static double runEndToEnd(const scenario &currentScenario, const SyntheticVideo &video, const std::string &videoFilePath, bool isDrawing,
+                          StageProfiler* stageProfiler, scenarioResult &result)
+{
+    flaggedFrameEncoder encoder;
+
+    AnalysisEngine::settings settings = AnalysisEngine::getDefaultSettings();
+    settings.motionSensitivity = MOTION_SENSITIVITY;
+    settings.analysisThreadCount = currentScenario.threads;
+    settings.isDrawingFlaggedFrames = isDrawing;
+
+    AnalysisEngine engine;
+    bool isDecoded = openSource(engine, video, videoFilePath);
+    engine.setRegions(SyntheticVideo::createWellLayout(currentScenario.wells, video.getSettings().width, video.getSettings().height, WELL_THRESHOLD));
+    engine.setSettings(settings);
+    engine.setListener(&encoder);
+    engine.setStageProfiler(stageProfiler);
+    engine.start();
+
+    cv::Mat frame;
+    int frameNumber = 0;
+    int frameIndex = 0;
+
+    int64 decodeTicks = 0;
+    int64 analyzeTicks = 0;
+    int newCalls = 0;
+    int bufferAllocations = 0;
+
+    for(;;)
+    {
+        int newCallsBefore = newCallCount.fetchAndAddRelaxed(0);
+        int64 startTicks = cv::getTickCount();
+
+        if(readNextFrame(engine, video, isDecoded, frameIndex, frame, frameNumber) == false)
+        {
+            break;
+        }
+
+        int64 decodedTicks = cv::getTickCount();
+        int64 encodeTicksBefore = encoder.encodeTicks;
+
+        engine.pushFrame(frame, frameNumber, false);
+
+        int64 analyzedTicks = cv::getTickCount();
+
+        //the first frame allocates the frame buffers, the allocations are counted for the frames after it
+        if(frameIndex > 0)
+        {
+            decodeTicks += decodedTicks - startTicks;
+            analyzeTicks += (analyzedTicks - decodedTicks) - (encoder.encodeTicks - encodeTicksBefore);
+            newCalls += newCallCount.fetchAndAddRelaxed(0) - newCallsBefore;
+            bufferAllocations += engine.getFrameBufferAllocationsLastFrame();
+        }
+        else
+        {
+            encoder.encodeTicks = 0;
+        }
+
+        frameIndex++;
+    }
+
+    engine.finish();
+
+    int timedFrames = frameIndex - 1;
+
+    result.isDecoded = isDecoded;
+    result.framesAnalyzed = engine.getFramesAnalyzed();
+    result.flaggedFrames = encoder.flaggedFrames;
+    result.decodeTime = isDecoded ? ticksToNanosecondsPerFrame(decodeTicks, timedFrames) : 0;
+    result.analyzeTime = ticksToNanosecondsPerFrame(analyzeTicks, timedFrames);
+    result.encodeTime = ticksToNanosecondsPerFrame(encoder.encodeTicks, timedFrames);
+    result.newCallsPerFrame = (timedFrames > 0) ? (double)newCalls / timedFrames : 0;
+    result.bufferAllocationsPerFrame = (timedFrames > 0) ? (double)bufferAllocations / timedFrames : 0;
+
+    return result.analyzeTime;
+}
+
+/*!
+ * Times the stages inside the analysis of a frame on one thread, without the engine around them.  The background
+ * update and the mask are one fused MotionKernel pass over every row and are timed together
+ *
+ * \param result: Receives the background and mask time and the counting time
+ */
+static void timeKernelStages(const scenario &currentScenario, const SyntheticVideo &video, scenarioResult &result)
+{
+    int width = video.getSettings().width;
+    int height = video.getSettings().height;
+
+    std::vector<AnalysisEngine::region> wells = SyntheticVideo::createWellLayout(currentScenario.wells, width, height, WELL_THRESHOLD);
+    std::vector < std::vector<int> > regionCoordinates;
+    std::vector<int> pixelsThatMustChange;
+
+    for(unsigned int i = 0; i < wells.size(); i++)
+    {
+        std::vector<int> coordinates(4);
+        coordinates[0] = wells[i].x;
+        coordinates[1] = wells[i].y;
+        coordinates[2] = wells[i].x + wells[i].width;
+        coordinates[3] = wells[i].y + wells[i].height;
+
+        regionCoordinates.push_back(coordinates);
+        pixelsThatMustChange.push_back((wells[i].width * wells[i].height * wells[i].threshold) / 100);
+    }
+
+    RegionEngine regionEngine;
+    regionEngine.setRegions(regionCoordinates, pixelsThatMustChange, width, height);
+
+    float motionSensitivity = OpenCV::getRunningAverageWeight(MOTION_SENSITIVITY);
+
+    cv::Mat frame;
+    cv::Mat movingAverage(height, width, CV_32FC3);
+    cv::Mat differenceImage(height, width, CV_8UC1);
+    std::vector<unsigned char> flagRow(width * 3);
+
+    int64 backgroundMaskTicks = 0;
+    int64 countingTicks = 0;
+
+    for(int frameNumber = 0; frameNumber < video.getSettings().frameCount; frameNumber++)
+    {
+        video.renderFrame(frameNumber, frame);
+
+        int64 startTicks = cv::getTickCount();
+
+        for(int row = 0; row < height; row++)
+        {
+            if(frameNumber == 0)
+            {
+                MotionKernel::resetRow(frame.ptr<unsigned char>(row), movingAverage.ptr<float>(row), differenceImage.ptr<unsigned char>(row), width);
+            }
+            else
+            {
+                MotionKernel::updateRow(frame.ptr<unsigned char>(row), movingAverage.ptr<float>(row), differenceImage.ptr<unsigned char>(row),
+                                        &flagRow[0], width, motionSensitivity);
+            }
+        }
+
+        int64 maskedTicks = cv::getTickCount();
+
+        regionEngine.countChangedPixels(differenceImage, 0, 0, width, height);
+        regionEngine.finishFrame();
+
+        int64 countedTicks = cv::getTickCount();
+
+        if(frameNumber > 0)
+        {
+            backgroundMaskTicks += maskedTicks - startTicks;
+            countingTicks += countedTicks - maskedTicks;
+        }
+    }
+
+    int timedFrames = video.getSettings().frameCount - 1;
+
+    result.backgroundMaskTime = ticksToNanosecondsPerFrame(backgroundMaskTicks, timedFrames);
+    result.countingTime = ticksToNanosecondsPerFrame(countingTicks, timedFrames);
+}
+
+/*!
+ * Runs one scenario: writes its video, runs it end to end with and without the overlay and with stage profiling, and
+ * times the kernel stages
+ *
+ * \param scratchDirectory: Where the video is written, empty to analyze the generator's frames without decoding
+ * \param isKeepingVideos: False to delete the video after the scenario
+ */
+static scenarioResult runScenario(const scenario &currentScenario, const std::string &scratchDirectory, bool isKeepingVideos)
+{
+    SyntheticVideo video(currentScenario.video);
+    scenarioResult result;
+
+    std::string videoFilePath;
+
+    if(scratchDirectory.empty() == false)
+    {
+        videoFilePath = scratchDirectory + "/synthetic-" + currentScenario.name + ".avi";
+
+        if(video.writeVideo(videoFilePath) == false)
+        {
+            fprintf(stderr, "%s: could not write %s, analyzing generated frames without decoding\n", currentScenario.name.c_str(), videoFilePath.c_str());
+            videoFilePath.clear();
+        }
+    }
+
+    runEndToEnd(currentScenario, video, videoFilePath, true, NULL, result);
+
+    //the overlay is drawn inside the analysis of flagged frames, it is timed as the difference to a run without it
+    scenarioResult withoutOverlay;
+    runEndToEnd(currentScenario, video, videoFilePath, false, NULL, withoutOverlay);
+    result.overlayTime = (result.analyzeTime > withoutOverlay.analyzeTime) ? result.analyzeTime - withoutOverlay.analyzeTime : 0;
+
+    //the same run timed by a profiler, as every analysis of the GUI is. Without a profiler the timers read no clock, the
+    //same as a build with BV_NO_STAGE_PROFILING apart from one pointer check per stage
+    StageProfiler stageProfiler;
+    scenarioResult profiled;
+    runEndToEnd(currentScenario, video, videoFilePath, true, &stageProfiler, profiled);
+
+    double unprofiledTime = result.decodeTime + result.analyzeTime;
+    double profiledTime = profiled.decodeTime + profiled.analyzeTime;
+    result.profilingOverhead = (unprofiledTime > 0) ? (profiledTime - unprofiledTime) * 100.0 / unprofiledTime : 0;
+
+    if(result.profilingOverhead > PROFILING_OVERHEAD_BUDGET)
+    {
+        fprintf(stderr, "%s: stage profiling added %.2f%% to decoding and analyzing, more than %.0f%%\n", currentScenario.name.c_str(),
+                result.profilingOverhead, PROFILING_OVERHEAD_BUDGET);
+    }
+
+    timeKernelStages(currentScenario, video, result);
+
+    if(videoFilePath.empty() == false && isKeepingVideos == false)
+    {
+        remove(videoFilePath.c_str());
+    }
+
+    result.peakResidentKilobytes = getPeakResidentKilobytes();
+
+    return result;
+}
+
+/*!
+ * Creates a scenario from the default video settings
+ */
+static scenario createScenario(const std::string &name, int width, int height, int wells)
+{
+    scenario newScenario;
+    newScenario.name = name;
+    newScenario.video = SyntheticVideo::getDefaultSettings();
+    newScenario.video.width = width;
+    newScenario.video.height = height;
+    newScenario.wells = wells;
+    newScenario.threads = 0;
+
+    return newScenario;
+}
+
+/*!
+ * Lays out the default suite: the common resolutions, plates from 1 to 384 wells, noisy and flickering lighting and a
+ * single analysis thread.  Ordered from the smallest frames up, so the peak memory column grows with the scenarios
+ */
+static std::vector<scenario> createDefaultSuite(int frameCount)
+{
+    std::vector<scenario> suite;
+
+    suite.push_back(createScenario("vga", 640, 480, 6));
+    suite.push_back(createScenario("hd", 1280, 720, 6));
+    suite.push_back(createScenario("hd_1_well", 1280, 720, 1));
+    suite.push_back(createScenario("hd_24_wells", 1280, 720, 24));
+    suite.push_back(createScenario("hd_96_wells", 1280, 720, 96));
+    suite.push_back(createScenario("hd_384_wells", 1280, 720, 384));
+
+    scenario noisy = createScenario("hd_noisy", 1280, 720, 6);
+    noisy.video.noiseLevel = 24;
+    suite.push_back(noisy);
+
+    scenario flickering = createScenario("hd_flicker", 1280, 720, 6);
+    flickering.video.flickerLevel = 20;
+    suite.push_back(flickering);
+
+    scenario singleThread = createScenario("hd_1_thread", 1280, 720, 6);
+    singleThread.threads = 1;
+    suite.push_back(singleThread);
+
+    suite.push_back(createScenario("full_hd", 1920, 1080, 6));
+
+    for(unsigned int i = 0; i < suite.size(); i++)
+    {
+        suite[i].video.frameCount = frameCount;
+    }
+
+    return suite;
+}
+
+static void printUsage()
+{
+    fprintf(stderr,
+            "usage: AnalysisSuite [options]\n"
+            "  runs the default suite, or one custom scenario when any video or well option is given\n"
+            "  --frames N      frames in every video (300)\n"
+            "  --scratch DIR   where the videos are written (.), \"none\" to analyze generated frames without decoding\n"
+            "  --keep-videos   keep the written videos\n"
+            "  --width N --height N --fps N --blobs N --blob-radius N --noise N --flicker N --seed N\n"
+            "  --wells N --threads N (0 for one per core)\n");
+}
+
+int main(int argc, char *argv[])
+{
+    std::string scratchDirectory = ".";
+    bool isKeepingVideos = false;
+    bool isCustom = false;
+
+    scenario custom = createScenario("custom", 1280, 720, 6);
+    int frameCount = custom.video.frameCount;
+
+    for(int i = 1; i < argc; i++)
+    {
+        const char* argument = argv[i];
+
+        if(strcmp(argument, "--keep-videos") == 0)
+        {
+            isKeepingVideos = true;
+            continue;
+        }
+
+        if(i + 1 >= argc)
+        {
+            printUsage();
+            return 2;
+        }
+
+        const char* value = argv[++i];
+
+        if(strcmp(argument, "--frames") == 0)
+            frameCount = atoi(value);
+        else if(strcmp(argument, "--scratch") == 0)
+            scratchDirectory = (strcmp(value, "none") == 0) ? "" : value;
+        else if(strcmp(argument, "--width") == 0)
+            custom.video.width = atoi(value);
+        else if(strcmp(argument, "--height") == 0)
+            custom.video.height = atoi(value);
+        else if(strcmp(argument, "--fps") == 0)
+            custom.video.frameRate = atof(value);
+        else if(strcmp(argument, "--blobs") == 0)
+            custom.video.blobCount = atoi(value);
+        else if(strcmp(argument, "--blob-radius") == 0)
+            custom.video.blobRadius = atoi(value);
+        else if(strcmp(argument, "--noise") == 0)
+            custom.video.noiseLevel = atoi(value);
+        else if(strcmp(argument, "--flicker") == 0)
+            custom.video.flickerLevel = atoi(value);
+        else if(strcmp(argument, "--seed") == 0)
+            custom.video.seed = (unsigned int)strtoul(value, NULL, 10);
+        else if(strcmp(argument, "--wells") == 0)
+            custom.wells = atoi(value);
+        else if(strcmp(argument, "--threads") == 0)
+            custom.threads = atoi(value);
+        else
+        {
+            printUsage();
+            return 2;
+        }
+
+        if(strcmp(argument, "--frames") != 0 && strcmp(argument, "--scratch") != 0)
+        {
+            isCustom = true;
+        }
+    }
+
+    if(frameCount < 2 || custom.video.width <= 0 || custom.video.height <= 0 || custom.wells <= 0)
+    {
+        printUsage();
+        return 2;
+    }
+
+    std::vector<scenario> suite;
+
+    if(isCustom == true)
+    {
+        custom.video.frameCount = frameCount;
+        suite.push_back(custom);
+    }
+    else
+    {
+        suite = createDefaultSuite(frameCount);
+    }
+
+    printf("scenario,source,width,height,frames,wells,blobs,noise,flicker,threads,frames_per_second,ns_per_pixel,"
+           "decode_ns,analyze_ns,encode_ns,background_mask_ns,counting_ns,overlay_ns,profiling_overhead_percent,flagged_frames,"
+           "new_calls_per_frame,buffer_allocations_per_frame,peak_rss_kb\n");
+
+    for(unsigned int i = 0; i < suite.size(); i++)
+    {
+        const scenario &currentScenario = suite[i];
+        scenarioResult result = runScenario(currentScenario, scratchDirectory, isKeepingVideos);
+
+        double frameTime = result.decodeTime + result.analyzeTime + result.encodeTime;
+        double pixels = (double)currentScenario.video.width * currentScenario.video.height;
+
+        printf("%s,%s,%d,%d,%d,%d,%d,%d,%d,%d,%.1f,%.3f,%.0f,%.0f,%.0f,%.0f,%.0f,%.0f,%.2f,%d,%.2f,%.2f,%ld\n",
+               currentScenario.name.c_str(), result.isDecoded ? "avi" : "generated",
+               currentScenario.video.width, currentScenario.video.height, result.framesAnalyzed, currentScenario.wells,
+               currentScenario.video.blobCount, currentScenario.video.noiseLevel, currentScenario.video.flickerLevel, currentScenario.threads,
+               (frameTime > 0) ? 1000000000.0 / frameTime : 0.0, frameTime / pixels,
+               result.decodeTime, result.analyzeTime, result.encodeTime, result.backgroundMaskTime, result.countingTime, result.overlayTime,
+               result.profilingOverhead, result.flaggedFrames, result.newCallsPerFrame, result.bufferAllocationsPerFrame, result.peakResidentKilobytes);
+        fflush(stdout);
+    }
+
+    return 0;
+}
@@ -0,0 +1,29 @@
+#-------------------------------------------------
+#
+# Golden result regression harness.
+# Runs the frozen reference analysis and every variant of the analysis engine over generated clips and given videos,
+# and reports how the flagged frames and changed pixels of each variant differ from the reference's.
+#
+#-------------------------------------------------
+
+QT       = core
+
+TARGET = GoldenResults
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+# the analysis engine and OpenCV
+BIOVISION_TOP = ../..
+include(../../BioVisionCore/BioVisionCore.pri)
+
+# the synthetic video generator of the benchmark suite
+INCLUDEPATH += ../AnalysisSuite
+
+SOURCES += main.cpp \
+    ReferenceAnalysis.cpp \
+    ../AnalysisSuite/SyntheticVideo.cpp
+
+HEADERS += \
+    ReferenceAnalysis.h \
+    ../AnalysisSuite/SyntheticVideo.h
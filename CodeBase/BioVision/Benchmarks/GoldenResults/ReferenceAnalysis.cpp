@@ -0,0 +1,216 @@
+#include "ReferenceAnalysis.h"
+#include "opencv2/imgproc/imgproc.hpp"
+#include <algorithm>
+
+/*!
+ * Constructor, sets up the regions, thresholds and analysis area the way an analysis did
+ *
+ * \param regions: The regions, an empty list analyzes one region covering the frame that passes on any change
+ * \param frameWidth: The width of the frames
+ * \param frameHeight: The height of the frames
+ * \param userSelectedSensitivity: Motion sensitivity selected by the user on the slider
+ * \param isFullFrameAnalysis: True to analyze the whole frame, false to analyze the area containing the regions
+ */
+ReferenceAnalysis::ReferenceAnalysis(const std::vector<AnalysisEngine::region> &regions, int frameWidth, int frameHeight, float userSelectedSensitivity,
+                                     bool isFullFrameAnalysis)
+{
+    std::vector<float> percentOfImageChange;
+    std::vector<int> regionWidths;
+    std::vector<int> regionHeights;
+
+    for(unsigned int i = 0; i < regions.size(); i++)
+    {
+        std::vector<int> coordinates(4);
+        coordinates[0] = regions[i].x;
+        coordinates[1] = regions[i].y;
+        coordinates[2] = regions[i].x + regions[i].width;
+        coordinates[3] = regions[i].y + regions[i].height;
+
+        _regionCoordinates.push_back(coordinates);
+        percentOfImageChange.push_back(regions[i].threshold / 100.0f);
+        regionWidths.push_back(regions[i].width);
+        regionHeights.push_back(regions[i].height);
+    }
+
+    if(regions.size() == 0)
+    {
+        std::vector<int> coordinates(4);
+        coordinates[0] = 0;
+        coordinates[1] = 0;
+        coordinates[2] = frameWidth;
+        coordinates[3] = frameHeight;
+
+        _regionCoordinates.push_back(coordinates);
+        percentOfImageChange.push_back(0);
+        regionWidths.push_back(frameWidth);
+        regionHeights.push_back(frameHeight);
+    }
+
+    for(unsigned int i = 0; i < _regionCoordinates.size(); i++)
+    {
+        //a threshold of 0 flags any pixel changes between frames
+        if(percentOfImageChange[i] > 0)
+        {
+            _pixelsThatMustChangePerRegion.push_back(percentOfImageChange[i] * regionHeights[i] * regionWidths[i]);
+        }
+        else
+        {
+            _pixelsThatMustChangePerRegion.push_back(1);
+        }
+    }
+
+    _regionPixelChanges.assign(_regionCoordinates.size(), 0);
+    _previousFramePixelChanges.assign(_regionCoordinates.size(), 0);
+    _isRegionOverThreshHold.assign(_regionCoordinates.size(), false);
+
+    if(isFullFrameAnalysis == false)
+    {
+        _xStartOfFrameAnalysisArea = _regionCoordinates[0][0];
+        _yStartOfFrameAnalysisArea = _regionCoordinates[0][1];
+        _xEndOfFrameAnalysisArea = _regionCoordinates[0][2];
+        _yEndOfFrameAnalysisArea = _regionCoordinates[0][3];
+
+        for(unsigned int i = 1; i < _regionCoordinates.size(); i++)
+        {
+            _xStartOfFrameAnalysisArea = std::min(_xStartOfFrameAnalysisArea, _regionCoordinates[i][0]);
+            _yStartOfFrameAnalysisArea = std::min(_yStartOfFrameAnalysisArea, _regionCoordinates[i][1]);
+            _xEndOfFrameAnalysisArea = std::max(_xEndOfFrameAnalysisArea, _regionCoordinates[i][2]);
+            _yEndOfFrameAnalysisArea = std::max(_yEndOfFrameAnalysisArea, _regionCoordinates[i][3]);
+        }
+
+        //regions drawn in the GUI never leave the frame, keep generated ones inside it as well
+        _xStartOfFrameAnalysisArea = std::max(_xStartOfFrameAnalysisArea, 0);
+        _yStartOfFrameAnalysisArea = std::max(_yStartOfFrameAnalysisArea, 0);
+        _xEndOfFrameAnalysisArea = std::min(_xEndOfFrameAnalysisArea, frameWidth);
+        _yEndOfFrameAnalysisArea = std::min(_yEndOfFrameAnalysisArea, frameHeight);
+    }
+    else
+    {
+        _xStartOfFrameAnalysisArea = 0;
+        _yStartOfFrameAnalysisArea = 0;
+        _xEndOfFrameAnalysisArea = frameWidth;
+        _yEndOfFrameAnalysisArea = frameHeight;
+    }
+
+    _motionSensitivity = (0.90F + (userSelectedSensitivity / 1000));
+
+    _movingAverage.create(frameHeight, frameWidth, CV_32FC3);
+}
+
+/*!
+ * Destructor
+ */
+ReferenceAnalysis::~ReferenceAnalysis()
+{
+
+}
+
+/*!
+ * Analyzes the next frame
+ *
+ * \param frame: The frame, a 3 channel BGR image with the size given to the constructor
+ * \param isEditFrame: True to reset the running average to this frame, as on the first frame or at an edit point
+ *
+ * \return Returns true if at least one region passed its threshold on this frame
+ */
+bool ReferenceAnalysis::analyzeFrame(const cv::Mat &frame, bool isEditFrame)
+{
+    //if this is the first frame to analyze, or first frame after an edit point, set the average to it,
+    //else update the average frame motion
+    if(isEditFrame == true)
+    {
+        frame.convertTo(_movingAverage, CV_32FC3, 1.0, 0.0);
+    }
+    else
+    {
+        cv::accumulateWeighted(frame, _movingAverage, _motionSensitivity);
+    }
+
+    cv::Mat average;
+    _movingAverage.convertTo(average, CV_8UC3, 1.0, 0.0);
+
+    //pixels brighter than the running average, the scalar 100 only offsets the first channel
+    cv::Mat difference;
+    cv::compare(frame, average + 100, difference, cv::CMP_GT);
+
+    cv::Mat greyDifference;
+    cv::cvtColor(difference, greyDifference, CV_RGB2GRAY);
+    cv::threshold(greyDifference, greyDifference, 70, 255, CV_THRESH_BINARY);
+
+    for(int i = _yStartOfFrameAnalysisArea; i < _yEndOfFrameAnalysisArea; i++)
+    {
+        const unsigned char* currentRow = greyDifference.ptr<unsigned char>(i);
+
+        for(int j = _xStartOfFrameAnalysisArea; j < _xEndOfFrameAnalysisArea; j++)
+        {
+            if(currentRow[j] != 0)
+            {
+                for(unsigned int regionNum = 0; regionNum < _regionCoordinates.size(); regionNum++)
+                {
+                    if(j >= _regionCoordinates[regionNum][0] && j <= _regionCoordinates[regionNum][2] &&
+                       i >= _regionCoordinates[regionNum][1] && i <= _regionCoordinates[regionNum][3])
+                    {
+                        _regionPixelChanges[regionNum]++;
+                    }
+                }
+            }
+        }
+    }
+
+    bool atLeastOneThreshHoldPassed = false;
+
+    for(unsigned int regionNum = 0; regionNum < _regionCoordinates.size(); regionNum++)
+    {
+        _isRegionOverThreshHold[regionNum] = (_pixelsThatMustChangePerRegion[regionNum] <= _regionPixelChanges[regionNum]) &&
+                                             (_regionPixelChanges[regionNum] != _previousFramePixelChanges[regionNum]) &&
+                                             (_regionPixelChanges[regionNum] != 0);
+
+        if(_isRegionOverThreshHold[regionNum] == true)
+        {
+            atLeastOneThreshHoldPassed = true;
+        }
+    }
+
+    //set the previous pixel differences for the next frame, the counts of this frame stay readable until then
+    for(unsigned int regionNum = 0; regionNum < _regionPixelChanges.size(); regionNum++)
+    {
+        _previousFramePixelChanges[regionNum] = _regionPixelChanges[regionNum];
+        _regionPixelChanges[regionNum] = 0;
+    }
+
+    return atLeastOneThreshHoldPassed;
+}
+
+/*!
+ * Get function for the number of regions
+ *
+ * \return Returns the number of regions, 1 when the frame is analyzed as one region
+ */
+int ReferenceAnalysis::getNumberOfRegions()
+{
+    return _regionCoordinates.size();
+}
+
+/*!
+ * Get function for the changed pixels of a region on the last analyzed frame
+ *
+ * \param regionNumber: The region, in the order the regions were given
+ *
+ * \return Returns the number of changed pixels
+ */
+int ReferenceAnalysis::getPixelChanges(int regionNumber)
+{
+    return _previousFramePixelChanges[regionNumber];
+}
+
+/*!
+ * Get function for whether a region passed its threshold on the last analyzed frame
+ *
+ * \param regionNumber: The region, in the order the regions were given
+ *
+ * \return Returns true if the region passed its threshold
+ */
+bool ReferenceAnalysis::isRegionOverThreshHold(int regionNumber)
+{
+    return _isRegionOverThreshHold[regionNumber];
+}
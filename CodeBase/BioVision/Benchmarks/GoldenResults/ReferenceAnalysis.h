@@ -0,0 +1,56 @@
+/*!
+ * \class ReferenceAnalysis
+ *
+ * The motion analysis exactly as OpenCV::analyzeCurrentFrame() computed it before any of it was optimized, kept as the
+ * reference the analysis engine is checked against.  Do not optimize or otherwise change this class: results published
+ * with BioVision were made with this algorithm, and the golden harness compares every variant of the engine to it.
+ *
+ * Every frame goes through the original chain of whole frame operations: the running average is updated with the
+ * motion sensitivity as its weight, converted to 8 bits, and the frame is compared to it plus 100 (which only offsets
+ * the first channel).  The compare mask is converted to gray with CV_RGB2GRAY, thresholded at 70, and every changed
+ * pixel inside the analysis area is counted in each region that contains it.  The analysis area is the whole frame,
+ * or runs from the smallest X1 and Y1 of the regions up to, but not including, their largest X2 and Y2.
+ *
+ * Drawing and saving flagged frames are left out, they do not change which frames are flagged.
+ */
+
+#ifndef REFERENCEANALYSIS_H
+#define REFERENCEANALYSIS_H
+
+#include "AnalysisEngine.h"
+#include "opencv2/core/core.hpp"
+#include <vector>
+
+class ReferenceAnalysis
+{
+
+public:
+    ReferenceAnalysis(const std::vector<AnalysisEngine::region> &regions, int frameWidth, int frameHeight, float userSelectedSensitivity,
+                      bool isFullFrameAnalysis);
+    ~ReferenceAnalysis();
+
+    bool analyzeFrame(const cv::Mat &frame, bool isEditFrame);
+
+    int getNumberOfRegions();
+    int getPixelChanges(int regionNumber);
+    bool isRegionOverThreshHold(int regionNumber);
+
+private:
+    //X1, Y1, X2 and Y2 of every region, end points are inclusive
+    std::vector < std::vector<int> > _regionCoordinates;
+    std::vector<int> _pixelsThatMustChangePerRegion;
+
+    std::vector<int> _regionPixelChanges;
+    std::vector<int> _previousFramePixelChanges;
+    std::vector<bool> _isRegionOverThreshHold;
+
+    int _xStartOfFrameAnalysisArea;
+    int _yStartOfFrameAnalysisArea;
+    int _xEndOfFrameAnalysisArea;
+    int _yEndOfFrameAnalysisArea;
+
+    float _motionSensitivity;
+
+    cv::Mat _movingAverage;
+};
+#endif
@@ -0,0 +1,692 @@
+///////////////////////////////////////////////////////////
+//  main.cpp
+//  Golden result regression harness
+///////////////////////////////////////////////////////////
+
+#include "ReferenceAnalysis.h"
+#include "SyntheticVideo.h"
+#include "AnalysisEngine.h"
+#include "MotionKernel.h"
+#include "opencv2/core/core.hpp"
+#include "opencv2/highgui/highgui.hpp"
+#include <algorithm>
+#include <iterator>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//the sensitivity every clip is analyzed with, the middle of the options window's slider
+static const int MOTION_SENSITIVITY = 49;
+
+//threshold of every well in percent
+static const int WELL_THRESHOLD = 1;
+
+//mismatching frames printed for each region with --verbose
+static const int MAX_REPORTED_FRAMES = 5;
+
+//a clip of the corpus, generated or read from a video file
+struct clip
+{
+    std::string name;
+    std::string filePath;
+    SyntheticVideo::videoSettings video;
+    int wells;
+
+    //true to stretch the wells of the last column and row to the frame's right and bottom edge
+    bool isReachingFrameEdge;
+
+    //frames between edit points, where the running average is reset, 0 for none
+    int editInterval;
+};
+
+//a configuration of the engine checked against the reference
+struct variant
+{
+    std::string name;
+    AnalysisEngine::settings settings;
+
+    //true if the variant must give the reference's results exactly, false if it may differ within the tolerances
+    bool isExactRequired;
+
+    //share of the reference's flagged frames that may be missing or extra, and the allowed pixel count error, in percent
+    double flagTolerance;
+    double pixelTolerance;
+};
+
+//the flagged frames and changed pixels of every region in one run over a clip
+struct runResult
+{
+    int framesAnalyzed;
+    std::vector < std::vector<int> > flaggedFrames;
+    std::vector < std::vector<int> > pixelChanges;
+};
+
+//how a variant's results differ from the reference's
+struct comparison
+{
+    int referenceFlags;
+    int missingFlags;
+    int extraFlags;
+    int differingCounts;
+    int largestCountDifference;
+    double pixelError;
+};
+
+//reads the frames of a clip, rendering generated clips and decoding the others
+class clipReader
+{
+public:
+    clipReader(const clip &sourceClip, int frameLimit)
+    {
+        _video = NULL;
+        _frameLimit = frameLimit;
+        _framesRead = 0;
+
+        if(sourceClip.filePath.empty() == true)
+        {
+            _video = new SyntheticVideo(sourceClip.video);
+            _frameLimit = sourceClip.video.frameCount;
+            width = sourceClip.video.width;
+            height = sourceClip.video.height;
+            frameRate = sourceClip.video.frameRate;
+        }
+        else
+        {
+            _capture.open(sourceClip.filePath);
+            width = (int)_capture.get(CV_CAP_PROP_FRAME_WIDTH);
+            height = (int)_capture.get(CV_CAP_PROP_FRAME_HEIGHT);
+            frameRate = _capture.get(CV_CAP_PROP_FPS);
+        }
+    }
+
+    ~clipReader()
+    {
+        delete _video;
+    }
+
+    bool isOpened()
+    {
+        return _video != NULL || _capture.isOpened();
+    }
+
+    bool read(cv::Mat &frame)
+    {
+        if(_frameLimit > 0 && _framesRead >= _frameLimit)
+        {
+            return false;
+        }
+
+        if(_video != NULL)
+        {
+            _video->renderFrame(_framesRead, frame);
+        }
+        else if(_capture.read(frame) == false || frame.empty() == true)
+        {
+            return false;
+        }
+
+        _framesRead++;
+
+        return true;
+    }
+
+    int width;
+    int height;
+    double frameRate;
+
+private:
+    SyntheticVideo* _video;
+    cv::VideoCapture _capture;
+    int _frameLimit;
+    int _framesRead;
+};
+
+//records the result of every frame the engine analyzes
+class resultRecorder : public AnalysisEngine::frameListener
+{
+public:
+    resultRecorder(runResult &result) : _result(result)
+    {
+
+    }
+
+    void frameAnalyzed(const AnalysisEngine::frameResult &frameResult)
+    {
+        for(unsigned int i = 0; i < frameResult.changedPixels.size(); i++)
+        {
+            _result.pixelChanges[i].push_back(frameResult.changedPixels[i]);
+
+            if(frameResult.isRegionOverThreshHold[i] == true)
+            {
+                _result.flaggedFrames[i].push_back(frameResult.frameNumber);
+            }
+        }
+    }
+
+private:
+    runResult &_result;
+};
+
+/*!
+ * Checks whether the running average is reset on a frame, as on the first frame or at an edit point
+ */
+static bool isEditFrame(const clip &sourceClip, int frameNumber)
+{
+    return frameNumber == 0 || (sourceClip.editInterval > 0 && frameNumber % sourceClip.editInterval == 0);
+}
+
+/*!
+ * Lays out the wells of a clip over its frames
+ */
+static std::vector<AnalysisEngine::region> createClipRegions(const clip &sourceClip, int frameWidth, int frameHeight)
+{
+    std::vector<AnalysisEngine::region> wells = SyntheticVideo::createWellLayout(sourceClip.wells, frameWidth, frameHeight, WELL_THRESHOLD);
+
+    if(sourceClip.isReachingFrameEdge == true)
+    {
+        int largestX2 = 0;
+        int largestY2 = 0;
+
+        for(unsigned int i = 0; i < wells.size(); i++)
+        {
+            largestX2 = std::max(largestX2, wells[i].x + wells[i].width);
+            largestY2 = std::max(largestY2, wells[i].y + wells[i].height);
+        }
+
+        //X2 and Y2 land on the frame width and height, as for a region covering the whole frame
+        for(unsigned int i = 0; i < wells.size(); i++)
+        {
+            if(wells[i].x + wells[i].width == largestX2)
+            {
+                wells[i].width = frameWidth - wells[i].x;
+            }
+
+            if(wells[i].y + wells[i].height == largestY2)
+            {
+                wells[i].height = frameHeight - wells[i].y;
+            }
+        }
+    }
+
+    return wells;
+}
+
+/*!
+ * Runs the reference analysis over a clip
+ *
+ * \return Returns false if the clip could not be opened
+ */
+static bool runReference(const clip &sourceClip, int frameLimit, bool isFullFrameAnalysis, runResult &result)
+{
+    clipReader reader(sourceClip, frameLimit);
+
+    if(reader.isOpened() == false)
+    {
+        return false;
+    }
+
+    std::vector<AnalysisEngine::region> wells = createClipRegions(sourceClip, reader.width, reader.height);
+    ReferenceAnalysis reference(wells, reader.width, reader.height, MOTION_SENSITIVITY, isFullFrameAnalysis);
+
+    result.framesAnalyzed = 0;
+    result.flaggedFrames.assign(reference.getNumberOfRegions(), std::vector<int>());
+    result.pixelChanges.assign(reference.getNumberOfRegions(), std::vector<int>());
+
+    cv::Mat frame;
+
+    while(reader.read(frame) == true)
+    {
+        reference.analyzeFrame(frame, isEditFrame(sourceClip, result.framesAnalyzed));
+
+        for(int i = 0; i < reference.getNumberOfRegions(); i++)
+        {
+            result.pixelChanges[i].push_back(reference.getPixelChanges(i));
+
+            if(reference.isRegionOverThreshHold(i) == true)
+            {
+                result.flaggedFrames[i].push_back(result.framesAnalyzed);
+            }
+        }
+
+        result.framesAnalyzed++;
+    }
+
+    return true;
+}
+
+/*!
+ * Runs a variant of the engine over a clip
+ *
+ * \return Returns false if the clip could not be opened or the engine could not start
+ */
+static bool runVariant(const clip &sourceClip, int frameLimit, const variant &engineVariant, runResult &result)
+{
+    clipReader reader(sourceClip, frameLimit);
+
+    if(reader.isOpened() == false)
+    {
+        return false;
+    }
+
+    std::vector<AnalysisEngine::region> wells = createClipRegions(sourceClip, reader.width, reader.height);
+
+    resultRecorder recorder(result);
+
+    AnalysisEngine engine;
+    engine.openSource(reader.width, reader.height, reader.frameRate);
+    engine.setRegions(wells);
+    engine.setSettings(engineVariant.settings);
+    engine.setListener(&recorder);
+
+    if(engine.start() == false)
+    {
+        return false;
+    }
+
+    //a clip without wells is analyzed as one region covering the frame
+    result.framesAnalyzed = 0;
+    result.flaggedFrames.assign(engine.getNumberOfRegions(), std::vector<int>());
+    result.pixelChanges.assign(engine.getNumberOfRegions(), std::vector<int>());
+
+    cv::Mat frame;
+
+    while(reader.read(frame) == true)
+    {
+        engine.pushFrame(frame, result.framesAnalyzed, isEditFrame(sourceClip, result.framesAnalyzed));
+        result.framesAnalyzed++;
+    }
+
+    engine.finish();
+
+    return true;
+}
+
+/*!
+ * Compares the flagged frames and changed pixels of a variant to the reference's, region by region
+ *
+ * \param isVerbose: True to print the first frames that differ in each region to stderr
+ */
+static comparison compareResults(const runResult &reference, const runResult &result, const std::string &label, bool isVerbose)
+{
+    comparison difference;
+    difference.referenceFlags = 0;
+    difference.missingFlags = 0;
+    difference.extraFlags = 0;
+    difference.differingCounts = 0;
+    difference.largestCountDifference = 0;
+
+    double referencePixels = 0;
+    double pixelDifference = 0;
+
+    for(unsigned int region = 0; region < reference.flaggedFrames.size() && region < result.flaggedFrames.size(); region++)
+    {
+        const std::vector<int> &referenceFlags = reference.flaggedFrames[region];
+        const std::vector<int> &resultFlags = result.flaggedFrames[region];
+
+        std::vector<int> missing;
+        std::vector<int> extra;
+        std::set_difference(referenceFlags.begin(), referenceFlags.end(), resultFlags.begin(), resultFlags.end(), std::back_inserter(missing));
+        std::set_difference(resultFlags.begin(), resultFlags.end(), referenceFlags.begin(), referenceFlags.end(), std::back_inserter(extra));
+
+        difference.referenceFlags += referenceFlags.size();
+        difference.missingFlags += missing.size();
+        difference.extraFlags += extra.size();
+
+        int reportedFrames = 0;
+        unsigned int frames = std::min(reference.pixelChanges[region].size(), result.pixelChanges[region].size());
+
+        for(unsigned int frame = 0; frame < frames; frame++)
+        {
+            int referenceCount = reference.pixelChanges[region][frame];
+            int countDifference = abs(result.pixelChanges[region][frame] - referenceCount);
+
+            referencePixels += referenceCount;
+            pixelDifference += countDifference;
+
+            if(countDifference != 0)
+            {
+                difference.differingCounts++;
+                difference.largestCountDifference = std::max(difference.largestCountDifference, countDifference);
+
+                if(isVerbose == true && reportedFrames < MAX_REPORTED_FRAMES)
+                {
+                    fprintf(stderr, "%s: region %u frame %u: %d changed pixels, reference %d\n", label.c_str(), region + 1, frame,
+                            result.pixelChanges[region][frame], referenceCount);
+                    reportedFrames++;
+                }
+            }
+        }
+
+        if(isVerbose == true)
+        {
+            for(unsigned int i = 0; i < missing.size() && (int)i < MAX_REPORTED_FRAMES; i++)
+            {
+                fprintf(stderr, "%s: region %u frame %d: flagged by the reference only\n", label.c_str(), region + 1, missing[i]);
+            }
+
+            for(unsigned int i = 0; i < extra.size() && (int)i < MAX_REPORTED_FRAMES; i++)
+            {
+                fprintf(stderr, "%s: region %u frame %d: flagged by the variant only\n", label.c_str(), region + 1, extra[i]);
+            }
+        }
+    }
+
+    difference.pixelError = (referencePixels > 0) ? (pixelDifference * 100.0) / referencePixels : (pixelDifference > 0 ? 100.0 : 0.0);
+
+    return difference;
+}
+
+/*!
+ * Decides whether a variant passes on a clip
+ *
+ * \return Returns "exact", "within_tolerance" or "MISMATCH"
+ */
+static const char* getVerdict(const variant &engineVariant, const runResult &reference, const runResult &result, const comparison &difference)
+{
+    bool isExact = (result.framesAnalyzed == reference.framesAnalyzed) && difference.missingFlags == 0 && difference.extraFlags == 0 &&
+                   difference.differingCounts == 0;
+
+    if(isExact == true)
+    {
+        return "exact";
+    }
+
+    if(engineVariant.isExactRequired == true || result.framesAnalyzed != reference.framesAnalyzed)
+    {
+        return "MISMATCH";
+    }
+
+    double allowedFlags = engineVariant.flagTolerance * std::max(difference.referenceFlags, 1) / 100.0;
+
+    if(difference.missingFlags + difference.extraFlags <= allowedFlags && difference.pixelError <= engineVariant.pixelTolerance)
+    {
+        return "within_tolerance";
+    }
+
+    return "MISMATCH";
+}
+
+/*!
+ * Creates a variant from the engine's default settings
+ */
+static variant createVariant(const std::string &name, bool isExactRequired, double flagTolerance, double pixelTolerance)
+{
+    variant newVariant;
+    newVariant.name = name;
+    newVariant.settings = AnalysisEngine::getDefaultSettings();
+    newVariant.settings.motionSensitivity = MOTION_SENSITIVITY;
+    newVariant.isExactRequired = isExactRequired;
+    newVariant.flagTolerance = flagTolerance;
+    newVariant.pixelTolerance = pixelTolerance;
+
+    return newVariant;
+}
+
+/*!
+ * Lays out the variants: the optimized paths that must match the reference exactly, and the approximations that may
+ * differ from it within a tolerance
+ */
+static std::vector<variant> createVariants()
+{
+    std::vector<variant> variants;
+
+    //the motion kernel as compiled, with a band per core
+    variants.push_back(createVariant("default", true, 0, 0));
+
+    variant singleThread = createVariant("single_thread", true, 0, 0);
+    singleThread.settings.analysisThreadCount = 1;
+    variants.push_back(singleThread);
+
+    variant fullFrame = createVariant("full_frame", true, 0, 0);
+    fullFrame.settings.isFullFrameAnalysis = true;
+    variants.push_back(fullFrame);
+
+    variant fixedPoint = createVariant("fixed_point", false, 1.0, 1.0);
+    fixedPoint.settings.isFixedPointBackground = true;
+    variants.push_back(fixedPoint);
+
+    variant luma = createVariant("luma", false, 5.0, 10.0);
+    luma.settings.isLumaAnalysis = true;
+    variants.push_back(luma);
+
+    variant halfScale = createVariant("half_scale", false, 10.0, 25.0);
+    halfScale.settings.analysisScale = 2;
+    variants.push_back(halfScale);
+
+    variant quarterScale = createVariant("quarter_scale", false, 20.0, 40.0);
+    quarterScale.settings.analysisScale = 4;
+    variants.push_back(quarterScale);
+
+    return variants;
+}
+
+/*!
+ * Creates a generated clip from the default video settings
+ */
+static clip createSyntheticClip(const std::string &name, int wells, int frameCount)
+{
+    clip newClip;
+    newClip.name = name;
+    newClip.video = SyntheticVideo::getDefaultSettings();
+    newClip.video.width = 640;
+    newClip.video.height = 480;
+    newClip.video.frameCount = frameCount;
+    newClip.wells = wells;
+    newClip.isReachingFrameEdge = false;
+    newClip.editInterval = 0;
+
+    return newClip;
+}
+
+/*!
+ * Lays out the generated part of the corpus: light and heavy noise, flicker, edit points, a large plate, regions on
+ * the frame edge and no regions at all
+ */
+static std::vector<clip> createSyntheticCorpus(int frameCount)
+{
+    std::vector<clip> corpus;
+
+    corpus.push_back(createSyntheticClip("synthetic", 6, frameCount));
+
+    clip noisy = createSyntheticClip("synthetic_noisy", 6, frameCount);
+    noisy.video.noiseLevel = 24;
+    corpus.push_back(noisy);
+
+    clip flickering = createSyntheticClip("synthetic_flicker", 6, frameCount);
+    flickering.video.flickerLevel = 20;
+    corpus.push_back(flickering);
+
+    clip edits = createSyntheticClip("synthetic_edits", 6, frameCount);
+    edits.editInterval = 50;
+    corpus.push_back(edits);
+
+    clip plate = createSyntheticClip("synthetic_96_wells", 96, frameCount);
+    plate.video.blobCount = 12;
+    plate.video.blobRadius = 8;
+    corpus.push_back(plate);
+
+    //odd sizes leave a remainder after the vector kernels and the scaled down frames
+    clip oddSize = createSyntheticClip("synthetic_odd_size", 7, frameCount);
+    oddSize.video.width = 651;
+    oddSize.video.height = 487;
+    corpus.push_back(oddSize);
+
+    //wells reaching the frame edge, whose last column and row are analyzed
+    clip edgeWells = createSyntheticClip("synthetic_edge_wells", 6, frameCount);
+    edgeWells.isReachingFrameEdge = true;
+    corpus.push_back(edgeWells);
+
+    //no wells, the whole frame is one region that passes on any change and its edge is analyzed as well
+    corpus.push_back(createSyntheticClip("synthetic_no_regions", 0, frameCount));
+
+    return corpus;
+}
+
+static void printUsage()
+{
+    fprintf(stderr,
+            "usage: GoldenResults [options] [video ...]\n"
+            "  compares every variant of the analysis engine to the reference analysis, on generated clips and the given videos\n"
+            "  --frames N           frames analyzed of each clip (300), 0 to analyze all of every video\n"
+            "  --wells N            wells laid over the given videos (6), 0 to analyze them without regions\n"
+            "  --variant NAME       check only this variant, may be repeated\n"
+            "  --no-synthetic       check only the given videos\n"
+            "  --flag-tolerance P   flagged frames that may differ in tolerance variants, percent of the reference's\n"
+            "  --pixel-tolerance P  changed pixel error allowed in tolerance variants, in percent\n"
+            "  --verbose            print the first differing frames of every region\n");
+}
+
+int main(int argc, char *argv[])
+{
+    int frameLimit = 300;
+    int videoWells = 6;
+    bool isSyntheticIncluded = true;
+    bool isVerbose = false;
+    double flagTolerance = -1;
+    double pixelTolerance = -1;
+
+    std::vector<std::string> videoFilePaths;
+    std::vector<std::string> selectedVariants;
+
+    for(int i = 1; i < argc; i++)
+    {
+        const char* argument = argv[i];
+        bool hasValue = (i + 1 < argc);
+
+        if(strcmp(argument, "--no-synthetic") == 0)
+            isSyntheticIncluded = false;
+        else if(strcmp(argument, "--verbose") == 0)
+            isVerbose = true;
+        else if(strcmp(argument, "--frames") == 0 && hasValue)
+            frameLimit = atoi(argv[++i]);
+        else if(strcmp(argument, "--wells") == 0 && hasValue)
+            videoWells = atoi(argv[++i]);
+        else if(strcmp(argument, "--variant") == 0 && hasValue)
+            selectedVariants.push_back(argv[++i]);
+        else if(strcmp(argument, "--flag-tolerance") == 0 && hasValue)
+            flagTolerance = atof(argv[++i]);
+        else if(strcmp(argument, "--pixel-tolerance") == 0 && hasValue)
+            pixelTolerance = atof(argv[++i]);
+        else if(argument[0] != '-')
+            videoFilePaths.push_back(argument);
+        else
+        {
+            printUsage();
+            return 2;
+        }
+    }
+
+    if(frameLimit < 0 || videoWells < 0 || (isSyntheticIncluded == false && videoFilePaths.empty() == true))
+    {
+        printUsage();
+        return 2;
+    }
+
+    std::vector<clip> corpus;
+
+    if(isSyntheticIncluded == true)
+    {
+        //generated clips need a length
+        corpus = createSyntheticCorpus((frameLimit > 0) ? frameLimit : 300);
+    }
+
+    for(unsigned int i = 0; i < videoFilePaths.size(); i++)
+    {
+        clip video;
+        video.name = videoFilePaths[i];
+        video.filePath = videoFilePaths[i];
+        video.wells = videoWells;
+        video.isReachingFrameEdge = false;
+        video.editInterval = 0;
+
+        corpus.push_back(video);
+    }
+
+    std::vector<variant> variants;
+    std::vector<variant> allVariants = createVariants();
+
+    for(unsigned int i = 0; i < allVariants.size(); i++)
+    {
+        if(selectedVariants.empty() == false && std::find(selectedVariants.begin(), selectedVariants.end(), allVariants[i].name) == selectedVariants.end())
+        {
+            continue;
+        }
+
+        if(flagTolerance >= 0 && allVariants[i].isExactRequired == false)
+        {
+            allVariants[i].flagTolerance = flagTolerance;
+        }
+
+        if(pixelTolerance >= 0 && allVariants[i].isExactRequired == false)
+        {
+            allVariants[i].pixelTolerance = pixelTolerance;
+        }
+
+        variants.push_back(allVariants[i]);
+    }
+
+    if(variants.empty() == true)
+    {
+        fprintf(stderr, "no variant matches the names given with --variant\n");
+        return 2;
+    }
+
+    fprintf(stderr, "motion kernel: %s\n", MotionKernel::getInstructionSet());
+
+    printf("clip,variant,frames,regions,reference_flags,missing_flags,extra_flags,differing_counts,largest_count_difference,"
+           "pixel_error_percent,verdict\n");
+
+    bool isEveryVariantPassing = true;
+
+    for(unsigned int i = 0; i < corpus.size(); i++)
+    {
+        //the reference is run once for each analysis area the variants use
+        runResult regionReference;
+        runResult fullFrameReference;
+        bool hasRegionReference = false;
+        bool hasFullFrameReference = false;
+
+        for(unsigned int j = 0; j < variants.size(); j++)
+        {
+            bool isFullFrameAnalysis = variants[j].settings.isFullFrameAnalysis;
+            runResult &reference = isFullFrameAnalysis ? fullFrameReference : regionReference;
+            bool &hasReference = isFullFrameAnalysis ? hasFullFrameReference : hasRegionReference;
+
+            if(hasReference == false)
+            {
+                if(runReference(corpus[i], frameLimit, isFullFrameAnalysis, reference) == false)
+                {
+                    fprintf(stderr, "%s: could not be opened\n", corpus[i].name.c_str());
+                    isEveryVariantPassing = false;
+                    break;
+                }
+
+                hasReference = true;
+            }
+
+            runResult result;
+
+            if(runVariant(corpus[i], frameLimit, variants[j], result) == false)
+            {
+                fprintf(stderr, "%s: the %s variant could not be run\n", corpus[i].name.c_str(), variants[j].name.c_str());
+                isEveryVariantPassing = false;
+                continue;
+            }
+
+            comparison difference = compareResults(reference, result, corpus[i].name + " " + variants[j].name, isVerbose);
+            const char* verdict = getVerdict(variants[j], reference, result, difference);
+
+            if(strcmp(verdict, "MISMATCH") == 0)
+            {
+                isEveryVariantPassing = false;
+            }
+
+            printf("%s,%s,%d,%u,%d,%d,%d,%d,%d,%.3f,%s\n", corpus[i].name.c_str(), variants[j].name.c_str(), result.framesAnalyzed,
+                   (unsigned int)reference.flaggedFrames.size(), difference.referenceFlags, difference.missingFlags, difference.extraFlags,
+                   difference.differingCounts, difference.largestCountDifference, difference.pixelError, verdict);
+            fflush(stdout);
+        }
+    }
+
+    return isEveryVariantPassing ? 0 : 1;
+}
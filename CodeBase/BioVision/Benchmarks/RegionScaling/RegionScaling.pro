@@ -0,0 +1,26 @@
+#-------------------------------------------------
+#
+# Region engine scaling benchmark.
+# Counts changed pixels for 1 to 400 regions and reports the time per frame.
+#
+#-------------------------------------------------
+
+QT       = core
+
+TARGET = RegionScaling
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+# the analysis engine and OpenCV
+BIOVISION_TOP = ../..
+include(../../BioVisionCore/BioVisionCore.pri)
+
+# the well layout of the benchmark suite
+INCLUDEPATH += ../AnalysisSuite
+
+SOURCES += main.cpp \
+    ../AnalysisSuite/SyntheticVideo.cpp
+
+HEADERS += \
+    ../AnalysisSuite/SyntheticVideo.h
@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////
+//  main.cpp
+//  Region engine scaling benchmark
+///////////////////////////////////////////////////////////
+
+#include "RegionEngine.h"
+#include "SyntheticVideo.h"
+#include "AnalysisEngine.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+//benchmark frame size, a 1080p recording
+static const int FRAME_WIDTH = 1920;
+static const int FRAME_HEIGHT = 1080;
+
+//number of frames counted for each region layout
+static const int FRAMES_PER_LAYOUT = 200;
+
+/*!
+ * Lays out the wells of a multi-well plate covering the frame, as every benchmark does
+ *
+ * \param numberOfRegions: How many wells to create
+ * \param isOverlapping: Grow each well by a few pixels so neighbours overlap, forcing the summed area table strategy
+ * \param regionCoordinates: Receives X1, Y1, X2 and Y2 of every well
+ */
+static void createWellLayout(int numberOfRegions, bool isOverlapping, std::vector < std::vector<int> > &regionCoordinates)
+{
+    std::vector<AnalysisEngine::region> wells = SyntheticVideo::createWellLayout(numberOfRegions, FRAME_WIDTH, FRAME_HEIGHT, 1);
+    regionCoordinates = AnalysisEngine::createRegionTable(wells, FRAME_WIDTH, FRAME_HEIGHT).regionCoordinates;
+
+    int growth = isOverlapping ? 4 : 0;
+
+    for(unsigned int i = 0; i < regionCoordinates.size(); i++)
+    {
+        regionCoordinates[i][2] += growth;
+        regionCoordinates[i][3] += growth;
+    }
+}
+
+/*!
+ * Times region counting for one layout
+ *
+ * \return Returns the average time to count one frame in microseconds
+ */
+static double timeLayout(int numberOfRegions, bool isOverlapping, std::vector<cv::Mat> &differenceImages, bool &isUsingLabelMap)
+{
+    std::vector < std::vector<int> > regionCoordinates;
+    createWellLayout(numberOfRegions, isOverlapping, regionCoordinates);
+
+    std::vector<int> pixelsThatMustChange(numberOfRegions, 1);
+
+    RegionEngine regionEngine;
+    regionEngine.setRegions(regionCoordinates, pixelsThatMustChange, FRAME_WIDTH, FRAME_HEIGHT);
+    isUsingLabelMap = regionEngine.isUsingLabelMap();
+
+    int64 startTicks = cv::getTickCount();
+
+    for(int frame = 0; frame < FRAMES_PER_LAYOUT; frame++)
+    {
+        regionEngine.countChangedPixels(differenceImages[frame % differenceImages.size()], 0, 0, FRAME_WIDTH, FRAME_HEIGHT);
+        regionEngine.finishFrame();
+    }
+
+    double seconds = (cv::getTickCount() - startTicks) / cv::getTickFrequency();
+
+    return (seconds * 1000000.0) / FRAMES_PER_LAYOUT;
+}
+
+int main(int argc, char *argv[])
+{
+    //a few difference images with roughly 5% of pixels changed
+    std::vector<cv::Mat> differenceImages;
+    cv::RNG rng(12345);
+
+    for(int i = 0; i < 8; i++)
+    {
+        cv::Mat noise(FRAME_HEIGHT, FRAME_WIDTH, CV_8UC1);
+        rng.fill(noise, cv::RNG::UNIFORM, 0, 100);
+        cv::Mat differenceImage = (noise < 5);
+        differenceImages.push_back(differenceImage);
+    }
+
+    const int regionCounts[] = { 1, 2, 6, 12, 24, 48, 96, 200, 384, 400 };
+    const int numberOfLayouts = sizeof(regionCounts) / sizeof(regionCounts[0]);
+
+    printf("regions,strategy,microseconds_per_frame\n");
+
+    for(int i = 0; i < numberOfLayouts; i++)
+    {
+        for(int overlapping = 0; overlapping < 2; overlapping++)
+        {
+            bool isUsingLabelMap = false;
+            double microseconds = timeLayout(regionCounts[i], overlapping == 1, differenceImages, isUsingLabelMap);
+
+            printf("%d,%s,%.1f\n", regionCounts[i], isUsingLabelMap ? "label_map" : "summed_area_table", microseconds);
+        }
+    }
+
+    return 0;
+}
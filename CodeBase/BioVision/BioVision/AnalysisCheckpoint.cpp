@@ -0,0 +1,291 @@
+#include "AnalysisCheckpoint.h"
+#include <QDataStream>
+#include <QFile>
+#include <QDir>
+#include <QStringList>
+#include <algorithm>
+
+//"BVCP", marks a checkpoint file
+static const quint32 CHECKPOINT_MAGIC = 0x42564350;
+
+//suffix of a new checkpoint while it is written, it replaces the old one once complete
+static const char* NEW_CHECKPOINT_SUFFIX = ".new";
+
+/*!
+ * Constructor, an empty checkpoint at the start of the first span
+ */
+AnalysisCheckpoint::AnalysisCheckpoint()
+{
+    isFinished = false;
+    spanNumber = 0;
+    nextFrameNumber = 0;
+    framesAnalyzed = 0;
+    framesFlagged = 0;
+    framesPastThreshHold = 0;
+}
+
+/*!
+ * Destructor
+ */
+AnalysisCheckpoint::~AnalysisCheckpoint()
+{
+
+}
+
+/*!
+ * Writes the checkpoint, replacing the one at the path once the new one is complete
+ *
+ * \param filePath: The path of the checkpoint file
+ *
+ * \return Returns true if the checkpoint was written, the old checkpoint is kept if it was not
+ */
+bool AnalysisCheckpoint::save(QString filePath)
+{
+    QString newFilePath = filePath + NEW_CHECKPOINT_SUFFIX;
+    QFile checkpointFile(newFilePath);
+
+    if(checkpointFile.open(QIODevice::WriteOnly | QIODevice::Truncate) == false)
+    {
+        return false;
+    }
+
+    QDataStream out(&checkpointFile);
+    out.setVersion(QDataStream::Qt_4_6);
+
+    out << CHECKPOINT_MAGIC << (qint32)FILE_VERSION << signature << isFinished;
+    out << (qint32)spanNumber << (qint32)nextFrameNumber;
+    out << (qint32)framesAnalyzed << (qint32)framesFlagged << (qint32)framesPastThreshHold;
+
+    //the running average as raw rows, it is only ever read back on the machine that wrote it
+    cv::Mat average = movingAverage.isContinuous() ? movingAverage : movingAverage.clone();
+
+    out << (qint32)average.rows << (qint32)average.cols << (qint32)average.type();
+
+    if(average.empty() == false)
+    {
+        out.writeRawData((const char*)average.data, (int)(average.total() * average.elemSize()));
+    }
+
+    out << (qint32)previousFramePixelChanges.size();
+
+    for(unsigned int i = 0; i < previousFramePixelChanges.size(); i++)
+    {
+        out << (qint32)previousFramePixelChanges[i];
+    }
+
+    out << (qint32)regionData.size();
+
+    for(unsigned int regionNum = 0; regionNum < regionData.size(); regionNum++)
+    {
+        const std::vector <OpenCV::frameData> &frames = regionData[regionNum].framesOverThreshHold;
+
+        out << (qint32)regionData[regionNum].totalFramesOverThreshHold << (qint32)frames.size();
+
+        for(unsigned int i = 0; i < frames.size(); i++)
+        {
+            out << (qint32)frames[i].frameNumber << (qint32)frames[i].hourFrameAppears << (qint32)frames[i].minuteFrameAppears
+                << (qint32)frames[i].secondFrameAppears << (qint32)frames[i].totalDifferentPixels;
+        }
+    }
+
+    checkpointFile.close();
+
+    if(out.status() != QDataStream::Ok || checkpointFile.error() != QFile::NoError)
+    {
+        QFile::remove(newFilePath);
+        return false;
+    }
+
+    //rename does not replace an existing file, load() falls back on the new file if this stops in between
+    QFile::remove(filePath);
+
+    return QFile::rename(newFilePath, filePath);
+}
+
+/*!
+ * Reads a checkpoint. If the last save() stopped after removing the old checkpoint, the complete new one is read instead
+ *
+ * \param filePath: The path of the checkpoint file
+ *
+ * \return Returns true if a whole checkpoint of this version was read
+ */
+bool AnalysisCheckpoint::load(QString filePath)
+{
+    QFile checkpointFile(filePath);
+
+    if(checkpointFile.exists() == false)
+    {
+        checkpointFile.setFileName(filePath + NEW_CHECKPOINT_SUFFIX);
+    }
+
+    if(checkpointFile.open(QIODevice::ReadOnly) == false)
+    {
+        return false;
+    }
+
+    QDataStream in(&checkpointFile);
+    in.setVersion(QDataStream::Qt_4_6);
+
+    quint32 magic = 0;
+    qint32 version = 0;
+
+    in >> magic >> version;
+
+    if(magic != CHECKPOINT_MAGIC || version != FILE_VERSION)
+    {
+        return false;
+    }
+
+    qint32 values[5];
+
+    in >> signature >> isFinished;
+    in >> values[0] >> values[1] >> values[2] >> values[3] >> values[4];
+
+    spanNumber = values[0];
+    nextFrameNumber = values[1];
+    framesAnalyzed = values[2];
+    framesFlagged = values[3];
+    framesPastThreshHold = values[4];
+
+    qint32 rows = 0;
+    qint32 cols = 0;
+    qint32 type = 0;
+
+    in >> rows >> cols >> type;
+
+    if(in.status() != QDataStream::Ok || rows < 0 || cols < 0)
+    {
+        return false;
+    }
+
+    movingAverage.release();
+
+    if(rows > 0 && cols > 0)
+    {
+        movingAverage.create(rows, cols, type);
+
+        int averageBytes = (int)(movingAverage.total() * movingAverage.elemSize());
+
+        if(in.readRawData((char*)movingAverage.data, averageBytes) != averageBytes)
+        {
+            return false;
+        }
+    }
+
+    qint32 count = 0;
+    in >> count;
+
+    previousFramePixelChanges.assign(std::max(count, 0), 0);
+
+    for(unsigned int i = 0; i < previousFramePixelChanges.size() && in.status() == QDataStream::Ok; i++)
+    {
+        qint32 pixelChanges = 0;
+        in >> pixelChanges;
+        previousFramePixelChanges[i] = pixelChanges;
+    }
+
+    in >> count;
+
+    regionData.assign(std::max(count, 0), OpenCV::regionData());
+
+    for(unsigned int regionNum = 0; regionNum < regionData.size() && in.status() == QDataStream::Ok; regionNum++)
+    {
+        qint32 totalFramesOverThreshHold = 0;
+        qint32 frameCount = 0;
+
+        in >> totalFramesOverThreshHold >> frameCount;
+
+        regionData[regionNum].totalFramesOverThreshHold = totalFramesOverThreshHold;
+        regionData[regionNum].framesOverThreshHold.clear();
+
+        for(int i = 0; i < frameCount && in.status() == QDataStream::Ok; i++)
+        {
+            qint32 frameValues[5];
+            in >> frameValues[0] >> frameValues[1] >> frameValues[2] >> frameValues[3] >> frameValues[4];
+
+            OpenCV::frameData frame;
+            frame.frameNumber = frameValues[0];
+            frame.hourFrameAppears = frameValues[1];
+            frame.minuteFrameAppears = frameValues[2];
+            frame.secondFrameAppears = frameValues[3];
+            frame.totalDifferentPixels = frameValues[4];
+
+            regionData[regionNum].framesOverThreshHold.push_back(frame);
+        }
+    }
+
+    //a file cut short by a crash reads past its end
+    return in.status() == QDataStream::Ok;
+}
+
+/*!
+ * Gets the path of a chunk's checkpoint
+ *
+ * \param directory: The output directory of the analysis
+ * \param chunkNumber: The chunk, in frame order
+ *
+ * \return Returns the path of the checkpoint file
+ */
+QString AnalysisCheckpoint::getFilePath(QString directory, int chunkNumber)
+{
+    return QDir(directory).filePath("checkpoint-" + QString::number(chunkNumber) + ".bvc");
+}
+
+/*!
+ * Reads the signature of a checkpoint without reading the rest of it
+ *
+ * \param filePath: The path of the checkpoint file
+ *
+ * \return Returns the signature, or an empty string if there is no readable checkpoint at the path
+ */
+QString AnalysisCheckpoint::readSignature(QString filePath)
+{
+    QFile checkpointFile(filePath);
+
+    if(checkpointFile.exists() == false)
+    {
+        checkpointFile.setFileName(filePath + NEW_CHECKPOINT_SUFFIX);
+    }
+
+    if(checkpointFile.open(QIODevice::ReadOnly) == false)
+    {
+        return "";
+    }
+
+    QDataStream in(&checkpointFile);
+    in.setVersion(QDataStream::Qt_4_6);
+
+    quint32 magic = 0;
+    qint32 version = 0;
+    QString signature;
+
+    in >> magic >> version;
+
+    if(magic != CHECKPOINT_MAGIC || version != FILE_VERSION)
+    {
+        return "";
+    }
+
+    in >> signature;
+
+    return (in.status() == QDataStream::Ok) ? signature : "";
+}
+
+/*!
+ * Deletes every checkpoint in a directory, including new checkpoints left by an interrupted save()
+ *
+ * \param directory: The output directory of the analysis
+ *
+ * \return Returns nothing
+ */
+void AnalysisCheckpoint::removeAll(QString directory)
+{
+    QDir dir(directory);
+
+    QStringList files = dir.entryList(QStringList() << "checkpoint-*.bvc" << "checkpoint-*.bvc.new", QDir::Files);
+
+    for(int i = 0; i < files.size(); i++)
+    {
+        dir.remove(files[i]);
+    }
+}
@@ -0,0 +1,68 @@
+/*!
+ * \class AnalysisCheckpoint
+ *
+ * The saved state of one chunk of an analysis, written to the analysis' output directory every few minutes so a long
+ * analysis that crashes, or is stopped with the machine, picks up where its last checkpoint left off.
+ *
+ * A checkpoint holds everything the chunk needs to go on exactly as if it had never stopped: the span and frame it
+ * continues from, a snapshot of the running average, each region's changed pixel count on the last analyzed frame
+ * (the flag rule compares against it), and the results and counters of every frame analyzed so far.  A chunk that has
+ * finished its spans writes a last checkpoint marked finished, which only holds its results.
+ *
+ * The signature ties a checkpoint to the analysis that wrote it: the video, regions, options and chunk plan.  A
+ * checkpoint whose signature does not match the analysis being started is ignored.
+ *
+ * Checkpoints are replaced safely: the new file is written next to the old one and only takes its place once it is
+ * complete, so a crash while writing leaves one of the two whole.
+ */
+
+#ifndef ANALYSISCHECKPOINT_H
+#define ANALYSISCHECKPOINT_H
+
+#include "OpenCV.h"
+#include <QString>
+#include <vector>
+
+class AnalysisCheckpoint
+{
+
+public:
+    AnalysisCheckpoint();
+    ~AnalysisCheckpoint();
+
+    bool save(QString filePath);
+    bool load(QString filePath);
+
+    static QString getFilePath(QString directory, int chunkNumber);
+    static QString readSignature(QString filePath);
+    static void removeAll(QString directory);
+
+    /*! Identifies the analysis the checkpoint belongs to. */
+    QString signature;
+
+    /*! True once the chunk has analyzed all of its spans, nothing is left to resume. */
+    bool isFinished;
+
+    /*! The span of the chunk being analyzed, and the frame number of the next frame it analyzes. */
+    int spanNumber;
+    int nextFrameNumber;
+
+    /*! Counters of the owned frames analyzed so far. */
+    int framesAnalyzed;
+    int framesFlagged;
+    int framesPastThreshHold;
+
+    /*! The running average after the last analyzed frame, empty for a finished chunk. */
+    cv::Mat movingAverage;
+
+    /*! Changed pixels of each region on the last analyzed frame. */
+    std::vector<int> previousFramePixelChanges;
+
+    /*! Results of each region so far, only totalFramesOverThreshHold and framesOverThreshHold are saved. */
+    std::vector <OpenCV::regionData> regionData;
+
+private:
+    //file version, a checkpoint written by another version is ignored
+    enum { FILE_VERSION = 1 };
+};
+#endif
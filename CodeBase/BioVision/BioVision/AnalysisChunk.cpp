@@ -0,0 +1,512 @@
+#include "AnalysisChunk.h"
+#include "FrameRing.h"
+#include "FrameDecoder.h"
+#include <algorithm>
+
+//number of frames the decoder may read ahead of the analysis
+static const int DECODED_FRAME_RING_SIZE = 4;
+
+//the pre-roll ends once the first frame's share of the running average is below this, 2^-16
+static const double PRE_ROLL_RESIDUE = 1.0 / 65536.0;
+
+//how often a paused chunk checks whether it was resumed or cancelled
+static const int PAUSE_POLL_MILLISECONDS = 50;
+
+/*!
+ * Constructor, stores the settings and frame spans of the chunk. The analysis starts when the thread is started
+ *
+ * \param settings: The settings of the whole analysis, with regionData holding each region's data before any frame is analyzed
+ * \param spans: The spans to analyze in frame order. Each starts reading at its start frame, records the results of the
+ *               frames from its first owned frame on, and stops before its end frame, or at the end of the segment plan
+ *               if the end frame is -1
+ */
+AnalysisChunk::AnalysisChunk(const analysisSettings &settings, const std::vector<frameSpan> &spans)
+{
+    _settings = settings;
+    _spans = spans;
+
+    _regionData = settings.regionData;
+    for(unsigned int i = 0; i < _regionData.size(); i++)
+    {
+        _regionData[i].totalFramesOverThreshHold = 0;
+        _regionData[i].framesOverThreshHold.clear();
+    }
+    _videoInfo.totalFramesPastThreshHold = 0;
+
+    _framesAnalyzed = 0;
+    _framesFlagged = 0;
+    _isCancelled = 0;
+    _isErrorThrown = 0;
+    _isPaused = 0;
+}
+
+/*!
+ * Destructor
+ */
+AnalysisChunk::~AnalysisChunk()
+{
+
+}
+
+/*!
+ * Gets the number of frames a chunk reads before its first owned frame, so that its running average has converged to
+ * the one of a serial run
+ *
+ * \param motionSensitivity: Motion sensetivity selected by the user on the slider
+ *
+ * \return Returns the number of pre-roll frames, including the frame that resets the average
+ *
+ * \see AnalysisChunk class description for the bound this gives
+ */
+int AnalysisChunk::getPreRollFrameCount(float motionSensitivity)
+{
+    double historyWeight = 1.0 - OpenCV::getRunningAverageWeight(motionSensitivity);
+
+    //the reset frame, then one frame per factor of the history weight until the largest possible difference is small enough
+    int preRollFrames = 1;
+    double residue = 255.0;
+
+    while(residue >= PRE_ROLL_RESIDUE)
+    {
+        residue = residue * historyWeight;
+        preRollFrames++;
+    }
+
+    return preRollFrames;
+}
+
+/*!
+ * Sets the file the chunk saves its checkpoints to and resumes from. Must be called before the thread is started, and
+ * only for an analysis with a checkpoint signature
+ *
+ * \param checkpointFilePath: The path of the chunk's checkpoint file
+ */
+void AnalysisChunk::setCheckpointFile(QString checkpointFilePath)
+{
+    _checkpointFilePath = checkpointFilePath;
+}
+
+/*!
+ * Pauses or resumes the chunk. A paused chunk saves a checkpoint after the frame it is analyzing, then waits until it is
+ * resumed or cancelled
+ *
+ * \param isPaused: True to pause the chunk, false to resume it
+ */
+void AnalysisChunk::setPaused(bool isPaused)
+{
+    _isPaused.fetchAndStoreOrdered(isPaused ? 1 : 0);
+}
+
+/*!
+ * Asks the chunk to stop, it finishes the frame it is analyzing
+ */
+void AnalysisChunk::cancel()
+{
+    _isCancelled.fetchAndStoreOrdered(1);
+}
+
+/*!
+ * Checks if the chunk failed, can be called while it is running
+ *
+ * \return Returns true if openCV threw an error while reading or analyzing a frame
+ */
+bool AnalysisChunk::isErrorThrown()
+{
+    return _isErrorThrown.fetchAndAddOrdered(0) != 0;
+}
+
+/*!
+ * Gets the number of owned frames analyzed so far, can be called while the chunk is running
+ *
+ * \return Returns the number of frames analyzed, pre-roll frames are not counted
+ */
+int AnalysisChunk::getFramesAnalyzed()
+{
+    return _framesAnalyzed.fetchAndAddOrdered(0);
+}
+
+/*!
+ * Gets the number of owned frames flagged so far, can be called while the chunk is running
+ *
+ * \return Returns the number of owned frames where at least one region passed its threshold
+ */
+int AnalysisChunk::getFramesFlagged()
+{
+    return _framesFlagged.fetchAndAddOrdered(0);
+}
+
+/*!
+ * Gets the number of owned frames where at least one region passed its threshold. Only valid once the thread has finished
+ *
+ * \return Returns the number of flagged frames
+ */
+int AnalysisChunk::getFramesPastThreshHold()
+{
+    return _videoInfo.totalFramesPastThreshHold;
+}
+
+/*!
+ * Gets the results of each region for the owned frames, in frame order. Only valid once the thread has finished
+ *
+ * \return Returns one regionData per region
+ */
+std::vector <OpenCV::regionData>& AnalysisChunk::getRegionData()
+{
+    return _regionData;
+}
+
+/*!
+ * Run on the chunk thread, analyzes the chunk and releases its video stream and frame buffers
+ */
+void AnalysisChunk::run()
+{
+    if(!_cvObject.openVideoFile(_settings.videoFilePath))
+    {
+        _isErrorThrown.fetchAndStoreOrdered(1);
+        return;
+    }
+
+    analyze();
+
+    //release average frame data from memory
+    _cvObject.deallocateMovingAverageFrame();
+
+    //after the chunk has been analyzed, close the video filestream
+    _cvObject.closeVideoFile();
+}
+
+/*!
+ * Sets up the openCV object for the analysis, then analyzes each span until an error or a cancel
+ */
+void AnalysisChunk::analyze()
+{
+    //set up the regions, frame buffers and running average the same way as every analysis of the engine
+    AnalysisEngine::settings engineSettings = AnalysisEngine::getDefaultSettings();
+    engineSettings.motionSensitivity = (int)_settings.motionSensitivity;
+    engineSettings.analysisThreadCount = _settings.analysisThreadCount;
+    engineSettings.analysisScale = _settings.analysisScale;
+    engineSettings.frameStride = _settings.frameStride;
+    engineSettings.isFixedPointBackground = _settings.isFixedPointBackground;
+    engineSettings.isLumaAnalysis = _settings.isLumaAnalysis;
+    engineSettings.isFullFrameAnalysis = _settings.isFullFrameAnalysis;
+
+    AnalysisEngine::setUpAnalysis(_cvObject, _settings.regions, engineSettings);
+
+    //set start frame, output path, and video file name in open CV class
+    _cvObject.initializeStartFrameAndFileName(_settings.outputFilePath, _settings.videoFileName, _settings.analysisStartFrame);
+
+    //time the stages of every frame with the job's profiler, the decoder and image writers use it through the openCV object
+    _cvObject.setStageProfiler(_settings.stageProfiler);
+
+    //set image output options based on GUI options chosen
+    _cvObject.setAnalyzeOptions(_settings.isOutputImages, _settings.imageOutputSize, _settings.jpegQuality);
+
+    //pre-roll frames are analyzed into these and thrown away
+    std::vector <OpenCV::regionData> preRollRegionData = _regionData;
+    OpenCV::generalVideoData preRollVideoInfo;
+    preRollVideoInfo.totalFramesPastThreshHold = 0;
+
+    //pick up from the checkpoint of an earlier run of this analysis, if there is one
+    AnalysisCheckpoint checkpoint;
+    bool isResumed = restoreCheckpoint(checkpoint);
+
+    if(isResumed == true && checkpoint.isFinished == true)
+    {
+        return;
+    }
+
+    unsigned int firstSpan = (isResumed == true) ? checkpoint.spanNumber : 0;
+
+    _checkpointTime.start();
+
+    for(unsigned int i = firstSpan; i < _spans.size(); i++)
+    {
+        frameSpan span = _spans[i];
+        bool isContinuingAverage = false;
+
+        //the frames before the checkpoint are done, the restored running average goes on with the next frame
+        if(isResumed == true && i == firstSpan)
+        {
+            if(span.endFrame >= 0 && checkpoint.nextFrameNumber >= span.endFrame)
+            {
+                continue;
+            }
+
+            span.startFrame = checkpoint.nextFrameNumber;
+            span.firstOwnedFrame = checkpoint.nextFrameNumber;
+            isContinuingAverage = true;
+        }
+
+        if(analyzeSpan(span, i, isContinuingAverage, preRollRegionData, preRollVideoInfo) == false)
+        {
+            _cvObject.deallocateFramesOnError();
+            _isErrorThrown.fetchAndStoreOrdered(1);
+            return;
+        }
+
+        if(_isCancelled.fetchAndAddOrdered(0) != 0)
+        {
+            return;
+        }
+    }
+
+    //every span is done, a later run of the same analysis only needs the results. Not saved if an image failed to save
+    if(_checkpointFilePath.isEmpty() == false && _settings.imageWriter->waitForImages(&_cvObject) == true)
+    {
+        saveCheckpoint((int)_spans.size(), 0, true);
+    }
+}
+
+/*!
+ * Reads the chunk's checkpoint and, if it was saved by this same analysis, puts back its results, counters and running
+ * average. Called once the openCV object is set up for the analysis
+ *
+ * \param checkpoint: Receives the checkpoint
+ *
+ * \return Returns true if the chunk resumes from the checkpoint, false if it starts from its first span
+ */
+bool AnalysisChunk::restoreCheckpoint(AnalysisCheckpoint &checkpoint)
+{
+    if(_checkpointFilePath.isEmpty() == true || checkpoint.load(_checkpointFilePath) == false)
+    {
+        return false;
+    }
+
+    if(checkpoint.signature != _settings.checkpointSignature || checkpoint.regionData.size() != _regionData.size() ||
+       checkpoint.spanNumber < 0 || checkpoint.spanNumber > (int)_spans.size())
+    {
+        return false;
+    }
+
+    //a finished chunk has no running average left to continue
+    if(checkpoint.isFinished == false && _cvObject.restoreAnalysisState(checkpoint.movingAverage, checkpoint.previousFramePixelChanges) == false)
+    {
+        return false;
+    }
+
+    for(unsigned int i = 0; i < _regionData.size(); i++)
+    {
+        _regionData[i].totalFramesOverThreshHold = checkpoint.regionData[i].totalFramesOverThreshHold;
+        _regionData[i].framesOverThreshHold.swap(checkpoint.regionData[i].framesOverThreshHold);
+    }
+
+    _videoInfo.totalFramesPastThreshHold = checkpoint.framesPastThreshHold;
+    _framesAnalyzed.fetchAndStoreOrdered(checkpoint.framesAnalyzed);
+    _framesFlagged.fetchAndStoreOrdered(checkpoint.framesFlagged);
+
+    return true;
+}
+
+/*!
+ * Saves the chunk's results and running average to its checkpoint file. The images of the frames covered must already
+ * be on disk. A checkpoint that fails to save is skipped, the analysis goes on and the previous checkpoint stays
+ *
+ * \param spanNumber: The span being analyzed
+ * \param nextFrameNumber: The frame number of the next frame to analyze
+ * \param isFinished: True if every span has been analyzed
+ *
+ * \return Returns nothing
+ */
+void AnalysisChunk::saveCheckpoint(int spanNumber, int nextFrameNumber, bool isFinished)
+{
+    AnalysisCheckpoint checkpoint;
+    checkpoint.signature = _settings.checkpointSignature;
+    checkpoint.isFinished = isFinished;
+    checkpoint.spanNumber = spanNumber;
+    checkpoint.nextFrameNumber = nextFrameNumber;
+    checkpoint.framesAnalyzed = _framesAnalyzed.fetchAndAddOrdered(0);
+    checkpoint.framesFlagged = _framesFlagged.fetchAndAddOrdered(0);
+    checkpoint.framesPastThreshHold = _videoInfo.totalFramesPastThreshHold;
+    checkpoint.regionData = _regionData;
+
+    if(isFinished == false)
+    {
+        _cvObject.copyAnalysisState(checkpoint.movingAverage, checkpoint.previousFramePixelChanges);
+    }
+
+    checkpoint.save(_checkpointFilePath);
+
+    _checkpointTime.restart();
+}
+
+/*!
+ * Waits while the chunk is paused, returns as soon as it is resumed or cancelled
+ *
+ * \return Returns nothing
+ */
+void AnalysisChunk::waitWhilePaused()
+{
+    while(_isPaused.fetchAndAddOrdered(0) != 0 && _isCancelled.fetchAndAddOrdered(0) == 0)
+    {
+        msleep(PAUSE_POLL_MILLISECONDS);
+    }
+}
+
+/*!
+ * Seeks to the start of a span's pre-roll and runs the analysis pipeline until the span's end frame, the end of the
+ * segment plan, an error or a cancel
+ *
+ * \param span: The span to analyze
+ * \param spanNumber: The number of the span in the chunk, saved with checkpoints
+ * \param isContinuingAverage: True if the span resumes from a checkpoint and its first frame continues the restored
+ *                             running average
+ * \param preRollRegionData: Receives the region results of pre-roll frames, which are thrown away
+ * \param preRollVideoInfo: Receives the frame count of pre-roll frames, which is thrown away
+ *
+ * \return Returns false if openCV threw an error while analyzing a frame
+ */
+bool AnalysisChunk::analyzeSpan(const frameSpan &span, int spanNumber, bool isContinuingAverage, std::vector <OpenCV::regionData> &preRollRegionData,
+                                OpenCV::generalVideoData &preRollVideoInfo)
+{
+    //a span that starts inside an edited out stretch starts where the analysis resumes instead
+    int segment = _settings.segmentPlan.findSegment(span.startFrame);
+
+    if(segment < 0)
+    {
+        return true;
+    }
+
+    int segmentFirstFrame = _settings.segmentPlan.getSegments()[segment].firstFrame;
+    int startFrame = std::max(span.startFrame, segmentFirstFrame);
+    int currentFrameNumber = 0;
+
+    //the serial run resets its running average at the start of a segment, there is nothing to continue
+    if(startFrame == segmentFirstFrame)
+    {
+        isContinuingAverage = false;
+    }
+
+    //set the video to the start of this span, frame numbers continue from where the stream lands
+    if(startFrame > 0 || _cvObject.getCurrentVideoFrame() != 0)
+    {
+        _cvObject.setCurrentVideoFrame(startFrame);
+        currentFrameNumber = _cvObject.getCurrentVideoFrame();
+    }
+
+    //the restored running average only fits the frame the checkpoint was saved before, move up to it if the seek landed early
+    if(isContinuingAverage == true && currentFrameNumber < startFrame)
+    {
+        currentFrameNumber = _cvObject.skipToVideoFrame(currentFrameNumber, startFrame);
+
+        if(currentFrameNumber < 0)
+        {
+            return true;
+        }
+    }
+
+    //the stream is past it, converge on it with a pre-roll instead, as at the start of a span
+    if(isContinuingAverage == true && currentFrameNumber > startFrame)
+    {
+        isContinuingAverage = false;
+
+        _cvObject.setCurrentVideoFrame(std::max(startFrame - getPreRollFrameCount(_settings.motionSensitivity), segmentFirstFrame));
+        currentFrameNumber = _cvObject.getCurrentVideoFrame();
+    }
+
+    //the chunk runs as a three stage pipeline: the decoder thread reads frames, this thread analyzes them, and the
+    //image writer threads save flagged frames as .JPGs. Stages are bounded, so a stage that gets ahead waits for the
+    //next one and the whole chunk runs at the speed of its slowest stage
+    FrameRing decodedFrames(DECODED_FRAME_RING_SIZE);
+
+    FrameDecoder decoder(&_cvObject, &decodedFrames, currentFrameNumber, _settings.segmentPlan, _settings.frameStride, isContinuingAverage);
+
+    decoder.start();
+
+    bool isErrorThrown = false;
+
+    //Main Analysis Loop//
+    while(true)
+    {
+        //waits for the decoder, returns NULL after the last frame of the analysis
+        FrameRing::Frame* decodedFrame = decodedFrames.beginRead();
+
+        if(decodedFrame == NULL)
+        {
+            break;
+        }
+
+        currentFrameNumber = decodedFrame->frameNumber;
+
+        //the rest of the video belongs to the next span or chunk
+        if(span.endFrame >= 0 && currentFrameNumber >= span.endFrame)
+        {
+            break;
+        }
+
+        bool isOwnedFrame = (currentFrameNumber >= span.firstOwnedFrame);
+
+        //did at least one region pass its threshold on this frame
+        bool isThreshHoldPassed = false;
+
+        //analyze current video frame
+        try
+        {
+            isThreshHoldPassed = _cvObject.analyzeFrame(decodedFrame->image, decodedFrame->lumaImage, decodedFrame->videoFramePosition, currentFrameNumber, _settings.regions.regionCoordinates,
+                                                        isOwnedFrame ? _videoInfo : preRollVideoInfo, isOwnedFrame ? _regionData : preRollRegionData,
+                                                        decodedFrame->isEditFrame);
+        }
+        catch(cv::Exception& e)//if an openCV error is caught, end the loop, the analyzer reports it
+        {
+            isErrorThrown = true;
+            break;
+        }
+
+        //the decoder can reuse the frame now
+        decodedFrames.finishRead();
+
+        if(isOwnedFrame == false)
+        {
+            continue;
+        }
+
+        //output the current frame containing its regions/difference pixels as a .JPG, waits while the image writers are behind
+        if(isThreshHoldPassed == true && _cvObject.isOutputingImages() == true)
+        {
+            //the analysis was cancelled, or an image failed to save and the analyzer reports it
+            if(_settings.imageWriter->write(&_cvObject, _cvObject.getFrameWithDifference(), currentFrameNumber) == false)
+            {
+                break;
+            }
+        }
+
+        _framesAnalyzed.fetchAndAddOrdered(1);
+
+        if(isThreshHoldPassed == true)
+        {
+            _framesFlagged.fetchAndAddOrdered(1);
+        }
+
+        //save a checkpoint every few minutes, and before pausing so the analysis can be resumed from here even if it is
+        //never unpaused
+        bool isPaused = (_isPaused.fetchAndAddOrdered(0) != 0);
+
+        if(_checkpointFilePath.isEmpty() == false && (isPaused == true || _checkpointTime.elapsed() >= _settings.checkpointIntervalSeconds * 1000))
+        {
+            //the checkpoint covers this frame, its image must be on disk first
+            if(_settings.imageWriter->waitForImages(&_cvObject) == false)
+            {
+                break;
+            }
+
+            saveCheckpoint(spanNumber, currentFrameNumber + 1, false);
+        }
+
+        if(isPaused == true)
+        {
+            waitWhilePaused();
+        }
+
+        //check if the analyzer has stopped this chunk
+        if(_isCancelled.fetchAndAddOrdered(0) != 0)
+        {
+            break;
+        }
+
+    }//End While, Main Analysis Loop
+
+    //the decoder has nothing left to do, stop it if it is still reading
+    decodedFrames.cancel();
+    decoder.wait();
+
+    return isErrorThrown == false;
+}
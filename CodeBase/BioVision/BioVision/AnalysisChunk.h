@@ -0,0 +1,148 @@
+/*!
+ * \class AnalysisChunk
+ *
+ * Analyzes one or more spans of a video on its own thread, with its own OpenCV object and its own video stream.  Analyzer
+ * splits a long analysis into chunks of frames that run at the same time and merges their results in frame order at the
+ * end.  A single chunk covering the whole analysis is the ordinary serial analysis.  The spans of one chunk are analyzed
+ * in order with the same video stream, each starting on its own pre-roll.
+ *
+ * Each chunk runs the decode / analyze / encode pipeline: a FrameDecoder reads its frames, the chunk thread analyzes
+ * them, and the analysis' JpegWriterPool saves its flagged frames as .JPGs.
+ *
+ * Pre-roll: the running average carries state from one frame to the next, so a chunk starts reading a few frames before
+ * the first frame it owns and analyzes them without recording any results.  The first pre-roll frame resets the average,
+ * the same way an edit point does.  Each frame after it multiplies the difference from the serial average by (1 - w),
+ * where w, the weight of a new frame, is at least 0.90.  The pre-roll is long enough for 255 * (1 - w)^n to fall below
+ * 2^-16 by the last pre-roll frame, whose region counts become the previous frame counts of the first owned frame.  The
+ * pre-roll never reaches back past the start of the segment of the analysis' SegmentPlan holding the first owned frame,
+ * as the serial run resets its average there too.
+ *
+ * Bound on the difference from a serial run: on every owned frame, each channel of the chunk's running average is within
+ * 2^-14 of the serial one (the pre-roll residue plus float rounding, which the same factor keeps from growing).  A mask
+ * pixel can only differ where the serial average lies within 2^-14 of a rounding midpoint, a region's changed pixel count
+ * can only differ by the number of such pixels, and a frame's flag can only differ if that count is that close to the
+ * region's threshold or to the previous frame's count.  With the fixed point background, truncation keeps a chunk's
+ * average from converging exactly, but it stays within 2/256 / w (below 0.009) of the serial one and the same reasoning
+ * applies with that bound.  A chunk whose pre-roll would start before its segment, or that starts inside an edited out
+ * stretch, starts on a reset frame exactly like the serial run and matches it exactly.
+ *
+ * Checkpoints: a chunk given a checkpoint file saves an AnalysisCheckpoint every few minutes, once the images of the
+ * frames it covers are on disk, and again whenever it is paused.  A chunk started with a checkpoint of the same analysis
+ * restores its results and running average and goes on from the frame after the checkpoint, exactly as if it had not
+ * stopped.  If the seek to that frame lands late, it runs a pre-roll up to it instead, with the bound above.  A chunk
+ * that finishes its spans saves a finished checkpoint, and a later run of the same analysis only reads its results back.
+ *
+ * Chunks own frames by frame number, read back from the stream after the seek as for the start time of a serial
+ * analysis.  The decoder does not always land on the frame asked for, a seek that lands late shortens the pre-roll by as
+ * many frames.
+ */
+
+#ifndef ANALYSISCHUNK_H
+#define ANALYSISCHUNK_H
+
+#include "OpenCV.h"
+#include "AnalysisEngine.h"
+#include "JpegWriterPool.h"
+#include "SegmentPlan.h"
+#include "AnalysisCheckpoint.h"
+#include <QThread>
+#include <QAtomicInt>
+#include <QString>
+#include <QTime>
+
+class AnalysisChunk : public QThread
+{
+
+public:
+    //analysis settings shared by every chunk of one analysis
+    struct analysisSettings
+    {
+        std::string videoFilePath;
+        std::string outputFilePath;
+        std::string videoFileName;
+        AnalysisEngine::regionTable regions;
+        std::vector <OpenCV::regionData> regionData;
+        bool isFullFrameAnalysis;
+        double analysisStartFrame;
+        SegmentPlan segmentPlan;
+        float motionSensitivity;
+        bool isOutputImages;
+        int imageOutputSize;
+        int jpegQuality;
+        JpegWriterPool* imageWriter;
+        int analysisThreadCount;
+        int frameStride;
+        int analysisScale;
+        bool isFixedPointBackground;
+        bool isLumaAnalysis;
+        StageProfiler* stageProfiler;
+        QString checkpointSignature;
+        int checkpointIntervalSeconds;
+    };
+
+    //a stretch of frames a chunk analyzes, the frames between the start frame and the first owned frame are its pre-roll
+    struct frameSpan
+    {
+        int startFrame;
+        int firstOwnedFrame;
+        int endFrame;
+    };
+
+    AnalysisChunk(const analysisSettings &settings, const std::vector<frameSpan> &spans);
+    ~AnalysisChunk();
+
+    static int getPreRollFrameCount(float motionSensitivity);
+
+    void setCheckpointFile(QString checkpointFilePath);
+    void setPaused(bool isPaused);
+
+    void cancel();
+    bool isErrorThrown();
+    int getFramesAnalyzed();
+    int getFramesPastThreshHold();
+    int getFramesFlagged();
+    std::vector <OpenCV::regionData>& getRegionData();
+
+protected:
+    void run();
+
+private:
+    /*! The openCV object holding this chunk's video stream and frame buffers. */
+    OpenCV _cvObject;
+
+    /*! Settings of the whole analysis. */
+    analysisSettings _settings;
+
+    /*! Spans in frame order. A span's end frame is -1 if it reads to the stop time. */
+    std::vector<frameSpan> _spans;
+
+    /*! Results of the owned frames, one entry per region. */
+    std::vector <OpenCV::regionData> _regionData;
+
+    /*! Counts the owned frames where at least one region passed its threshold. */
+    OpenCV::generalVideoData _videoInfo;
+
+    /*! Number of owned frames analyzed so far, read by the analyzer thread for progress. */
+    QAtomicInt _framesAnalyzed;
+
+    /*! Number of owned frames where a region passed its threshold so far, read by the analyzer thread for progress. */
+    QAtomicInt _framesFlagged;
+
+    QAtomicInt _isCancelled;
+    QAtomicInt _isErrorThrown;
+    QAtomicInt _isPaused;
+
+    /*! File the chunk's checkpoints are saved to, empty if the analysis is not checkpointed. */
+    QString _checkpointFilePath;
+
+    /*! Time since the last checkpoint was saved. */
+    QTime _checkpointTime;
+
+    void analyze();
+    bool analyzeSpan(const frameSpan &span, int spanNumber, bool isContinuingAverage, std::vector <OpenCV::regionData> &preRollRegionData,
+                     OpenCV::generalVideoData &preRollVideoInfo);
+    bool restoreCheckpoint(AnalysisCheckpoint &checkpoint);
+    void saveCheckpoint(int spanNumber, int nextFrameNumber, bool isFinished);
+    void waitWhilePaused();
+};
+#endif
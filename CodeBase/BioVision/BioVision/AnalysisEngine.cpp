@@ -0,0 +1,443 @@
+#include "AnalysisEngine.h"
+#include "OpenCV.h"
+
+//the analysis data of an engine, kept with the OpenCV object that fills it
+struct AnalysisEngine::engineData
+{
+    OpenCV cvObject;
+
+    //the regions of the running analysis, with the whole frame standing in for an empty list
+    regionTable regions;
+
+    //totals of every region, the flagged frames themselves are passed to the listener instead of being kept
+    std::vector <OpenCV::regionData> regionData;
+    OpenCV::generalVideoData videoInfo;
+
+    //luma of the pushed frame, its buffer is reused between frames
+    cv::Mat lumaFrame;
+};
+
+/*!
+ * Constructor, no source is open and the default settings are used
+ */
+AnalysisEngine::AnalysisEngine()
+{
+    _data = new engineData();
+    _settings = getDefaultSettings();
+    _listener = NULL;
+    _isStarted = false;
+    _isFirstFrame = true;
+    _framesAnalyzed = 0;
+    _framesFlagged = 0;
+}
+
+/*!
+ * Destructor, finishes the analysis and closes the source
+ */
+AnalysisEngine::~AnalysisEngine()
+{
+    finish();
+    closeSource();
+    delete _data;
+}
+
+/*!
+ * Get function for the settings a new engine uses, the defaults of the GUI's options window and the middle of its
+ * sensitivity slider
+ *
+ * \return Returns the default settings
+ */
+AnalysisEngine::settings AnalysisEngine::getDefaultSettings()
+{
+    settings defaultSettings;
+
+    defaultSettings.motionSensitivity = 49;
+    defaultSettings.analysisThreadCount = 0;
+    defaultSettings.analysisScale = 1;
+    defaultSettings.frameStride = 1;
+    defaultSettings.isFixedPointBackground = false;
+    defaultSettings.isLumaAnalysis = false;
+    defaultSettings.isFullFrameAnalysis = false;
+    defaultSettings.isDrawingFlaggedFrames = false;
+
+    return defaultSettings;
+}
+
+/*!
+ * Builds the region table of an analysis from its regions.  Without regions the whole frame is one region that passes
+ * on any change, as in an analysis started from the GUI
+ *
+ * \param regions: The regions, in full resolution pixels with their thresholds in percent
+ * \param frameWidth: The width of the video's frames, used for the whole frame region
+ * \param frameHeight: The height of the video's frames, used for the whole frame region
+ *
+ * \return Returns one entry per region, or the one whole frame region
+ */
+AnalysisEngine::regionTable AnalysisEngine::createRegionTable(const std::vector<region> &regions, int frameWidth, int frameHeight)
+{
+    regionTable table;
+
+    for(unsigned int i = 0; i < regions.size(); i++)
+    {
+        std::vector<int> coordinates(4);
+        coordinates[0] = regions[i].x;
+        coordinates[1] = regions[i].y;
+        coordinates[2] = regions[i].x + regions[i].width;
+        coordinates[3] = regions[i].y + regions[i].height;
+
+        table.regionCoordinates.push_back(coordinates);
+        table.regionWidths.push_back(regions[i].width);
+        table.regionHeights.push_back(regions[i].height);
+
+        //convert from percent to a share of the region
+        table.percentChangeInRegion.push_back(regions[i].threshold / 100.0f);
+    }
+
+    if(regions.size() == 0)
+    {
+        std::vector<int> coordinates(4);
+        coordinates[0] = 0;
+        coordinates[1] = 0;
+        coordinates[2] = frameWidth;
+        coordinates[3] = frameHeight;
+
+        table.regionCoordinates.push_back(coordinates);
+        table.regionWidths.push_back(frameWidth);
+        table.regionHeights.push_back(frameHeight);
+        table.percentChangeInRegion.push_back(0);
+    }
+
+    return table;
+}
+
+/*!
+ * Sets up an OpenCV object with an open video for an analysis of the regions, and allocates its frame buffers and
+ * running average.  The output file names and image options are left to the caller
+ *
+ * \param cvObject: The OpenCV object, its video or frame format must be set
+ * \param regions: The region table of the analysis, from createRegionTable()
+ * \param analysisSettings: The options of the analysis, the drawing option is not used
+ */
+void AnalysisEngine::setUpAnalysis(OpenCV &cvObject, regionTable &regions, const settings &analysisSettings)
+{
+    //set how much frames are scaled down before they are analyzed, used to size the regions and frame buffers
+    cvObject.setAnalysisScale(analysisSettings.analysisScale);
+
+    //set amount of frame to analyze based on user input
+    cvObject.setFrameAnalysisSize(regions.regionCoordinates, analysisSettings.isFullFrameAnalysis);
+
+    //initialize the region engine with the pixels that must change in every region, the region data only takes the thresholds
+    std::vector <OpenCV::regionData> regionData = cvObject.createRegionData(regions.regionCoordinates, regions.percentChangeInRegion);
+    cvObject.initializePixelChangeVariables(regions.regionCoordinates, regionData, regions.percentChangeInRegion, &regions.regionWidths, &regions.regionHeights);
+
+    //set the number of threads each frame is split across, used when the frame buffers are allocated
+    cvObject.setAnalysisThreadCount(analysisSettings.analysisThreadCount);
+
+    //set how many video frames each analyzed frame stands for, used to scale the motion sensitivity
+    cvObject.setFrameStride(analysisSettings.frameStride);
+
+    //set whether frames are analyzed on their luma alone, used to size the frame buffers and running average
+    cvObject.setLumaAnalysis(analysisSettings.isLumaAnalysis);
+
+    //set current frame size of video, used for creating image variables for analysis
+    cvObject.initializeFrameSizeSensitivityAndDrawSize(analysisSettings.motionSensitivity);
+
+    //initialize average frame motion image variable, as floats or fixed point
+    cvObject.setFixedPointBackground(analysisSettings.isFixedPointBackground);
+    cvObject.initializeMovingAverageFrame();
+}
+
+/*!
+ * Opens a video file as the source of the analysis, its frames are read with readFrame()
+ *
+ * \param videoFilePath: The path of the video
+ *
+ * \return Returns true if the video was opened
+ */
+bool AnalysisEngine::openSource(const std::string &videoFilePath)
+{
+    finish();
+
+    return _data->cvObject.openVideoFile(videoFilePath);
+}
+
+/*!
+ * Opens a source of frames made by the caller, such as generated test frames
+ *
+ * \param frameWidth: The width of every frame that will be pushed
+ * \param frameHeight: The height of every frame that will be pushed
+ * \param frameRate: The frame rate the frames are timed with
+ */
+void AnalysisEngine::openSource(int frameWidth, int frameHeight, double frameRate)
+{
+    finish();
+
+    _data->cvObject.closeVideoFile();
+    _data->cvObject.setVideoFormat(frameWidth, frameHeight, frameRate);
+}
+
+/*!
+ * Closes the video file opened as the source, if there is one
+ */
+void AnalysisEngine::closeSource()
+{
+    _data->cvObject.closeVideoFile();
+}
+
+/*!
+ * Reads the next frame of the video opened as the source
+ *
+ * \param frame: Receives the frame, its buffer is reused if it has the size of the video
+ * \param frameNumber: Receives the frame number of the frame
+ *
+ * \return Returns false at the end of the video
+ */
+bool AnalysisEngine::readFrame(cv::Mat &frame, int &frameNumber)
+{
+    frameNumber = (int)_data->cvObject.getCurrentVideoFrame();
+
+    BV_TIME_STAGE(_data->cvObject.getStageProfiler(), StageProfiler::DECODE);
+
+    _data->cvObject.getFrameForAnalysis(frame);
+
+    return frame.empty() == false;
+}
+
+/*!
+ * Get function for the width of the source's frames
+ *
+ * \return Returns the width in pixels
+ */
+int AnalysisEngine::getFrameWidth()
+{
+    return (int)_data->cvObject.getVideoFrameWidth();
+}
+
+/*!
+ * Get function for the height of the source's frames
+ *
+ * \return Returns the height in pixels
+ */
+int AnalysisEngine::getFrameHeight()
+{
+    return (int)_data->cvObject.getVideoFrameHeight();
+}
+
+/*!
+ * Get function for the frame rate of the source
+ *
+ * \return Returns the frames per second
+ */
+double AnalysisEngine::getFrameRate()
+{
+    return _data->cvObject.getVideoFrameRate();
+}
+
+/*!
+ * Get function for the number of frames of the source
+ *
+ * \return Returns the number of frames of the video, 0 for frames made by the caller
+ */
+int AnalysisEngine::getFrameCount()
+{
+    return (int)_data->cvObject.getNumberOfVideoFrames();
+}
+
+/*!
+ * Sets the regions of the analysis, used from the next start()
+ *
+ * \param regions: The regions, an empty list analyzes one region covering the frame that passes on any change
+ */
+void AnalysisEngine::setRegions(const std::vector<region> &regions)
+{
+    _regions = regions;
+}
+
+/*!
+ * Sets the options of the analysis, used from the next start()
+ *
+ * \param analysisSettings: The options
+ */
+void AnalysisEngine::setSettings(const settings &analysisSettings)
+{
+    _settings = analysisSettings;
+}
+
+/*!
+ * Sets the object that receives the result of every analyzed frame
+ *
+ * \param listener: The listener, or NULL to only count the frames
+ */
+void AnalysisEngine::setListener(frameListener* listener)
+{
+    _listener = listener;
+}
+
+/*!
+ * Sets the profiler that reads and pushed frames are timed with. Must not be changed while a frame is analyzed
+ *
+ * \param stageProfiler: The profiler to add the stage times to, NULL to stop timing
+ */
+void AnalysisEngine::setStageProfiler(StageProfiler* stageProfiler)
+{
+    _data->cvObject.setStageProfiler(stageProfiler);
+}
+
+/*!
+ * Starts an analysis of the source with the current regions and settings, allocating its frame buffers.  Set up with
+ * setUpAnalysis(), as an AnalysisChunk sets up its OpenCV object
+ *
+ * \return Returns false if no source is open
+ */
+bool AnalysisEngine::start()
+{
+    finish();
+
+    int frameWidth = getFrameWidth();
+    int frameHeight = getFrameHeight();
+
+    if(frameWidth <= 0 || frameHeight <= 0)
+    {
+        return false;
+    }
+
+    OpenCV &cvObject = _data->cvObject;
+
+    _data->regions = createRegionTable(_regions, frameWidth, frameHeight);
+    _data->regionData = cvObject.createRegionData(_data->regions.regionCoordinates, _data->regions.percentChangeInRegion);
+    _data->videoInfo.totalFramesPastThreshHold = 0;
+
+    setUpAnalysis(cvObject, _data->regions, _settings);
+    cvObject.initializeStartFrameAndFileName("", "", 0);
+    cvObject.setAnalyzeOptions(_settings.isDrawingFlaggedFrames, 1, 95);
+
+    _frameResult.changedPixels.assign(_data->regionData.size(), 0);
+    _frameResult.isRegionOverThreshHold.assign(_data->regionData.size(), false);
+
+    _framesAnalyzed = 0;
+    _framesFlagged = 0;
+    _isFirstFrame = true;
+    _isStarted = true;
+
+    return true;
+}
+
+/*!
+ * Analyzes the next frame of the analysis and passes its result to the listener
+ *
+ * \param frame: The frame, a 3 channel BGR image with the size of the source
+ * \param frameNumber: The frame number of the frame, used to time it and reported back in its result
+ * \param isEditFrame: True to reset the running average on this frame, as at an edit point
+ *
+ * \return Returns false if the analysis was not started or the frame does not have the size of the source
+ */
+bool AnalysisEngine::pushFrame(const cv::Mat &frame, int frameNumber, bool isEditFrame)
+{
+    if(_isStarted == false || frame.cols != getFrameWidth() || frame.rows != getFrameHeight())
+    {
+        return false;
+    }
+
+    OpenCV &cvObject = _data->cvObject;
+
+    if(_settings.isLumaAnalysis == true)
+    {
+        cvObject.getLumaFrameForAnalysis(frame, _data->lumaFrame);
+    }
+
+    //the frame position is one past the frame number, as the decoder reads it from the stream
+    bool isThreshHoldPassed = cvObject.analyzeFrame(frame, _data->lumaFrame, frameNumber + 1, frameNumber, _data->regions.regionCoordinates,
+                                                    _data->videoInfo, _data->regionData, isEditFrame || _isFirstFrame);
+    _isFirstFrame = false;
+
+    _framesAnalyzed++;
+
+    if(isThreshHoldPassed == true)
+    {
+        _framesFlagged++;
+    }
+
+    for(unsigned int i = 0; i < _data->regionData.size(); i++)
+    {
+        _frameResult.changedPixels[i] = cvObject.getLastFramePixelChanges(i);
+        _frameResult.isRegionOverThreshHold[i] = (_data->regionData[i].framesOverThreshHold.size() != 0);
+
+        //the frame is passed on below, only the totals are kept
+        _data->regionData[i].framesOverThreshHold.clear();
+    }
+
+    if(_listener != NULL)
+    {
+        _frameResult.frameNumber = frameNumber;
+        _frameResult.isThreshHoldPassed = isThreshHoldPassed;
+        _frameResult.frameWithDifference = (isThreshHoldPassed && cvObject.isOutputingImages()) ? &cvObject.getFrameWithDifference() : NULL;
+
+        _listener->frameAnalyzed(_frameResult);
+    }
+
+    return true;
+}
+
+/*!
+ * Ends the analysis and releases its running average, the totals stay readable until the next start()
+ */
+void AnalysisEngine::finish()
+{
+    if(_isStarted == true)
+    {
+        _data->cvObject.deallocateMovingAverageFrame();
+        _isStarted = false;
+    }
+}
+
+/*!
+ * Get function for the number of regions analyzed since start()
+ *
+ * \return Returns the number of regions set, or 1 for the whole frame region of an analysis without regions
+ */
+int AnalysisEngine::getNumberOfRegions()
+{
+    return (int)_data->regionData.size();
+}
+
+/*!
+ * Get function for the number of frames analyzed since start()
+ *
+ * \return Returns the number of pushed frames that were analyzed
+ */
+int AnalysisEngine::getFramesAnalyzed()
+{
+    return _framesAnalyzed;
+}
+
+/*!
+ * Get function for the number of frames flagged since start()
+ *
+ * \return Returns the number of frames where at least one region passed its threshold
+ */
+int AnalysisEngine::getFramesFlagged()
+{
+    return _framesFlagged;
+}
+
+/*!
+ * Get function for the number of frames a region passed its threshold on since start()
+ *
+ * \param regionNumber: The region, in the order the regions were set
+ *
+ * \return Returns the number of frames the region passed its threshold on
+ */
+int AnalysisEngine::getFramesOverThreshHold(int regionNumber)
+{
+    return _data->regionData[regionNumber].totalFramesOverThreshHold;
+}
+
+/*!
+ * Get function for the frame buffers allocated while analyzing the last frame, 0 once the buffers are reused
+ *
+ * \return Returns the number of pooled frame buffers that were allocated during the last frame
+ */
+int AnalysisEngine::getFrameBufferAllocationsLastFrame()
+{
+    return _data->cvObject.getFrameBufferAllocationsLastFrame();
+}
@@ -0,0 +1,162 @@
+/*!
+ * \class AnalysisEngine
+ *
+ * The motion analysis of the biovision-core library behind a plain C++ interface, for programs that analyze frames
+ * without the GUI's threads and result files, such as benchmarks and other applications embedding the engine.
+ *
+ * A source is opened, either a video file or a frame size for frames made in memory.  Regions and settings are set, the
+ * analysis is started, and frames are pushed one at a time in order.  Every pushed frame is analyzed exactly as the
+ * GUI's analyses do it, through the same OpenCV object, and its result is passed to the frame listener before
+ * pushFrame() returns.
+ *
+ * The first frame pushed after start() resets the running average, as do frames pushed as edit frames.  Frames must
+ * have the size of the source.  An openCV error while analyzing a frame is thrown from pushFrame() as a cv::Exception.
+ *
+ * One engine analyzes one stream of frames on the calling thread, and splits each frame across its analysis threads.
+ * Engines do not share any state, several can run at the same time on different threads.
+ *
+ * A StageProfiler set on the engine times the decoding of readFrame() and the stages of every pushed frame, as it does
+ * for the GUI's analyses.
+ *
+ * createRegionTable() and setUpAnalysis() are how every analysis of the library is set up, the GUI's chunks set up
+ * their own OpenCV objects with them too, so an engine analyzes exactly the regions and thresholds they do.
+ */
+
+#ifndef ANALYSISENGINE_H
+#define ANALYSISENGINE_H
+
+#include "opencv2/core/core.hpp"
+#include <vector>
+#include <string>
+
+class OpenCV;
+class StageProfiler;
+
+class AnalysisEngine
+{
+
+public:
+    //a region of the frame, in full resolution pixels
+    struct region
+    {
+        std::string name;
+        int x;
+        int y;
+        int width;
+        int height;
+
+        //percent of the region's pixels that must change for it to pass, 0 passes on any change
+        int threshold;
+    };
+
+    //the options of an analysis, with the same meaning as in the GUI's options window
+    struct settings
+    {
+        int motionSensitivity;
+        int analysisThreadCount;
+        int analysisScale;
+        int frameStride;
+        bool isFixedPointBackground;
+        bool isLumaAnalysis;
+        bool isFullFrameAnalysis;
+
+        //draw the regions, changed pixels and time onto frames that pass a threshold, as the GUI saves them
+        bool isDrawingFlaggedFrames;
+    };
+
+    //the result of one analyzed frame
+    struct frameResult
+    {
+        int frameNumber;
+
+        //true if at least one region passed its threshold
+        bool isThreshHoldPassed;
+
+        //changed pixels of every region in full resolution pixels, and whether it passed its threshold
+        std::vector<int> changedPixels;
+        std::vector<bool> isRegionOverThreshHold;
+
+        //the drawn frame if it passed a threshold while drawing is on, NULL otherwise.  Valid until the next frame
+        const cv::Mat* frameWithDifference;
+    };
+
+    //the regions an analysis is set up with, one entry per region in every vector
+    struct regionTable
+    {
+        //X1, Y1, X2 and Y2 of every region in full resolution pixels
+        std::vector < std::vector<int> > regionCoordinates;
+        std::vector<int> regionWidths;
+        std::vector<int> regionHeights;
+
+        //share of each region's pixels that must change for it to pass, 0 passes on any change
+        std::vector<float> percentChangeInRegion;
+    };
+
+    //receives the result of every analyzed frame, on the thread that pushed the frame
+    class frameListener
+    {
+    public:
+        virtual ~frameListener() {}
+        virtual void frameAnalyzed(const frameResult &result) = 0;
+    };
+
+    AnalysisEngine();
+    ~AnalysisEngine();
+
+    static settings getDefaultSettings();
+
+    static regionTable createRegionTable(const std::vector<region> &regions, int frameWidth, int frameHeight);
+    static void setUpAnalysis(OpenCV &cvObject, regionTable &regions, const settings &analysisSettings);
+
+    bool openSource(const std::string &videoFilePath);
+    void openSource(int frameWidth, int frameHeight, double frameRate);
+    void closeSource();
+
+    bool readFrame(cv::Mat &frame, int &frameNumber);
+
+    int getFrameWidth();
+    int getFrameHeight();
+    double getFrameRate();
+    int getFrameCount();
+
+    void setRegions(const std::vector<region> &regions);
+    void setSettings(const settings &analysisSettings);
+    void setListener(frameListener* listener);
+    void setStageProfiler(StageProfiler* stageProfiler);
+
+    bool start();
+    bool pushFrame(const cv::Mat &frame, int frameNumber, bool isEditFrame);
+    void finish();
+
+    int getNumberOfRegions();
+    int getFramesAnalyzed();
+    int getFramesFlagged();
+    int getFramesOverThreshHold(int regionNumber);
+    int getFrameBufferAllocationsLastFrame();
+
+private:
+    //the OpenCV object and the analysis data kept with it, kept out of this header as OpenCV.h includes Qt
+    struct engineData;
+    engineData* _data;
+
+    std::vector<region> _regions;
+    settings _settings;
+    frameListener* _listener;
+
+    /*! True between start() and finish(), while frame buffers are allocated. */
+    bool _isStarted;
+
+    /*! True until the first frame after start() has reset the running average. */
+    bool _isFirstFrame;
+
+    int _framesAnalyzed;
+    int _framesFlagged;
+
+    /*! Reused for every frame, so results are passed on without allocating. */
+    frameResult _frameResult;
+
+    //an engine owns its OpenCV object and is never copied
+    AnalysisEngine(const AnalysisEngine &);
+    AnalysisEngine& operator=(const AnalysisEngine &);
+};
+#endif
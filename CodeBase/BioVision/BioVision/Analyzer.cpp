@@ -5,8 +5,26 @@
 ///////////////////////////////////////////////////////////
 
 #include "Analyzer.h"
+#include "AnalysisCheckpoint.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFileInfo>
+#include <QDateTime>
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+
+//shortest chunk an analysis is split into, shorter analyses use fewer chunks so the pre-roll stays a small share of each
+static const int MIN_FRAMES_PER_CHUNK = 1000;
+
+//how often the progress bar is updated while the chunks run, in milliseconds
+static const unsigned long PROGRESS_UPDATE_MILLISECONDS = 100;
+
+//progress at which a strided analysis starts analyzing the frames around its events at full rate, in percent
+static const float REFINEMENT_PROGRESS_START = 90.0f;
+
+//how often each chunk saves a checkpoint, in seconds
+static const int CHECKPOINT_INTERVAL_SECONDS = 120;
 
 
 /*!
@@ -14,7 +32,8 @@
  */
 Analyzer::Analyzer()
 {
-
+    _outputDirectory = "tmp";
+    _isResumingFromCheckpoint = true;
 }
 
 /*!
@@ -38,10 +57,19 @@ Analyzer::Analyzer()
  * \param imageOutputSize: Value set by the user, determines how much to reduce the size of large image files output during analysis
  * \param isOutputImages: Determines if we are saving image files for a given analysis or not
  * \param isFullFrameAnalysis: Determines whether we are analyzing the entire video frame, or just a sub-area that contains all user created regions
+ * \param analysisThreadCount: The number of threads each frame is split across, 0 uses one thread per processor core
+ * \param analysisChunkCount: The number of chunks the video is split into and analyzed at the same time, 0 uses one per processor core
+ * \param jpegQuality: The quality of saved images, from 0 to 100
+ * \param imageMemoryBudget: The most memory in megabytes that flagged frames waiting to be saved may use
+ * \param frameStride: The number of video frames between two analyzed frames when screening, 1 analyzes every frame
+ * \param analysisScale: How many times smaller in width and height frames are analyzed at, 1 for full resolution, 2, 4 or 8
+ * \param isFixedPointBackground: Keeps the running average as 16 bit fixed point instead of 32 bit floats, halving its memory
+ * \param isLumaAnalysis: Analyzes the luma of each frame instead of its three color channels, meant for monochrome video
  */
 Analyzer::Analyzer(std::vector<int>* xCoords, std::vector<int>* yCoords, std::vector<int>* widths, std::vector<int>* heights,
                    std::vector<int>* thresholds, QString videoFilePath, int startSecond, int stopSecond, std::deque<int> videoEditTimesInSeconds,
-                   int motionSensitivity, std::vector<QString>* regionNames, int imageOutputSize, bool isOutputImages, bool isFullFrameAnalysis)
+                   int motionSensitivity, std::vector<QString>* regionNames, int imageOutputSize, bool isOutputImages, bool isFullFrameAnalysis,
+                   int analysisThreadCount, int analysisChunkCount, int jpegQuality, int imageMemoryBudget, int frameStride, int analysisScale, bool isFixedPointBackground, bool isLumaAnalysis)
 {
     _regionXCoords = xCoords;
     _regionYCoords = yCoords;
@@ -59,12 +87,29 @@ Analyzer::Analyzer(std::vector<int>* xCoords, std::vector<int>* yCoords, std::ve
     _imageOutputSize = imageOutputSize;
     _isOutputImages = isOutputImages;
     _isFullFrameAnalysis = isFullFrameAnalysis;
-
-    //reset bool for when/if the canceled button is clicked.
-    _isCancelled = false;
+    _analysisThreadCount = analysisThreadCount;
+    _analysisChunkCount = analysisChunkCount;
+    _jpegQuality = jpegQuality;
+    _imageMemoryBudget = imageMemoryBudget;
+    _frameStride = frameStride;
+    _analysisScale = analysisScale;
+    _isFixedPointBackground = isFixedPointBackground;
+    _isLumaAnalysis = isLumaAnalysis;
+
+    _outputDirectory = "tmp";
+    _isResumingFromCheckpoint = true;
 
     // Set the message- means this task is running
     setMessage("Analyzer is currently running.");
+
+    // analyses writing to the same output directory run one at a time, see setOutputDirectory().
+    setExclusiveResource(QDir(_outputDirectory).absolutePath());
+
+    // the chunks and frame bands of the analysis share this many threads.
+    setThreadCount((analysisThreadCount == 0) ? QThread::idealThreadCount() : analysisThreadCount);
+
+    // a paused analysis checkpoints and waits, see AnalysisChunk.
+    setPausable(true);
 }
 
 /*!
@@ -91,10 +136,7 @@ Analyzer::~Analyzer()
  */
 void Analyzer::startSlot()
 {
-    //Commented out for final release
-    //qDebug()<<"Calling clearTmpDirectory";
-    clearTmpDirectory();
-
+    //the tmp directory is cleared by analyze(), unless it holds checkpoints of this same analysis
     analyze();
 
     emit finished();
@@ -103,13 +145,16 @@ void Analyzer::startSlot()
 /*!
  * This slot is connected to the OpenCV image written signal.  We then forward the image name to
  * BvSystem by way of a signal that was connected in thread manager to this object.  From there System can tell the
- * carousel to load it.
+ * carousel to load it.  The carousel loads images from the tmp directory, so an image in a directory below it is sent
+ * with its path from there.
  *
  * \param fileName The name of a newly written image.
  */
 void Analyzer::sendImageInfoSlot(QString fileName, QString index)
 {
-    emit sendImageInfoSignal(fileName, index);
+    QString imagePath = QDir(_outputDirectory).absoluteFilePath(fileName);
+
+    emit sendImageInfoSignal(QDir(QDir("tmp").absolutePath()).relativeFilePath(imagePath), index);
 }
 
 void Analyzer::clearCarouselSlot()
@@ -130,13 +175,13 @@ void Analyzer::clearTmpDirectory()
     clearCarouselSlot();
 
     // Make sure the tmp directory exists and clean it of old runs.
-    if(!QDir("tmp").exists())
+    if(!QDir(_outputDirectory).exists())
     {
-        QDir().mkdir("tmp");
+        QDir().mkpath(_outputDirectory);
     }
     else
     {
-        QDir dir("tmp/");
+        QDir dir(_outputDirectory + "/");
 
         // sets filters on the files retrieved by entry list- only delete jpg files.
         dir.setNameFilters(QStringList() << "*.jpg");
@@ -160,9 +205,59 @@ void Analyzer::clearTmpDirectory()
             dir.remove(files.first());
             files.removeFirst();
         }
+
+        // timelines of earlier runs must not be saved with this one.
+        dir.setNameFilters(QStringList() << "*.json");
+        dir.setFilter(QDir::Files);
+        files = dir.entryList();
+        while(files.size() > 0)
+        {
+            dir.remove(files.first());
+            files.removeFirst();
+        }
     }
 }
 
+/*!
+ * Sets the directory the results and images of the analysis are written to, in place of the tmp directory.  Its old
+ * images and results are deleted when the analysis starts, so the ThreadManager runs analyses with the same output
+ * directory one at a time.  Must be called before the analysis is queued
+ *
+ * \param outputDirectory: The directory to write to, created if it does not exist
+ */
+void Analyzer::setOutputDirectory(QString outputDirectory)
+{
+    _outputDirectory = outputDirectory;
+
+    setExclusiveResource(QDir(outputDirectory).absolutePath());
+}
+
+/*!
+ * Records a timeline of every timed stage of the analysis, on every thread, and writes it as a Chrome trace once the
+ * analysis ends, stopped or not. The timeline keeps the most recent few minutes of a long analysis
+ *
+ * \param traceFilePath: The .json file to write, an empty path records no timeline
+ *
+ * \see StageProfiler for the stages
+ */
+void Analyzer::setTraceFilePath(QString traceFilePath)
+{
+    _traceFilePath = traceFilePath;
+}
+
+/*!
+ * Sets whether the analysis picks up from the checkpoints an interrupted run of the same analysis left in the output
+ * directory. On by default. Either way the analysis saves checkpoints of its own as it runs
+ *
+ * \param isResumingFromCheckpoint: True to resume from matching checkpoints, false to always start over
+ *
+ * \see AnalysisCheckpoint
+ */
+void Analyzer::setResumeFromCheckpoint(bool isResumingFromCheckpoint)
+{
+    _isResumingFromCheckpoint = isResumingFromCheckpoint;
+}
+
 /*!
  * Parses and adapts data passed by the GUI into format used by analysis functions, and runs loop to complete an analysis of a video
  * Takes no parameters, all data needed is referenced form class level variables that store data Passed from GUI
@@ -175,40 +270,25 @@ void Analyzer::analyze()
 {
     //holds general video data that will be sent to output
     OpenCV::generalVideoData videoInfo;
-    //holds data for individual regions that will be sent to output
-    std::vector <OpenCV::regionData> regionData;
-    //the region coordinates that will be used for analysis
-    std::vector < std::vector<int> > regionCoordinates;
-    //temporary container for a single regions coordinates, used to fill regionCoordinates
-    std::vector <int> regionTemp;
-
-    //holds all of out possible region threshold values
-    float percentChangeInRegion[10];
-
-    //set 2 region coordinates using start point passed from system. and region height and width passed from system
-    if(_regionHeights->size() != 0)
-    {
-        for(unsigned int i = 0; i < _regionHeights->size();  i++)
-        {
-            //add an empty container to hold one regions coordinates
-            regionCoordinates.push_back(regionTemp);
-
-            //fill that container with region data
-            regionCoordinates[i].push_back( (*_regionXCoords)[i] );
-            regionCoordinates[i].push_back( (*_regionYCoords)[i] );
-            regionCoordinates[i].push_back( (*_regionXCoords)[i] + (*_regionWidths)[i] );
-            regionCoordinates[i].push_back( (*_regionYCoords)[i] + (*_regionHeights)[i] );
 
-            //convert from int to decimal
-            percentChangeInRegion[i] = ( (*_regionThresholds)[i] );
+    //the regions drawn by the user, in full resolution pixels with their thresholds in percent
+    std::vector <AnalysisEngine::region> regions;
 
-            percentChangeInRegion[i] = ( percentChangeInRegion[i] / 100 );
-        }
-    }
-    else//if no regions were selected by the user, set up a default region
+    for(unsigned int i = 0; i < _regionHeights->size();  i++)
     {
-        percentChangeInRegion[0] = 0;
+        AnalysisEngine::region tempRegion;
+        tempRegion.x = (*_regionXCoords)[i];
+        tempRegion.y = (*_regionYCoords)[i];
+        tempRegion.width = (*_regionWidths)[i];
+        tempRegion.height = (*_regionHeights)[i];
+        tempRegion.threshold = (*_regionThresholds)[i];
+
+        regions.push_back(tempRegion);
+    }
 
+    //if no regions were selected by the user, the analysis has one default region
+    if(regions.size() == 0)
+    {
         //add a defult region name for output when no regions are selected
         _regionNames->push_back("default");
     }
@@ -218,18 +298,18 @@ void Analyzer::analyze()
 
     //temporary output is stored in the system's "tmp" folder, final output will be saved in the users working directory
     //if they chose to keep analysis data
-    std::string outputFilePath = "tmp";
+    std::string outputFilePath = _outputDirectory.toStdString();
 
     int lastSlashInPath = videoFilePath.find_last_of('/');
 
     //if we are on macOS
     if(lastSlashInPath != -1)
     {
-        outputFilePath = "tmp/";
+        outputFilePath += "/";
     }
     else//windows
     {
-        outputFilePath = "tmp\\";
+        outputFilePath += "\\";
     }
 
 
@@ -238,6 +318,9 @@ void Analyzer::analyze()
     {
         //Commented out for final release
         //std::cout << "Failed to open video file " << videoFilePath << std::endl;
+
+        //results of an earlier analysis must not be taken for this one's
+        clearTmpDirectory();
     }
     else//continue to analyze video
     {
@@ -286,60 +369,11 @@ void Analyzer::analyze()
         videoInfo.totalFramesPastThreshHold = 0;
 
 
-        //if at least one region was selected by the user
-        if(regionCoordinates.size() != 0)
-        {
-            //output and region data, and store it for results later
-            for(unsigned int regionNum = 0; regionNum < regionCoordinates.size(); regionNum++)
-            {
-                //store region data for results later
-                OpenCV::regionData tempData;
-                tempData.regionStartPointX = regionCoordinates[regionNum][0];
-                tempData.regionStartPointY = regionCoordinates[regionNum][1];
-                tempData.regionEndPointX = regionCoordinates[regionNum][2];
-                tempData.regionEndPointY = regionCoordinates[regionNum][3];
-                tempData.regionRectangleColor = _cvObject.colorList[regionNum].colorName;
-                regionData.push_back(tempData);
-            }
-
-        }
-        else //if no regions were selected by the user, set one region selecting the whole frame
-        {
-            OpenCV::regionData tempData;
-            std::vector <int> tempCoordinates(4);
-
-            regionCoordinates.push_back(tempCoordinates);
+        //the region table every chunk is set up with, the whole frame if no regions were selected by the user
+        AnalysisEngine::regionTable regionTable = AnalysisEngine::createRegionTable(regions, (int)_cvObject.getVideoFrameWidth(), (int)_cvObject.getVideoFrameHeight());
 
-            regionCoordinates[0][0] = 0;
-            regionCoordinates[0][1] = 0;
-            regionCoordinates[0][2] = _cvObject.getVideoFrameWidth();
-            regionCoordinates[0][3] = _cvObject.getVideoFrameHeight();
-
-            tempData.regionStartPointX = 0;
-            tempData.regionStartPointY = 0;
-            tempData.regionEndPointX = _cvObject.getVideoFrameWidth();
-            tempData.regionEndPointY = _cvObject.getVideoFrameHeight();
-            tempData.regionRectangleColor = _cvObject.colorList[0].colorName;
-
-            regionData.push_back(tempData);
-        }
-
-
-        //set amount of frame to analyze based on user input
-        _cvObject.setFrameAnalysisSize(regionCoordinates, _isFullFrameAnalysis);
-
-        //setup results for changes
-        if(regionCoordinates.size() != 0)
-        {
-            //initialize variables withing the OpenCV class that track pixel changes per region
-            int numberOfRegions = regionCoordinates.size();
-            _cvObject.initializePixelChangeVariables(numberOfRegions, regionData, percentChangeInRegion, _regionWidths, _regionHeights);
-        }
-        else //if no regions were selected by the user, set one region selecting the whole frame
-        {
-            //initialize pixel change variables for a single region
-            _cvObject.initializePixelChangeVariables(1, regionData, percentChangeInRegion, _regionWidths, _regionHeights);
-        }
+        //holds data for individual regions that will be sent to output
+        std::vector <OpenCV::regionData> regionData = _cvObject.createRegionData(regionTable.regionCoordinates, regionTable.percentChangeInRegion);
 
 
         //currently, the video starts at the beginning and analyzes all the way to the end
@@ -366,138 +400,247 @@ void Analyzer::analyze()
 
         //set analysis end time based on time chosen by the user
         analysisEndFrame = _stopSecond * _cvObject.getVideoFrameRate();
-        _stopSecond = _stopSecond * 1000;
 
         //output file start and end video data
         videoInfo.frameAnalysisStart = analysisStartFrame;
         videoInfo.frameAnalysisEnd = analysisEndFrame;
 
-        //set start frame, output path, and video file name in open CV class
-        _cvObject.initializeStartFrameAndFileName(outputFilePath, videoFileName, analysisStartFrame);
+        //turn the start, stop and edit times into the frame ranges that are analyzed, nothing is read past the video's end
+        int lastFrame = (int)analysisEndFrame;
+
+        if(_cvObject.getNumberOfVideoFrames() > 0)
+        {
+            lastFrame = std::min(lastFrame, (int)_cvObject.getNumberOfVideoFrames());
+        }
 
-        //set current frame size of video, used for creating image variables for analysis
-        _cvObject.initializeFrameSizeSensitivityAndDrawSize(_motionSensitivity);
+        SegmentPlan segmentPlan((int)analysisStartFrame, lastFrame, _editPoints, _cvObject.getVideoFrameRate());
 
-        //initialize average frame motion image variable
-        _cvObject.initializeMovingAverageFrame();
+        //each chunk opens its own video stream, this one was only needed for the video data and the start frame
+        _cvObject.closeVideoFile();
 
-        //set image output options based on GUI options chosen
-        _cvObject.setAnalyzeOptions(_isOutputImages, _imageOutputSize);
+        //settings shared by every chunk of the analysis
+        AnalysisChunk::analysisSettings settings;
+        settings.videoFilePath = videoFilePath;
+        settings.outputFilePath = outputFilePath;
+        settings.videoFileName = videoFileName;
+        settings.regions = regionTable;
+        settings.regionData = regionData;
+        settings.isFullFrameAnalysis = _isFullFrameAnalysis;
+        settings.analysisStartFrame = analysisStartFrame;
+        settings.segmentPlan = segmentPlan;
+        settings.motionSensitivity = _motionSensitivity;
+        settings.isOutputImages = _isOutputImages;
+        settings.imageOutputSize = _imageOutputSize;
+        settings.jpegQuality = _jpegQuality;
+        settings.analysisThreadCount = _analysisThreadCount;
+        settings.analysisScale = _analysisScale;
+        settings.isFixedPointBackground = _isFixedPointBackground;
+        settings.isLumaAnalysis = _isLumaAnalysis;
+
+        //every chunk, band and image writer times its stages with the job's profiler, the timeline starts here
+        settings.stageProfiler = _jobControl->getStageProfiler();
+        settings.stageProfiler->reset();
+        settings.stageProfiler->setTracing(_traceFilePath.isEmpty() == false);
+
+        //split the analysis into chunks of frames that are analyzed at the same time, short analyses stay in one chunk.
+        //Only frames the plan includes are counted, so edited out stretches cost nothing
+        int framesToAnalyze = segmentPlan.getIncludedFrameCount();
+        int chunkCount = _analysisChunkCount;
+
+        if(chunkCount == 0)
+        {
+            chunkCount = QThread::idealThreadCount();
+        }
 
-        //is the current frame to be analyzed the first frame of the video, or a new edit frame chosen by the user
-        bool isEditFrame = true;
+        chunkCount = std::max(std::min(chunkCount, framesToAnalyze / MIN_FRAMES_PER_CHUNK), 1);
 
-        //emit a starting signal to show that analysis has begun for very long jobs
-        emit progressSignal(1);
+        //a long analysis checkpoints each chunk, and goes on from the checkpoints of an interrupted run of the same
+        //analysis. Otherwise the images and results of the last analysis are cleared
+        settings.checkpointSignature = getCheckpointSignature(settings, chunkCount);
+        settings.checkpointIntervalSeconds = CHECKPOINT_INTERVAL_SECONDS;
 
-        //has an openCV error occured on this run
-        bool isErrorThrown = false;
+        bool isResumed = (_isResumingFromCheckpoint == true && settings.checkpointSignature.isEmpty() == false &&
+                          AnalysisCheckpoint::readSignature(AnalysisCheckpoint::getFilePath(_outputDirectory, 0)) == settings.checkpointSignature);
 
-        //Main Analysis Loop//
-        while(true)
+        if(isResumed == true)
+        {
+            clearCarouselSlot();
+        }
+        else
         {
-            //path for image files saved during analysis, send this data through the system to the carosel
-            QString savedImagePath;
+            clearTmpDirectory();
+            AnalysisCheckpoint::removeAll(_outputDirectory);
+        }
 
-            //analyze current video frame
-            try
-            {
-                savedImagePath = _cvObject.analyzeCurrentFrame(currentFrameNumber, regionCoordinates, videoInfo, regionData, isEditFrame);
-            }
-            catch(cv::Exception& e)//if an openCV error is caught, end the loop, deallocate data, and send error message/window
-            {
-                //Commented out for final release
-                //const char* err_msg = e.what();
-                //std::cout << err_msg;
+        //the chunks share the analysis threads, instead of each splitting its frames across all of them
+        if(chunkCount > 1)
+        {
+            int threadCount = (_analysisThreadCount == 0) ? QThread::idealThreadCount() : _analysisThreadCount;
+            settings.analysisThreadCount = std::max(threadCount / chunkCount, 1);
+        }
 
-                isErrorThrown = true;
-                _isCancelled = true;
-                _cvObject.deallocateFramesOnError();
-                break;
-            }
+        //flagged frames from every chunk are saved by one pool of image writers, which slows the chunks down once the
+        //frames waiting to be saved fill its memory budget
+        JpegWriterPool imageWriter(std::max(QThread::idealThreadCount() / 2, 1), _imageMemoryBudget);
+        settings.imageWriter = &imageWriter;
 
-            //check if the user has stopped the analysis by clicking a button on the GUI
-            if(_isCancelled == true)
+        //the image writers pass saved file paths straight back through the system, this thread only watches the chunks
+        connect(&imageWriter, SIGNAL(imageSavedSignal(QString, QString)), this, SLOT(sendImageInfoSlot(QString, QString)), Qt::DirectConnection);
+
+        //a strided analysis decodes every Nth frame, it needs N times as many video frames to settle its running average
+        int frameStride = std::max(_frameStride, 1);
+        int preRollFrames = AnalysisChunk::getPreRollFrameCount(_motionSensitivity);
+
+        settings.frameStride = frameStride;
+
+        //a strided analysis only screens for events, the frames around every event are analyzed again at full rate and
+        //only those results are kept, so the screening pass saves no images
+        if(frameStride > 1)
+        {
+            settings.isOutputImages = false;
+        }
+
+        std::vector<AnalysisChunk*> chunks;
+
+        for(int i = 0; i < chunkCount; i++)
+        {
+            int firstOwnedFrame = segmentPlan.getIncludedFrame((int)(((double)framesToAnalyze * i) / chunkCount));
+            int endFrame = -1;
+
+            if(i < chunkCount - 1)
             {
-                emit progressSignal(0);
-                break;
+                endFrame = segmentPlan.getIncludedFrame((int)(((double)framesToAnalyze * (i + 1)) / chunkCount));
             }
-            //if we are at the end of the video, or at the user selected stopping point, end analysis
-            if(_cvObject.getCurrentVideoTime() >= _stopSecond)
+
+            std::vector<AnalysisChunk::frameSpan> chunkSpans;
+            chunkSpans.push_back(createFrameSpan(segmentPlan, firstOwnedFrame, endFrame, preRollFrames * frameStride));
+
+            chunks.push_back(new AnalysisChunk(settings, chunkSpans));
+
+            if(settings.checkpointSignature.isEmpty() == false)
             {
-                break;
+                chunks[i]->setCheckpointFile(AnalysisCheckpoint::getFilePath(_outputDirectory, i));
             }
+        }
 
-            //output current percentage completion
-            float framesAnalyzed = currentFrameNumber;
-            float lastFrameToAnylize = analysisEndFrame;
+        //report a starting progress to show that analysis has begun for very long jobs
+        _jobControl->setProgress(1);
 
-            if(percentComplete < int((framesAnalyzed/lastFrameToAnylize) * 100))
-            {
-                percentComplete = int((framesAnalyzed/lastFrameToAnylize) * 100);
+        //a strided analysis leaves the last part of the progress bar for the refinement pass
+        float progressScale = (frameStride > 1) ? REFINEMENT_PROGRESS_START / 100.0f : 1.0f;
+
+        //has an openCV error occured on this run, progress follows the frames of the plan rather than the stream position
+        bool isErrorThrown = runChunks(chunks, imageWriter, percentComplete, 0.0f,
+                                       progressScale * 100.0f * frameStride / (float)std::max(framesToAnalyze, 1));
 
-                //Commented out for final release
-                //std::cout << "Analysis is " << percentComplete << "% Complete\n";
+        //go back over the frames around every strided frame where a region passed its threshold, this time at full rate
+        if(frameStride > 1 && isCancelled() == false)
+        {
+            std::vector<AnalysisChunk::frameSpan> refinementSpans = getRefinementSpans(chunks, segmentPlan, frameStride, preRollFrames);
 
-                //Emit this data to the GUI to update our progress bar
-                emit progressSignal(percentComplete);
+            for(unsigned int i = 0; i < chunks.size(); i++)
+            {
+                delete chunks[i];
             }
+            chunks.clear();
 
-            //if we are at an edit point set by the user, skip to the next frame they wish to have analyzed
-            if(_editPoints.size() != 0)
+            settings.frameStride = 1;
+            settings.isOutputImages = _isOutputImages;
+
+            //hand each chunk a run of neighbouring spans with about the same number of frames
+            int refinementFrames = 0;
+            for(unsigned int i = 0; i < refinementSpans.size(); i++)
             {
-                //if the current video time is equal/greater than the next edit point
-                if(_cvObject.getCurrentVideoTime() >= (_editPoints.front() * 1000))
-                {
-                    //pop old edit time
-                    _editPoints.pop_front();
+                refinementFrames += segmentPlan.countIncludedFrames(refinementSpans[i].firstOwnedFrame, refinementSpans[i].endFrame);
+            }
 
-                    ///set the video to the user selected time to resume analysis
-                    _cvObject.setCurrentVideoTime((double) (_editPoints.front() * 1000));
-                    currentFrameNumber = _cvObject.getCurrentVideoFrame();
+            int refinementChunkCount = std::min(chunkCount, (int)refinementSpans.size());
+            int spansFrames = 0;
+            std::vector<AnalysisChunk::frameSpan> chunkSpans;
 
-                    //remove analysis resume time
-                    _editPoints.pop_front();
+            for(unsigned int i = 0; i < refinementSpans.size(); i++)
+            {
+                chunkSpans.push_back(refinementSpans[i]);
+                spansFrames += segmentPlan.countIncludedFrames(refinementSpans[i].firstOwnedFrame, refinementSpans[i].endFrame);
 
-                    //we have skipped time in the video, tells frame analysis algorythim to reset
-                    //moving frame average for the next frame
-                    isEditFrame = true;
-                }
-                else
+                if(i == refinementSpans.size() - 1 || spansFrames >= ((double)refinementFrames * (chunks.size() + 1)) / refinementChunkCount)
                 {
-                    isEditFrame = false;
+                    chunks.push_back(new AnalysisChunk(settings, chunkSpans));
+                    chunkSpans.clear();
                 }
             }
-            else//Else no edit had taken place, proceed as normal
+
+            if(chunks.size() != 0)
             {
-                isEditFrame = false;
+                isErrorThrown = runChunks(chunks, imageWriter, percentComplete, REFINEMENT_PROGRESS_START,
+                                          (100.0f - REFINEMENT_PROGRESS_START) / std::max(refinementFrames, 1));
             }
+        }
 
-            //if an image was saved this frame, pass its file path back through the system
-            if(savedImagePath != "")
+        //save every flagged frame still waiting, or drop them if the analysis was stopped
+        if(isCancelled() == true)
+        {
+            imageWriter.cancel();
+        }
+        else
+        {
+            imageWriter.finish();
+        }
+
+        _jobControl->setKilobytesWritten(imageWriter.getKilobytesWritten());
+
+        if(imageWriter.isErrorThrown() == true)
+        {
+            isErrorThrown = true;
+            _jobControl->cancel();
+        }
+
+        //merge the chunk results, chunks are in frame order and each holds its frames in order
+        if(isCancelled() == false)
+        {
+            for(unsigned int i = 0; i < chunks.size(); i++)
             {
-                _parseString = savedImagePath.split("-");
-                sendImageInfoSlot(savedImagePath, _parseString.at(1).toLocal8Bit().constData());
-            }
+                std::vector <OpenCV::regionData> &chunkRegionData = chunks[i]->getRegionData();
 
-        }//End While, Main Analysis Loop
+                for(unsigned int regionNum = 0; regionNum < regionData.size(); regionNum++)
+                {
+                    regionData[regionNum].totalFramesOverThreshHold += chunkRegionData[regionNum].totalFramesOverThreshHold;
+                    regionData[regionNum].framesOverThreshHold.insert(regionData[regionNum].framesOverThreshHold.end(),
+                                                                      chunkRegionData[regionNum].framesOverThreshHold.begin(),
+                                                                      chunkRegionData[regionNum].framesOverThreshHold.end());
+                }
 
-        //release average frame data from memory
-        _cvObject.deallocateMovingAverageFrame();
+                videoInfo.totalFramesPastThreshHold += chunks[i]->getFramesPastThreshHold();
+            }
+        }
 
-        //after the entire video has been analyzed, close the video filestream
-        _cvObject.closeVideoFile();
+        for(unsigned int i = 0; i < chunks.size(); i++)
+        {
+            delete chunks[i];
+        }
+
+        //every stage has ended, write the timeline
+        if(_traceFilePath.isEmpty() == false)
+        {
+            settings.stageProfiler->exportTrace(_traceFilePath);
+        }
 
         //if the user did not stop the analysis while it was in progress, output the analysis result data
-        if(_isCancelled == false)
+        if(isCancelled() == false)
         {
             //reset progress bar
-            emit progressSignal(0);
+            _jobControl->setProgress(0);
 
             //process the results from an analysis
             Result getResult;
             getResult.exportToText(videoFilePath, outputFilePath, videoInfo, regionData, _regionNames);
 
+            //the results are saved, there is nothing left to resume
+            if(isErrorThrown == false)
+            {
+                AnalysisCheckpoint::removeAll(_outputDirectory);
+            }
+
             // Prepare the result object to be emitted.
             _result = new Result();
             emit sendResultSignal(_result);
@@ -506,11 +649,260 @@ void Analyzer::analyze()
         //if an openCV error has ended the analysis
         if(isErrorThrown == true)
         {
-            emit progressSignal(0);
+            _jobControl->setProgress(0);
             //display error window letting user know something went wrong while analyzing this video
             displayErrorMessageSignal();
         }
     }
 }
 
+/*!
+ * Starts the chunks and watches them until they have all finished, the user cancels, or one of them fails, updating the
+ * progress bar as they go
+ *
+ * \param chunks: The chunks to run
+ * \param imageWriter: The pool saving the chunks' flagged frames, checked for errors
+ * \param percentComplete: The progress last sent to the GUI, updated as the chunks analyze frames
+ * \param progressAtStart: The progress before any frame of these chunks is analyzed, in percent
+ * \param progressPerFrame: The progress each analyzed frame adds, in percent
+ *
+ * \return Returns true if openCV threw an error in a chunk or the image writers, the analysis is cancelled as well
+ */
+bool Analyzer::runChunks(std::vector<AnalysisChunk*> &chunks, JpegWriterPool &imageWriter, int &percentComplete, float progressAtStart, float progressPerFrame)
+{
+    bool isErrorThrown = false;
+
+    //a refinement pass adds its frames to those of the screening pass
+    int framesDoneAtStart = _jobControl->getFramesDone();
+
+    for(unsigned int i = 0; i < chunks.size(); i++)
+    {
+        chunks[i]->start();
+    }
+
+    while(true)
+    {
+        int framesAnalyzed = 0;
+        int framesFlagged = 0;
+        AnalysisChunk* runningChunk = NULL;
+
+        //an image that failed to save ends the analysis the same way an analysis error does
+        if(imageWriter.isErrorThrown() == true)
+        {
+            isErrorThrown = true;
+            _jobControl->cancel();
+        }
+
+        for(unsigned int i = 0; i < chunks.size(); i++)
+        {
+            framesAnalyzed += chunks[i]->getFramesAnalyzed();
+            framesFlagged += chunks[i]->getFramesFlagged();
+
+            if(chunks[i]->isErrorThrown() == true)
+            {
+                isErrorThrown = true;
+                _jobControl->cancel();
+            }
+
+            if(runningChunk == NULL && chunks[i]->isFinished() == false)
+            {
+                runningChunk = chunks[i];
+            }
+        }
+
+        //the GUI polls these counters, events are counted anew by each pass
+        _jobControl->setFramesDone(framesDoneAtStart + framesAnalyzed);
+        _jobControl->setEventsFound(framesFlagged);
+        _jobControl->setKilobytesWritten(imageWriter.getKilobytesWritten());
+
+        //pause or resume every chunk with the job, a paused chunk checkpoints and then waits
+        bool isPaused = _jobControl->isPaused();
+
+        for(unsigned int i = 0; i < chunks.size(); i++)
+        {
+            chunks[i]->setPaused(isPaused);
+        }
+
+        //check if the user has stopped the analysis by clicking a button on the GUI, an error stops every chunk too
+        if(isCancelled() == true)
+        {
+            for(unsigned int i = 0; i < chunks.size(); i++)
+            {
+                chunks[i]->cancel();
+            }
+
+            _jobControl->setProgress(0);
+            break;
+        }
+
+        if(runningChunk == NULL)
+        {
+            break;
+        }
+
+        //output current percentage completion
+        if(percentComplete < int(progressAtStart + framesAnalyzed * progressPerFrame))
+        {
+            percentComplete = int(progressAtStart + framesAnalyzed * progressPerFrame);
+
+            //store it for the GUI, which reads it to update our progress bar
+            _jobControl->setProgress(percentComplete);
+        }
+
+        runningChunk->wait(PROGRESS_UPDATE_MILLISECONDS);
+    }
+
+    int framesAnalyzed = 0;
+    int framesFlagged = 0;
+
+    for(unsigned int i = 0; i < chunks.size(); i++)
+    {
+        chunks[i]->wait();
+
+        framesAnalyzed += chunks[i]->getFramesAnalyzed();
+        framesFlagged += chunks[i]->getFramesFlagged();
+
+        //a chunk that failed after it was last checked
+        if(chunks[i]->isErrorThrown() == true)
+        {
+            isErrorThrown = true;
+            _jobControl->cancel();
+        }
+    }
+
+    _jobControl->setFramesDone(framesDoneAtStart + framesAnalyzed);
+    _jobControl->setEventsFound(framesFlagged);
+
+    return isErrorThrown;
+}
+
+/*!
+ * Builds the span a chunk analyzes, starting its pre-roll before its first owned frame. The serial analysis resets its
+ * running average at the start of every segment, so a pre-roll that would reach back past the start of its segment
+ * starts there instead, exactly like the serial analysis
+ *
+ * \param segmentPlan: The frame ranges of the analysis
+ * \param firstOwnedFrame: The first frame whose results the span records
+ * \param endFrame: The first frame after the span, or -1 to read until the end of the plan
+ * \param preRollFrames: The number of video frames read before the first owned frame
+ *
+ * \return Returns the span
+ */
+AnalysisChunk::frameSpan Analyzer::createFrameSpan(const SegmentPlan &segmentPlan, int firstOwnedFrame, int endFrame, int preRollFrames)
+{
+    AnalysisChunk::frameSpan span;
+    span.firstOwnedFrame = firstOwnedFrame;
+    span.endFrame = endFrame;
+    span.startFrame = firstOwnedFrame - preRollFrames;
+
+    int segment = segmentPlan.findSegment(firstOwnedFrame);
+
+    if(segment >= 0)
+    {
+        span.startFrame = std::max(span.startFrame, segmentPlan.getSegments()[segment].firstFrame);
+    }
+
+    return span;
+}
+
+/*!
+ * Finds the frames a strided analysis has to analyze again at full rate: the frames skipped on both sides of every
+ * analyzed frame where at least one region passed its threshold. Spans closer together than a pre-roll are joined, as
+ * reading the frames between them costs less than starting a new span
+ *
+ * \param chunks: The finished chunks of the strided pass
+ * \param segmentPlan: The frame ranges of the analysis
+ * \param frameStride: The number of video frames between two analyzed frames
+ * \param preRollFrames: The number of frames a full rate span reads before its first owned frame
+ *
+ * \return Returns the spans in frame order, they do not overlap
+ */
+std::vector<AnalysisChunk::frameSpan> Analyzer::getRefinementSpans(std::vector<AnalysisChunk*> &chunks, const SegmentPlan &segmentPlan, int frameStride, int preRollFrames)
+{
+    int analysisStartFrame = segmentPlan.getIncludedFrame(0);
+
+    //every frame where at least one region passed its threshold
+    std::vector<int> flaggedFrames;
+
+    for(unsigned int i = 0; i < chunks.size(); i++)
+    {
+        std::vector <OpenCV::regionData> &chunkRegionData = chunks[i]->getRegionData();
+
+        for(unsigned int regionNum = 0; regionNum < chunkRegionData.size(); regionNum++)
+        {
+            for(unsigned int j = 0; j < chunkRegionData[regionNum].framesOverThreshHold.size(); j++)
+            {
+                flaggedFrames.push_back(chunkRegionData[regionNum].framesOverThreshHold[j].frameNumber);
+            }
+        }
+    }
+
+    std::sort(flaggedFrames.begin(), flaggedFrames.end());
+    flaggedFrames.erase(std::unique(flaggedFrames.begin(), flaggedFrames.end()), flaggedFrames.end());
+
+    std::vector<AnalysisChunk::frameSpan> spans;
+
+    for(unsigned int i = 0; i < flaggedFrames.size(); i++)
+    {
+        int firstOwnedFrame = std::max(flaggedFrames[i] - (frameStride - 1), analysisStartFrame);
+        int endFrame = flaggedFrames[i] + frameStride;
+
+        if(spans.size() != 0 && firstOwnedFrame <= spans.back().endFrame + preRollFrames)
+        {
+            spans.back().endFrame = endFrame;
+        }
+        else
+        {
+            spans.push_back(createFrameSpan(segmentPlan, firstOwnedFrame, endFrame, preRollFrames));
+        }
+    }
+
+    return spans;
+}
+
+/*!
+ * Builds the signature tying checkpoints to this analysis: the video, the frames analyzed, the regions, every option the
+ * results or images depend on, and the chunk plan. Checkpoints are only saved for analyses of every frame, a strided
+ * analysis' refinement spans depend on the results of its screening pass
+ *
+ * \param settings: The settings shared by the chunks of the analysis
+ * \param chunkCount: The number of chunks the analysis is split into
+ *
+ * \return Returns the signature, or an empty string if the analysis is not checkpointed
+ */
+QString Analyzer::getCheckpointSignature(const AnalysisChunk::analysisSettings &settings, int chunkCount)
+{
+    if(std::max(_frameStride, 1) > 1)
+    {
+        return "";
+    }
+
+    QByteArray analysisDescription;
+    QDataStream out(&analysisDescription, QIODevice::WriteOnly);
+
+    //a video that was replaced or edited in place no longer matches
+    QFileInfo videoFile(_videoFilePath);
+    out << videoFile.absoluteFilePath() << videoFile.size() << videoFile.lastModified().toString(Qt::ISODate);
+
+    const std::vector<SegmentPlan::segment> &segments = settings.segmentPlan.getSegments();
 
+    for(unsigned int i = 0; i < segments.size(); i++)
+    {
+        out << (qint32)segments[i].firstFrame << (qint32)segments[i].endFrame;
+    }
+
+    for(unsigned int i = 0; i < settings.regions.regionCoordinates.size(); i++)
+    {
+        for(unsigned int j = 0; j < settings.regions.regionCoordinates[i].size(); j++)
+        {
+            out << (qint32)settings.regions.regionCoordinates[i][j];
+        }
+
+        out << settings.regions.percentChangeInRegion[i];
+    }
+
+    out << settings.motionSensitivity << settings.isFullFrameAnalysis << settings.analysisScale << settings.isFixedPointBackground
+        << settings.isLumaAnalysis << settings.isOutputImages << settings.imageOutputSize << settings.jpegQuality << chunkCount;
+
+    return QString(QCryptographicHash::hash(analysisDescription, QCryptographicHash::Md5).toHex());
+}
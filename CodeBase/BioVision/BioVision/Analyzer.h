@@ -7,18 +7,43 @@
  *
  * Analyzer overrides the startSlot (which is run on another thread) and performs the main logical loop of the program,
  * analyzing the video for differences.  At the end it emits a signal to send the results and a signal to finish the
- * thread.  During it emits progress signals to notify the user of the progress, and a signal whenever an image is written
+ * thread.  During it stores its progress in the job control for the GUI to read, and emits a signal whenever an image is written
  * to a file (then the carousel can display it.)
+ *
+ * The frames are analyzed by one or more AnalysisChunk threads.  Long videos can be split into chunks of frames that
+ * are analyzed at the same time, each with its own video stream, and their results are merged in frame order.  While the
+ * chunks run, this thread reports their progress and stops them if the user cancels.  Flagged frames from every chunk
+ * are saved by one JpegWriterPool.
+ *
+ * With a frame stride above 1 the analysis screens the video first, decoding every Nth frame and skipping the others
+ * with grab().  The frames around every screened frame where a region passed its threshold are then analyzed again at
+ * full rate, and only the results and images of that refinement pass are kept.
+ *
+ * Before any frame is read, the start, stop and edit times are compiled into a SegmentPlan of the frame ranges that are
+ * analyzed.  Chunks are cut and progress is measured in included frames only, and the gaps between ranges are skipped
+ * without decoding them.
+ *
+ * Frames can be analyzed at 1/2, 1/4 or 1/8 of their resolution.  Region thresholds are scaled to match and changed
+ * pixel counts are reported in full resolution pixels, while saved images keep the full resolution of the video.
+ *
+ * An analysis of every frame saves a checkpoint of each chunk every few minutes and whenever it is paused.  Started again
+ * after a crash with the same video, regions and options, it goes on from its checkpoints instead of starting over.
+ *
+ * Results and images are written to an output directory the GUI copies them from, one below tmp for every video, and
+ * the headless batch analyzer gives every analysis its own.  Analyses with different output directories can run at the
+ * same time.
  */
 
 #ifndef ANALYZER_H
 #define ANALYZER_H
 
 #include "OpenCV.h"
+#include "AnalysisChunk.h"
+#include "JpegWriterPool.h"
+#include "SegmentPlan.h"
 #include "Result.h"
 #include "BvThreadWorker.h"
 #include "QDir"
-#include <QMessageBox>
 #include <QStringList>
 #include <QDebug>
 
@@ -29,10 +54,15 @@ public:
     Analyzer();
     Analyzer(std::vector<int>* xCoords, std::vector<int>* yCoords, std::vector<int>* widths, std::vector<int>* heights,
              std::vector<int>* thresholds, QString videoFilePath, int startSecond, int stopSecond, std::deque<int> videoEditTimesInSeconds,
-             int motionSensitivity, std::vector<QString>* regionNames, int imageOutputSize, bool isOutputImages, bool isFullFrameAnalysis);
+             int motionSensitivity, std::vector<QString>* regionNames, int imageOutputSize, bool isOutputImages, bool isFullFrameAnalysis,
+             int analysisThreadCount, int analysisChunkCount, int jpegQuality, int imageMemoryBudget, int frameStride, int analysisScale, bool isFixedPointBackground,
+             bool isLumaAnalysis);
     ~Analyzer();
     void analyze();
     void clearTmpDirectory();
+    void setOutputDirectory(QString outputDirectory);
+    void setTraceFilePath(QString traceFilePath);
+    void setResumeFromCheckpoint(bool isResumingFromCheckpoint);
 
 public Q_SLOTS:
     void startSlot();
@@ -56,9 +86,30 @@ private:
     float _motionSensitivity;
     std::vector<QString>* _regionNames;
 
+    /*! Where the results and images of the analysis are written, "tmp" unless set. */
+    QString _outputDirectory;
+
+    /*! Where the timeline of the analysis is written as a Chrome trace, no timeline is recorded when empty. */
+    QString _traceFilePath;
+
+    /*! Whether the analysis goes on from the checkpoints of an interrupted run of the same analysis. */
+    bool _isResumingFromCheckpoint;
+
     int _imageOutputSize;
     int _isOutputImages;
     bool _isFullFrameAnalysis;
-    QStringList _parseString;
+    int _analysisThreadCount;
+    int _analysisChunkCount;
+    int _jpegQuality;
+    int _imageMemoryBudget;
+    int _frameStride;
+    int _analysisScale;
+    bool _isFixedPointBackground;
+    bool _isLumaAnalysis;
+
+    bool runChunks(std::vector<AnalysisChunk*> &chunks, JpegWriterPool &imageWriter, int &percentComplete, float progressAtStart, float progressPerFrame);
+    AnalysisChunk::frameSpan createFrameSpan(const SegmentPlan &segmentPlan, int firstOwnedFrame, int endFrame, int preRollFrames);
+    QString getCheckpointSignature(const AnalysisChunk::analysisSettings &settings, int chunkCount);
+    std::vector<AnalysisChunk::frameSpan> getRefinementSpans(std::vector<AnalysisChunk*> &chunks, const SegmentPlan &segmentPlan, int frameStride, int preRollFrames);
 };
 #endif
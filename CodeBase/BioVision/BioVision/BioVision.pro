@@ -12,8 +12,8 @@ greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 TARGET = BioVision
 TEMPLATE = app
 
-win32:INCLUDEPATH += C:\opencv\build\include
-macx:INCLUDEPATH += /usr/local/include
+# the analysis engine and OpenCV
+include(../BioVisionCore/BioVisionCore.pri)
 
 SOURCES += main.cpp \
     AboutWindow.cpp \
@@ -22,19 +22,21 @@ SOURCES += main.cpp \
     DetailAnalyzer.cpp \
     MainWindow.cpp \
     RegionWindow.cpp \
-    Result.cpp \
     ThreadManager.cpp \
     Video.cpp \
     VideoCopier.cpp \
+    VideoIndexer.cpp \
     WindowManager.cpp \
     Project.cpp \
-    OpenCV.cpp \
     ProjectManager.cpp \
     BvThreadWorker.cpp \
     BvRegion.cpp \
     OptionsWindow.cpp \
     AnalyzeCheckDialog.cpp \
-    EnlargedFrameWindow.cpp
+    EnlargedFrameWindow.cpp \
+    JobStatus.cpp \
+    JobControl.cpp \
+    ThroughputMonitor.cpp
 
 HEADERS  += \
     AboutWindow.h \
@@ -44,13 +46,12 @@ HEADERS  += \
     EnlargedFrameWindow.h \
     MainWindow.h \
     RegionWindow.h \
-    Result.h \
     ThreadManager.h \
     Video.h \
     VideoCopier.h \
+    VideoIndexer.h \
     WindowManager.h \
     Project.h \
-    OpenCV.h \
     ProjectManager.h \
     MainWindow.h \
     AboutWindow.h \
@@ -58,7 +59,10 @@ HEADERS  += \
     BvRegion.h \
     OptionsWindow.h \
     AnalyzeCheckDialog.h \
-    EnlargedFrameWindow.h
+    EnlargedFrameWindow.h \
+    JobStatus.h \
+    JobControl.h \
+    ThroughputMonitor.h
 
 FORMS    += \
     RegionWindow.ui \
@@ -72,9 +76,6 @@ FORMS    += \
 RC_FILE = myapp.rc
 ICON = BioVision.icns
 
-win32:LIBS += C:\opencv\build\x86\vc10\lib\*.lib
-macx:LIBS += /usr/local/lib/*.dylib
-
 RESOURCES += \
     BvResources.qrc
 
@@ -23,6 +23,8 @@ BvSystem::BvSystem(int & argc, char ** argv) : QApplication(argc, argv)
     //WindowManager must be constructed after ProjectManager
     _windowManager = new WindowManager(this); //Construct WindowManager
 
+    _threadManager->setMaxConcurrentJobs(_projectManager->getConcurrentJobCount());
+
     _imageOfVideo = new QImage(0,0, QImage::Format_ARGB32);
 }
 
@@ -54,6 +56,216 @@ void BvSystem::setWorkspace(QString workspacePath)
     _projectManager->setWorkspaceDirectory(workspacePath);
 }
 
+/*!
+ * \brief BvSystem::getAnalysisThreadCount retrieves the number of threads used by each analysis from the project manager.
+ *
+ * \return The number of analysis threads, 0 means one thread per processor core.
+ */
+int BvSystem::getAnalysisThreadCount()
+{
+    return _projectManager->getAnalysisThreadCount();
+}
+
+/*!
+ * \brief BvSystem::setAnalysisThreadCount asks ProjectManager to save a new number of threads used by each analysis.
+ *
+ * \param threadCount the number of analysis threads, 0 uses one thread per processor core.
+ */
+void BvSystem::setAnalysisThreadCount(int threadCount)
+{
+    _projectManager->setAnalysisThreadCount(threadCount);
+}
+
+/*!
+ * \brief BvSystem::getAnalysisChunkCount retrieves the number of chunks each analysis splits its video into from the
+ * project manager.
+ *
+ * \return The number of analysis chunks, 0 means one chunk per processor core.
+ */
+int BvSystem::getAnalysisChunkCount()
+{
+    return _projectManager->getAnalysisChunkCount();
+}
+
+/*!
+ * \brief BvSystem::setAnalysisChunkCount asks ProjectManager to save a new number of chunks each analysis splits its
+ * video into.
+ *
+ * \param chunkCount the number of analysis chunks, 0 uses one chunk per processor core.
+ */
+void BvSystem::setAnalysisChunkCount(int chunkCount)
+{
+    _projectManager->setAnalysisChunkCount(chunkCount);
+}
+
+/*!
+ * \brief BvSystem::getJpegQuality retrieves the quality of the images saved by an analysis from the project manager.
+ *
+ * \return The JPEG quality, from 0 to 100.
+ */
+int BvSystem::getJpegQuality()
+{
+    return _projectManager->getJpegQuality();
+}
+
+/*!
+ * \brief BvSystem::setJpegQuality asks ProjectManager to save a new quality for the images saved by an analysis.
+ *
+ * \param jpegQuality the JPEG quality, from 0 to 100.
+ */
+void BvSystem::setJpegQuality(int jpegQuality)
+{
+    _projectManager->setJpegQuality(jpegQuality);
+}
+
+/*!
+ * \brief BvSystem::getImageMemoryBudget retrieves the most memory that flagged frames waiting to be saved may use from
+ * the project manager.
+ *
+ * \return The memory budget in megabytes.
+ */
+int BvSystem::getImageMemoryBudget()
+{
+    return _projectManager->getImageMemoryBudget();
+}
+
+/*!
+ * \brief BvSystem::setImageMemoryBudget asks ProjectManager to save a new memory budget for flagged frames waiting to be
+ * saved.
+ *
+ * \param megabytes the memory budget in megabytes.
+ */
+void BvSystem::setImageMemoryBudget(int megabytes)
+{
+    _projectManager->setImageMemoryBudget(megabytes);
+}
+
+/*!
+ * \brief BvSystem::getFrameStride retrieves the number of video frames between two analyzed frames when screening from
+ * the project manager.
+ *
+ * \return The frame stride, 1 analyzes every frame.
+ */
+int BvSystem::getFrameStride()
+{
+    return _projectManager->getFrameStride();
+}
+
+/*!
+ * \brief BvSystem::setFrameStride asks ProjectManager to save a new frame stride for screening.
+ *
+ * \param frameStride the frame stride, 1 analyzes every frame.
+ */
+void BvSystem::setFrameStride(int frameStride)
+{
+    _projectManager->setFrameStride(frameStride);
+}
+
+/*!
+ * \brief BvSystem::getAnalysisScale retrieves how many times smaller in width and height frames are analyzed at from the
+ * project manager.
+ *
+ * \return The analysis scale, 1 analyzes frames at full resolution.
+ */
+int BvSystem::getAnalysisScale()
+{
+    return _projectManager->getAnalysisScale();
+}
+
+/*!
+ * \brief BvSystem::setAnalysisScale asks ProjectManager to save a new analysis scale.
+ *
+ * \param analysisScale the analysis scale, 1, 2, 4 or 8.
+ */
+void BvSystem::setAnalysisScale(int analysisScale)
+{
+    _projectManager->setAnalysisScale(analysisScale);
+}
+
+/*!
+ * \brief BvSystem::isFixedPointBackground retrieves whether the running average background is kept as 16 bit fixed point
+ * from the project manager.
+ *
+ * \return True for the fixed point background.
+ */
+bool BvSystem::isFixedPointBackground()
+{
+    return _projectManager->isFixedPointBackground();
+}
+
+/*!
+ * \brief BvSystem::setFixedPointBackground asks ProjectManager to save which running average background to use.
+ *
+ * \param isFixedPointBackground true for 16 bit fixed point, false for 32 bit floats.
+ */
+void BvSystem::setFixedPointBackground(bool isFixedPointBackground)
+{
+    _projectManager->setFixedPointBackground(isFixedPointBackground);
+}
+
+/*!
+ * \brief BvSystem::isLumaAnalysis retrieves whether frames are analyzed on their luma from the project manager.
+ *
+ * \return True for luma analysis.
+ */
+bool BvSystem::isLumaAnalysis()
+{
+    return _projectManager->isLumaAnalysis();
+}
+
+/*!
+ * \brief BvSystem::setLumaAnalysis asks ProjectManager to save whether frames are analyzed on their luma.
+ *
+ * \param isLumaAnalysis true for luma analysis, false to analyze all three color channels.
+ */
+void BvSystem::setLumaAnalysis(bool isLumaAnalysis)
+{
+    _projectManager->setLumaAnalysis(isLumaAnalysis);
+}
+
+/*!
+ * \brief BvSystem::isRecordingTimeline retrieves whether a timeline of each analysis is recorded from the project manager.
+ *
+ * \return True if the timeline is recorded.
+ */
+bool BvSystem::isRecordingTimeline()
+{
+    return _projectManager->isRecordingTimeline();
+}
+
+/*!
+ * \brief BvSystem::setRecordingTimeline asks ProjectManager to save whether a timeline of each analysis is recorded.
+ *
+ * \param isRecordingTimeline true to record the timeline.
+ */
+void BvSystem::setRecordingTimeline(bool isRecordingTimeline)
+{
+    _projectManager->setRecordingTimeline(isRecordingTimeline);
+}
+
+/*!
+ * \brief BvSystem::getConcurrentJobCount retrieves the most background jobs that run at the same time from the project
+ * manager.
+ *
+ * \return The most jobs that run at the same time, 0 for one per processor core.
+ */
+int BvSystem::getConcurrentJobCount()
+{
+    return _projectManager->getConcurrentJobCount();
+}
+
+/*!
+ * \brief BvSystem::setConcurrentJobCount asks ProjectManager to save the most background jobs that run at the same time,
+ * and passes it on to the ThreadManager.
+ *
+ * \param concurrentJobCount The most jobs that run at the same time, 0 for one per processor core.
+ */
+void BvSystem::setConcurrentJobCount(int concurrentJobCount)
+{
+    _projectManager->setConcurrentJobCount(concurrentJobCount);
+    _threadManager->setMaxConcurrentJobs(concurrentJobCount);
+}
+
 /*!
  * \brief BvSystem::getAllProjects calls project manager to get all of the projects to display in MainWindow.
  * \return the vector of projects to WindowManager.
@@ -147,14 +359,10 @@ QString BvSystem::sendVideoCopyRequest(QString projName, QString videoPath, QStr
         newPath = _projectManager->getWorkspaceDirectory() + "/" + projName + "/" + vidName + "/" + vidName;
     BvThreadWorker *vidCopier = new VideoCopier(projName, videoPath, newPath);
 
-    if(!_threadManager->startThread(vidCopier))
-    {
-        return _threadManager->getCurrentTaskMessage();
-    }
-    else
-    {
-        return "";
-    }
+    // copying a long video can take minutes, it waits its turn behind the analyses already queued.
+    int jobId = _threadManager->queueJob(vidCopier, ThreadManager::NORMAL_PRIORITY);
+
+    return _threadManager->getQueuedJobMessage(jobId);
 }
 
 
@@ -306,18 +514,6 @@ bool BvSystem::setRegion(QString projName, QString vidName, QString oldName, QSt
     return _projectManager->setRegion(projName, vidName, oldName, newName, threshold, notes, x, y, width, height);
 }
 
-/*!
- * \brief BvSystem::checkNumberOfRegions calls ProjectManager to check how many regions have currently been added.
- *
- * \param projName The name of the project
- * \param vidName the name of the video the region will be added to.
- * \return true if the size is less than or equal to 10, false otherwise.
- */
-bool BvSystem::checkNumberOfRegions(QString projName, QString vidName)
-{
-    return (_projectManager->checkRegionSize(projName, vidName));
-}
-
 std::vector<int>* BvSystem::getAllRegionsXcoords(QString projName, QString vidName)
 {
     return _projectManager->getAllRegionsXcoords(projName, vidName);
@@ -358,8 +554,9 @@ int BvSystem::getVideoHeight(QString projName, QString vidName)
  * Handles a request to begin analyzing a video.
  *
  * Creates an Analyzer object (subclass of BvThread Worker) with the needed region data and then calls
- * the startThread method on ThreadManager and passes it that object.  The manager handles the rest.
- * Parameters are all settings for the analysis.
+ * the queueJob method on ThreadManager and passes it that object.  The manager handles the rest.
+ * Parameters are all settings for the analysis.  Analyses requested while another one runs are queued, where their
+ * results are saved is taken now, so each queued analysis saves to the experiment it was requested for.
  *
  * \param projName The name of the project that contains the video to be analyzed.
  * \param vidName The name of the video that will be analyzed.
@@ -373,7 +570,7 @@ int BvSystem::getVideoHeight(QString projName, QString vidName)
  * \param imageOutputSize
  * \param isOutputImages
  *
- * \return an error string if it fails (thread is already running) empty string otherwise
+ * \return an error string if it fails, a notice if the analysis was queued behind other tasks, empty string otherwise
  */
 QString BvSystem::sendAnalyzeRequest(QString projName, QString vidName, int startSec, int stopSec, std::deque<int> videoEditTimesInSeconds, int motionSensitivity, bool isPreviewSelected,
                                   int previewSpeed, int previewSize, int imageOutputSize, bool isOutputImages, bool isFullFrameAnalysis)
@@ -389,6 +586,28 @@ QString BvSystem::sendAnalyzeRequest(QString projName, QString vidName, int star
 
     QString filePath = _projectManager->getVideoPath(projName, vidName);
 
+    // the number of threads each frame is split across, set in the options window.
+    int analysisThreadCount = _projectManager->getAnalysisThreadCount();
+
+    // the number of chunks a long video is split into and analyzed at the same time, set in the options window.
+    int analysisChunkCount = _projectManager->getAnalysisChunkCount();
+
+    // the quality of saved images, and the memory flagged frames may use while they wait to be saved.
+    int jpegQuality = _projectManager->getJpegQuality();
+    int imageMemoryBudget = _projectManager->getImageMemoryBudget();
+
+    // screen every Nth frame and go back over the frames around each event at full rate, set in the options window.
+    int frameStride = _projectManager->getFrameStride();
+
+    // analyze frames at a fraction of their resolution, set in the options window.
+    int analysisScale = _projectManager->getAnalysisScale();
+
+    // keep the running average as 16 bit fixed point to halve its memory, set in the options window.
+    bool isFixedPointBackground = _projectManager->isFixedPointBackground();
+
+    // analyze the luma of each frame alone, meant for monochrome video, set in the options window.
+    bool isLumaAnalysis = _projectManager->isLumaAnalysis();
+
     // Check to make sure the video has not been moved or deleted.
     if(!QFile::exists(filePath))
     {
@@ -399,39 +618,69 @@ QString BvSystem::sendAnalyzeRequest(QString projName, QString vidName, int star
     // If preview is not selected, run a standard analyze by creating an instance of the analyzer class.
     if(isPreviewSelected == false)
     {
-        BvThreadWorker *analyzer = new Analyzer(xCoords, yCoords, widths, heights, thresholds, filePath, startSec, stopSec, videoEditTimesInSeconds, motionSensitivity, regionNames,
-                                                imageOutputSize, isOutputImages, isFullFrameAnalysis);
+        Analyzer *analyzer = new Analyzer(xCoords, yCoords, widths, heights, thresholds, filePath, startSec, stopSec, videoEditTimesInSeconds, motionSensitivity, regionNames,
+                                          imageOutputSize, isOutputImages, isFullFrameAnalysis, analysisThreadCount,
+                                          analysisChunkCount, jpegQuality, imageMemoryBudget, frameStride, analysisScale,
+                                          isFixedPointBackground, isLumaAnalysis);
+
+        // every video gets its own output directory, so analyses of different videos run at the same time, while
+        // analyses of one video wait for each other and find the checkpoints an interrupted run left.
+        QString outputDirectory = "tmp/" + projName + "/" + vidName;
+        analyzer->setOutputDirectory(outputDirectory);
+
+        // record a timeline of the analysis' stages, saved with the run when its results are saved.
+        if(_projectManager->isRecordingTimeline() == true)
+        {
+            analyzer->setTraceFilePath(outputDirectory + "/trace.json");
+        }
         //Commented out for final release
         //qDebug() << "starting thread from bvSystem.";
 
-        if(!_threadManager->startThread(analyzer))
-        {
-            return _threadManager->getCurrentTaskMessage();
-        }
-        else
-            return "";
+        analysisRun run;
+        run.projectName = _analyzeProjectName;
+        run.videoName = _analyzeVideoName;
+        run.experimentName = _analyzeExperimentName;
+        run.overwrite = _overwrite;
+        run.outputDirectory = outputDirectory;
+
+        int jobId = _threadManager->queueJob(analyzer, ThreadManager::NORMAL_PRIORITY);
+
+        _analysisRuns.insert(jobId, run);
+
+        return _threadManager->getQueuedJobMessage(jobId);
     }
     // Otherwise, create an instance of the preview analyze class.
     else
     {
         BvThreadWorker *previewAnalyze = new DetailAnalyzer(xCoords, yCoords, widths, heights, thresholds, filePath, startSec, stopSec, videoEditTimesInSeconds, motionSensitivity,
-                                                            previewSpeed, previewSize);
+                                                            previewSpeed, previewSize, analysisThreadCount);
 
-        if(!_threadManager->startThread(previewAnalyze))
-        {
-            return _threadManager->getCurrentTaskMessage();
-        }
-        else
-            return "";
+        int jobId = _threadManager->queueJob(previewAnalyze, ThreadManager::NORMAL_PRIORITY);
+
+        return _threadManager->getQueuedJobMessage(jobId);
     }
 }
 
 /*!
- * \brief cancelTask sets static BvThreadWorker variable _isCancelled to true, signaling any running analysis to stop.
+ * \brief cancelTask cancels the current task, the one the progress bar follows, through its own cancellation token.
+ * Other running and queued jobs are not affected.
  */
 void BvSystem::cancelTask()
 {
-    BvThreadWorker::_isCancelled = true;
+    _threadManager->cancelCurrentTask();
+}
+
+/*!
+ * \brief pauseTask pauses or resumes the current task, through its own pause token.  Only analyses can be paused, they
+ * save a checkpoint and wait.
+ *
+ * \param isPaused true to pause the task, false to resume it.
+ *
+ * \return true if the current task was paused or resumed, false if it cannot be paused.
+ */
+bool BvSystem::pauseTask(bool isPaused)
+{
+    return _threadManager->pauseCurrentTask(isPaused);
 }
 
 /*!
@@ -458,6 +707,18 @@ void BvSystem::progressUpdateSlot(int progress)
     _windowManager->updateProgress(progress);
 }
 
+/*!
+ *  BvSystem::statusUpdateSlot passes the live status of the current task (its rate, time left and where its time goes)
+ *  to the windowManager to show in the status bar.
+ *
+ * \param statusText the status of the current task, empty once no task is running.
+ * \param isPaused true while the current task is paused.
+ */
+void BvSystem::statusUpdateSlot(QString statusText, bool isPaused)
+{
+    _windowManager->updateStatus(statusText, isPaused);
+}
+
 /*!
  * \brief BvSystem::updateCarouselSlot calls window manager to update the carousel with the newly written image at this
  * filename.
@@ -482,9 +743,10 @@ void BvSystem::displayErrorWindowSlot()
  * BvSystem::handleResultSlot is called when the thread is done.  It is passed a pointer to a Result object
  * that contains the data gathered from the threading call.
  *
+ * \param jobId the id of the job that sent the result, used to find where an analysis saves its results.
  * \param result the result object.  \see Result
  */
-void BvSystem::handleResultSlot(Result* result)
+void BvSystem::handleResultSlot(int jobId, Result* result)
 {   
     // If the data field is set, then it was a video copy request.
     if(result->getData()!="")
@@ -505,32 +767,49 @@ void BvSystem::handleResultSlot(Result* result)
             {
                 _windowManager->displayVidCopyError();
             }
-            else//do nothing
+            else
             {
                 //Commented out for final release
                 //qDebug() << "congrats you copied the video!";
+
+                // index the copy once nothing else is waiting, the video can be analyzed without its index meanwhile.
+                _threadManager->queueJob(new VideoIndexer(path), ThreadManager::LOW_PRIORITY);
             }
         }
     }
     // this is an Analyze finished request.  Prompt the user on further actions.
     else
     {
+        analysisRun run = _analysisRuns.take(jobId);
+
         // get the approximate size of the images that were generated by this run.
-        QString size = _projectManager->getSizeOfImages();
+        QString size = _projectManager->getSizeOfImages(run.outputDirectory);
 
         // Prompt to save the images from this run.  If so, pass true for that boolean value.
         if(_windowManager->launchAnalyzeFinishedDialog(size))
         {
-            _projectManager->outputResults(_analyzeProjectName, _analyzeVideoName, _analyzeExperimentName, _overwrite, true);
+            _projectManager->outputResults(run.projectName, run.videoName, run.experimentName, run.overwrite, true, run.outputDirectory);
         }
         // otherwise, pass false.
         else
         {
-            _projectManager->outputResults(_analyzeProjectName, _analyzeVideoName, _analyzeExperimentName, _overwrite, false);
+            _projectManager->outputResults(run.projectName, run.videoName, run.experimentName, run.overwrite, false, run.outputDirectory);
         }
     }
 }
 
+/*!
+ * \brief BvSystem::jobFinishedSlot is called by the ThreadManager when a job is finished, after its result, if it sent
+ * one, has been handled.  An analysis that was cancelled, or stopped on an error, sends no result, so where it would
+ * have saved its results is forgotten here.
+ *
+ * \param jobId the id of the finished job.
+ */
+void BvSystem::jobFinishedSlot(int jobId)
+{
+    _analysisRuns.remove(jobId);
+}
+
 /*!
  * \brief BvSystem::setOverwriteOldExperiment If an experiment name already exists, then we prompt the user if they want
  * to overwrite that experiment data.  This function sets the result of that prompt, and then this value is passed to the
@@ -572,7 +851,7 @@ bool BvSystem::checkExperimentName(QString projName, QString vidName, QString ru
  */
 void BvSystem::getAllMetaData(QString videoFilePath)
 {
-    OpenCV openCV = OpenCV();
+    OpenCV openCV;
     openCV.openVideoFile(videoFilePath.toStdString());
     _numberOfFrames = openCV.OpenCV::getNumberOfVideoFrames();
     _frameRate = openCV.getVideoFrameRate();
@@ -597,7 +876,7 @@ void BvSystem::getAllMetaData(QString videoFilePath)
  */
 std::string BvSystem::saveFrameWhenRegionCreated(QString videoFilePath, int videoTimeInMilliseconds, int frameX1, int frameY1, int frameWidth, int frameHeight, int regionNumber)
 {
-    OpenCV openCV = OpenCV();
+    OpenCV openCV;
 
     //open the video file, and set all data for drawing onto a frame
     openCV.openVideoFile(videoFilePath.toStdString());
@@ -26,8 +26,10 @@ class ProjectManager;
 #include "Analyzer.h"
 #include "DetailAnalyzer.h"
 #include "VideoCopier.h"
+#include "VideoIndexer.h"
 
 #include <QString>
+#include <QMap>
 #include <QApplication>
 #include <string>
 
@@ -46,6 +48,28 @@ public:
     QString getWorkspace();
     void setWorkspace(QString workspacePath);
 
+    // Functions for the analysis options.  These go to ProjectManager.
+    int getAnalysisThreadCount();
+    void setAnalysisThreadCount(int threadCount);
+    int getAnalysisChunkCount();
+    void setAnalysisChunkCount(int chunkCount);
+    int getJpegQuality();
+    void setJpegQuality(int jpegQuality);
+    int getImageMemoryBudget();
+    void setImageMemoryBudget(int megabytes);
+    int getFrameStride();
+    void setFrameStride(int frameStride);
+    int getAnalysisScale();
+    void setAnalysisScale(int analysisScale);
+    bool isFixedPointBackground();
+    void setFixedPointBackground(bool isFixedPointBackground);
+    bool isLumaAnalysis();
+    void setLumaAnalysis(bool isLumaAnalysis);
+    bool isRecordingTimeline();
+    void setRecordingTimeline(bool isRecordingTimeline);
+    int getConcurrentJobCount();
+    void setConcurrentJobCount(int concurrentJobCount);
+
     //Requests to Access or Manipulate ProjectManager data
     Project* getProject(QString projName);
     std::vector<Project*> getAllProjects();
@@ -71,7 +95,6 @@ public:
 
     // Region data.
     bool setRegion(QString projName, QString vidName, QString oldName, QString newName, int threshold, QString notes, int x, int y, int width, int height);
-    bool checkNumberOfRegions(QString projName, QString vidName);
     std::vector<int>* getAllRegionsXcoords(QString projName, QString vidName);
     std::vector<int>* getAllRegionsYcoords(QString projName, QString vidName);
     std::vector<int>* getAllRegionsWidths(QString projName, QString vidName);
@@ -101,6 +124,7 @@ public:
 
     // Cancels a task.
     void cancelTask();
+    bool pauseTask(bool isPaused);
 
     // Create image when regions are selected .
     std::string saveFrameWhenRegionCreated(QString videoPath, int videoTimeInMilliseconds, int frameX1, int frameY1, int frameWidth, int frameHeight, int regionNumber);
@@ -110,10 +134,12 @@ public:
 
 public Q_SLOTS:
     void progressUpdateSlot(int);
+    void statusUpdateSlot(QString statusText, bool isPaused);
     void clearCarouselSlot();
     void updateCarouselSlot(QString, QString index);
     void displayErrorWindowSlot();
-    void handleResultSlot(Result*);
+    void handleResultSlot(int jobId, Result*);
+    void jobFinishedSlot(int jobId);
 
 private:
     /*!
@@ -143,6 +169,21 @@ private:
     QString _analyzeProjectName;
     QString _analyzeVideoName;
     QString _analyzeExperimentName;
+
+    //where the results of a queued analysis are saved, taken when the analysis is requested
+    struct analysisRun
+    {
+        QString projectName;
+        QString videoName;
+        QString experimentName;
+        bool overwrite;
+
+        //where the analysis writes its results and images until they are saved
+        QString outputDirectory;
+    };
+
+    /*! The output of every analysis that has not sent its result yet, by job id, until its job finishes. */
+    QMap<int, analysisRun> _analysisRuns;
     QImage* _imageOfVideo;
 
     //End Managers
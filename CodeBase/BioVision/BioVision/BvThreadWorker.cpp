@@ -1,13 +1,18 @@
 #include "BvThreadWorker.h"
+#include <algorithm>
 
-//static variable used to stop an analysis when it is cancled from the GUI
-bool BvThreadWorker::_isCancelled = false;
 /*!
- * Instantiates the boolean cancelTask to false.
+ * Sets the default busy message, and leaves the task unpausable, using no thread, and without a JobControl until the
+ * ThreadManager queues it.
  */
 BvThreadWorker::BvThreadWorker()
 {
     _message = "A task is currently running.";
+    _isPausable = false;
+    _threadCount = 0;
+
+    // every job gets its own control, set by the ThreadManager when the job is queued.
+    _jobControl = NULL;
 }
 
 /*!
@@ -34,6 +39,81 @@ QString BvThreadWorker::getMessage()
     return _message;
 }
 
+/*!
+ * Sets what the task writes that no other task may use while it runs, such as its analysis output directory or the
+ * preview window.  The ThreadManager never runs two tasks with the same resource at the same time, tasks with different
+ * resources or none run side by side
+ */
+void BvThreadWorker::setExclusiveResource(QString resource)
+{
+    _exclusiveResource = resource;
+}
+
+/*!
+ * Returns what the task writes that no other task may use while it runs, empty for nothing
+ */
+QString BvThreadWorker::getExclusiveResource()
+{
+    return _exclusiveResource;
+}
+
+/*!
+ * Sets how many threads the task keeps busy while it runs.  The ThreadManager starts queued tasks only while the threads
+ * of the running tasks fit on the processor cores.  0, the default, is for tasks that keep no core busy, which start
+ * regardless
+ */
+void BvThreadWorker::setThreadCount(int threadCount)
+{
+    _threadCount = std::max(threadCount, 0);
+}
+
+/*!
+ * Returns how many threads the task keeps busy while it runs
+ */
+int BvThreadWorker::getThreadCount()
+{
+    return _threadCount;
+}
+
+/*!
+ * Sets whether the task checks the pause token of its job while it runs. The ThreadManager only pauses such tasks
+ */
+void BvThreadWorker::setPausable(bool isPausable)
+{
+    _isPausable = isPausable;
+}
+
+/*!
+ * Returns whether the task can be paused
+ */
+bool BvThreadWorker::isPausable()
+{
+    return _isPausable;
+}
+
+/*!
+ * Sets the cancellation token and progress counters of the job. The control belongs to the job's JobStatus, which
+ * outlives the worker
+ */
+void BvThreadWorker::setJobControl(JobControl* jobControl)
+{
+    _jobControl = jobControl;
+}
+
+/*!
+ * Returns true once the job has been cancelled, by the user or by the worker after an error. A worker that was never
+ * queued has no job and is not cancelled
+ */
+bool BvThreadWorker::isCancelled()
+{
+    if(_jobControl == NULL)
+    {
+        return false;
+    }
+
+    return _jobControl->isCancelled();
+}
+
 /*!
  * \brief BvThreadWorker::sendImageInfoSlot is implemented by subclasses.
  *
@@ -52,12 +132,3 @@ void BvThreadWorker::clearCarouselSlot()
     //do nothing- subclasses can specify unique behaviors.
 }
 
-/*!
- * \brief BvThreadWorker::progressConvert is implemented by subclasses.
- *
- * \param progress is a measure of the progress of a given task.
- */
-void BvThreadWorker::progressConvert(qint64 progress)
-{
-    // do nothing- subclasses can specify unique behaviors.
-}
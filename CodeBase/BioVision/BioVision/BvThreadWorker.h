@@ -3,7 +3,7 @@
  *
  * Abstract superclass for objects that can be moved to threads and do background work for BioVision.
  *
- * Implemented by Analyzer, DetailAnalyzer, and VideoCopier.  These classes override the virtual startSlot() function and allow
+ * Implemented by Analyzer, DetailAnalyzer, VideoCopier, and VideoIndexer.  These classes override the virtual startSlot() function and allow
  * customized behavior when the thread is started.  This way thread manager does not need to know what kind of
  * task it has to perform, it just takes a task, connects the right signals and slots (signals defined here) and
  * starts the thread.
@@ -14,6 +14,7 @@
 
 #include <QObject>
 #include "Result.h"
+#include "JobControl.h"
 
 class BvThreadWorker : public QObject
 {
@@ -36,16 +37,50 @@ class BvThreadWorker : public QObject
         void setMessage(QString message);
         QString getMessage();
 
-        static bool _isCancelled;
+        void setExclusiveResource(QString resource);
+        QString getExclusiveResource();
+
+        void setThreadCount(int threadCount);
+        int getThreadCount();
+
+        void setPausable(bool isPausable);
+        bool isPausable();
+
+        void setJobControl(JobControl* jobControl);
+        bool isCancelled();
+
+    protected:
+        /*!
+         * \brief _jobControl the cancellation token and progress counters of the job, set by the ThreadManager before
+         * the job starts.
+         */
+        JobControl* _jobControl;
+
+    private:
+        /*!
+         * \brief _exclusiveResource what the task writes that other tasks must not use at the same time, such as an
+         * analysis output directory or the preview window.  The ThreadManager runs tasks naming the same resource one at
+         * a time, empty for none.
+         */
+        QString _exclusiveResource;
+
+        /*!
+         * \brief _threadCount how many threads the task keeps busy, the ThreadManager starts tasks while their threads
+         * fit on the processor cores.
+         */
+        int _threadCount;
+
+        /*!
+         * \brief _isPausable true for tasks that check JobControl::isPaused() while they run, only those can be paused.
+         */
+        bool _isPausable;
 
     public Q_SLOTS:
         virtual void startSlot()=0;
         virtual void sendImageInfoSlot(QString imageName, QString index);
         virtual void clearCarouselSlot();
-        virtual void progressConvert(qint64 progress);
 
     Q_SIGNALS:
-        void progressSignal(int progress);
         void sendImageInfoSignal(QString name, QString index);
         void clearCarouselSignal();
         void sendResultSignal(Result* result);
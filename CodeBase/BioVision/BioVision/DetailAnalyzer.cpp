@@ -5,8 +5,11 @@
 ///////////////////////////////////////////////////////////
 
 #include "DetailAnalyzer.h"
+#include "SegmentPlan.h"
+#include <QThread>
 #include <iostream>
 #include <fstream>
+#include <algorithm>
 
 /*!
  * Default constructor.
@@ -35,10 +38,11 @@ DetailAnalyzer::DetailAnalyzer()
  * \param motionSensitivity: Determines the level of motion detected in a video, passed from GUI slider bar
  * \param previewSpeed: Determines the playback speed of the preview
  * \param previewSize: Determines the size of the preview window, used to enlarge low resolution videos for easier viewing
+ * \param analysisThreadCount: The number of threads each frame is split across, 0 uses one thread per processor core
  */
 DetailAnalyzer::DetailAnalyzer(std::vector<int>* xCoords, std::vector<int>* yCoords, std::vector<int>* widths, std::vector<int>* heights,
                    std::vector<int>* thresholds, QString videoFilePath, int startSecond, int stopSecond, std::deque<int> videoEditTimesInSeconds,
-                   int motionSensitivity, int previewSpeed, int previewSize)
+                   int motionSensitivity, int previewSpeed, int previewSize, int analysisThreadCount)
 {
     _regionXCoords = xCoords;
     _regionYCoords = yCoords;
@@ -53,11 +57,16 @@ DetailAnalyzer::DetailAnalyzer(std::vector<int>* xCoords, std::vector<int>* yCoo
     _motionSensitivity = (float)motionSensitivity;
     _previewSpeed = previewSpeed;
     _previewSize = previewSize;
-
-    _isCancelled = false;
+    _analysisThreadCount = analysisThreadCount;
 
     // Set the message for detailed Analyzer.
     setMessage("Preview Analyze is currently running.");
+
+    // the preview window is shared by every preview, they run one at a time.  Analyses run next to a preview.
+    setExclusiveResource("preview window");
+
+    // the frame is split across this many threads.
+    setThreadCount((analysisThreadCount == 0) ? QThread::idealThreadCount() : analysisThreadCount);
 }
 
 /*!
@@ -76,7 +85,7 @@ DetailAnalyzer::~DetailAnalyzer()
  * The slot that is run on the QThread object.  It contains the actual analyze algorithm
  * definition.
  *
- * Uses the CV object to call all of the open-cv related methods.  Updates progress via the progressSignal,
+ * Uses the CV object to call all of the open-cv related methods.  Updates progress through the job control,
  * and calls the finish signal when it is done.  **Important** also instantiate any objects that the thread will use
  * in this function, otherwise it will be a conflict (different thread affinities, as this is the only method run on
  * the new thread).
@@ -105,7 +114,7 @@ void DetailAnalyzer::previewAnalyze()
 
     std::vector <int> regionTemp;
 
-    float percentChangeInRegion[10];
+    std::vector <float> percentChangeInRegion;
 
     //set 2 region coordinates using start point passed from system. and region height and width passed from system
     if(_regionHeights->size() != 0)
@@ -120,14 +129,14 @@ void DetailAnalyzer::previewAnalyze()
             regionCoordinates[i].push_back( (*_regionYCoords)[i] + (*_regionHeights)[i] );
 
             //convert from int to decimal
-            percentChangeInRegion[i] = ( (*_regionThresholds)[i] );
+            percentChangeInRegion.push_back( (*_regionThresholds)[i] );
 
             percentChangeInRegion[i] = ( percentChangeInRegion[i] / 100 );
         }
     }
     else
     {
-        percentChangeInRegion[0] = 0;
+        percentChangeInRegion.push_back(0);
     }
 
     //copy the video file path as a standard string
@@ -178,7 +187,7 @@ void DetailAnalyzer::previewAnalyze()
                 tempData.regionStartPointY = regionCoordinates[regionNum][1];
                 tempData.regionEndPointX = regionCoordinates[regionNum][2];
                 tempData.regionEndPointY = regionCoordinates[regionNum][3];
-                tempData.regionRectangleColor = _cvObject.colorList[regionNum].colorName;
+                tempData.regionRectangleColor = _cvObject.getRegionColor(regionNum).colorName;
                 regionData.push_back(tempData);
             }
 
@@ -203,18 +212,8 @@ void DetailAnalyzer::previewAnalyze()
             regionData.push_back(tempData);
         }
 
-        //setup results for changes
-        if(regionCoordinates.size() != 0)
-        {
-            //initialize variables withing the OpenCV class that track pixel changes per region
-            int numberOfRegions = regionCoordinates.size();
-            _cvObject.initializePixelChangeVariables(numberOfRegions, regionData, percentChangeInRegion, _regionWidths, _regionHeights);
-        }
-        else //if no regions were selected by the user, set one region selecting the whole frame
-        {
-            //initialize pixel change variables for a single region
-            _cvObject.initializePixelChangeVariables(1, regionData, percentChangeInRegion, _regionWidths, _regionHeights);
-        }
+        //setup results for changes, initialize variables withing the OpenCV class that track pixel changes per region
+        _cvObject.initializePixelChangeVariables(regionCoordinates, regionData, percentChangeInRegion, _regionWidths, _regionHeights);
 
 
         //currently, the video starts at the beginning and analyzes all the way to the end
@@ -241,11 +240,29 @@ void DetailAnalyzer::previewAnalyze()
 
         //set analysis end time based on time chosen by the user
         analysisEndFrame = _stopSecond * _cvObject.getVideoFrameRate();
-        _stopSecond = _stopSecond * 1000;
+
+        //turn the start, stop and edit times into the frame ranges that are previewed, nothing is read past the video's end
+        int lastFrame = (int)analysisEndFrame;
+
+        if(_cvObject.getNumberOfVideoFrames() > 0)
+        {
+            lastFrame = std::min(lastFrame, (int)_cvObject.getNumberOfVideoFrames());
+        }
+
+        SegmentPlan segmentPlan(currentFrameNumber, lastFrame, _editPoints, _cvObject.getVideoFrameRate());
+        const std::vector<SegmentPlan::segment> &segments = segmentPlan.getSegments();
+        int currentSegment = segmentPlan.findSegment(currentFrameNumber);
+
+        //progress is counted in previewed frames, edited out stretches are never read
+        int framesPreviewed = 0;
+        int framesToPreview = std::max(segmentPlan.getIncludedFrameCount(), 1);
 
         //set start frame, output path, and video file name in open CV class NOTE: output path is empty for DetailAnalyzer, as it has no output
         _cvObject.initializeStartFrameAndFileName("", videoFileName, analysisStartFrame);
 
+        //set the number of threads each frame is split across, used when the frame buffers are allocated
+        _cvObject.setAnalysisThreadCount(_analysisThreadCount);
+
         //set current frame size of video, used for creating image variables for analysis
         _cvObject.initializeFrameSizeSensitivityAndDrawSize(_motionSensitivity);
 
@@ -261,13 +278,13 @@ void DetailAnalyzer::previewAnalyze()
         //open preview window
         _cvObject.openPreviewWindow();
 
-        //emit a starting signal to show that analysis has begun for very long jobs
-        emit progressSignal(1);
+        //report a starting progress to show that analysis has begun for very long jobs
+        _jobControl->setProgress(1);
 
         //has an openCV error occured on this run
         bool isErrorThrown = false;
 
-        while(true)
+        while(currentSegment >= 0)
         {
             try
             {
@@ -279,76 +296,69 @@ void DetailAnalyzer::previewAnalyze()
                 //const char* err_msg = e.what();
                 //std::cout << err_msg;
 
+                //the header's frame count is only an estimate, a read that fails at the end of the video ends the preview
+                if(_cvObject.isEndOfVideo(currentFrameNumber))
+                {
+                    break;
+                }
+
                 isErrorThrown = true;
-                _isCancelled = true;
+                _jobControl->cancel();
                 _cvObject.shrinkPreviewWindow();
                 _cvObject.deallocateFramesOnError();
                 break;
             }
 
             //if the cancel button is clicked, close the preview window and reset status bar
-            if(_isCancelled == true)
+            if(isCancelled() == true)
             {
-                emit progressSignal(0);
+                _jobControl->setProgress(0);
                 _cvObject.closePreviewWindow();
                 break;
             }
 
-            if(_cvObject.getCurrentVideoTime() >= _stopSecond)
-            {
-                _cvObject.shrinkPreviewWindow();
-                break;
-            }
+            framesPreviewed++;
 
             //output current percentage completion
-            float framesAnalyzed = currentFrameNumber;
-            float lastFrameToAnylize = analysisEndFrame;
-            if(percentComplete < int((framesAnalyzed/lastFrameToAnylize) * 100))
+            if(percentComplete < (framesPreviewed * 100) / framesToPreview)
             {
-                percentComplete = int((framesAnalyzed/lastFrameToAnylize) * 100);
+                percentComplete = (framesPreviewed * 100) / framesToPreview;
 
-                //Commented out for final release
-                //std::cout << "Analysis is " << percentComplete << "% Complete\n";
-
-                //Emit this data to the GUI to update our progress bar
-                emit progressSignal(percentComplete);
+                //store it for the GUI, which reads it to update our progress bar
+                _jobControl->setProgress(percentComplete);
             }
 
-            //if we are at an edit point set by the user, skip to the next frame they wish to have analyzed
-            if(_editPoints.size() != 0)
+            //the segment is done, skip the frames left out to the next one
+            if(currentFrameNumber >= segments[currentSegment].endFrame)
             {
-                //if the current video time is equal/greater than the next edit point
-                if(_cvObject.getCurrentVideoTime() >= (_editPoints.front() * 1000))
-                {
-                    //pop old edit time
-                    _editPoints.pop_front();
-
-                    //set the video to the user selected time to resume analysis
-                    _cvObject.setCurrentVideoTime((double) (_editPoints.front() * 1000));
-                    currentFrameNumber = _cvObject.getCurrentVideoFrame();
-
-                    //remove analysis resume time
-                    _editPoints.pop_front();
+                currentSegment++;
 
-                    //we have skipped time in the video, tells frame analysis algorythim to reset
-                    //moving frame average for the next frame
-                    isEditFrame = true;
+                if(currentSegment < (int)segments.size())
+                {
+                    currentFrameNumber = _cvObject.skipToVideoFrame(currentFrameNumber, segments[currentSegment].firstFrame);
                 }
-                else
+
+                //the last segment is done, or the end of the video was reached inside the gap
+                if(currentSegment == (int)segments.size() || currentFrameNumber < 0)
                 {
-                    isEditFrame = false;
+                    _cvObject.shrinkPreviewWindow();
+                    break;
                 }
+
+                //we have skipped time in the video, tells frame analysis algorythim to reset
+                //moving frame average for the next frame
+                isEditFrame = true;
             }
-            else//Else no edit had taken place, proceed as normal
+            else
             {
                 isEditFrame = false;
             }
         }
 
         //if we reach the end of the video, shrink the preview window and reset status bar
-        if(_isCancelled == false)
+        if(isCancelled() == false)
         {
-            emit progressSignal(0);
+            _jobControl->setProgress(0);
             _cvObject.shrinkPreviewWindow();
         }
 
@@ -359,7 +369,7 @@ void DetailAnalyzer::previewAnalyze()
 
         if(isErrorThrown == true)
         {
-            emit progressSignal(0);
+            _jobControl->setProgress(0);
             //display error window letting user know something is wrong while analyzing this video
             displayErrorMessageSignal();
         }
@@ -6,7 +6,7 @@
  *
  * DetailAnalyzer overrides the startSlot (which is run on another thread) and performs the main logical loop of the program,
  * analyzing the video for differences.  At the end it emits a signal to send the results and a signal to finish the
- * thread.  During it emits progress signals to notify the user of the progress.
+ * thread.  During it stores its progress in the job control for the GUI to read.
  *
  * Unlike Analyzer, DetailAnalyzer saves no image files and collects no other analysis data. Instead, it plays the video back in
  * real time for the user, using the analysis setting they selected in order to allow them to preview their full analysis run,
@@ -28,7 +28,7 @@ public:
     DetailAnalyzer();
     DetailAnalyzer(std::vector<int>* xCoords, std::vector<int>* yCoords, std::vector<int>* widths, std::vector<int>* heights,
              std::vector<int>* thresholds, QString videoFilePath, int startSecond, int stopSecond, std::deque<int> videoEditTimesInSeconds,
-             int motionSensitivity, int previewSpeed, int previewSize);
+             int motionSensitivity, int previewSpeed, int previewSize, int analysisThreadCount);
     ~DetailAnalyzer();
     void previewAnalyze();
 
@@ -49,6 +49,7 @@ private:
     float _motionSensitivity;
     int _previewSpeed;
     int _previewSize;
+    int _analysisThreadCount;
 
 };
 #endif
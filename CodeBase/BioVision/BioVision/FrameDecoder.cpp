@@ -0,0 +1,171 @@
+#include "FrameDecoder.h"
+#include <algorithm>
+
+/*!
+ * Constructor, stores the video stream and analysis range. Decoding starts when the thread is started
+ *
+ * \param cvObject: The openCV object with the video file open and set to the first frame of the analysis
+ * \param decodedFrames: The ring decoded frames are written to
+ * \param firstFrameNumber: The frame number of the next frame the stream will read
+ * \param segmentPlan: The frame ranges of the analysis, frames outside them are skipped without being decoded
+ * \param frameStride: 1 to decode every frame, N to decode every Nth frame
+ * \param isContinuingAverage: True if the running average was restored from a checkpoint and the first frame continues it
+ */
+FrameDecoder::FrameDecoder(OpenCV* cvObject, FrameRing* decodedFrames, int firstFrameNumber, const SegmentPlan &segmentPlan, int frameStride,
+                           bool isContinuingAverage)
+{
+    _cvObject = cvObject;
+    _decodedFrames = decodedFrames;
+    _currentFrameNumber = firstFrameNumber;
+    _segmentPlan = segmentPlan;
+    _frameStride = std::max(frameStride, 1);
+    _isContinuingAverage = isContinuingAverage;
+}
+
+/*!
+ * Destructor
+ */
+FrameDecoder::~FrameDecoder()
+{
+
+}
+
+/*!
+ * Decoding loop, run on the decoder thread. Reads frames until the end of the last segment, a failed read, or until the
+ * ring is cancelled, then closes the ring
+ */
+void FrameDecoder::run()
+{
+    const std::vector<SegmentPlan::segment> &segments = _segmentPlan.getSegments();
+
+    //the segment holding the next frame, a stream that starts between two segments moves on to the next one
+    int currentSegment = _segmentPlan.findSegment(_currentFrameNumber);
+
+    if(currentSegment >= 0 && _currentFrameNumber < segments[currentSegment].firstFrame)
+    {
+        _currentFrameNumber = _cvObject->skipToVideoFrame(_currentFrameNumber, segments[currentSegment].firstFrame);
+    }
+
+    if(currentSegment < 0 || _currentFrameNumber < 0)
+    {
+        _decodedFrames->close();
+        return;
+    }
+
+    //is the next frame the first frame of the analysis, or the first frame of a new segment. A resumed analysis goes on
+    //with its restored running average unless it resumes at the start of a segment
+    bool isEditFrame = (_isContinuingAverage == false || _currentFrameNumber == segments[currentSegment].firstFrame);
+
+    while(true)
+    {
+        //waits while the analysis is behind, returns NULL if the analysis was cancelled
+        FrameRing::Frame* frame = _decodedFrames->beginWrite();
+
+        if(frame == NULL)
+        {
+            return;
+        }
+
+        try
+        {
+            BV_TIME_STAGE(_cvObject->getStageProfiler(), StageProfiler::DECODE);
+
+            _cvObject->getFrameForAnalysis(frame->image);
+
+            //extract the luma here, so the analysis thread only works on a single channel
+            if(_cvObject->isLumaAnalysis() == true && frame->image.empty() == false)
+            {
+                _cvObject->getLumaFrameForAnalysis(frame->image, frame->lumaImage);
+            }
+        }
+        catch(cv::Exception& e)
+        {
+            frame->image = cv::Mat();
+        }
+
+        //the header's frame count is only an estimate, a read that fails at the end of the video ends the analysis
+        if(frame->image.empty() && _cvObject->isEndOfVideo(_currentFrameNumber))
+        {
+            break;
+        }
+
+        //the stream position after a read is the number of the next frame
+        frame->frameNumber = _currentFrameNumber;
+        frame->videoFramePosition = _currentFrameNumber + 1;
+        frame->isEditFrame = isEditFrame;
+
+        _currentFrameNumber++;
+
+        //a failed read is passed on so the analysis reports it, and nothing more can be read
+        if(frame->image.empty())
+        {
+            //a luma image left in the slot from an earlier frame must not be analyzed in its place
+            frame->lumaImage = cv::Mat();
+            _decodedFrames->finishWrite();
+            break;
+        }
+
+        isEditFrame = false;
+
+        //is the frame just read the last frame of the analysis
+        bool isLastFrame = false;
+
+        //step over the frames the stride leaves out, stopping early at the end of the segment
+        for(int skippedFrames = 0; ; skippedFrames++)
+        {
+            //the segment is done, jump over the frames left out to the next one
+            if(_currentFrameNumber >= segments[currentSegment].endFrame)
+            {
+                currentSegment++;
+
+                if(currentSegment < (int)segments.size())
+                {
+                    _currentFrameNumber = _cvObject->skipToVideoFrame(_currentFrameNumber, segments[currentSegment].firstFrame);
+                }
+
+                //the last segment is done, or the end of the video was reached inside the gap
+                if(currentSegment == (int)segments.size() || _currentFrameNumber < 0)
+                {
+                    isLastFrame = true;
+                    break;
+                }
+
+                //we have skipped time in the video, tells frame analysis algorythim to reset
+                //moving frame average for the next frame
+                isEditFrame = true;
+                break;
+            }
+
+            if(skippedFrames == _frameStride - 1)
+            {
+                break;
+            }
+
+            //the end of the video was reached between two decoded frames
+            bool isFrameSkipped;
+            {
+                BV_TIME_STAGE(_cvObject->getStageProfiler(), StageProfiler::DECODE);
+
+                isFrameSkipped = _cvObject->skipFrameForAnalysis();
+            }
+
+            if(isFrameSkipped == false)
+            {
+                isLastFrame = true;
+                break;
+            }
+
+            _currentFrameNumber++;
+        }
+
+        _decodedFrames->finishWrite();
+
+        if(isLastFrame == true)
+        {
+            break;
+        }
+    }
+
+    //no more frames, the analysis ends once it has read every frame already in the ring
+    _decodedFrames->close();
+}
@@ -0,0 +1,61 @@
+/*!
+ * \class FrameDecoder
+ *
+ * The first stage of the analysis pipeline.  FrameDecoder runs on its own thread and reads every frame of an analysis from
+ * the video stream into a FrameRing, so the next frame is decoded while the current one is analyzed.
+ *
+ * It owns the video stream for the whole analysis and follows the analysis' SegmentPlan: it reads the frames of each
+ * segment, jumps to the next segment with OpenCV::skipToVideoFrame() once the current one ends, and stops after the last
+ * frame of the last segment.  Frame numbers are counted as frames are read, the stream is only asked for its position
+ * after a seek.  A frame that fails to read at the end of the video, \see OpenCV::isEndOfVideo(), ends the analysis like
+ * its last frame.  One that fails inside the video is passed on empty, so the analysis reports it the same way it always
+ * has, and decoding ends.
+ *
+ * With a frame stride of N, only every Nth frame is decoded.  The frames in between are grabbed from the stream without
+ * being decoded into an image, and still count towards frame numbers and segment ends.
+ *
+ * An analysis resumed from a checkpoint continues the running average it restored, so its first frame is only an edit
+ * frame if it starts a segment.
+ *
+ * With luma analysis the decoder also extracts the luma of each frame, so that work stays off the analysis thread.
+ */
+
+#ifndef FRAMEDECODER_H
+#define FRAMEDECODER_H
+
+#include "OpenCV.h"
+#include "FrameRing.h"
+#include "SegmentPlan.h"
+#include <QThread>
+
+class FrameDecoder : public QThread
+{
+
+public:
+    FrameDecoder(OpenCV* cvObject, FrameRing* decodedFrames, int firstFrameNumber, const SegmentPlan &segmentPlan, int frameStride,
+                 bool isContinuingAverage = false);
+    ~FrameDecoder();
+
+protected:
+    void run();
+
+private:
+    /*! The openCV object holding the open video stream. */
+    OpenCV* _cvObject;
+
+    /*! Ring the decoded frames are written to. */
+    FrameRing* _decodedFrames;
+
+    /*! Frame number of the next frame read. */
+    int _currentFrameNumber;
+
+    /*! The frame ranges of the analysis. */
+    SegmentPlan _segmentPlan;
+
+    /*! Number of video frames between two decoded frames. */
+    int _frameStride;
+
+    /*! True if the first frame continues the running average of an earlier run instead of starting a new one. */
+    bool _isContinuingAverage;
+};
+#endif
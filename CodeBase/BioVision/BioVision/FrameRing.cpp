@@ -0,0 +1,191 @@
+#include "FrameRing.h"
+#include <QMutexLocker>
+
+//longest a waiting stage sleeps before looking at the ring again, in milliseconds
+static const unsigned long MAX_WAIT_MILLISECONDS = 50;
+
+/*!
+ * Constructor, creates an empty ring
+ *
+ * \param capacity: The number of frames the ring holds before the producer has to wait
+ */
+FrameRing::FrameRing(int capacity)
+{
+    _frames.resize(capacity + 1);
+
+    _writeIndex = 0;
+    _readIndex = 0;
+    _isClosed = 0;
+    _isCancelled = 0;
+    _waitingThreads = 0;
+}
+
+/*!
+ * Destructor
+ */
+FrameRing::~FrameRing()
+{
+
+}
+
+/*!
+ * Gets the slot the producer fills next, waiting while the ring is full
+ *
+ * \return Returns the slot to fill, or NULL if the ring was cancelled
+ */
+FrameRing::Frame* FrameRing::beginWrite()
+{
+    int writeIndex = _writeIndex.fetchAndAddOrdered(0);
+
+    //the ring is full while the consumer still holds the slot after ours
+    while(nextIndex(writeIndex) == _readIndex.fetchAndAddOrdered(0))
+    {
+        if(isCancelled())
+        {
+            return NULL;
+        }
+
+        waitForChange(nextIndex(writeIndex), _readIndex);
+    }
+
+    if(isCancelled())
+    {
+        return NULL;
+    }
+
+    return &_frames[writeIndex];
+}
+
+/*!
+ * Hands the slot returned by beginWrite() to the consumer
+ */
+void FrameRing::finishWrite()
+{
+    _writeIndex.fetchAndStoreOrdered(nextIndex(_writeIndex.fetchAndAddOrdered(0)));
+    wakeWaitingThreads();
+}
+
+/*!
+ * Gets the oldest frame in the ring, waiting while the ring is empty
+ *
+ * \return Returns the slot to read, or NULL if the ring was cancelled, or closed with every frame read
+ */
+FrameRing::Frame* FrameRing::beginRead()
+{
+    int readIndex = _readIndex.fetchAndAddOrdered(0);
+
+    while(readIndex == _writeIndex.fetchAndAddOrdered(0))
+    {
+        if(isCancelled())
+        {
+            return NULL;
+        }
+
+        //the producer closes the ring after its last write, so look at the ring once more after seeing it closed
+        if(_isClosed.fetchAndAddOrdered(0) != 0)
+        {
+            if(readIndex == _writeIndex.fetchAndAddOrdered(0))
+            {
+                return NULL;
+            }
+            break;
+        }
+
+        waitForChange(readIndex, _writeIndex);
+    }
+
+    if(isCancelled())
+    {
+        return NULL;
+    }
+
+    return &_frames[readIndex];
+}
+
+/*!
+ * Gives the slot returned by beginRead() back to the producer
+ */
+void FrameRing::finishRead()
+{
+    _readIndex.fetchAndStoreOrdered(nextIndex(_readIndex.fetchAndAddOrdered(0)));
+    wakeWaitingThreads();
+}
+
+/*!
+ * Called by the producer after its last frame. The consumer still reads every frame already in the ring
+ */
+void FrameRing::close()
+{
+    _isClosed.fetchAndStoreOrdered(1);
+    wakeWaitingThreads();
+}
+
+/*!
+ * Stops both sides of the ring. Waiting calls return NULL, and frames still in the ring are dropped
+ */
+void FrameRing::cancel()
+{
+    _isCancelled.fetchAndStoreOrdered(1);
+    wakeWaitingThreads();
+}
+
+/*!
+ * Checks if the ring was cancelled
+ *
+ * \return Returns true if cancel() was called
+ */
+bool FrameRing::isCancelled()
+{
+    return _isCancelled.fetchAndAddOrdered(0) != 0;
+}
+
+/*!
+ * Gets the slot after a slot, wrapping at the end of the ring
+ */
+int FrameRing::nextIndex(int index)
+{
+    index++;
+
+    if(index == (int)_frames.size())
+    {
+        index = 0;
+    }
+
+    return index;
+}
+
+/*!
+ * Sleeps until the other side moves its index away from the given value, or the ring is closed or cancelled.
+ * The waiting count is raised before the index is checked again, and the other side publishes its index before reading
+ * the count, so one of the two always sees the other and a wake up can not be missed
+ *
+ * \param index: The value the other side's index has while this side has to wait
+ * \param changingIndex: The other side's index
+ */
+void FrameRing::waitForChange(int index, QAtomicInt &changingIndex)
+{
+    _waitingThreads.fetchAndAddOrdered(1);
+
+    {
+        QMutexLocker locker(&_waitMutex);
+
+        if(changingIndex.fetchAndAddOrdered(0) == index && _isClosed.fetchAndAddOrdered(0) == 0 && isCancelled() == false)
+        {
+            _ringChanged.wait(&_waitMutex, MAX_WAIT_MILLISECONDS);
+        }
+    }
+
+    _waitingThreads.fetchAndAddOrdered(-1);
+}
+
+/*!
+ * Wakes the other side if it is sleeping in waitForChange()
+ */
+void FrameRing::wakeWaitingThreads()
+{
+    if(_waitingThreads.fetchAndAddOrdered(0) != 0)
+    {
+        QMutexLocker locker(&_waitMutex);
+        _ringChanged.wakeAll();
+    }
+}
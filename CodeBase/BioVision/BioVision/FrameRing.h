@@ -0,0 +1,73 @@
+/*!
+ * \class FrameRing
+ *
+ * A bounded queue of pooled video frames, used to pass frames from one analysis pipeline stage to the next.
+ *
+ * The ring has exactly one producer thread and one consumer thread.  Each side owns one index and only publishes it
+ * with an atomic store, so passing a frame never takes a lock.  The frames are allocated by openCV the first time a slot
+ * is filled and then reused for the rest of the analysis.
+ *
+ * Backpressure: a producer that finds the ring full, or a consumer that finds it empty, sleeps on a wait condition until
+ * the other side moves.  The mutex is only touched by a side that has to sleep, or to wake a side that is sleeping.
+ *
+ * The producer calls close() after its last frame, and the consumer drains the ring and then sees no more frames.
+ * Either side may call cancel(), after which both sides stop right away.
+ */
+
+#ifndef FRAMERING_H
+#define FRAMERING_H
+
+#include "opencv2/core/core.hpp"
+#include <QAtomicInt>
+#include <QMutex>
+#include <QWaitCondition>
+#include <vector>
+
+class FrameRing
+{
+
+public:
+    //one pooled frame and the data that travels with it between stages
+    struct Frame
+    {
+        cv::Mat image;
+        cv::Mat lumaImage;
+        int frameNumber;
+        double videoFramePosition;
+        bool isEditFrame;
+    };
+
+    FrameRing(int capacity);
+    ~FrameRing();
+
+    Frame* beginWrite();
+    void finishWrite();
+
+    Frame* beginRead();
+    void finishRead();
+
+    void close();
+    void cancel();
+    bool isCancelled();
+
+private:
+    //one slot more than the capacity, so a full ring can be told apart from an empty one
+    std::vector<Frame> _frames;
+
+    //next slot the producer writes, and next slot the consumer reads
+    QAtomicInt _writeIndex;
+    QAtomicInt _readIndex;
+
+    QAtomicInt _isClosed;
+    QAtomicInt _isCancelled;
+
+    //only used by a side that has to wait, and by the other side to wake it
+    QAtomicInt _waitingThreads;
+    QMutex _waitMutex;
+    QWaitCondition _ringChanged;
+
+    int nextIndex(int index);
+    void waitForChange(int index, QAtomicInt &changingIndex);
+    void wakeWaitingThreads();
+};
+#endif
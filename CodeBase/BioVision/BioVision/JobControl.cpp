@@ -0,0 +1,150 @@
+#include "JobControl.h"
+
+/*!
+ * Constructor, the job is not cancelled and every counter is 0
+ */
+JobControl::JobControl()
+{
+    _isCancelled = 0;
+    _isPaused = 0;
+    _progress = 0;
+    _framesDone = 0;
+    _kilobytesWritten = 0;
+    _eventsFound = 0;
+}
+
+/*!
+ * Destructor
+ */
+JobControl::~JobControl()
+{
+
+}
+
+/*!
+ * Asks the job to stop. The worker sees it the next time it checks isCancelled()
+ */
+void JobControl::cancel()
+{
+    _isCancelled.fetchAndStoreOrdered(1);
+}
+
+/*!
+ * Checks if the job was asked to stop, by the user or by the worker itself after an error
+ *
+ * \return Returns true if the job was cancelled
+ */
+bool JobControl::isCancelled()
+{
+    return _isCancelled.fetchAndAddOrdered(0) != 0;
+}
+
+/*!
+ * Pauses or resumes the job. The worker sees it the next time it checks isPaused()
+ *
+ * \param isPaused: True to pause the job, false to resume it
+ */
+void JobControl::setPaused(bool isPaused)
+{
+    _isPaused.fetchAndStoreOrdered(isPaused ? 1 : 0);
+}
+
+/*!
+ * Checks if the user has paused the job
+ *
+ * \return Returns true if the job is paused
+ */
+bool JobControl::isPaused()
+{
+    return _isPaused.fetchAndAddOrdered(0) != 0;
+}
+
+/*!
+ * Set function for the progress of the job
+ *
+ * \param percentComplete: The progress in percent
+ */
+void JobControl::setProgress(int percentComplete)
+{
+    _progress.fetchAndStoreOrdered(percentComplete);
+}
+
+/*!
+ * Get function for the progress of the job
+ *
+ * \return Returns the progress in percent
+ */
+int JobControl::getProgress()
+{
+    return _progress.fetchAndAddOrdered(0);
+}
+
+/*!
+ * Set function for the number of frames the job has analyzed
+ *
+ * \param framesDone: The number of frames analyzed so far
+ */
+void JobControl::setFramesDone(int framesDone)
+{
+    _framesDone.fetchAndStoreOrdered(framesDone);
+}
+
+/*!
+ * Get function for the number of frames the job has analyzed
+ *
+ * \return Returns the number of frames analyzed so far
+ */
+int JobControl::getFramesDone()
+{
+    return _framesDone.fetchAndAddOrdered(0);
+}
+
+/*!
+ * Set function for the amount of data the job has written
+ *
+ * \param kilobytesWritten: The kilobytes written so far
+ */
+void JobControl::setKilobytesWritten(int kilobytesWritten)
+{
+    _kilobytesWritten.fetchAndStoreOrdered(kilobytesWritten);
+}
+
+/*!
+ * Get function for the amount of data the job has written
+ *
+ * \return Returns the kilobytes written so far
+ */
+int JobControl::getKilobytesWritten()
+{
+    return _kilobytesWritten.fetchAndAddOrdered(0);
+}
+
+/*!
+ * Set function for the number of events the job has found
+ *
+ * \param eventsFound: The number of frames where a region passed its threshold so far
+ */
+void JobControl::setEventsFound(int eventsFound)
+{
+    _eventsFound.fetchAndStoreOrdered(eventsFound);
+}
+
+/*!
+ * Get function for the number of events the job has found
+ *
+ * \return Returns the number of frames where a region passed its threshold so far
+ */
+int JobControl::getEventsFound()
+{
+    return _eventsFound.fetchAndAddOrdered(0);
+}
+
+/*!
+ * Get function for the stage profiler of the job
+ *
+ * \return Returns the profiler the job's worker times its stages with
+ */
+StageProfiler* JobControl::getStageProfiler()
+{
+    return &_stageProfiler;
+}
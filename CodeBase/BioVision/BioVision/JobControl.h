@@ -0,0 +1,67 @@
+/*!
+ * \class JobControl
+ *
+ * The cancellation and pause tokens and the progress counters of one background job.  The job's worker writes the counters and checks
+ * the tokens from its own threads, the GUI thread cancels or pauses the job and polls the counters at a fixed rate, so every field
+ * is an atomic and no call ever takes a lock.  The stage profiler, which holds the time spent in each stage of the job,
+ * is the exception: it is only locked once per stage per frame, and read by the GUI at the same rate as the counters.
+ *
+ * Each job gets its own JobControl, owned by its JobStatus, so it outlives the worker and cancelling one job never
+ * touches another.
+ */
+
+#ifndef JOBCONTROL_H
+#define JOBCONTROL_H
+
+#include "StageProfiler.h"
+#include <QAtomicInt>
+
+class JobControl
+{
+
+public:
+    JobControl();
+    ~JobControl();
+
+    void cancel();
+    bool isCancelled();
+
+    void setPaused(bool isPaused);
+    bool isPaused();
+
+    void setProgress(int percentComplete);
+    int getProgress();
+
+    void setFramesDone(int framesDone);
+    int getFramesDone();
+
+    void setKilobytesWritten(int kilobytesWritten);
+    int getKilobytesWritten();
+
+    void setEventsFound(int eventsFound);
+    int getEventsFound();
+
+    StageProfiler* getStageProfiler();
+
+private:
+    QAtomicInt _isCancelled;
+
+    /*! Set while the user has the job paused, a job that cannot pause ignores it. */
+    QAtomicInt _isPaused;
+
+    /*! Progress of the job in percent. */
+    QAtomicInt _progress;
+
+    /*! Frames analyzed so far. */
+    QAtomicInt _framesDone;
+
+    /*! Kilobytes of images or video written so far, kilobytes keep the count inside an int. */
+    QAtomicInt _kilobytesWritten;
+
+    /*! Frames where a region passed its threshold so far. */
+    QAtomicInt _eventsFound;
+
+    /*! Time spent in each stage of the job so far. */
+    StageProfiler _stageProfiler;
+};
+#endif
@@ -0,0 +1,126 @@
+#include "JobStatus.h"
+
+/*!
+ * \brief JobStatus::JobStatus creates the status of a newly queued job.
+ *
+ * \param jobId The id the ThreadManager gave the job.
+ * \param message The job's busy message.
+ * \param priority The job's priority, higher priorities start first.
+ * \param exclusiveResource What the job writes that no other job may use at the same time, empty for nothing.
+ */
+JobStatus::JobStatus(int jobId, QString message, int priority, QString exclusiveResource)
+{
+    _jobId = jobId;
+    _message = message;
+    _priority = priority;
+    _exclusiveResource = exclusiveResource;
+    _state = QUEUED;
+}
+
+/*!
+ * \brief JobStatus::~JobStatus default destructor.
+ */
+JobStatus::~JobStatus()
+{
+
+}
+
+/*!
+ * \brief JobStatus::getJobId gets the id of the job.
+ *
+ * \return the id the ThreadManager gave the job when it was queued.
+ */
+int JobStatus::getJobId()
+{
+    return _jobId;
+}
+
+/*!
+ * \brief JobStatus::getMessage gets the busy message of the job.
+ *
+ * \return the message the job's worker set.
+ */
+QString JobStatus::getMessage()
+{
+    return _message;
+}
+
+/*!
+ * \brief JobStatus::getPriority gets the priority of the job.
+ *
+ * \return the priority, \see ThreadManager::jobPriority.
+ */
+int JobStatus::getPriority()
+{
+    return _priority;
+}
+
+/*!
+ * \brief JobStatus::isExclusive checks if the job holds a resource other jobs must wait for.
+ *
+ * \return true for analyses and preview analyses, false otherwise.
+ */
+bool JobStatus::isExclusive()
+{
+    return _exclusiveResource.isEmpty() == false;
+}
+
+/*!
+ * \brief JobStatus::getExclusiveResource gets what the job writes that no other job may use at the same time.
+ *
+ * \return the resource, such as an analysis output directory, empty for nothing.
+ */
+QString JobStatus::getExclusiveResource()
+{
+    return _exclusiveResource;
+}
+
+/*!
+ * \brief JobStatus::getState gets whether the job is queued, running, or finished.
+ *
+ * \return the state of the job.
+ */
+JobStatus::jobState JobStatus::getState()
+{
+    return _state;
+}
+
+/*!
+ * \brief JobStatus::setState sets the state of the job, called by the ThreadManager as it starts and finishes the job.
+ *
+ * \param state the new state of the job.
+ */
+void JobStatus::setState(jobState state)
+{
+    _state = state;
+}
+
+/*!
+ * \brief JobStatus::getJobControl gets the cancellation token and progress counters of the job.
+ *
+ * \return the job's JobControl, it lives as long as this status.
+ */
+JobControl* JobStatus::getJobControl()
+{
+    return &_jobControl;
+}
+
+/*!
+ * \brief JobStatus::resultSlot is connected to the result signal of the job's worker.  Passes the result on tagged with
+ * the job id.
+ *
+ * \param result the result the worker sent.
+ */
+void JobStatus::resultSlot(Result* result)
+{
+    emit resultSignal(_jobId, result);
+}
+
+/*!
+ * \brief JobStatus::finishedSlot is connected to the finished signal of the job's worker.  Passes it on tagged with the
+ * job id.
+ */
+void JobStatus::finishedSlot()
+{
+    emit finishedSignal(_jobId);
+}
@@ -0,0 +1,67 @@
+/*!
+ * \class JobStatus
+ *
+ * The status of one job queued on the ThreadManager: its id, busy message, priority, whether it is queued, running or
+ * finished, and its JobControl, which holds the job's cancellation token and the progress counters the GUI polls.
+ *
+ * A JobStatus lives on the main thread for the whole life of its job.  The job's worker signals are connected to its
+ * slots, so every signal is tagged with the job it came from before it reaches the ThreadManager, no matter how many
+ * jobs are running.  Progress is not signalled, the ThreadManager reads it from the JobControl.
+ */
+
+#ifndef JOBSTATUS_H
+#define JOBSTATUS_H
+
+#include <QObject>
+#include <QString>
+#include "Result.h"
+#include "JobControl.h"
+
+class JobStatus : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum jobState {QUEUED, RUNNING, FINISHED};
+
+    JobStatus(int jobId, QString message, int priority, QString exclusiveResource);
+    virtual ~JobStatus();
+
+    int getJobId();
+    QString getMessage();
+    int getPriority();
+    bool isExclusive();
+    QString getExclusiveResource();
+
+    jobState getState();
+    void setState(jobState state);
+
+    JobControl* getJobControl();
+
+public Q_SLOTS:
+    void resultSlot(Result* result);
+    void finishedSlot();
+
+Q_SIGNALS:
+    void resultSignal(int jobId, Result* result);
+    void finishedSignal(int jobId);
+
+private:
+    /*! The id the ThreadManager gave the job when it was queued. */
+    int _jobId;
+
+    /*! The job's busy message, \see BvThreadWorker::getMessage(). */
+    QString _message;
+
+    /*! Jobs with a higher priority start first. */
+    int _priority;
+
+    /*! Jobs with the same resource never run at the same time, \see BvThreadWorker::getExclusiveResource(). */
+    QString _exclusiveResource;
+
+    jobState _state;
+
+    /*! Cancellation token and progress counters, shared with the job's worker. */
+    JobControl _jobControl;
+};
+#endif
@@ -0,0 +1,286 @@
+#include "JpegWriterPool.h"
+#include <QThread>
+#include <QMutexLocker>
+#include <QStringList>
+#include <QFileInfo>
+#include <algorithm>
+
+/*!
+ * \class JpegWriter
+ *
+ * One writer thread of a JpegWriterPool. Saves queued frames until the pool is finished or cancelled
+ */
+class JpegWriter : public QThread
+{
+
+public:
+    JpegWriter(JpegWriterPool* owner)
+    {
+        _owner = owner;
+    }
+
+protected:
+    void run()
+    {
+        _owner->writeImages();
+    }
+
+private:
+    JpegWriterPool* _owner;
+};
+
+/*!
+ * Constructor, starts the writer threads
+ *
+ * \param writerCount: The number of writer threads, at least one is started
+ * \param memoryBudgetInMegabytes: The most memory the pool's image buffers may use, in megabytes
+ */
+JpegWriterPool::JpegWriterPool(int writerCount, int memoryBudgetInMegabytes)
+{
+    _memoryInUse = 0;
+    _memoryBudget = (size_t)std::max(memoryBudgetInMegabytes, 0) * 1024 * 1024;
+
+    _isFinishing = false;
+    _isCancelled = false;
+    _isErrorThrown = false;
+    _bytesWritten = 0;
+
+    for(int i = 0; i < std::max(writerCount, 1); i++)
+    {
+        _writers.push_back(new JpegWriter(this));
+        _writers[i]->start();
+    }
+}
+
+/*!
+ * Destructor, drops any images not saved yet and stops the writer threads
+ */
+JpegWriterPool::~JpegWriterPool()
+{
+    cancel();
+
+    for(unsigned int i = 0; i < _writers.size(); i++)
+    {
+        delete _writers[i];
+    }
+}
+
+/*!
+ * Copies a frame into a pooled buffer and queues it to be saved. Waits while every buffer the memory budget allows is in
+ * use. Can be called from several threads at once
+ *
+ * \param cvObject: The openCV object whose output options and file names the image is saved with, must stay alive until
+ *                  the pool has finished
+ * \param image: The frame to save
+ * \param frameNumber: The frame number of the frame, added to the file name
+ *
+ * \return Returns false if the pool was cancelled or failed to save an image, the frame is not saved
+ */
+bool JpegWriterPool::write(OpenCV* cvObject, const cv::Mat &image, int frameNumber)
+{
+    size_t imageBytes = image.total() * image.elemSize();
+    cv::Mat buffer;
+
+    {
+        QMutexLocker locker(&_queueMutex);
+
+        //reuse a buffer whose image is saved, or add one while the budget allows it, otherwise wait for a writer
+        while(true)
+        {
+            if(_isCancelled == true)
+            {
+                return false;
+            }
+
+            if(_freeImages.size() != 0)
+            {
+                buffer = _freeImages.back();
+                _freeImages.pop_back();
+                break;
+            }
+
+            if(_memoryInUse == 0 || _memoryInUse + imageBytes <= _memoryBudget)
+            {
+                _memoryInUse += imageBytes;
+                break;
+            }
+
+            _imageSaved.wait(&_queueMutex);
+        }
+    }
+
+    //copy outside the lock so writers are not held up
+    image.copyTo(buffer);
+
+    QMutexLocker locker(&_queueMutex);
+
+    if(_isCancelled == true)
+    {
+        return false;
+    }
+
+    queuedImage nextImage;
+    nextImage.image = buffer;
+    nextImage.frameNumber = frameNumber;
+    nextImage.cvObject = cvObject;
+    _queuedImages.push_back(nextImage);
+    _unsavedImages[cvObject]++;
+
+    _imageQueued.wakeOne();
+
+    return true;
+}
+
+/*!
+ * Saves every image still queued, then stops the writer threads. Called once no more frames will be written
+ */
+void JpegWriterPool::finish()
+{
+    {
+        QMutexLocker locker(&_queueMutex);
+        _isFinishing = true;
+        _imageQueued.wakeAll();
+    }
+
+    stopWriters();
+}
+
+/*!
+ * Drops every image not saved yet and stops the writer threads. Waiting calls to write() return false
+ */
+void JpegWriterPool::cancel()
+{
+    {
+        QMutexLocker locker(&_queueMutex);
+        _isCancelled = true;
+        _queuedImages.clear();
+        _imageQueued.wakeAll();
+        _imageSaved.wakeAll();
+    }
+
+    stopWriters();
+}
+
+/*!
+ * Waits until every image an openCV object has written so far is on disk. Other openCV objects can keep writing
+ * meanwhile
+ *
+ * \param cvObject: The openCV object whose images to wait for
+ *
+ * \return Returns false if the pool was cancelled or failed to save an image, the images may not all be saved
+ */
+bool JpegWriterPool::waitForImages(OpenCV* cvObject)
+{
+    QMutexLocker locker(&_queueMutex);
+
+    while(_isCancelled == false && _unsavedImages[cvObject] > 0)
+    {
+        _imageSaved.wait(&_queueMutex);
+    }
+
+    return _isCancelled == false;
+}
+
+/*!
+ * Checks if an image failed to save
+ *
+ * \return Returns true if openCV threw an error while writing an image, or an image could not be written
+ */
+bool JpegWriterPool::isErrorThrown()
+{
+    QMutexLocker locker(&_queueMutex);
+    return _isErrorThrown;
+}
+
+/*!
+ * Gets the size of the images saved so far, can be called while the writers are running
+ *
+ * \return Returns the size of every saved image in kilobytes
+ */
+int JpegWriterPool::getKilobytesWritten()
+{
+    QMutexLocker locker(&_queueMutex);
+    return (int)(_bytesWritten / 1024);
+}
+
+/*!
+ * Writer loop, run on each writer thread. Saves the oldest queued image until the pool is finished and the queue is
+ * empty, or the pool is cancelled
+ */
+void JpegWriterPool::writeImages()
+{
+    while(true)
+    {
+        queuedImage nextImage;
+
+        {
+            QMutexLocker locker(&_queueMutex);
+
+            while(_queuedImages.size() == 0 && _isFinishing == false && _isCancelled == false)
+            {
+                _imageQueued.wait(&_queueMutex);
+            }
+
+            if(_isCancelled == true || _queuedImages.size() == 0)
+            {
+                return;
+            }
+
+            nextImage = _queuedImages.front();
+            _queuedImages.pop_front();
+        }
+
+        QString savedImagePath;
+
+        try
+        {
+            BV_TIME_STAGE(nextImage.cvObject->getStageProfiler(), StageProfiler::IMAGE_WRITE);
+
+            savedImagePath = nextImage.cvObject->saveFrameAsJPG(nextImage.image, nextImage.frameNumber, nextImage.cvObject->getOutputFilePath());
+        }
+        catch(cv::Exception& e)//an empty path below stops the pool
+        {
+            savedImagePath.clear();
+        }
+
+        //the image is not on disk, stop the pool without counting it as saved, the analyzer reports the error
+        if(savedImagePath.isEmpty() == true)
+        {
+            QMutexLocker locker(&_queueMutex);
+            _isErrorThrown = true;
+            _isCancelled = true;
+            _queuedImages.clear();
+            _imageQueued.wakeAll();
+            _imageSaved.wakeAll();
+            return;
+        }
+
+        qint64 imageFileSize = QFileInfo(QString::fromStdString(nextImage.cvObject->getOutputFilePath()) + savedImagePath).size();
+
+        //the buffer can take the next frame
+        {
+            QMutexLocker locker(&_queueMutex);
+            _bytesWritten += imageFileSize;
+            _freeImages.push_back(nextImage.image);
+            _unsavedImages[nextImage.cvObject]--;
+
+            //wakes writes waiting for a buffer, and chunks waiting for their images
+            _imageSaved.wakeAll();
+        }
+
+        //pass the saved file path back through the system for the carousel, only once the image is on disk
+        QStringList parseString = savedImagePath.split("-");
+        emit imageSavedSignal(savedImagePath, parseString.at(1));
+    }
+}
+
+/*!
+ * Waits for every writer thread to return
+ */
+void JpegWriterPool::stopWriters()
+{
+    for(unsigned int i = 0; i < _writers.size(); i++)
+    {
+        _writers[i]->wait();
+    }
+}
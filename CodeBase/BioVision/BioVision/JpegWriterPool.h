@@ -0,0 +1,91 @@
+/*!
+ * \class JpegWriterPool
+ *
+ * The last stage of the analysis pipeline.  A pool of writer threads that save flagged frames as .JPGs, so JPEG encoding
+ * and disk writes run on several cores and overlap with the analysis of the following frames.  One pool is shared by
+ * every chunk of an analysis.
+ *
+ * Frames are copied into pooled image buffers and queued in the order they are written.  The buffers held by the pool,
+ * queued, being saved or waiting for reuse, never add up to more than the memory budget (a pool always has at least one
+ * buffer).  When every buffer is in use, write() waits for a writer to finish an image, which slows the analysis down
+ * instead of letting the queue grow.
+ *
+ * waitForImages() lets one chunk wait until its own images are on disk, while the other chunks keep writing, so a
+ * checkpoint never covers frames whose images were lost.
+ *
+ * imageSavedSignal is emitted from the writer thread once an image is on disk, so the carousel can load it.
+ */
+
+#ifndef JPEGWRITERPOOL_H
+#define JPEGWRITERPOOL_H
+
+#include "OpenCV.h"
+#include <QObject>
+#include <QString>
+#include <QMutex>
+#include <QWaitCondition>
+#include <deque>
+#include <vector>
+#include <map>
+
+class JpegWriter;
+
+class JpegWriterPool : public QObject
+{
+    Q_OBJECT
+
+    friend class JpegWriter;
+
+public:
+    JpegWriterPool(int writerCount, int memoryBudgetInMegabytes);
+    ~JpegWriterPool();
+
+    bool write(OpenCV* cvObject, const cv::Mat &image, int frameNumber);
+    void finish();
+    void cancel();
+    bool waitForImages(OpenCV* cvObject);
+    bool isErrorThrown();
+    int getKilobytesWritten();
+
+Q_SIGNALS:
+    void imageSavedSignal(QString imageName, QString index);
+
+private:
+    //one frame waiting to be saved, and the openCV object whose output options and file names it is saved with
+    struct queuedImage
+    {
+        cv::Mat image;
+        int frameNumber;
+        OpenCV* cvObject;
+    };
+
+    std::vector<JpegWriter*> _writers;
+
+    /*! Frames waiting for a writer, oldest first. */
+    std::deque<queuedImage> _queuedImages;
+
+    /*! Buffers whose image has been saved, reused for the next frames. */
+    std::vector<cv::Mat> _freeImages;
+
+    /*! Images queued or being saved, per openCV object. */
+    std::map<OpenCV*, int> _unsavedImages;
+
+    /*! Bytes of every buffer the pool holds, and the most it may hold. */
+    size_t _memoryInUse;
+    size_t _memoryBudget;
+
+    bool _isFinishing;
+    bool _isCancelled;
+    bool _isErrorThrown;
+
+    /*! Size of every image saved so far. */
+    qint64 _bytesWritten;
+
+    QMutex _queueMutex;
+    QWaitCondition _imageQueued;
+    QWaitCondition _imageSaved;
+
+    void writeImages();
+    void stopWriters();
+};
+#endif
@@ -90,6 +90,8 @@ MainWindow::MainWindow(QWidget *parent, WindowManager *windowManager) :
     connect(ui->Analyze, SIGNAL(clicked()), this, SLOT(analyzeSlot()));
     // Cancel- cancels an operation.
     connect(ui->cancel, SIGNAL(clicked()), this, SLOT(cancelSlot()));
+    // Pause- pauses or resumes an analysis.
+    connect(ui->pause, SIGNAL(toggled(bool)), this, SLOT(pauseSlot(bool)));
 
     //Project Browser- pressed, double clicked, and right clicked
     connect(ui->projectBrowser, SIGNAL(itemPressed(QTreeWidgetItem*,int)), this, SLOT(projectBrowserPressedSlot(QTreeWidgetItem*,int)));
@@ -661,6 +663,22 @@ void MainWindow::cancelSlot()
     _windowManager->cancelTask();
 }
 
+/*!
+ * \brief MainWindow::pauseSlot pauses or resumes the current background task when the pause button is toggled.  Only
+ * analyses can be paused, the button springs back for other tasks or when no task is running.
+ *
+ * \param isPaused true when the button was pressed in, false when it was released.
+ */
+void MainWindow::pauseSlot(bool isPaused)
+{
+    if(_windowManager->pauseTask(isPaused) == false && isPaused == true)
+    {
+        ui->pause->blockSignals(true);
+        ui->pause->setChecked(false);
+        ui->pause->blockSignals(false);
+    }
+}
+
 /*!
  * \brief MainWindow::setProgress Called from window manager to set the progress of a given task.  Could be a video copy,
  * analyze, etc.
@@ -672,6 +690,30 @@ void MainWindow::setProgress(int progress)
     ui->progressBar->setValue(progress);
 }
 
+/*!
+ * \brief MainWindow::setStatus Called from window manager to show the live status of the current task in the status
+ * bar, its analysis rate, time left and the share of its time spent in each stage.
+ *
+ * \param statusText the status to show, an empty string clears the status bar
+ * \param isPaused true while the task is paused, the pause button follows it
+ */
+void MainWindow::setStatus(QString statusText, bool isPaused)
+{
+    // the task may have ended or been cancelled while paused
+    ui->pause->blockSignals(true);
+    ui->pause->setChecked(isPaused);
+    ui->pause->blockSignals(false);
+
+    if(statusText.isEmpty() == true)
+    {
+        ui->statusBar->clearMessage();
+    }
+    else
+    {
+        ui->statusBar->showMessage(statusText);
+    }
+}
+
 /*!
  * \brief MainWindow::thresholdChangedSlot when the slider is changes values, call this function to
  * update the value in the threshold value text box.
@@ -1376,11 +1418,13 @@ void MainWindow::moveAndResizePlayerElements()
 void MainWindow::moveAndResizeStatusElements()
 {
     #if defined WIN32
-        ui->progressBar->setGeometry(0,0, ui->StatusFrame->width() - 100, ui->StatusFrame->height() - 3);
-        ui->cancel->setGeometry(ui->progressBar->x() + ui->progressBar->width() + 10, 0, 80, ui->StatusFrame->height() -  2);
+        ui->progressBar->setGeometry(0,0, ui->StatusFrame->width() - 190, ui->StatusFrame->height() - 3);
+        ui->pause->setGeometry(ui->progressBar->x() + ui->progressBar->width() + 10, 0, 80, ui->StatusFrame->height() -  2);
+        ui->cancel->setGeometry(ui->pause->x() + ui->pause->width() + 10, 0, 80, ui->StatusFrame->height() -  2);
     #else
-        ui->progressBar->setGeometry(10, 6, ui->StatusFrame->width() - 100, ui->StatusFrame->height());
-        ui->cancel->setGeometry(ui->progressBar->x() + ui->progressBar->width() + 10, 0, 80, 30);
+        ui->progressBar->setGeometry(10, 6, ui->StatusFrame->width() - 190, ui->StatusFrame->height());
+        ui->pause->setGeometry(ui->progressBar->x() + ui->progressBar->width() + 10, 0, 80, 30);
+        ui->cancel->setGeometry(ui->pause->x() + ui->pause->width() + 10, 0, 80, 30);
     #endif
 }
 
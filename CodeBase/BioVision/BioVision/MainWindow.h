@@ -43,6 +43,7 @@ public:
 
     // Progress
     void setProgress(int progress);
+    void setStatus(QString statusText, bool isPaused);
 
     // Projects tree view
     void refreshProjectBrowser();
@@ -99,6 +100,7 @@ public slots:
     // Analyze
     void analyzeSlot();
     void cancelSlot();
+    void pauseSlot(bool isPaused);
 
     // Video start and end times, edit points slot
     void addEditPointSlot();
@@ -0,0 +1,459 @@
+#include "MotionKernel.h"
+#include "opencv2/core/core.hpp"
+#include <algorithm>
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BV_MOTION_KERNEL_SSE2 1
+#endif
+
+//brightness the first channel must rise above the running average to be flagged as motion, the other
+//channels are compared to the running average without an offset
+static const int MOTION_DIFFERENCE_OFFSET = 100;
+
+//number of fraction bits of the fixed point running average
+static const int FIXED_POINT_FRACTION_BITS = 8;
+
+/*!
+ * Updates one float average with a frame value
+ *
+ * \return Returns the new average rounded and saturated to 8 bits, the same way as cvConvertScale
+ */
+static inline int updateFloatAverage(unsigned char frameValue, float &average, float alpha, float beta)
+{
+    average = frameValue * alpha + average * beta;
+
+    return cv::saturate_cast<unsigned char>(average);
+}
+
+/*!
+ * Updates one fixed point average with a frame value, both products are truncated
+ *
+ * \return Returns the new average rounded to 8 bits
+ */
+static inline int updateFixedPointAverage(unsigned char frameValue, unsigned short &average, unsigned int frameWeight, unsigned int averageWeight)
+{
+    unsigned int frameFixedPoint = (unsigned int)frameValue << FIXED_POINT_FRACTION_BITS;
+    unsigned int newAverage = ((frameFixedPoint * frameWeight) >> 16) + ((average * averageWeight) >> 16);
+    average = (unsigned short)newAverage;
+
+    return (newAverage + (1 << (FIXED_POINT_FRACTION_BITS - 1))) >> FIXED_POINT_FRACTION_BITS;
+}
+
+#ifdef BV_MOTION_KERNEL_SSE2
+/*!
+ * Updates 16 float averages with 16 frame values
+ *
+ * \return Returns the new averages rounded to nearest and saturated to 8 bits, same as cvConvertScale to an 8 bit image
+ */
+static inline __m128i updateFloatAverages(__m128i pixels, float* averages, __m128 alphaVector, __m128 betaVector)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    __m128i pixelsLow = _mm_unpacklo_epi8(pixels, zero);
+    __m128i pixelsHigh = _mm_unpackhi_epi8(pixels, zero);
+
+    __m128 frame0 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(pixelsLow, zero));
+    __m128 frame1 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(pixelsLow, zero));
+    __m128 frame2 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(pixelsHigh, zero));
+    __m128 frame3 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(pixelsHigh, zero));
+
+    __m128 average0 = _mm_add_ps(_mm_mul_ps(frame0, alphaVector), _mm_mul_ps(_mm_loadu_ps(averages), betaVector));
+    __m128 average1 = _mm_add_ps(_mm_mul_ps(frame1, alphaVector), _mm_mul_ps(_mm_loadu_ps(averages + 4), betaVector));
+    __m128 average2 = _mm_add_ps(_mm_mul_ps(frame2, alphaVector), _mm_mul_ps(_mm_loadu_ps(averages + 8), betaVector));
+    __m128 average3 = _mm_add_ps(_mm_mul_ps(frame3, alphaVector), _mm_mul_ps(_mm_loadu_ps(averages + 12), betaVector));
+
+    _mm_storeu_ps(averages, average0);
+    _mm_storeu_ps(averages + 4, average1);
+    _mm_storeu_ps(averages + 8, average2);
+    _mm_storeu_ps(averages + 12, average3);
+
+    return _mm_packus_epi16(_mm_packs_epi32(_mm_cvtps_epi32(average0), _mm_cvtps_epi32(average1)),
+                            _mm_packs_epi32(_mm_cvtps_epi32(average2), _mm_cvtps_epi32(average3)));
+}
+
+/*!
+ * Updates 16 fixed point averages with 16 frame values, computing exactly what updateFixedPointAverage() does
+ *
+ * \return Returns the new averages rounded to 8 bits, the average never passes 255 so no saturation is needed
+ */
+static inline __m128i updateFixedPointAverages(__m128i pixels, unsigned short* averages, __m128i frameWeightVector, __m128i averageWeightVector)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i roundingVector = _mm_set1_epi16(1 << (FIXED_POINT_FRACTION_BITS - 1));
+
+    //frame values shifted into the fixed point format
+    __m128i frameLow = _mm_unpacklo_epi8(zero, pixels);
+    __m128i frameHigh = _mm_unpackhi_epi8(zero, pixels);
+
+    __m128i averageLow = _mm_loadu_si128((const __m128i*)averages);
+    __m128i averageHigh = _mm_loadu_si128((const __m128i*)(averages + 8));
+
+    averageLow = _mm_add_epi16(_mm_mulhi_epu16(frameLow, frameWeightVector), _mm_mulhi_epu16(averageLow, averageWeightVector));
+    averageHigh = _mm_add_epi16(_mm_mulhi_epu16(frameHigh, frameWeightVector), _mm_mulhi_epu16(averageHigh, averageWeightVector));
+
+    _mm_storeu_si128((__m128i*)averages, averageLow);
+    _mm_storeu_si128((__m128i*)(averages + 8), averageHigh);
+
+    return _mm_packus_epi16(_mm_srli_epi16(_mm_adds_epu16(averageLow, roundingVector), FIXED_POINT_FRACTION_BITS),
+                            _mm_srli_epi16(_mm_adds_epu16(averageHigh, roundingVector), FIXED_POINT_FRACTION_BITS));
+}
+
+/*!
+ * Compares 16 frame values to their upper bounds
+ *
+ * \return Returns 255 for each value above its bound and 0 elsewhere, an unsigned compare built from max and equality
+ */
+static inline __m128i isAboveBound(__m128i pixels, __m128i upperBound)
+{
+    __m128i notAbove = _mm_cmpeq_epi8(_mm_max_epu8(pixels, upperBound), upperBound);
+
+    return _mm_xor_si128(notAbove, _mm_set1_epi8((char)0xFF));
+}
+
+/*!
+ * Builds the per channel offsets added to the rounded average of 16 channel values. The offset pattern repeats every 3
+ * bytes, so each block of 16 starts one channel later than the last
+ *
+ * \param offsetVectors: Receives the offsets of the blocks starting on the first, second and third channel
+ */
+static void getOffsetVectors(__m128i offsetVectors[3])
+{
+    for(int phase = 0; phase < 3; phase++)
+    {
+        unsigned char offsets[16];
+        for(int k = 0; k < 16; k++)
+        {
+            offsets[k] = ((phase + k) % 3 == 0) ? MOTION_DIFFERENCE_OFFSET : 0;
+        }
+        offsetVectors[phase] = _mm_loadu_si128((const __m128i*)offsets);
+    }
+}
+#endif
+
+/*!
+ * Gets the motion flag of one channel value
+ *
+ * \param frameValue: The channel value of the current frame
+ * \param roundedAverage: The running average of the channel, rounded to 8 bits
+ * \param channel: The channel of the value, 0 to 2
+ *
+ * \return Returns 255 if the value is above the rounded average, plus the offset on the first channel, and 0 otherwise
+ */
+static inline unsigned char getChannelFlag(unsigned char frameValue, int roundedAverage, int channel)
+{
+    int upperBound = roundedAverage;
+
+    if(channel == 0)
+    {
+        upperBound += MOTION_DIFFERENCE_OFFSET;
+    }
+
+    if(upperBound > 255)
+    {
+        upperBound = 255;
+    }
+
+    return (frameValue > upperBound) ? 255 : 0;
+}
+
+/*!
+ * Combines the channel flags of a row into the motion mask, only the first two channels can mark a pixel as motion
+ */
+static inline void combineChannelFlags(const unsigned char* flagRow, unsigned char* maskRow, int width)
+{
+    for(int x = 0; x < width; x++)
+    {
+        maskRow[x] = flagRow[x * 3] | flagRow[x * 3 + 1];
+    }
+}
+
+/*!
+ * Resets the running average of one row to the current frame, used for the first frame and the first frame after an
+ * edit point.  No motion can be detected on a reset frame, so the mask row is cleared
+ *
+ * \param frameRow: One row of the current 3 channel, 8 bit frame
+ * \param averageRow: The matching row of the 3 channel, 32 bit float running average
+ * \param maskRow: The matching row of the single channel motion mask
+ * \param width: Number of pixels in the row
+ */
+void MotionKernel::resetRow(const unsigned char* frameRow, float* averageRow, unsigned char* maskRow, int width)
+{
+    const int length = width * 3;
+
+    for(int i = 0; i < length; i++)
+    {
+        averageRow[i] = frameRow[i];
+    }
+
+    for(int x = 0; x < width; x++)
+    {
+        maskRow[x] = 0;
+    }
+}
+
+/*!
+ * Updates the running average of one row with the current frame and writes the motion mask for that row
+ *
+ * The average is updated as average = frame * motionSensitivity + average * (1 - motionSensitivity), the same
+ * arithmetic as cvRunningAvg, and rounded the same way as cvConvertScale before it is compared to the frame
+ *
+ * \param frameRow: One row of the current 3 channel, 8 bit frame
+ * \param averageRow: The matching row of the 3 channel, 32 bit float running average, updated in place
+ * \param maskRow: The matching row of the single channel motion mask, 255 where motion was found and 0 elsewhere
+ * \param flagRow: Scratch buffer of at least width * 3 bytes that holds the per channel flags
+ * \param width: Number of pixels in the row
+ * \param motionSensitivity: Weight of the current frame in the running average
+ */
+void MotionKernel::updateRow(const unsigned char* frameRow, float* averageRow, unsigned char* maskRow, unsigned char* flagRow,
+                             int width, float motionSensitivity)
+{
+    const int length = width * 3;
+    const float alpha = motionSensitivity;
+    const float beta = 1.0f - motionSensitivity;
+
+    int i = 0;
+
+#ifdef BV_MOTION_KERNEL_SSE2
+    const __m128 alphaVector = _mm_set1_ps(alpha);
+    const __m128 betaVector = _mm_set1_ps(beta);
+
+    __m128i offsetVectors[3];
+    getOffsetVectors(offsetVectors);
+    int phase = 0;
+
+    //16 channel values per iteration
+    for(; i <= length - 16; i += 16)
+    {
+        __m128i pixels = _mm_loadu_si128((const __m128i*)(frameRow + i));
+        __m128i rounded = updateFloatAverages(pixels, averageRow + i, alphaVector, betaVector);
+
+        //frame > min(average + offset, 255)
+        _mm_storeu_si128((__m128i*)(flagRow + i), isAboveBound(pixels, _mm_adds_epu8(rounded, offsetVectors[phase])));
+
+        phase = (phase == 2) ? 0 : phase + 1;
+    }
+#endif
+
+    for(; i < length; i++)
+    {
+        flagRow[i] = getChannelFlag(frameRow[i], updateFloatAverage(frameRow[i], averageRow[i], alpha, beta), i % 3);
+    }
+
+    combineChannelFlags(flagRow, maskRow, width);
+}
+
+/*!
+ * Converts the weight of the current frame in the running average into the 16 bit weight used by the fixed point update
+ *
+ * \param motionSensitivity: Weight of the current frame in the running average
+ *
+ * \return Returns the frame weight times 2^16, kept between 1 and 2^16 - 1 so the average keeps a weight of its own
+ */
+unsigned short MotionKernel::getFixedPointFrameWeight(float motionSensitivity)
+{
+    int weight = (int)(motionSensitivity * 65536.0 + 0.5);
+
+    return (unsigned short)std::max(std::min(weight, 65535), 1);
+}
+
+/*!
+ * Resets the fixed point running average of one row to the current frame, used for the first frame and the first frame
+ * after an edit point.  No motion can be detected on a reset frame, so the mask row is cleared
+ *
+ * \param frameRow: One row of the current 3 channel, 8 bit frame
+ * \param averageRow: The matching row of the 3 channel, 16 bit fixed point running average
+ * \param maskRow: The matching row of the single channel motion mask
+ * \param width: Number of pixels in the row
+ */
+void MotionKernel::resetRow(const unsigned char* frameRow, unsigned short* averageRow, unsigned char* maskRow, int width)
+{
+    const int length = width * 3;
+
+    for(int i = 0; i < length; i++)
+    {
+        averageRow[i] = (unsigned short)(frameRow[i] << FIXED_POINT_FRACTION_BITS);
+    }
+
+    for(int x = 0; x < width; x++)
+    {
+        maskRow[x] = 0;
+    }
+}
+
+/*!
+ * Updates the fixed point running average of one row with the current frame and writes the motion mask for that row
+ *
+ * The average is updated as average = (frame * frameWeight) / 2^16 + (average * averageWeight) / 2^16 with both products
+ * truncated, where the two weights add up to 2^16, then rounded to 8 bits before it is compared to the frame.  The
+ * vector and scalar code compute exactly the same values
+ *
+ * \param frameRow: One row of the current 3 channel, 8 bit frame
+ * \param averageRow: The matching row of the 3 channel, 16 bit fixed point running average, updated in place
+ * \param maskRow: The matching row of the single channel motion mask, 255 where motion was found and 0 elsewhere
+ * \param flagRow: Scratch buffer of at least width * 3 bytes that holds the per channel flags
+ * \param width: Number of pixels in the row
+ * \param motionSensitivity: Weight of the current frame in the running average
+ */
+void MotionKernel::updateRow(const unsigned char* frameRow, unsigned short* averageRow, unsigned char* maskRow, unsigned char* flagRow,
+                             int width, float motionSensitivity)
+{
+    const int length = width * 3;
+    const unsigned int frameWeight = getFixedPointFrameWeight(motionSensitivity);
+    const unsigned int averageWeight = 65536 - frameWeight;
+
+    int i = 0;
+
+#ifdef BV_MOTION_KERNEL_SSE2
+    const __m128i frameWeightVector = _mm_set1_epi16((short)frameWeight);
+    const __m128i averageWeightVector = _mm_set1_epi16((short)averageWeight);
+
+    __m128i offsetVectors[3];
+    getOffsetVectors(offsetVectors);
+    int phase = 0;
+
+    //16 channel values per iteration
+    for(; i <= length - 16; i += 16)
+    {
+        __m128i pixels = _mm_loadu_si128((const __m128i*)(frameRow + i));
+        __m128i rounded = updateFixedPointAverages(pixels, averageRow + i, frameWeightVector, averageWeightVector);
+
+        //frame > min(average + offset, 255)
+        _mm_storeu_si128((__m128i*)(flagRow + i), isAboveBound(pixels, _mm_adds_epu8(rounded, offsetVectors[phase])));
+
+        phase = (phase == 2) ? 0 : phase + 1;
+    }
+#endif
+
+    for(; i < length; i++)
+    {
+        flagRow[i] = getChannelFlag(frameRow[i], updateFixedPointAverage(frameRow[i], averageRow[i], frameWeight, averageWeight), i % 3);
+    }
+
+    combineChannelFlags(flagRow, maskRow, width);
+}
+
+/*!
+ * Resets the single channel running average of one luma row to the current frame.  No motion can be detected on a
+ * reset frame, so the mask row is cleared
+ *
+ * \param lumaRow: One row of the current single channel, 8 bit luma frame
+ * \param averageRow: The matching row of the single channel, 32 bit float running average
+ * \param maskRow: The matching row of the single channel motion mask
+ * \param width: Number of pixels in the row
+ */
+void MotionKernel::resetLumaRow(const unsigned char* lumaRow, float* averageRow, unsigned char* maskRow, int width)
+{
+    for(int x = 0; x < width; x++)
+    {
+        averageRow[x] = lumaRow[x];
+        maskRow[x] = 0;
+    }
+}
+
+/*!
+ * Updates the single channel running average of one luma row and writes the motion mask for that row.  A pixel is
+ * flagged when its luma is brighter than the rounded running average, the rule that decides the color mask of a gray
+ * frame.  The average is updated with the same arithmetic as updateRow()
+ *
+ * \param lumaRow: One row of the current single channel, 8 bit luma frame
+ * \param averageRow: The matching row of the single channel, 32 bit float running average, updated in place
+ * \param maskRow: The matching row of the single channel motion mask, 255 where motion was found and 0 elsewhere
+ * \param width: Number of pixels in the row
+ * \param motionSensitivity: Weight of the current frame in the running average
+ */
+void MotionKernel::updateLumaRow(const unsigned char* lumaRow, float* averageRow, unsigned char* maskRow, int width, float motionSensitivity)
+{
+    const float alpha = motionSensitivity;
+    const float beta = 1.0f - motionSensitivity;
+
+    int x = 0;
+
+#ifdef BV_MOTION_KERNEL_SSE2
+    const __m128 alphaVector = _mm_set1_ps(alpha);
+    const __m128 betaVector = _mm_set1_ps(beta);
+
+    //16 pixels per iteration
+    for(; x <= width - 16; x += 16)
+    {
+        __m128i pixels = _mm_loadu_si128((const __m128i*)(lumaRow + x));
+        __m128i rounded = updateFloatAverages(pixels, averageRow + x, alphaVector, betaVector);
+
+        _mm_storeu_si128((__m128i*)(maskRow + x), isAboveBound(pixels, rounded));
+    }
+#endif
+
+    for(; x < width; x++)
+    {
+        maskRow[x] = (lumaRow[x] > updateFloatAverage(lumaRow[x], averageRow[x], alpha, beta)) ? 255 : 0;
+    }
+}
+
+/*!
+ * Resets the single channel fixed point running average of one luma row to the current frame.  No motion can be
+ * detected on a reset frame, so the mask row is cleared
+ *
+ * \param lumaRow: One row of the current single channel, 8 bit luma frame
+ * \param averageRow: The matching row of the single channel, 16 bit fixed point running average
+ * \param maskRow: The matching row of the single channel motion mask
+ * \param width: Number of pixels in the row
+ */
+void MotionKernel::resetLumaRow(const unsigned char* lumaRow, unsigned short* averageRow, unsigned char* maskRow, int width)
+{
+    for(int x = 0; x < width; x++)
+    {
+        averageRow[x] = (unsigned short)(lumaRow[x] << FIXED_POINT_FRACTION_BITS);
+        maskRow[x] = 0;
+    }
+}
+
+/*!
+ * Updates the single channel fixed point running average of one luma row and writes the motion mask for that row, with
+ * the arithmetic of the fixed point updateRow() and the rule of the float updateLumaRow()
+ *
+ * \param lumaRow: One row of the current single channel, 8 bit luma frame
+ * \param averageRow: The matching row of the single channel, 16 bit fixed point running average, updated in place
+ * \param maskRow: The matching row of the single channel motion mask, 255 where motion was found and 0 elsewhere
+ * \param width: Number of pixels in the row
+ * \param motionSensitivity: Weight of the current frame in the running average
+ */
+void MotionKernel::updateLumaRow(const unsigned char* lumaRow, unsigned short* averageRow, unsigned char* maskRow, int width, float motionSensitivity)
+{
+    const unsigned int frameWeight = getFixedPointFrameWeight(motionSensitivity);
+    const unsigned int averageWeight = 65536 - frameWeight;
+
+    int x = 0;
+
+#ifdef BV_MOTION_KERNEL_SSE2
+    const __m128i frameWeightVector = _mm_set1_epi16((short)frameWeight);
+    const __m128i averageWeightVector = _mm_set1_epi16((short)averageWeight);
+
+    //16 pixels per iteration
+    for(; x <= width - 16; x += 16)
+    {
+        __m128i pixels = _mm_loadu_si128((const __m128i*)(lumaRow + x));
+        __m128i rounded = updateFixedPointAverages(pixels, averageRow + x, frameWeightVector, averageWeightVector);
+
+        _mm_storeu_si128((__m128i*)(maskRow + x), isAboveBound(pixels, rounded));
+    }
+#endif
+
+    for(; x < width; x++)
+    {
+        maskRow[x] = (lumaRow[x] > updateFixedPointAverage(lumaRow[x], averageRow[x], frameWeight, averageWeight)) ? 255 : 0;
+    }
+}
+
+/*!
+ * Get function for the instructions the kernels were compiled with, so benchmark and regression results can be told apart
+ *
+ * \return Returns "sse2" when the rows are processed 16 pixels at a time, "scalar" when they are processed one at a time
+ */
+const char* MotionKernel::getInstructionSet()
+{
+#ifdef BV_MOTION_KERNEL_SSE2
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
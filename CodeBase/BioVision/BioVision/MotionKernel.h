@@ -0,0 +1,56 @@
+/*!
+ * \class MotionKernel
+ *
+ * Fused per-row motion detection kernel used by the OpenCV class.
+ *
+ * A single sweep over a frame row updates the running average background and writes the final black and white motion
+ * mask for that row.  It replaces the old chain of cvRunningAvg, cvConvertScale, compare, cvCvtColor and cvThreshold
+ * calls, which each walked the whole frame, while producing exactly the same mask.
+ *
+ * A pixel is flagged as motion when its first channel is brighter than the rounded running average of that channel plus
+ * 100, or its second channel is brighter than the rounded running average of that channel.  This is what the old chain
+ * computed: "(Mat)image + 100" only offsets the first channel, and after the per channel masks were converted with
+ * CV_RGB2GRAY and thresholded at 70 only the first two channels carry enough weight to pass the threshold.
+ *
+ * The running average is kept either as 32 bit floats, or as 16 bit fixed point with 8 fraction bits, which halves the
+ * memory and bandwidth of the background.  The fixed point update weighs the frame and the average with 16 bit weights
+ * that add up to 2^16 and truncates each product, so each update is at most 2/256 below the float one.  The difference
+ * shrinks by the history weight (at most 0.1) every frame, so the rounded average used for the mask is within 0.01 of
+ * the float model's and the masks only differ where the float average lies that close to a rounding midpoint.
+ *
+ * The luma kernels work on single channel frames with a single channel average, a third of the work of a color row.  A
+ * luma pixel is flagged when it is brighter than the rounded average.  On a gray frame, where every channel holds the
+ * luma, this is exactly the color rule: the second channel decides it, and the first channel can only be flagged when
+ * the second one is.
+ */
+
+#ifndef MOTIONKERNEL_H
+#define MOTIONKERNEL_H
+
+class MotionKernel
+{
+
+public:
+    static void resetRow(const unsigned char* frameRow, float* averageRow, unsigned char* maskRow, int width);
+
+    static void updateRow(const unsigned char* frameRow, float* averageRow, unsigned char* maskRow, unsigned char* flagRow,
+                          int width, float motionSensitivity);
+
+    static void resetRow(const unsigned char* frameRow, unsigned short* averageRow, unsigned char* maskRow, int width);
+
+    static void updateRow(const unsigned char* frameRow, unsigned short* averageRow, unsigned char* maskRow, unsigned char* flagRow,
+                          int width, float motionSensitivity);
+
+    static void resetLumaRow(const unsigned char* lumaRow, float* averageRow, unsigned char* maskRow, int width);
+
+    static void updateLumaRow(const unsigned char* lumaRow, float* averageRow, unsigned char* maskRow, int width, float motionSensitivity);
+
+    static void resetLumaRow(const unsigned char* lumaRow, unsigned short* averageRow, unsigned char* maskRow, int width);
+
+    static void updateLumaRow(const unsigned char* lumaRow, unsigned short* averageRow, unsigned char* maskRow, int width, float motionSensitivity);
+
+    static unsigned short getFixedPointFrameWeight(float motionSensitivity);
+
+    static const char* getInstructionSet();
+};
+#endif
@@ -1,15 +1,55 @@
 #include "OpenCV.h"
+#include "MotionKernel.h"
 #include <sstream>
 #include <fstream>
 #include <math.h>
 #include <stdlib.h>
 #include <time.h>
+#include <stdio.h>
+#include <algorithm>
 #include <QDir>
+#include <QDebug>
+#include <QThread>
+#include <QRunnable>
 
 
 using namespace std;
 using namespace cv;
 
+//gaps in the video shorter than this are grabbed through rather than seeked over, in seconds of video
+static const double SHORT_SKIP_SECONDS = 1.0;
+
+//how far the frame count in the header of a video without an index can be off, in seconds of video
+static const double FRAME_COUNT_ESTIMATE_SECONDS = 2.0;
+
+/*!
+ * \class DifferenceImageBand
+ *
+ * Runs one horizontal band of OpenCV::computeDifferenceImage() on the band thread pool. Workers are created once per
+ * analysis and reused for every frame, so they are not deleted by the pool
+ */
+class DifferenceImageBand : public QRunnable
+{
+
+public:
+    DifferenceImageBand(OpenCV* owner, int band)
+    {
+        _owner = owner;
+        _band = band;
+        setAutoDelete(false);
+    }
+
+    void run()
+    {
+        _owner->computeDifferenceImageBand(_band);
+        _owner->_bandsFinished.release();
+    }
+
+private:
+    OpenCV* _owner;
+    int _band;
+};
+
 //Constructor
 OpenCV::OpenCV()
 {
@@ -20,6 +60,40 @@ OpenCV::OpenCV()
     this->_frameHeight = 0;
     this->_currentFrameNumber = 0;
 
+    //frame buffer pool debug data
+    for(int i = 0; i < NUMBER_OF_POOLED_FRAME_BUFFERS; i++)
+    {
+        _frameBufferAddresses[i] = NULL;
+    }
+    _frameBufferAllocationsLastFrame = 0;
+
+    //0 threads uses one thread per processor core. Band threads are kept alive for the whole analysis
+    _analysisThreadCount = 0;
+    _isEditFrame = false;
+    _analyzedFrame = NULL;
+    _bandThreadPool.setExpiryTimeout(-1);
+
+    //frames are not profiled unless a profiler is set
+    _stageProfiler = NULL;
+
+    //same quality imwrite uses when none is given
+    _jpegQuality = 95;
+
+    //every frame is analyzed unless a stride is set
+    _frameStride = 1;
+
+    //only the pixels covered by regions are analyzed unless the user asks for the whole frame
+    _isFullFrameAnalysis = false;
+
+    //frames are analyzed at their full resolution unless a smaller scale is set
+    _analysisScale = 1;
+
+    //the running average is kept as floats unless the fixed point background is chosen
+    _isFixedPointBackground = false;
+
+    //all three color channels are analyzed unless luma analysis is chosen
+    _isLumaAnalysis = false;
+
     //list of colors for each region in a project
 
     //pink
@@ -82,13 +156,6 @@ OpenCV::OpenCV()
     colorList[9].b = 228;
     colorList[9].colorName = "Lavender";
 
-    //red
-    //used only for RegionWindow when the user tries to create a region and there are already 10 regions in their current video
-    colorList[10].r = 255;
-    colorList[10].g = 0;
-    colorList[10].b = 0;
-    colorList[10].colorName = "Red";
-
     //sets random number to be appended to saved image files. should insure
     //that image file names for are unique for the frame carousel each run.
     srand(time(NULL));
@@ -102,7 +169,7 @@ OpenCV::OpenCV()
 //Destructor
 OpenCV::~OpenCV()
 {
-
+    releaseFrameBands();
 }
 
 /*!
@@ -126,6 +193,9 @@ bool OpenCV::openVideoFile(string videoFilePath)
 
     if(vidStream.isOpened())
     {
+        //a video without an index, or with one built from an older copy of the file, goes by the header's frame count
+        _videoIndex.load(QString::fromStdString(videoFilePath));
+
         collectVideoMetaData();
         return true;
     }
@@ -143,6 +213,7 @@ bool OpenCV::openVideoFile(string videoFilePath)
 bool OpenCV::closeVideoFile()
 {
     vidStream.release();
+    _videoIndex.clear();
 
     if(!vidStream.isOpened())
     {
@@ -163,6 +234,28 @@ void OpenCV::collectVideoMetaData()
     this->_frameRate = vidStream.get(CV_CAP_PROP_FPS);
     this->_frameWidth = vidStream.get(CV_CAP_PROP_FRAME_WIDTH);
     this->_frameHeight = vidStream.get(CV_CAP_PROP_FRAME_HEIGHT);
+
+    //the header's frame count is an estimate, the index counted every frame
+    if(_videoIndex.isLoaded())
+    {
+        this->_numberOfFramesInVideo = _videoIndex.getFrameCount();
+    }
+}
+
+/*!
+ * Sets the video data of frames that do not come from a video file, such as frames generated in memory, in place of
+ * the meta data collected when a video is opened
+ *
+ * \param frameWidth: The width of every frame
+ * \param frameHeight: The height of every frame
+ * \param frameRate: The frame rate the frames are timed with
+ */
+void OpenCV::setVideoFormat(double frameWidth, double frameHeight, double frameRate)
+{
+    this->_numberOfFramesInVideo = 0;
+    this->_frameRate = frameRate;
+    this->_frameWidth = frameWidth;
+    this->_frameHeight = frameHeight;
 }
 
 /*!
@@ -196,19 +289,27 @@ void OpenCV::getFormattedVideoTime(int &hours, int &minutes, int &seconds, doubl
 }
 
 /*!
- * Sets the next frame of the video that will be analyzed
+ * Sets the next frame of the video that will be analyzed. The decoder may land near the target rather than on it, so
+ * callers that need the exact position read it back with getCurrentVideoFrame()
+ *
+ * With a video index the target is kept inside the counted frames
  *
  * \param nextFrameToAnalyze: The frame number of the next frame that will be analyzed
  */
 void OpenCV::setCurrentVideoFrame(double nextFrameToAnalyze)
 {
+    if(_videoIndex.isLoaded())
+    {
+        nextFrameToAnalyze = std::max(std::min((int)nextFrameToAnalyze, _videoIndex.getFrameCount()), 0);
+    }
+
     vidStream.set(CV_CAP_PROP_POS_FRAMES, nextFrameToAnalyze);
 }
 
 /*!
  * Get function for current video frame
  *
- * \return Returns the number of the next frame that will be analyzed
+ * \return Returns the number of the next frame that will be analyzed, as reported by the decoder
  */
 double OpenCV::getCurrentVideoFrame()
 {
@@ -235,6 +336,25 @@ void OpenCV::setCurrentVideoTime(double newVideoTime)
     vidStream.set(CV_CAP_PROP_POS_MSEC, newVideoTime);
 }
 
+/*!
+ * Checks if a frame that failed to read lies at the end of the video rather than inside it. With a video index the
+ * frame count is exact. Without one the header's frame count is an estimate, so a read that fails within
+ * FRAME_COUNT_ESTIMATE_SECONDS of it, or past it, is taken as the end of the video
+ *
+ * \param frameNumber: The frame number of the frame that failed to read
+ *
+ * \return Returns true if the video ends before the frame
+ */
+bool OpenCV::isEndOfVideo(int frameNumber)
+{
+    if(_videoIndex.isLoaded())
+    {
+        return frameNumber >= _videoIndex.getFrameCount();
+    }
+
+    return frameNumber >= _numberOfFramesInVideo - FRAME_COUNT_ESTIMATE_SECONDS * _frameRate;
+}
+
 /*!
  * Get function for video frame count
  *
@@ -287,6 +407,62 @@ void OpenCV::getFrameForAnalysis(Mat& frameToAnalize)
     vidStream.read(frameToAnalize);
 }
 
+/*!
+ * Extracts the luma plane of a decoded frame for luma analysis. Can be called on the decoder thread
+ *
+ * \param frame: The decoded 3 channel frame
+ * \param lumaFrame: Receives the single channel luma of the frame, its buffer is reused between calls
+ */
+void OpenCV::getLumaFrameForAnalysis(const cv::Mat &frame, cv::Mat &lumaFrame)
+{
+    cvtColor(frame, lumaFrame, CV_BGR2GRAY);
+}
+
+/*!
+ * Moves the video stream past its next frame without decoding it into an image, used to skip frames a strided analysis
+ * does not look at
+ *
+ * \return Returns false if there is no frame left to skip
+ */
+bool OpenCV::skipFrameForAnalysis()
+{
+    return vidStream.grab();
+}
+
+/*!
+ * Moves the video stream forward to a later frame without decoding the frames in between into images. A seek restarts
+ * decoding at the keyframe before the target, so gaps shorter than SHORT_SKIP_SECONDS are grabbed through instead, and
+ * longer gaps take a single seek
+ *
+ * \param currentFrameNumber: The frame number of the next frame the stream will read
+ * \param targetFrameNumber: The frame number to move to
+ *
+ * \return Returns the frame number of the next frame the stream will read, at or after the target, or -1 if the end of
+ *         the video was reached first
+ */
+int OpenCV::skipToVideoFrame(int currentFrameNumber, int targetFrameNumber)
+{
+    if(targetFrameNumber - currentFrameNumber > SHORT_SKIP_SECONDS * _frameRate)
+    {
+        setCurrentVideoFrame(targetFrameNumber);
+
+        //the decoder may land before the target, read back where the stream landed and grab through the rest
+        currentFrameNumber = (int)getCurrentVideoFrame();
+    }
+
+    while(currentFrameNumber < targetFrameNumber)
+    {
+        if(skipFrameForAnalysis() == false)
+        {
+            return -1;
+        }
+
+        currentFrameNumber++;
+    }
+
+    return currentFrameNumber;
+}
+
 /*!
  * Set the preview window output size if the video is low enough resolution,
  * and set the speed of the preview playback. Based on user input
@@ -414,10 +590,12 @@ Mat OpenCV::resizePreviewImage(Mat previewImage)
  *
  * \param isOutputImage: User set value from the GUI that determines if we will be saving image output for this analysis
  * \param imageSizeSelected: User set value from the GUI that determine if we will be resizing saved images for this analysis
+ * \param jpegQuality: Quality of saved images, from 0 to 100
  */
-void OpenCV::setAnalyzeOptions(bool isOutputImage, int imageSizeSelected)
+void OpenCV::setAnalyzeOptions(bool isOutputImage, int imageSizeSelected, int jpegQuality)
 {
     _isOutputingImages = isOutputImage;
+    _jpegQuality = jpegQuality;
 
     if(imageSizeSelected == 1)
     {
@@ -483,62 +661,18 @@ void OpenCV::setAnalyzeOptions(bool isOutputImage, int imageSizeSelected)
 }
 
 /*!
- * Set the area of the frame to analyze if Full Frame Analysis is disabled. Based on all region selected by the user
+ * Set whether the whole frame is analyzed, or only the pixels inside the regions selected by the user. Must be called before
+ * initializePixelChangeVariables(), which builds the analyzed areas from the regions
  *
  * \param regionCoordinates: Coordinates of all regions selected by the user
- * \param isFullFrameAnalysis: Does the user want to analyze the whole frame, or just a subsection containing all selected regions
+ * \param isFullFrameAnalysis: Does the user want to analyze the whole frame, or just the pixels covered by the selected regions
  */
 void OpenCV::setFrameAnalysisSize(std::vector < std::vector<int> > regionCoordinates, bool isFullFrameAnalysis)
 {
-    if(isFullFrameAnalysis == false)
-    {
-        int smallestStartingXCoordinate = regionCoordinates[0][0];
-        int smallestStartingYCoordinate = regionCoordinates[0][1];
-        int largestStartingXCoordinate = regionCoordinates[0][2];
-        int largestStartingYCoordinate = regionCoordinates[0][3];
-
-        if(regionCoordinates.size() > 1)
-        {
-            for(unsigned int i = 1; i < regionCoordinates.size(); i++)
-            {
-                if(smallestStartingXCoordinate > regionCoordinates[i][0])
-                {
-                    smallestStartingXCoordinate = regionCoordinates[i][0];
-                }
-
-                if(smallestStartingYCoordinate > regionCoordinates[i][1])
-                {
-                    smallestStartingYCoordinate = regionCoordinates[i][1];
-                }
-
-                if(largestStartingXCoordinate < regionCoordinates[i][2])
-                {
-                    largestStartingXCoordinate = regionCoordinates[i][2];
-                }
-
-                if(largestStartingYCoordinate < regionCoordinates[i][3])
-                {
-                    largestStartingYCoordinate = regionCoordinates[i][3];
-                }
-            }//end for
-        }//end if regionCoordinates.size < 1
-
-        _xStartOfFrameAnalysisArea = smallestStartingXCoordinate;
-        _yStartOfFrameAnalysisArea = smallestStartingYCoordinate;
-        _xEndOfFrameAnalysisArea = largestStartingXCoordinate;
-        _yEndOfFrameAnalysisArea = largestStartingYCoordinate;
-    }
-    else
-    {
-        _xStartOfFrameAnalysisArea = 0;
-        _yStartOfFrameAnalysisArea = 0;
-        _xEndOfFrameAnalysisArea = _frameWidth;
-        _yEndOfFrameAnalysisArea = _frameHeight;
-    }
+    //the regions are turned into analyzed areas by initializePixelChangeVariables(), once they are known at the analysis scale
+    _isFullFrameAnalysis = isFullFrameAnalysis;
 }
 
-
-
 /*!
  * Resize output image frames based on settings chosen by the user
  *
@@ -593,7 +727,8 @@ void OpenCV::shrinkPreviewWindow()
  * \param outoutFilePath : The full path to the directory the .JPG will be output to, including the trailing  "\" or
  *                         "/" after the directory name, for Windows and Mac respactively.
  *
- * \return Returns a QString containing the image path, which is sent through the system so the frame carosel can be updated.
+ * \return Returns a QString containing the image path, which is sent through the system so the frame carosel can be updated,
+ *         or an empty QString if the image could not be written.
  */
 QString OpenCV::saveFrameAsJPG(Mat imageToSave, int frameNumber, string outputFilePath)
 {
@@ -608,15 +743,27 @@ QString OpenCV::saveFrameAsJPG(Mat imageToSave, int frameNumber, string outputFi
     //QString to hold path that will be sent to the carousel
     qFileName = QString::fromStdString(_randomImageNameAddition) + QString::fromStdString(_videoFileName) + "frame-" + QString::fromStdString(frameNumberAsString) + "-" + ".jpg";
 
+    std::vector<int> jpegParameters;
+    jpegParameters.push_back(CV_IMWRITE_JPEG_QUALITY);
+    jpegParameters.push_back(_jpegQuality);
+
+    bool isImageWritten = false;
+
     //output native resolution image
     if(_outputImageSizeX == 0)
     {  
-        imwrite(filePath + _randomImageNameAddition + _videoFileName + "frame-" + frameNumberAsString + "-" + ".jpg", imageToSave);
+        isImageWritten = imwrite(filePath + _randomImageNameAddition + _videoFileName + "frame-" + frameNumberAsString + "-" + ".jpg", imageToSave, jpegParameters);
     }
     else//else output a smaller resized image
     {
         Mat smallerImage = resizeOutputImage(imageToSave);
-        imwrite(filePath + _randomImageNameAddition + _videoFileName + "frame-" + frameNumberAsString + "-" + ".jpg", smallerImage);
+        isImageWritten = imwrite(filePath + _randomImageNameAddition + _videoFileName + "frame-" + frameNumberAsString + "-" + ".jpg", smallerImage, jpegParameters);
+    }
+
+    //the carousel is only told about images that are on disk
+    if(isImageWritten == false)
+    {
+        return QString();
     }
 
     //return path for carousel
@@ -641,11 +788,11 @@ void OpenCV::drawRegionRectangle(int startPointX, int startPointY, int endPointX
     //if region is the full size of the frame
     if(startPointY == 0)
     {
-        line(differenceImage, cvPoint(startPointX, startPointY + (_lineSizeRegionRect/2)), cvPoint(endPointX, startPointY + (_lineSizeRegionRect/2)), CV_RGB(colorList[regionNumber].r, colorList[regionNumber].g, colorList[regionNumber].b), _lineSizeRegionRect, 8, 0);
+        line(differenceImage, cvPoint(startPointX, startPointY + (_lineSizeRegionRect/2)), cvPoint(endPointX, startPointY + (_lineSizeRegionRect/2)), CV_RGB(getRegionColor(regionNumber).r, getRegionColor(regionNumber).g, getRegionColor(regionNumber).b), _lineSizeRegionRect, 8, 0);
     }
     else
     {
-        line(differenceImage, cvPoint(startPointX, startPointY), cvPoint(endPointX, startPointY), CV_RGB(colorList[regionNumber].r, colorList[regionNumber].g, colorList[regionNumber].b), _lineSizeRegionRect, 8, 0);
+        line(differenceImage, cvPoint(startPointX, startPointY), cvPoint(endPointX, startPointY), CV_RGB(getRegionColor(regionNumber).r, getRegionColor(regionNumber).g, getRegionColor(regionNumber).b), _lineSizeRegionRect, 8, 0);
     }
 
     //draw bottom of region
@@ -654,27 +801,27 @@ void OpenCV::drawRegionRectangle(int startPointX, int startPointY, int endPointX
     {
         if(_lineSizeRegionRect == 4)
         {
-            line(differenceImage, cvPoint(startPointX, endPointY - (_lineSizeRegionRect - 1)), cvPoint(endPointX, endPointY - (_lineSizeRegionRect - 1)), CV_RGB(colorList[regionNumber].r, colorList[regionNumber].g, colorList[regionNumber].b), _lineSizeRegionRect, 8, 0);
+            line(differenceImage, cvPoint(startPointX, endPointY - (_lineSizeRegionRect - 1)), cvPoint(endPointX, endPointY - (_lineSizeRegionRect - 1)), CV_RGB(getRegionColor(regionNumber).r, getRegionColor(regionNumber).g, getRegionColor(regionNumber).b), _lineSizeRegionRect, 8, 0);
         }
         else
         {
-            line(differenceImage, cvPoint(startPointX, endPointY - (_lineSizeRegionRect/2)), cvPoint(endPointX, endPointY - (_lineSizeRegionRect/2)), CV_RGB(colorList[regionNumber].r, colorList[regionNumber].g, colorList[regionNumber].b), _lineSizeRegionRect, 8, 0);
+            line(differenceImage, cvPoint(startPointX, endPointY - (_lineSizeRegionRect/2)), cvPoint(endPointX, endPointY - (_lineSizeRegionRect/2)), CV_RGB(getRegionColor(regionNumber).r, getRegionColor(regionNumber).g, getRegionColor(regionNumber).b), _lineSizeRegionRect, 8, 0);
         }
     }
     else
     {
-        line(differenceImage, cvPoint(startPointX, endPointY), cvPoint(endPointX, endPointY), CV_RGB(colorList[regionNumber].r, colorList[regionNumber].g, colorList[regionNumber].b), _lineSizeRegionRect, 8, 0);
+        line(differenceImage, cvPoint(startPointX, endPointY), cvPoint(endPointX, endPointY), CV_RGB(getRegionColor(regionNumber).r, getRegionColor(regionNumber).g, getRegionColor(regionNumber).b), _lineSizeRegionRect, 8, 0);
     }
 
     //draw left side of region
     //if region is the full size of the frame
     if(startPointX == 0)
     {
-        line(differenceImage, cvPoint(startPointX + (_lineSizeRegionRect/2), startPointY), cvPoint(startPointX + (_lineSizeRegionRect/2), endPointY), CV_RGB(colorList[regionNumber].r, colorList[regionNumber].g, colorList[regionNumber].b), _lineSizeRegionRect, 8, 0);
+        line(differenceImage, cvPoint(startPointX + (_lineSizeRegionRect/2), startPointY), cvPoint(startPointX + (_lineSizeRegionRect/2), endPointY), CV_RGB(getRegionColor(regionNumber).r, getRegionColor(regionNumber).g, getRegionColor(regionNumber).b), _lineSizeRegionRect, 8, 0);
     }
     else
     {
-        line(differenceImage, cvPoint(startPointX, startPointY), cvPoint(startPointX, endPointY), CV_RGB(colorList[regionNumber].r, colorList[regionNumber].g, colorList[regionNumber].b), _lineSizeRegionRect, 8, 0);
+        line(differenceImage, cvPoint(startPointX, startPointY), cvPoint(startPointX, endPointY), CV_RGB(getRegionColor(regionNumber).r, getRegionColor(regionNumber).g, getRegionColor(regionNumber).b), _lineSizeRegionRect, 8, 0);
     }
 
 
@@ -684,16 +831,16 @@ void OpenCV::drawRegionRectangle(int startPointX, int startPointY, int endPointX
     {
         if(_lineSizeRegionRect == 4)
         {
-            line(differenceImage, cvPoint(endPointX - (_lineSizeRegionRect - 1), startPointY), cvPoint(endPointX - (_lineSizeRegionRect- 1), endPointY), CV_RGB(colorList[regionNumber].r, colorList[regionNumber].g, colorList[regionNumber].b), _lineSizeRegionRect, 8, 0);
+            line(differenceImage, cvPoint(endPointX - (_lineSizeRegionRect - 1), startPointY), cvPoint(endPointX - (_lineSizeRegionRect- 1), endPointY), CV_RGB(getRegionColor(regionNumber).r, getRegionColor(regionNumber).g, getRegionColor(regionNumber).b), _lineSizeRegionRect, 8, 0);
         }
         else
         {
-            line(differenceImage, cvPoint(endPointX - (_lineSizeRegionRect/2), startPointY), cvPoint(endPointX - (_lineSizeRegionRect/2), endPointY), CV_RGB(colorList[regionNumber].r, colorList[regionNumber].g, colorList[regionNumber].b), _lineSizeRegionRect, 8, 0);
+            line(differenceImage, cvPoint(endPointX - (_lineSizeRegionRect/2), startPointY), cvPoint(endPointX - (_lineSizeRegionRect/2), endPointY), CV_RGB(getRegionColor(regionNumber).r, getRegionColor(regionNumber).g, getRegionColor(regionNumber).b), _lineSizeRegionRect, 8, 0);
         }
     }
     else
     {
-        line(differenceImage, cvPoint(endPointX, startPointY), cvPoint(endPointX, endPointY), CV_RGB(colorList[regionNumber].r, colorList[regionNumber].g, colorList[regionNumber].b), _lineSizeRegionRect, 8, 0);
+        line(differenceImage, cvPoint(endPointX, startPointY), cvPoint(endPointX, endPointY), CV_RGB(getRegionColor(regionNumber).r, getRegionColor(regionNumber).g, getRegionColor(regionNumber).b), _lineSizeRegionRect, 8, 0);
     }
 
 }
@@ -776,104 +923,31 @@ void OpenCV::drawMotionRegionRectangle(int startPointX, int startPointY, int end
 
 }
 
-/*!
- * Takes the coordinates of a single changed pixel, and determines which regions contain that pixel
- *
- * \param xPosition: The X coordinate of the pixel we are checking
- * \param yPosition: The Y coordinate of the pixel we are checking
- * \param regionPixelChanges: A vector that holds the number of pixels that have changed in each region for this frame
- * \param regionCoordinates: A vector that holds the start and end points of each region
- *
- * \return Returns nothing, increments the values held in regionPixelChanges to count the number of pixels changed in this frame per region
- */
-void OpenCV::evaluateRegionalChanges(int xPosition, int yPosition, std::vector <int> &regionPixleChanges, std::vector < std::vector<int> > &regionCoordinates)
-{
-    for(unsigned int regionNum = 0; regionNum < regionCoordinates.size(); regionNum++)
-    {
-        //if this pixel falls within this region's x axis area
-        if(xPosition  >= regionCoordinates[regionNum][0] && xPosition <= regionCoordinates[regionNum][2])
-        {
-            //and if this pixel falls within this region's y axis area
-            if(yPosition  >= regionCoordinates[regionNum][1] && yPosition <= regionCoordinates[regionNum][3])
-            {
-                regionPixleChanges[regionNum] ++;
-            }
-
-        }
-
-    }
-
-}
-
-/*!
- * Takes the coordinates of a pixel that changed this frame, and draws it in red to the frame, scaled based on frame resolution
- *
- * \param startPointX: Start point to draw the pixel to
- * \param endPointX: End point to draw the pixel to
- *
- * \return Returns nothing, passes back the current frame with the changed pixel drawn to it by reference
- */
-void OpenCV::drawDifferencePixelOnFrame(int startPointX, int endPointX, int yAxisPoint, cv::Mat &currentImageCopy)
-{
-    line(currentImageCopy, cvPoint(startPointX, yAxisPoint), cvPoint(endPointX, yAxisPoint), CV_RGB(255, 0, 0), _pixelSize, 8, 0);
-}
-
 /*!
  * Draws the current video time string onto the passed in Matrix image
  *
  * \param currentImage: Image we are drawing the text to, passed by reference
+ * \param videoFramePosition: The video stream position the image was read at, used to find its video time
  *
  * \return Returns nothing, passes back the current frame with the text drawn to it by reference
  */
-void OpenCV::drawTimeOnToImage(cv::Mat &currentImage)
+void OpenCV::drawTimeOnToImage(cv::Mat &currentImage, double videoFramePosition)
 {
     int hours;
     int minutes;
     int seconds;
 
-    string currentVideoTime;
-    stringstream hourConverter;
-    stringstream minuteConverter;
-    stringstream secondConverter;
-
     //get video time
-    getFormattedVideoTime(hours, minutes, seconds, getCurrentVideoFrame(), _frameRate);
-
-    if(hours < 10)
-    {
-        hourConverter << hours;
-        currentVideoTime = "0" + hourConverter.str() + ":";
-    }
-    else
-    {
-        hourConverter << hours;
-        currentVideoTime = hourConverter.str() + ":";
-    }
-
-    if(minutes < 10)
-    {
-        minuteConverter << minutes;
-        currentVideoTime += ("0" + minuteConverter.str() + ":");
-    }
-    else
-    {
-        minuteConverter << minutes;
-        currentVideoTime += (minuteConverter.str() + ":");
-    }
+    getFormattedVideoTime(hours, minutes, seconds, videoFramePosition, _frameRate);
 
-    if(seconds < 10)
-    {
-        secondConverter << seconds;
-        currentVideoTime += ("0" + secondConverter.str());
-    }
-    else
-    {
-        secondConverter << seconds;
-        currentVideoTime += secondConverter.str();
-    }
+    //format the time into a fixed size buffer, this is called for every analyzed frame
+    char currentVideoTime[32];
+    sprintf(currentVideoTime, "%02d:%02d:%02d", hours, minutes, seconds);
 
     rectangle(currentImage, cvPoint(_x1Time, _y1Time), cvPoint(_x2Time, _y2Time), CV_RGB(0, 0, 0), CV_FILLED, 8, 0);
-    putText(currentImage, currentVideoTime.c_str(), cvPoint(_xTimeText, _yTimeText), FONT_HERSHEY_SIMPLEX, _timeFontSize, CV_RGB(255, 255, 255), 1, CV_AA, false);
+
+    //compose the text from the glyphs rasterized for this resolution tier
+    _timeGlyphs.drawText(currentImage, currentVideoTime, cvPoint(_xTimeText, _yTimeText));
 }
 
 /*!
@@ -895,464 +969,1166 @@ void OpenCV::initializeStartFrameAndFileName(std::string outFilePath, std::strin
 /*!
  * Sets initial values in openCV object for variables responsible for tracking pixel changes during an analysis
  *
- * \param numberOfRegions: The number of regions selected by the user for this analysis
+ * \param regionCoordinates: A vector containing one integer vector for every region. Each internal vector hold X1, Y1, X2 and Y2 coordinates of a region
  * \param indexedRegionOutput: Stores the region data collected over the course of an analysis, used to generate output files later
- * \param percentOfImageChange: An array that holds thresholds set by the user for each region
+ * \param percentOfImageChange: Holds thresholds set by the user for each region
  * \param regionWidths: Width of each region, used for calculating minimum number of chandged pixels that will flag a regions threshold
- *\param regionHeights: Height of each region, used for calculating minimum number of chandged pixels that will flag a regions threshold
+ * \param regionHeights: Height of each region, used for calculating minimum number of chandged pixels that will flag a regions threshold
  *
  * \return Returns nothing, passes back indexedRegionOutput by reference
  */
-void OpenCV::initializePixelChangeVariables(int numberOfRegions, std::vector <regionData> &indexedRegionOutput, float percentOfImageChange[10], std::vector<int>* regionWidths, std::vector<int>* regionHeights)
+void OpenCV::initializePixelChangeVariables(std::vector < std::vector<int> > &regionCoordinates, std::vector <regionData> &indexedRegionOutput, std::vector<float> &percentOfImageChange, std::vector<int>* regionWidths, std::vector<int>* regionHeights)
 {
-    for(int i = 0; i < numberOfRegions; i++)
-    {
-        _regionPixelChanges.push_back(0);
-        _previousFramePixelChanges[i] = 0;
+    std::vector<int> pixelsThatMustChangePerRegion(regionCoordinates.size());
 
+    for(unsigned int i = 0; i < regionCoordinates.size(); i++)
+    {
         //if a threshold larger than 0 was selected by the user, set that threshold as the % of pixels that
         //must change between frames for a frame to be flagged
         if(percentOfImageChange[i] > 0)
         {
             indexedRegionOutput[i].regionThreshHold = percentOfImageChange[i];
-            _pixelsThatMustChangePerRegion[i] = percentOfImageChange[i] * (*regionHeights)[i] * (*regionWidths)[i];//* _frameHeight * _frameWidth;
+            pixelsThatMustChangePerRegion[i] = percentOfImageChange[i] * (*regionHeights)[i] * (*regionWidths)[i];//* _frameHeight * _frameWidth;
+
+            //a pixel of a scaled down frame stands for scale * scale pixels of the full frame
+            int pixelsPerAnalysisPixel = _analysisScale * _analysisScale;
+            pixelsThatMustChangePerRegion[i] = std::max((pixelsThatMustChangePerRegion[i] + pixelsPerAnalysisPixel - 1) / pixelsPerAnalysisPixel, 1);
         }
         else//if the threshold is 0, than flag any pixel changes that occure between frames
         {
             indexedRegionOutput[i].regionThreshHold = percentOfImageChange[i];
-            _pixelsThatMustChangePerRegion[i] = 1;
+            pixelsThatMustChangePerRegion[i] = 1;
         }
     }
+
+    //regions are counted on the frame as it is analyzed, which may be scaled down
+    cv::Size analysisSize = getAnalysisFrameSize();
+    std::vector < std::vector<int> > analysisRegionCoordinates = regionCoordinates;
+
+    for(unsigned int i = 0; i < analysisRegionCoordinates.size(); i++)
+    {
+        analysisRegionCoordinates[i][0] = toAnalysisCoordinate(regionCoordinates[i][0], analysisSize.width);
+        analysisRegionCoordinates[i][1] = toAnalysisCoordinate(regionCoordinates[i][1], analysisSize.height);
+        analysisRegionCoordinates[i][2] = toAnalysisCoordinate(regionCoordinates[i][2], analysisSize.width);
+        analysisRegionCoordinates[i][3] = toAnalysisCoordinate(regionCoordinates[i][3], analysisSize.height);
+    }
+
+    _regionEngine.setRegions(analysisRegionCoordinates, pixelsThatMustChangePerRegion, analysisSize.width, analysisSize.height);
+
+    //the background and difference image are only updated inside the regions, or the whole frame if the user asked for it
+    setAnalysisAreas(regionCoordinates, analysisRegionCoordinates, analysisSize);
 }
 
 /*!
- * Initializes frame size used for generating images that will store openCV change data, motion sensitivity for this analysis,
- * and all sizing data for elements that will be drawn to video frames based on the video's resolution
+ * Splits the pixels covered by at least one region into rectangles that do not overlap, so every covered pixel is
+ * analyzed exactly once and pixels outside every region are never touched. Rows are cut at every region's top and bottom
+ * edge, and within each strip of rows the column spans of the regions covering it are merged
  *
- * \param userSelectedSensitivity: Motion sensetivity selected by the user on the slider
+ * \param regionCoordinates: The X1, Y1, X2 and Y2 coordinates of every region in the video frame, as the user set them
+ * \param analysisRegionCoordinates: The inclusive X1, Y1, X2 and Y2 coordinates of every region in the analyzed frame
+ * \param analysisSize: The size frames are analyzed at
  *
- * \return Returns nothing
+ * \return Returns nothing, the areas are stored in _analysisAreas in row order and their bounding box in _analysisBounds
  */
-void OpenCV::initializeFrameSizeSensitivityAndDrawSize(float userSelectedSensitivity)
+void OpenCV::setAnalysisAreas(std::vector < std::vector<int> > &regionCoordinates, std::vector < std::vector<int> > &analysisRegionCoordinates, cv::Size analysisSize)
 {
-    _imgSize.width = _frameWidth;
-    _imgSize.height = _frameHeight;
+    _analysisAreas.clear();
 
-    if (_frameWidth < 600)
+    if(_isFullFrameAnalysis == true)
     {
-        //data for drawing the time onto video frames
-        _x1Time = 6;
-        _y1Time = 6;
-        _x2Time = 76;
-        _y2Time = 20;
-        _xTimeText = 6;
-        _yTimeText = 18;
-        _timeFontSize = 0.5f;
-
-        //data dor drawing rectangles onto video frames
-        _lineSizeRegionRect = 4;
-        _lineSizeMotionRect = 2;
-        _offsetMotionRect = 2;
-
-        //draw size of pixels flagged as motion
-        _pixelSize = 2;
+        _analysisAreas.push_back(cv::Rect(0, 0, analysisSize.width, analysisSize.height));
     }
-    else if(_frameWidth < 1200)
+    else
     {
-        //data for drawing the time onto video frames
-        _x1Time = 6 * 2;
-        _y1Time = 6 * 2;
-        _x2Time = 76 * 2;
-        _y2Time = 20 * 2;
-        _xTimeText = 6 * 2;
-        _yTimeText = 18 * 2;
-        _timeFontSize = 0.5f * 2;
+        //the analyzed area has always stopped one pixel short of the largest X2 and Y2 of the regions, so the last
+        //column and row of the regions' bounding box are not counted.  Kept so results match earlier analyses.  The end
+        //is taken from the coordinates the user set, analysis coordinates are kept inside the frame and would also drop
+        //the last column and row of a region that reaches the frame edge
+        int xEnd = analysisSize.width;
+        int yEnd = analysisSize.height;
+
+        if(regionCoordinates.empty() == false)
+        {
+            int largestX2 = regionCoordinates[0][2];
+            int largestY2 = regionCoordinates[0][3];
 
-        //data dor drawing rectangles onto video frames
-        _lineSizeRegionRect = 6;
-        _lineSizeMotionRect = 2;
-        _offsetMotionRect = 3;
+            for(unsigned int i = 1; i < regionCoordinates.size(); i++)
+            {
+                largestX2 = std::max(largestX2, regionCoordinates[i][2]);
+                largestY2 = std::max(largestY2, regionCoordinates[i][3]);
+            }
 
-        //draw size of pixels flagged as motion
-        _pixelSize = 4;
+            //a scaled down pixel is analyzed if any of the full frame pixels it stands for is
+            xEnd = std::min((std::max(largestX2, 0) + _analysisScale - 1) / _analysisScale, analysisSize.width);
+            yEnd = std::min((std::max(largestY2, 0) + _analysisScale - 1) / _analysisScale, analysisSize.height);
+        }
+
+        //every region as a rectangle clipped to the analyzed area, region end points are inclusive
+        std::vector<cv::Rect> regionAreas;
+        std::vector<int> rowEdges;
+
+        for(unsigned int i = 0; i < analysisRegionCoordinates.size(); i++)
+        {
+            int x1 = std::max(analysisRegionCoordinates[i][0], 0);
+            int y1 = std::max(analysisRegionCoordinates[i][1], 0);
+            int x2 = std::min(analysisRegionCoordinates[i][2] + 1, xEnd);
+            int y2 = std::min(analysisRegionCoordinates[i][3] + 1, yEnd);
+
+            if(x1 < x2 && y1 < y2)
+            {
+                regionAreas.push_back(cv::Rect(x1, y1, x2 - x1, y2 - y1));
+                rowEdges.push_back(y1);
+                rowEdges.push_back(y2);
+            }
+        }
+
+        std::sort(rowEdges.begin(), rowEdges.end());
+        rowEdges.erase(std::unique(rowEdges.begin(), rowEdges.end()), rowEdges.end());
+
+        //every row between two neighbouring edges is covered by the same regions
+        for(unsigned int edge = 0; edge + 1 < rowEdges.size(); edge++)
+        {
+            int top = rowEdges[edge];
+            int bottom = rowEdges[edge + 1];
+
+            std::vector < std::pair<int, int> > columnSpans;
+
+            for(unsigned int i = 0; i < regionAreas.size(); i++)
+            {
+                if(regionAreas[i].y <= top && regionAreas[i].y + regionAreas[i].height >= bottom)
+                {
+                    columnSpans.push_back(std::make_pair(regionAreas[i].x, regionAreas[i].x + regionAreas[i].width));
+                }
+            }
+
+            std::sort(columnSpans.begin(), columnSpans.end());
+
+            //merge spans that overlap or touch, each merged span becomes one area
+            unsigned int span = 0;
+
+            while(span < columnSpans.size())
+            {
+                int spanStart = columnSpans[span].first;
+                int spanEnd = columnSpans[span].second;
+
+                for(span++; span < columnSpans.size() && columnSpans[span].first <= spanEnd; span++)
+                {
+                    spanEnd = std::max(spanEnd, columnSpans[span].second);
+                }
+
+                _analysisAreas.push_back(cv::Rect(spanStart, top, spanEnd - spanStart, bottom - top));
+            }
+        }
     }
-    else
+
+    //bounding box of all areas, changed pixels are only ever drawn inside it
+    _analysisBounds = cv::Rect();
+
+    if(_analysisAreas.empty() == false)
     {
-        //data for drawing the time onto video frames
-        _x1Time = 6 * 3;
-        _y1Time = 6 * 3;
-        _x2Time = 76 * 3;
-        _y2Time = 20 * 3;
-        _xTimeText = 6 * 3;
-        _yTimeText = 18 * 3;
-        _timeFontSize = 0.5f * 3;
+        int xStart = analysisSize.width;
+        int yStart = analysisSize.height;
+        int xEnd = 0;
+        int yEnd = 0;
 
-        //data for drawing rectangles onto video frames
-        _lineSizeRegionRect = 8;
-        _lineSizeMotionRect = 3;
-        _offsetMotionRect = 4;
+        for(unsigned int i = 0; i < _analysisAreas.size(); i++)
+        {
+            xStart = std::min(xStart, _analysisAreas[i].x);
+            yStart = std::min(yStart, _analysisAreas[i].y);
+            xEnd = std::max(xEnd, _analysisAreas[i].x + _analysisAreas[i].width);
+            yEnd = std::max(yEnd, _analysisAreas[i].y + _analysisAreas[i].height);
+        }
 
-        //draw size of pixels flagged as motion
-        _pixelSize = 6;
+        _analysisBounds = cv::Rect(xStart, yStart, xEnd - xStart, yEnd - yStart);
     }
-
-    //set motion sensitivity based on user selected value
-    _motionSensitivity = (0.90F + (userSelectedSensitivity / 1000));
 }
 
 /*!
- * Initializes an image variable that stores the average of all frame values analyzed so far
+ * Sets how much frames are scaled down before they are analyzed. Must be called before initializePixelChangeVariables()
+ * and initializeFrameSizeSensitivityAndDrawSize(), which size the regions and frame buffers to match
  *
- * \return Returns nothing
+ * \param analysisScale: 1 analyzes frames at full resolution, 2, 4 or 8 analyze them at 1/2, 1/4 or 1/8 of their width and height
  */
-void OpenCV::initializeMovingAverageFrame()
+void OpenCV::setAnalysisScale(int analysisScale)
 {
-    _movingAverage = cvCreateImage( _imgSize, IPL_DEPTH_32F, 3);
-}
+    _analysisScale = 1;
+
+    //only powers of two up to 8 are supported, anything else falls back to the next smaller one
+    while(_analysisScale * 2 <= std::min(analysisScale, (int)MAX_ANALYSIS_SCALE))
+    {
+        _analysisScale = _analysisScale * 2;
+    }
+}
 
 /*!
- * Deallocates frame data stored in memory when an openCV error is thrown
+ * Get function for the analysis scale
  *
- * \return Returns nothing
+ * \return Returns how many times smaller than the video frames the analyzed frames are, in width and height
  */
-void OpenCV::deallocateFramesOnError()
+int OpenCV::getAnalysisScale()
 {
-    cvReleaseImage(&_differenceIpl);
-    cvReleaseImage(&_differenceIplLessThan);
-    cvReleaseImage(&_greyDiffImage);
-    cvReleaseImage(&_greyDiffImageLessThan);
-    cvReleaseImage(&_currentColorImage);
-    cvReleaseImage(&_tempIpl);
+    return _analysisScale;
 }
 
 /*!
- * Analyzes a single frame from the video stream, and outputs image files if that frame passes any regions threshold
+ * Gets the size frames are analyzed at, the video frame size divided by the analysis scale
+ *
+ * \return Returns the analysis frame size, at least one pixel in each direction
+ */
+cv::Size OpenCV::getAnalysisFrameSize()
+{
+    return cv::Size(std::max((int)_frameWidth / _analysisScale, 1), std::max((int)_frameHeight / _analysisScale, 1));
+}
+
+/*!
+ * Converts a full resolution coordinate into the matching coordinate of the analyzed frame
+ *
+ * \param fullFrameCoordinate: The X or Y coordinate in the video frame
+ * \param analysisFrameSize: The width or height of the analyzed frame
+ *
+ * \return Returns the coordinate in the analyzed frame, kept inside it
+ */
+int OpenCV::toAnalysisCoordinate(int fullFrameCoordinate, int analysisFrameSize)
+{
+    return std::max(std::min(fullFrameCoordinate / _analysisScale, analysisFrameSize - 1), 0);
+}
+
+/*!
+ * Gets the color used to draw a region. Colors repeat once every color in the list has been used
+ *
+ * \param regionNumber: The number of the region
+ *
+ * \return Returns the color of the region
+ */
+OpenCV::regionColors OpenCV::getRegionColor(int regionNumber)
+{
+    return colorList[regionNumber % NUMBER_OF_REGION_COLORS];
+}
+
+/*!
+ * Creates the data each region's results are collected in, before any frame is analyzed
  *
- * \param currentFrameNumber: The frame number we will be analyzing on this function call
- * \param fileStream: The stream object from Analyze.cpp, used for printing to the output files
  * \param regionCoordinates: A vector containing one integer vector for every region. Each internal vector hold X1, Y1, X2 and Y2 coordinates of a region
- * \param videoInfo: Holds general video data and non region specific analysis data that will be output to a file later
- * \param indexedRegionOutput: Holds analysis output data for each region selected by the user
- * \param isEditFrame: Determines if the running frame average should be reset if is is eitehr the beginning of the video, or a new edit point
+ * \param percentOfImageChange: Holds the threshold of each region
  *
- * \return Returns nothing, currentFrameNumber is incremented and passed back by reference
+ * \return Returns one regionData per region, with no frames over its threshold
+ */
+std::vector <OpenCV::regionData> OpenCV::createRegionData(std::vector < std::vector<int> > &regionCoordinates, std::vector<float> &percentOfImageChange)
+{
+    std::vector <regionData> indexedRegionOutput;
+
+    for(unsigned int regionNum = 0; regionNum < regionCoordinates.size(); regionNum++)
+    {
+        regionData tempData;
+        tempData.regionStartPointX = regionCoordinates[regionNum][0];
+        tempData.regionStartPointY = regionCoordinates[regionNum][1];
+        tempData.regionEndPointX = regionCoordinates[regionNum][2];
+        tempData.regionEndPointY = regionCoordinates[regionNum][3];
+        tempData.regionRectangleColor = getRegionColor(regionNum).colorName;
+        tempData.regionThreshHold = percentOfImageChange[regionNum];
+        tempData.totalFramesOverThreshHold = 0;
+
+        indexedRegionOutput.push_back(tempData);
+    }
+
+    return indexedRegionOutput;
+}
+
+/*!
+ * Initializes frame size used for generating images that will store openCV change data, motion sensitivity for this analysis,
+ * and all sizing data for elements that will be drawn to video frames based on the video's resolution
+ *
+ * \param userSelectedSensitivity: Motion sensetivity selected by the user on the slider
  *
- * \see Analyzer for loop structure that calls this function
+ * \return Returns nothing
  */
-QString OpenCV::analyzeCurrentFrame(int &currentFrameNumber, std::vector < std::vector<int> > &regionCoordinates, generalVideoData &videoInfo, std::vector <regionData> &indexedRegionOutput, bool isEditFrame)
+void OpenCV::initializeFrameSizeSensitivityAndDrawSize(float userSelectedSensitivity)
 {
-    _greyDiffImage = cvCreateImage(cvSize(_frameWidth,_frameHeight), IPL_DEPTH_8U, 1);
-    _greyDiffImageLessThan = cvCreateImage(cvSize(_frameWidth,_frameHeight), IPL_DEPTH_8U, 1);
+    //the running average and difference image are kept at the analysis scale, drawn images stay at full resolution
+    _imgSize.width = getAnalysisFrameSize().width;
+    _imgSize.height = getAnalysisFrameSize().height;
 
-    Mat currentVideoFrame;
-    Mat currentFrameWithDifference;
+    if (_frameWidth < 600)
+    {
+        //data for drawing the time onto video frames
+        _x1Time = 6;
+        _y1Time = 6;
+        _x2Time = 76;
+        _y2Time = 20;
+        _xTimeText = 6;
+        _yTimeText = 18;
+        _timeFontSize = 0.5f;
 
+        //data dor drawing rectangles onto video frames
+        _lineSizeRegionRect = 4;
+        _lineSizeMotionRect = 2;
+        _offsetMotionRect = 2;
 
-    //if this is the first frame to analyze, or first frame after an edit point,
-    //get the next video frame, and set our current frame average to it
-    if(isEditFrame == true)
+        //draw size of pixels flagged as motion
+        _pixelSize = 2;
+    }
+    else if(_frameWidth < 1200)
     {
-        getFrameForAnalysis(currentVideoFrame);
+        //data for drawing the time onto video frames
+        _x1Time = 6 * 2;
+        _y1Time = 6 * 2;
+        _x2Time = 76 * 2;
+        _y2Time = 20 * 2;
+        _xTimeText = 6 * 2;
+        _yTimeText = 18 * 2;
+        _timeFontSize = 0.5f * 2;
 
-        //copy the current frame to this difference frame, which will have all pixels that change between frames drawn onto it
-        currentVideoFrame.copyTo(currentFrameWithDifference);
+        //data dor drawing rectangles onto video frames
+        _lineSizeRegionRect = 6;
+        _lineSizeMotionRect = 2;
+        _offsetMotionRect = 3;
 
-        //convert first image to iplImage for analysis
-        _currentColorImage = cvCloneImage(&(IplImage)currentVideoFrame);//ignore this compiler warning
-        _differenceIpl = cvCloneImage(_currentColorImage);
-        _differenceIplLessThan = cvCloneImage(_currentColorImage);
-        _tempIpl = cvCloneImage(_currentColorImage);
-        cvConvertScale(_currentColorImage, _movingAverage, 1.0, 0.0);
+        //draw size of pixels flagged as motion
+        _pixelSize = 4;
     }
-    else //else get the next frame we are analyzing in the video, and update the average frame motion
+    else
     {
-        getFrameForAnalysis(currentVideoFrame);
-        currentVideoFrame.copyTo(currentFrameWithDifference);
-        _currentColorImage = cvCloneImage(&(IplImage)currentVideoFrame);//ignore this compiler warning
-        _differenceIpl = cvCloneImage(_currentColorImage);
-        _differenceIplLessThan = cvCloneImage(_currentColorImage);
-        _tempIpl = cvCloneImage(_currentColorImage);
+        //data for drawing the time onto video frames
+        _x1Time = 6 * 3;
+        _y1Time = 6 * 3;
+        _x2Time = 76 * 3;
+        _y2Time = 20 * 3;
+        _xTimeText = 6 * 3;
+        _yTimeText = 18 * 3;
+        _timeFontSize = 0.5f * 3;
+
+        //data for drawing rectangles onto video frames
+        _lineSizeRegionRect = 8;
+        _lineSizeMotionRect = 3;
+        _offsetMotionRect = 4;
 
-        cvRunningAvg(_currentColorImage, _movingAverage, _motionSensitivity, NULL);
+        //draw size of pixels flagged as motion
+        _pixelSize = 6;
     }
 
-    //Convert the scale of the moving average.
-    cvConvertScale(_movingAverage, _tempIpl, 1.0, 0.0);
+    //rasterize the time glyphs for this tier, and the round brush changed pixels are drawn with
+    _timeGlyphs.setFont(FONT_HERSHEY_SIMPLEX, _timeFontSize);
+    _overlayBrush = getStructuringElement(MORPH_ELLIPSE, Size(_pixelSize + 1, _pixelSize + 1));
 
-    //Get high and low end pixel differences between running average and current frame
-    compare((Mat)_currentColorImage, ((Mat)_tempIpl + 100), (Mat)_differenceIpl, CMP_GT);
-    compare((Mat)_currentColorImage, ((Mat)_tempIpl - 100), (Mat)_differenceIplLessThan, CMP_LT);
+    //set motion sensitivity based on user selected value
+    _motionSensitivity = getRunningAverageWeight(userSelectedSensitivity);
 
-    //Convert the difference image to grayscale.
-    cvCvtColor(_differenceIpl, _greyDiffImage, CV_RGB2GRAY);
-    cvCvtColor(_differenceIplLessThan, _greyDiffImageLessThan, CV_RGB2GRAY);
+    //a strided analysis weighs each analyzed frame as much as the frames it stands for would have been weighted together
+    if(_frameStride > 1)
+    {
+        _motionSensitivity = 1.0F - pow(1.0F - _motionSensitivity, _frameStride);
+    }
 
-    //Convert the grayscale difference image to black and white.
-    cvThreshold(_greyDiffImage, _greyDiffImage, 70, 255, CV_THRESH_BINARY);
-    cvThreshold(_greyDiffImageLessThan, _greyDiffImageLessThan, 70, 255, CV_THRESH_BINARY);
+    //allocate the frame buffers that every analyzed frame will reuse
+    allocateFrameBufferPool();
+}
+
+/*!
+ * Sets the number of video frames each analyzed frame stands for. Must be called before
+ * initializeFrameSizeSensitivityAndDrawSize(), which scales the running average weight to match
+ *
+ * \param frameStride: 1 to analyze every frame, N to analyze every Nth frame
+ */
+void OpenCV::setFrameStride(int frameStride)
+{
+    _frameStride = std::max(frameStride, 1);
+}
 
-    //copy iplImage difference to a matrix format image for editing and collecting data
-    _differenceBetweenFrames = cvCloneImage(_greyDiffImage);
-    _differenceBetweenFramesLessThan = cvCloneImage(_greyDiffImageLessThan);
+/*!
+ * Converts the motion sensitivity selected by the user into the weight each new frame has in the running average
+ *
+ * \param userSelectedSensitivity: Motion sensetivity selected by the user on the slider
+ *
+ * \return Returns the weight of the current frame, between 0.90 and 1
+ */
+float OpenCV::getRunningAverageWeight(float userSelectedSensitivity)
+{
+    return (0.90F + (userSelectedSensitivity / 1000));
+}
 
-    //check every pixel in the current frame for changes
-    for(int i = _yStartOfFrameAnalysisArea; i < _yEndOfFrameAnalysisArea; i++)
+/*!
+ * Initializes an image variable that stores the average of all frame values analyzed so far
+ *
+ * \return Returns nothing
+ */
+void OpenCV::initializeMovingAverageFrame()
+{
+    if(_isLumaAnalysis == true)
     {
-        const unsigned char* currentRow = _differenceBetweenFrames.ptr<unsigned char>(i);
-        const unsigned char* currentRowLessThan = _differenceBetweenFrames.ptr<unsigned char>(i);
+        _movingAverage.create(_imgSize.height, _imgSize.width, _isFixedPointBackground ? CV_16UC1 : CV_32FC1);
+    }
+    else
+    {
+        _movingAverage.create(_imgSize.height, _imgSize.width, _isFixedPointBackground ? CV_16UC3 : CV_32FC3);
+    }
 
-        for(int j = _xStartOfFrameAnalysisArea; j < _xEndOfFrameAnalysisArea; j++)
-        {
-            //when a difference is detected
-            if(currentRow[j] != 0 && currentRowLessThan != 0)
-            {
-                //draw the pixel changed detected to a copy of the current image
-                drawDifferencePixelOnFrame(j, j, i, currentFrameWithDifference);
+    recordFrameBufferAddresses();
+}
 
-                //find out which regions the change occured in
-                evaluateRegionalChanges(j, i, _regionPixelChanges, regionCoordinates);
-            }
-        }
+/*!
+ * Chooses how the running average is stored. Must be called before initializeMovingAverageFrame()
+ *
+ * \param isFixedPointBackground: True to keep the average as 16 bit fixed point, false for 32 bit floats
+ *
+ * \see MotionKernel for the difference between the two
+ */
+void OpenCV::setFixedPointBackground(bool isFixedPointBackground)
+{
+    _isFixedPointBackground = isFixedPointBackground;
+}
+
+/*!
+ * Chooses whether frames are analyzed on their luma alone. Must be called before initializeFrameSizeSensitivityAndDrawSize()
+ * and initializeMovingAverageFrame(), which size the frame buffers and the running average to match
+ *
+ * \param isLumaAnalysis: True to analyze the single channel luma of each frame, false to analyze its three color channels
+ */
+void OpenCV::setLumaAnalysis(bool isLumaAnalysis)
+{
+    _isLumaAnalysis = isLumaAnalysis;
+}
+
+/*!
+ * Get function for the luma analysis option
+ *
+ * \return Returns true if frames are analyzed on their luma, analyzeFrame() then needs the luma of each frame
+ */
+bool OpenCV::isLumaAnalysis()
+{
+    return _isLumaAnalysis;
+}
+
+/*!
+ * Allocates every frame sized buffer used during an analysis. The buffers are owned by the openCV object and reused
+ * for every frame, so a steady state frame performs no heap allocations of its own
+ *
+ * \return Returns nothing
+ */
+void OpenCV::allocateFrameBufferPool()
+{
+    _currentVideoFrame.create(_frameHeight, _frameWidth, CV_8UC3);
+    _currentFrameWithDifference.create(_frameHeight, _frameWidth, CV_8UC3);
+    _differenceBetweenFrames.create(_imgSize.height, _imgSize.width, CV_8UC1);
+    _overlayMask.create(_frameHeight, _frameWidth, CV_8UC1);
+
+    //pixels outside the analyzed areas are never written, so they never show up as changed
+    _differenceBetweenFrames.setTo(Scalar(0));
+
+    //scaled down copy of each frame, only used when the analysis scale is above 1
+    if(_analysisScale > 1)
+    {
+        _scaledVideoFrame.create(_imgSize.height, _imgSize.width, _isLumaAnalysis ? CV_8UC1 : CV_8UC3);
     }
 
-    //flag showing that at least one region had activity higher than its threshHold
-    bool atLeastOneThreshHoldPassed = false;
+    //split the frame into bands, each band gets its own motion flag row
+    allocateFrameBands();
 
-    //loop through data for each region after a frame has been analyzed
-    for(unsigned int regionNum = 0; regionNum < regionCoordinates.size(); regionNum++)
+    recordFrameBufferAddresses();
+}
+
+/*!
+ * Sets the number of threads each analyzed frame is split across. Must be called before
+ * initializeFrameSizeSensitivityAndDrawSize(), which splits the frame into bands
+ *
+ * \param threadCount: The number of analysis threads, 0 uses one thread per processor core
+ */
+void OpenCV::setAnalysisThreadCount(int threadCount)
+{
+    _analysisThreadCount = std::max(threadCount, 0);
+}
+
+/*!
+ * Get function for the number of analysis threads
+ *
+ * \return Returns the number of threads each frame is split across, 0 means one thread per processor core
+ */
+int OpenCV::getAnalysisThreadCount()
+{
+    return _analysisThreadCount;
+}
+
+/*!
+ * Splits the frame into one horizontal band of rows per analysis thread, and creates the workers that run every band
+ * but the first on the band thread pool. Bands are cut so each holds about the same number of analyzed pixels, which needs
+ * the analyzed areas from initializePixelChangeVariables(). Without them the rows are split evenly
+ *
+ * \return Returns nothing
+ */
+void OpenCV::allocateFrameBands()
+{
+    releaseFrameBands();
+
+    int numberOfBands = _analysisThreadCount;
+
+    if(numberOfBands == 0)
     {
-        //draw region rectangles onto image
-        drawRegionRectangle(regionCoordinates[regionNum][0], regionCoordinates[regionNum][1], regionCoordinates[regionNum][2], regionCoordinates[regionNum][3], regionNum, currentFrameWithDifference);
+        numberOfBands = QThread::idealThreadCount();
+    }
 
-        //check each region to see if it has passed its threshHold on this frame, if it has,
-        //collect its data for results to use later, and draw its region rectangle onto the output difference image
-        if( (_pixelsThatMustChangePerRegion[regionNum] <= _regionPixelChanges[regionNum]) && (_regionPixelChanges[regionNum] != _previousFramePixelChanges[regionNum]) && (_regionPixelChanges[regionNum] != 0) )
+    //never more bands than rows
+    numberOfBands = std::max(1, std::min(numberOfBands, (int)_imgSize.height));
+
+    _bandStartRows.resize(numberOfBands + 1);
+
+    //number of analyzed pixels above each row
+    std::vector<int64> analyzedPixelsAboveRow(_imgSize.height + 1, 0);
+
+    for(unsigned int area = 0; area < _analysisAreas.size(); area++)
+    {
+        int lastRow = std::min(_analysisAreas[area].y + _analysisAreas[area].height, (int)_imgSize.height);
+
+        for(int i = std::max(_analysisAreas[area].y, 0); i < lastRow; i++)
         {
-            //draw over other rectangle when motion past threshold in region detected
-            drawMotionRegionRectangle(regionCoordinates[regionNum][0], regionCoordinates[regionNum][1], regionCoordinates[regionNum][2], regionCoordinates[regionNum][3], regionNum, currentFrameWithDifference);
+            analyzedPixelsAboveRow[i + 1] += _analysisAreas[area].width;
+        }
+    }
 
-            atLeastOneThreshHoldPassed = true;
+    for(int i = 0; i < _imgSize.height; i++)
+    {
+        analyzedPixelsAboveRow[i + 1] += analyzedPixelsAboveRow[i];
+    }
 
-            indexedRegionOutput[regionNum].totalFramesOverThreshHold++;
+    int64 analyzedPixels = analyzedPixelsAboveRow[_imgSize.height];
 
-            frameData tempFrameData;
-            tempFrameData.frameNumber = currentFrameNumber;
-            tempFrameData.totalDifferentPixels = _regionPixelChanges[regionNum];
-            getFormattedVideoTime(tempFrameData.hourFrameAppears, tempFrameData.minuteFrameAppears, tempFrameData.secondFrameAppears, currentFrameNumber, _frameRate);
+    for(int band = 0; band <= numberOfBands; band++)
+    {
+        if(analyzedPixels == 0 || band == 0 || band == numberOfBands)
+        {
+            _bandStartRows[band] = (_imgSize.height * band) / numberOfBands;
+        }
+        else
+        {
+            //first row with at least this band's share of the analyzed pixels above it
+            int64 pixelsBeforeBand = (analyzedPixels * band) / numberOfBands;
 
-            indexedRegionOutput[regionNum].framesOverThreshHold.push_back(tempFrameData);
+            _bandStartRows[band] = std::lower_bound(analyzedPixelsAboveRow.begin(), analyzedPixelsAboveRow.end(), pixelsBeforeBand) - analyzedPixelsAboveRow.begin();
         }
+    }
+
+    //scratch rows used by MotionKernel::updateRow(), one per band
+    _motionFlagRow.create(numberOfBands, _imgSize.width * 3, CV_8UC1);
+
+    _bandTimings.resize(numberOfBands);
+
+    //private region counters for every band, merged once all bands are done
+    _regionEngine.setNumberOfBands(numberOfBands);
+
+    for(int band = 1; band < numberOfBands; band++)
+    {
+        _bandWorkers.push_back(new DifferenceImageBand(this, band));
+    }
 
+    _bandThreadPool.setMaxThreadCount(std::max(numberOfBands - 1, 1));
+}
+
+/*!
+ * Deletes the band workers. No band may be running when this is called
+ *
+ * \return Returns nothing
+ */
+void OpenCV::releaseFrameBands()
+{
+    for(unsigned int i = 0; i < _bandWorkers.size(); i++)
+    {
+        delete _bandWorkers[i];
     }
 
-    ///draw current video time onto this frame
-    drawTimeOnToImage(currentFrameWithDifference);
+    _bandWorkers.clear();
+}
+
+/*!
+ * Releases every buffer held in the frame buffer pool
+ *
+ * \return Returns nothing
+ */
+void OpenCV::releaseFrameBufferPool()
+{
+    _currentVideoFrame.release();
+    _currentFrameWithDifference.release();
+    _differenceBetweenFrames.release();
+    _overlayMask.release();
+    _motionFlagRow.release();
+    _resizedPreviewFrame.release();
+    _scaledVideoFrame.release();
+
+    recordFrameBufferAddresses();
+}
 
-    QString imageFilePath = "";
+/*!
+ * Stores the current data address of every pooled buffer, used as the baseline for countFrameBufferAllocations()
+ *
+ * \return Returns nothing
+ */
+void OpenCV::recordFrameBufferAddresses()
+{
+    const cv::Mat* pool[NUMBER_OF_POOLED_FRAME_BUFFERS] = { &_currentVideoFrame, &_currentFrameWithDifference, &_movingAverage,
+                                                            &_differenceBetweenFrames, &_motionFlagRow, &_resizedPreviewFrame, &_scaledVideoFrame,
+                                                            &_overlayMask };
 
-    //if at least one region passed its threshold, output the current frame and a copy of the
-    //current frame containing its  regions/difference pixels as a .JPG
-    if(atLeastOneThreshHoldPassed == true)
+    for(int i = 0; i < NUMBER_OF_POOLED_FRAME_BUFFERS; i++)
     {
-        videoInfo.totalFramesPastThreshHold++;
+        _frameBufferAddresses[i] = pool[i]->data;
+    }
 
-        //don't output .JPGs unless the user specifies it
-        if(_isOutputingImages == true)
+    _frameBufferAllocationsLastFrame = 0;
+}
+
+/*!
+ * Counts how many pooled buffers had to be (re)allocated since the last call. Any buffer whose data address changed
+ * was allocated by openCV during the frame, which should only happen on the first frame of an analysis
+ *
+ * \return Returns the number of buffer allocations that took place during the last analyzed frame
+ */
+int OpenCV::countFrameBufferAllocations()
+{
+    const cv::Mat* pool[NUMBER_OF_POOLED_FRAME_BUFFERS] = { &_currentVideoFrame, &_currentFrameWithDifference, &_movingAverage,
+                                                            &_differenceBetweenFrames, &_motionFlagRow, &_resizedPreviewFrame, &_scaledVideoFrame,
+                                                            &_overlayMask };
+
+    int allocations = 0;
+
+    for(int i = 0; i < NUMBER_OF_POOLED_FRAME_BUFFERS; i++)
+    {
+        if(_frameBufferAddresses[i] != pool[i]->data)
         {
-            imageFilePath = saveFrameAsJPG(currentFrameWithDifference, currentFrameNumber, _outputFilePath);
+            _frameBufferAddresses[i] = pool[i]->data;
+            allocations++;
         }
     }
 
-    //reset pixel differences found in each region, and set previous pixel differences found for next frame analysis
-    for(unsigned int regionNumber = 0; regionNumber < _regionPixelChanges.size(); regionNumber++)
+    _frameBufferAllocationsLastFrame = allocations;
+
+#ifdef BV_DEBUG_FRAME_ALLOCATIONS
+    qDebug() << "Frame" << _currentFrameNumber << "buffer allocations:" << allocations;
+#endif
+
+    return allocations;
+}
+
+/*!
+ * Get function for the frame buffer pool debug counter
+ *
+ * \return Returns the number of pooled buffers that were allocated while analyzing the last frame
+ */
+int OpenCV::getFrameBufferAllocationsLastFrame()
+{
+    return _frameBufferAllocationsLastFrame;
+}
+
+/*!
+ * Sets the profiler the stages of each analyzed frame are timed with. Must not be changed while a frame is analyzed
+ *
+ * \param stageProfiler: The profiler of the analysis, NULL to stop timing
+ *
+ * \see StageProfiler for the stages
+ */
+void OpenCV::setStageProfiler(StageProfiler* stageProfiler)
+{
+    _stageProfiler = stageProfiler;
+}
+
+/*!
+ * Get function for the stage profiler, used by the decoder and image writers to time their own stages
+ *
+ * \return Returns the profiler of the analysis, or NULL if it is not profiled
+ */
+StageProfiler* OpenCV::getStageProfiler()
+{
+    return _stageProfiler;
+}
+
+/*!
+ * Deallocates frame data stored in memory when an openCV error is thrown
+ *
+ * \return Returns nothing
+ */
+void OpenCV::deallocateFramesOnError()
+{
+    releaseFrameBufferPool();
+}
+
+/*!
+ * Updates the running average with a frame, builds the black and white difference image between the two and counts the
+ * changed pixels of every region. Only the analyzed areas are processed, the cost of a frame follows the area covered by
+ * regions rather than the frame size. The frame is split into bands that are processed at the same time on the band threads.
+ * Shared by analyzeFrame() and previewAnalysis()
+ *
+ * \param frame: The video frame to analyze
+ * \param isEditFrame: Determines if the running frame average should be reset if is is eitehr the beginning of the video, or a new edit point
+ *
+ * \return Returns nothing, the result is stored in _differenceBetweenFrames and the region engine's pixel counts
+ *
+ * \see computeDifferenceImageBand() for the work done on each band, setAnalysisAreas() for the analyzed areas
+ */
+void OpenCV::computeDifferenceImage(const cv::Mat &frame, bool isEditFrame)
+{
+    //a failed read leaves an empty frame, report it the same way the old openCV calls did
+    CV_Assert(frame.type() == (_isLumaAnalysis ? CV_8UC1 : CV_8UC3) && frame.size() == _movingAverage.size());
+
+    _analyzedFrame = &frame;
+    _isEditFrame = isEditFrame;
+
+    //hand every band but the first to the band threads, and process the first band on this thread
+    for(unsigned int i = 0; i < _bandWorkers.size(); i++)
     {
-        _previousFramePixelChanges[regionNumber] = _regionPixelChanges[regionNumber];
-        _regionPixelChanges[regionNumber] = 0;
+        _bandThreadPool.start(_bandWorkers[i]);
     }
 
-    //increment current frame number
-    currentFrameNumber++;
+    computeDifferenceImageBand(0);
+
+    //wait for the other bands, then add their region counts together in band order
+    _bandsFinished.acquire(_bandWorkers.size());
 
-    //deallocate all currently allocated analysis frames in memory
-    cvReleaseImage(&_differenceIpl);
-    cvReleaseImage(&_differenceIplLessThan);
-    cvReleaseImage(&_greyDiffImage);
-    cvReleaseImage(&_greyDiffImageLessThan);
-    cvReleaseImage(&_currentColorImage);
-    cvReleaseImage(&_tempIpl);
-    _differenceBetweenFrames.deallocate();
-    _differenceBetweenFramesLessThan.deallocate();
+    _regionEngine.mergeBandCounts();
+
+#ifndef BV_NO_STAGE_PROFILING
+    //the bands only stamp their times, so no band thread ever waits on the profiler
+    if(_stageProfiler != NULL)
+    {
+        for(unsigned int band = 0; band < _bandTimings.size(); band++)
+        {
+            const bandTiming &timing = _bandTimings[band];
 
-    return imageFilePath;
+            _stageProfiler->addStageTime(StageProfiler::MOTION, timing.motionStartTicks, timing.countingStartTicks, timing.threadId);
+            _stageProfiler->addStageTime(StageProfiler::COUNTING, timing.countingStartTicks, timing.countingEndTicks, timing.threadId);
+        }
+    }
+#endif
 }
 
 /*!
- * Removes our avereage frame variable from memory, called from our analyze function when analysis is complete
+ * Processes one band of rows of the current frame: updates the running average and the difference image of the analyzed
+ * areas in those rows, then counts the changed pixels of each region in them into the band's own counters. Bands never
+ * touch each others rows
+ *
+ * \param band: The band to process, from 0 to the number of analysis threads - 1
+ *
+ * \return Returns nothing
  */
-void OpenCV::deallocateMovingAverageFrame()
+void OpenCV::computeDifferenceImageBand(int band)
 {
-    cvReleaseImage(&_movingAverage);
+    int bandStartRow = _bandStartRows[band];
+    int bandEndRow = _bandStartRows[band + 1];
+
+    unsigned char* flagRow = _motionFlagRow.ptr<unsigned char>(band);
+
+#ifndef BV_NO_STAGE_PROFILING
+    bandTiming &timing = _bandTimings[band];
+
+    if(_stageProfiler != NULL)
+    {
+        timing.threadId = QThread::currentThreadId();
+        timing.motionStartTicks = cv::getTickCount();
+    }
+#endif
+
+    for(unsigned int area = 0; area < _analysisAreas.size(); area++)
+    {
+        const cv::Rect &analysisArea = _analysisAreas[area];
+
+        int firstRow = std::max(bandStartRow, analysisArea.y);
+        int endRow = std::min(bandEndRow, analysisArea.y + analysisArea.height);
+
+        for(int i = firstRow; i < endRow; i++)
+        {
+            computeDifferenceRow(i, analysisArea.x, analysisArea.width, flagRow);
+        }
+    }
+
+#ifndef BV_NO_STAGE_PROFILING
+    if(_stageProfiler != NULL)
+    {
+        timing.countingStartTicks = cv::getTickCount();
+    }
+#endif
+
+    //count the changed pixels of the analyzed areas in the rows of this band
+    _regionEngine.countChangedPixelsInAreas(_differenceBetweenFrames, band, _analysisAreas, bandStartRow, bandEndRow);
+
+#ifndef BV_NO_STAGE_PROFILING
+    if(_stageProfiler != NULL)
+    {
+        timing.countingEndTicks = cv::getTickCount();
+    }
+#endif
 }
 
 /*!
- * Preview analysis function. Runs an analysis without storing any data, just shows analyzed video playback to the user
+ * Updates the running average and the difference image of one span of pixels in a row of the current frame
  *
- * \param currentFrameNumber: The frame number we will be analyzing on this function call
+ * \param row: The row of the analyzed frame
+ * \param xStart: The first column of the span
+ * \param width: The number of pixels in the span
+ * \param flagRow: Scratch row of the calling band, used by MotionKernel::updateRow()
+ *
+ * \return Returns nothing
+ *
+ * \see MotionKernel for the per row update
+ */
+void OpenCV::computeDifferenceRow(int row, int xStart, int width, unsigned char* flagRow)
+{
+    int channels = _analyzedFrame->channels();
+
+    const unsigned char* frameRow = _analyzedFrame->ptr<unsigned char>(row) + xStart * channels;
+    unsigned char* maskRow = _differenceBetweenFrames.ptr<unsigned char>(row) + xStart;
+
+    //if this is the first frame to analyze, or first frame after an edit point, set our current frame average to it,
+    //else update the average frame motion and find the pixels that changed
+    if(_isFixedPointBackground == true)
+    {
+        unsigned short* averageRow = _movingAverage.ptr<unsigned short>(row) + xStart * channels;
+
+        if(_isLumaAnalysis == true)
+        {
+            if(_isEditFrame == true)
+                MotionKernel::resetLumaRow(frameRow, averageRow, maskRow, width);
+            else
+                MotionKernel::updateLumaRow(frameRow, averageRow, maskRow, width, _motionSensitivity);
+        }
+        else
+        {
+            if(_isEditFrame == true)
+                MotionKernel::resetRow(frameRow, averageRow, maskRow, width);
+            else
+                MotionKernel::updateRow(frameRow, averageRow, maskRow, flagRow, width, _motionSensitivity);
+        }
+    }
+    else
+    {
+        float* averageRow = _movingAverage.ptr<float>(row) + xStart * channels;
+
+        if(_isLumaAnalysis == true)
+        {
+            if(_isEditFrame == true)
+                MotionKernel::resetLumaRow(frameRow, averageRow, maskRow, width);
+            else
+                MotionKernel::updateLumaRow(frameRow, averageRow, maskRow, width, _motionSensitivity);
+        }
+        else
+        {
+            if(_isEditFrame == true)
+                MotionKernel::resetRow(frameRow, averageRow, maskRow, width);
+            else
+                MotionKernel::updateRow(frameRow, averageRow, maskRow, flagRow, width, _motionSensitivity);
+        }
+    }
+}
+
+/*!
+ * Analyzes a single decoded video frame and records every region that passes its threshold. Frames that pass a threshold
+ * while images are output get their changed pixels and regions drawn onto a copy, no other frame is drawn on. Does not
+ * touch the video stream, so frames can be decoded on another thread
+ *
+ * \param frame: The video frame to analyze, changed pixels are drawn onto a copy of it
+ * \param lumaFrame: The luma of the frame from getLumaFrameForAnalysis(), analyzed instead of the frame with luma analysis
+ * \param videoFramePosition: The video stream position the frame was read at, used to draw its video time
+ * \param frameNumber: The frame number of the frame, stored with each region that passes its threshold
  * \param regionCoordinates: A vector containing one integer vector for every region. Each internal vector hold X1, Y1, X2 and Y2 coordinates of a region
+ * \param videoInfo: Holds general video data and non region specific analysis data that will be output to a file later
  * \param indexedRegionOutput: Holds analysis output data for each region selected by the user
  * \param isEditFrame: Determines if the running frame average should be reset if is is eitehr the beginning of the video, or a new edit point
  *
- * \return Returns nothing, currentFrameNumber is incremented and passed back by reference
+ * \return Returns true if at least one region passed its threshold. If images are output, the drawn frame is then available
+ *         from getFrameWithDifference()
  *
- * \see DetailAnalyzer for loop structure that calls this function
+ * \see Analyzer for the pipeline that calls this function
  */
-void OpenCV::previewAnalysis(int &currentFrameNumber, std::vector < std::vector<int> > &regionCoordinates, std::vector <regionData> &indexedRegionOutput, bool isEditFrame)
+bool OpenCV::analyzeFrame(const cv::Mat &frame, const cv::Mat &lumaFrame, double videoFramePosition, int frameNumber, std::vector < std::vector<int> > &regionCoordinates, generalVideoData &videoInfo,
+                          std::vector <regionData> &indexedRegionOutput, bool isEditFrame)
 {
-    _greyDiffImage = cvCreateImage(cvSize(_frameWidth,_frameHeight), IPL_DEPTH_8U, 1);
-    _greyDiffImageLessThan = cvCreateImage(cvSize(_frameWidth,_frameHeight), IPL_DEPTH_8U, 1);
+    _currentFrameNumber = frameNumber;
+
+    //the frame the running average is updated with, the luma alone skips two thirds of the work
+    const cv::Mat &analyzedFrame = (_isLumaAnalysis == true) ? lumaFrame : frame;
 
-    //the matrix variables that will be used to store, parse through, and
-    //output analysis difference data
-    Mat currentVideoFrame;
-    Mat currentFrameWithDifference;
+    if(_analysisScale > 1)
+    {
+        BV_TIME_STAGE(_stageProfiler, StageProfiler::PREPARE);
 
+        //scale the frame down before any work is done on it, averaging the pixels each analyzed pixel covers
+        resize(analyzedFrame, _scaledVideoFrame, _scaledVideoFrame.size(), 0, 0, CV_INTER_AREA);
+    }
 
-    //if this is the first frame to analyze, get a our first video frame, and set our current frame average to it
-    if(isEditFrame == true)
+    //build the difference image and count the changed pixels that fall inside each region
+    computeDifferenceImage((_analysisScale > 1) ? _scaledVideoFrame : analyzedFrame, isEditFrame);
+
+    //flag showing that at least one region had activity higher than its threshHold
+    bool atLeastOneThreshHoldPassed = false;
+
+    //loop through data for each region after a frame has been analyzed
+    for(unsigned int regionNum = 0; regionNum < regionCoordinates.size(); regionNum++)
     {
-        //get the first frame from video, or hte first after an edit point
-        getFrameForAnalysis(currentVideoFrame);
+        //check each region to see if it has passed its threshHold on this frame, if it has,
+        //collect its data for results to use later
+        if(_regionEngine.isRegionOverThreshold(regionNum))
+        {
+            atLeastOneThreshHoldPassed = true;
 
-        //copy the current frame to this difference frame, which will have all pixels that change between frames drawn onto it
-        currentVideoFrame.copyTo(currentFrameWithDifference);
+            indexedRegionOutput[regionNum].totalFramesOverThreshHold++;
+
+            frameData tempFrameData;
+            tempFrameData.frameNumber = frameNumber;
+
+            //report changed pixels in full resolution pixels, whatever scale the frame was analyzed at
+            tempFrameData.totalDifferentPixels = _regionEngine.getPixelChanges(regionNum) * _analysisScale * _analysisScale;
+            getFormattedVideoTime(tempFrameData.hourFrameAppears, tempFrameData.minuteFrameAppears, tempFrameData.secondFrameAppears, frameNumber, _frameRate);
+
+            indexedRegionOutput[regionNum].framesOverThreshHold.push_back(tempFrameData);
+        }
 
-        //convert first image to iplImage for analysis
-        _currentColorImage = cvCloneImage(&(IplImage)currentVideoFrame);//ignore this compiler warning
-        _differenceIpl = cvCloneImage(_currentColorImage);
-        _differenceIplLessThan = cvCloneImage(_currentColorImage);
-        _tempIpl = cvCloneImage(_currentColorImage);
-        cvConvertScale(_currentColorImage, _movingAverage, 1.0, 0.0);
     }
-    else //else get the next frame we are analyzing in the video, and update the average frame motion
+
+    //if at least one region passed its threshold, the caller outputs the copy of the current frame
+    //containing its regions/difference pixels as a .JPG
+    if(atLeastOneThreshHoldPassed == true)
     {
-        getFrameForAnalysis(currentVideoFrame);
-        currentVideoFrame.copyTo(currentFrameWithDifference);
-        _currentColorImage = cvCloneImage(&(IplImage)currentVideoFrame);//ignore this compiler warning
-        _differenceIpl = cvCloneImage(_currentColorImage);
-        _differenceIplLessThan = cvCloneImage(_currentColorImage);
-        _tempIpl = cvCloneImage(_currentColorImage);
+        videoInfo.totalFramesPastThreshHold++;
+
+        //only frames that will be saved are drawn on, most frames pass no threshold and are never looked at
+        if(_isOutputingImages == true)
+        {
+            BV_TIME_STAGE(_stageProfiler, StageProfiler::OVERLAY);
 
-        cvRunningAvg(_currentColorImage, _movingAverage, _motionSensitivity, NULL);
+            drawFrameWithDifference(frame, regionCoordinates, videoFramePosition, _analysisBounds.x, _analysisBounds.y,
+                                    _analysisBounds.x + _analysisBounds.width, _analysisBounds.y + _analysisBounds.height);
+        }
     }
 
-    //Convert the scale of the moving average.
-    cvConvertScale(_movingAverage, _tempIpl, 1.0, 0.0);
+    //reset pixel differences found in each region, and set previous pixel differences found for next frame analysis
+    _regionEngine.finishFrame();
 
-    //Minus the current frame from the moving average, leaving only the difference pixels
-    compare((Mat)_currentColorImage, ((Mat)_tempIpl + 100), (Mat)_differenceIpl, CMP_GT);
-    compare((Mat)_currentColorImage, ((Mat)_tempIpl - 100), (Mat)_differenceIplLessThan, CMP_LT);
+    //update the frame buffer pool debug counter
+    countFrameBufferAllocations();
 
-    //Convert the difference image to grayscale.
-    cvCvtColor(_differenceIpl, _greyDiffImage, CV_RGB2GRAY);
-    cvCvtColor(_differenceIplLessThan, _greyDiffImageLessThan, CV_RGB2GRAY);
+    return atLeastOneThreshHoldPassed;
+}
 
-    //Convert the grayscale difference image to black and white.
-    cvThreshold(_greyDiffImage, _greyDiffImage, 70, 255, CV_THRESH_BINARY);
-    cvThreshold(_greyDiffImageLessThan, _greyDiffImageLessThan, 70, 255, CV_THRESH_BINARY);
+/*!
+ * Draws a frame's changed pixels, its region rectangles, the motion rectangles of the regions that passed their
+ * threshold and its video time onto a copy of the frame. Must be called before the region engine finishes the frame
+ *
+ * \param frame: The video frame that was analyzed
+ * \param regionCoordinates: A vector containing one integer vector for every region. Each internal vector hold X1, Y1, X2 and Y2 coordinates of a region
+ * \param videoFramePosition: The video stream position the frame was read at, used to draw its video time
+ * \param xStart: The first column of the analyzed frame whose changed pixels are drawn
+ * \param yStart: The first row of the analyzed frame whose changed pixels are drawn
+ * \param xEnd: One past the last column of the analyzed frame whose changed pixels are drawn
+ * \param yEnd: One past the last row of the analyzed frame whose changed pixels are drawn
+ *
+ * \return Returns nothing, the drawn frame is stored in _currentFrameWithDifference
+ */
+void OpenCV::drawFrameWithDifference(const cv::Mat &frame, std::vector < std::vector<int> > &regionCoordinates, double videoFramePosition,
+                                     int xStart, int yStart, int xEnd, int yEnd)
+{
+    //copy the current frame to this difference frame, which will have all pixels that change between frames drawn onto it
+    frame.copyTo(_currentFrameWithDifference);
 
-    //copy iplImage difference to a matrix format image for editing and collecting data
-    _differenceBetweenFrames = cvCloneImage(_greyDiffImage);
-    _differenceBetweenFramesLessThan = cvCloneImage(_greyDiffImageLessThan);
+    //build a full resolution mask of the changed pixels in the analyzed area, as large as they are drawn
+    _overlayMask.setTo(Scalar(0));
 
-    //check every pixel in the current frame for changes
-    for(int i = 0; i < _frameHeight; i++)
+    if(xEnd > xStart && yEnd > yStart)
     {
-        const unsigned char* currentRow = _differenceBetweenFrames.ptr<unsigned char>(i);
-        const unsigned char* currentRowLessThan = _differenceBetweenFrames.ptr<unsigned char>(i);
+        Mat changedPixels(_differenceBetweenFrames, Rect(xStart, yStart, xEnd - xStart, yEnd - yStart));
 
-        for(int j = 0; j < _frameWidth; j++)
+        if(_analysisScale > 1)
         {
-            //when a difference is detected
-            if(currentRow[j] != 0 && currentRowLessThan != 0)
-            {
-                //draw the pixel changed detected to a copy of the current image
-                drawDifferencePixelOnFrame(j, j, i, currentFrameWithDifference);
+            //a scaled down pixel covers a block of the full frame, the analysis size is rounded down so the blocks always fit
+            Mat changedBlocks(_overlayMask, Rect(xStart * _analysisScale, yStart * _analysisScale,
+                                                 (xEnd - xStart) * _analysisScale, (yEnd - yStart) * _analysisScale));
 
-                //find out which regions the change occured in
-                evaluateRegionalChanges(j, i, _regionPixelChanges, regionCoordinates);
-            }
+            resize(changedPixels, changedBlocks, changedBlocks.size(), 0, 0, INTER_NEAREST);
+        }
+        else
+        {
+            //grow each changed pixel by the round brush, the shape a line of _pixelSize thickness would draw
+            Mat changedArea(_overlayMask, Rect(xStart, yStart, xEnd - xStart, yEnd - yStart));
 
+            changedPixels.copyTo(changedArea);
+            dilate(_overlayMask, _overlayMask, _overlayBrush);
         }
+    }
+
+    //draw every changed pixel in red in one pass
+    _currentFrameWithDifference.setTo(CV_RGB(255, 0, 0), _overlayMask);
+
+    for(unsigned int regionNum = 0; regionNum < regionCoordinates.size(); regionNum++)
+    {
+        //draw region rectangles onto image
+        drawRegionRectangle(regionCoordinates[regionNum][0], regionCoordinates[regionNum][1], regionCoordinates[regionNum][2], regionCoordinates[regionNum][3], regionNum, _currentFrameWithDifference);
+
+        //draw over other rectangle when motion past threshold in region detected
+        if(_regionEngine.isRegionOverThreshold(regionNum))
+        {
+            drawMotionRegionRectangle(regionCoordinates[regionNum][0], regionCoordinates[regionNum][1], regionCoordinates[regionNum][2], regionCoordinates[regionNum][3], regionNum, _currentFrameWithDifference);
+        }
+    }
+
+    //draw current video time onto this frame
+    drawTimeOnToImage(_currentFrameWithDifference, videoFramePosition);
+}
+
+/*!
+ * Get function for the copy of the last analyzed frame with its changed pixels, regions and video time drawn onto it
+ *
+ * \return Returns the drawn frame. Only frames that passed a threshold while images are output are drawn, it is
+ * overwritten by the next frame that is
+ */
+const cv::Mat& OpenCV::getFrameWithDifference()
+{
+    return _currentFrameWithDifference;
+}
+
+/*!
+ * Get function for the changed pixels of a region on the last analyzed frame, whether it passed its threshold or not
+ *
+ * \param regionNumber: The region to get the changed pixels of
+ *
+ * \return Returns the number of changed pixels in full resolution pixels, whatever scale the frame was analyzed at
+ */
+int OpenCV::getLastFramePixelChanges(int regionNumber)
+{
+    return _regionEngine.getPreviousPixelChanges(regionNumber) * _analysisScale * _analysisScale;
+}
+
+/*!
+ * Get function for the image output option
+ *
+ * \return Returns true if frames that pass a threshold should be saved as .JPG files
+ */
+bool OpenCV::isOutputingImages()
+{
+    return _isOutputingImages;
+}
+
+/*!
+ * Get function for the output directory of saved images
+ *
+ * \return Returns the output path set by initializeStartFrameAndFileName()
+ */
+std::string OpenCV::getOutputFilePath()
+{
+    return _outputFilePath;
+}
+
+/*!
+ * Removes our avereage frame variable from memory, called from our analyze function when analysis is complete
+ */
+void OpenCV::deallocateMovingAverageFrame()
+{
+    _movingAverage.release();
+    recordFrameBufferAddresses();
+}
 
+/*!
+ * Copies the state carried from one frame to the next, the running average and each region's changed pixels, so the
+ * analysis can be checkpointed
+ *
+ * \param movingAverage: Receives a copy of the running average
+ * \param previousFramePixelChanges: Receives the changed pixels of each region on the last analyzed frame
+ *
+ * \return Returns nothing
+ */
+void OpenCV::copyAnalysisState(cv::Mat &movingAverage, std::vector<int> &previousFramePixelChanges)
+{
+    _movingAverage.copyTo(movingAverage);
+    previousFramePixelChanges = _regionEngine.getPreviousFramePixelChanges();
+}
+
+/*!
+ * Puts back state copied by copyAnalysisState(), so the next frame is analyzed as if the analysis had not stopped.
+ * Must be called after initializeMovingAverageFrame() and the region setup of the analysis
+ *
+ * \param movingAverage: The running average to continue from
+ * \param previousFramePixelChanges: The changed pixels of each region on the last analyzed frame
+ *
+ * \return Returns false if the state does not fit this analysis' frame size, storage or regions, nothing is changed then
+ */
+bool OpenCV::restoreAnalysisState(const cv::Mat &movingAverage, const std::vector<int> &previousFramePixelChanges)
+{
+    if(movingAverage.size() != _movingAverage.size() || movingAverage.type() != _movingAverage.type() ||
+       previousFramePixelChanges.size() != (unsigned int)_regionEngine.getNumberOfRegions())
+    {
+        return false;
     }
 
+    //copy into the existing buffer, so the pooled buffer is not reallocated
+    movingAverage.copyTo(_movingAverage);
+    _regionEngine.setPreviousFramePixelChanges(previousFramePixelChanges);
+
+    return true;
+}
+
+/*!
+ * Preview analysis function. Runs an analysis without storing any data, just shows analyzed video playback to the user
+ *
+ * \param currentFrameNumber: The frame number we will be analyzing on this function call
+ * \param regionCoordinates: A vector containing one integer vector for every region. Each internal vector hold X1, Y1, X2 and Y2 coordinates of a region
+ * \param indexedRegionOutput: Holds analysis output data for each region selected by the user
+ * \param isEditFrame: Determines if the running frame average should be reset if is is eitehr the beginning of the video, or a new edit point
+ *
+ * \return Returns nothing, currentFrameNumber is incremented and passed back by reference
+ *
+ * \see DetailAnalyzer for loop structure that calls this function
+ */
+void OpenCV::previewAnalysis(int &currentFrameNumber, std::vector < std::vector<int> > &regionCoordinates, std::vector <regionData> &indexedRegionOutput, bool isEditFrame)
+{
+    _currentFrameNumber = currentFrameNumber;
+
+    //build the difference image and count the changed pixels that fall inside each region, preview only looks at the regions
+    getFrameForAnalysis(_currentVideoFrame);
+    computeDifferenceImage(_currentVideoFrame, isEditFrame);
+
     //flag showing that at least one region had activity higher than its threshHold
     bool atLeastOneThreshHoldPassed = false;
 
     //loop through data for each region after a frame has been analyzed
     for(unsigned int regionNum = 0; regionNum < regionCoordinates.size(); regionNum++)
     {
-        //draw region rectangles onto image
-        drawRegionRectangle(regionCoordinates[regionNum][0], regionCoordinates[regionNum][1], regionCoordinates[regionNum][2], regionCoordinates[regionNum][3], regionNum, currentFrameWithDifference);
-
         //check each region to see if it has passed its threshHold on this frame, if it has,
-        //collect its data for results to use later, and draw its region rectangle onto the output difference image
-        if( (_pixelsThatMustChangePerRegion[regionNum] <= _regionPixelChanges[regionNum]) && (_regionPixelChanges[regionNum] != _previousFramePixelChanges[regionNum]) && (_regionPixelChanges[regionNum] != 0) )
+        //collect its data for results to use later
+        if(_regionEngine.isRegionOverThreshold(regionNum))
         {
-            //draw over other rectangle when motion past threshold in region detected
-            drawMotionRegionRectangle(regionCoordinates[regionNum][0], regionCoordinates[regionNum][1], regionCoordinates[regionNum][2], regionCoordinates[regionNum][3], regionNum, currentFrameWithDifference);
-
             atLeastOneThreshHoldPassed = true;
 
             indexedRegionOutput[regionNum].totalFramesOverThreshHold++;
 
             frameData tempFrameData;
             tempFrameData.frameNumber = currentFrameNumber;
-            tempFrameData.totalDifferentPixels = _regionPixelChanges[regionNum];
+            tempFrameData.totalDifferentPixels = _regionEngine.getPixelChanges(regionNum);
             getFormattedVideoTime(tempFrameData.hourFrameAppears, tempFrameData.minuteFrameAppears, tempFrameData.secondFrameAppears, currentFrameNumber, _frameRate);
 
             indexedRegionOutput[regionNum].framesOverThreshHold.push_back(tempFrameData);
         }
     }
 
-    //reset pixel differences found in each region, and set previous pixel differences found for next frame analysis
-    for(unsigned int regionNumber = 0; regionNumber < _regionPixelChanges.size(); regionNumber++)
-    {
-        _previousFramePixelChanges[regionNumber] = _regionPixelChanges[regionNumber];
-        _regionPixelChanges[regionNumber] = 0;
-    }
+    //every preview frame is shown, so every frame is drawn on
+    drawFrameWithDifference(_currentVideoFrame, regionCoordinates, getCurrentVideoFrame(), _analysisBounds.x, _analysisBounds.y,
+                            _analysisBounds.x + _analysisBounds.width, _analysisBounds.y + _analysisBounds.height);
 
-    //the current video time onto the frame
-    drawTimeOnToImage(currentFrameWithDifference);
+    //reset pixel differences found in each region, and set previous pixel differences found for next frame analysis
+    _regionEngine.finishFrame();
 
     //resize preview frame if applicable
     if(_previewSizeX != 0)
     {
-        Mat resizedFrame = resizePreviewImage(currentFrameWithDifference);
+        resize(_currentFrameWithDifference, _resizedPreviewFrame, Size(_previewSizeX, _previewSizeY), 0, 0, CV_INTER_LINEAR);
 
         //show image in preview window
-        imshow("Preview Analyze", resizedFrame);
+        imshow("Preview Analyze", _resizedPreviewFrame);
     }
     else
     {
         //show image in preview window
-        imshow("Preview Analyze", currentFrameWithDifference);
+        imshow("Preview Analyze", _currentFrameWithDifference);
     }
 
+    //update the frame buffer pool debug counter
+    countFrameBufferAllocations();
+
     //update image, and show that image for a number of milliseconds equal to the _previewPlaybackSpeed
     waitKey(_previewPlaybackSpeed);
 
     //increment frame number, reset threshHold check(, on second look, threshHold reset looks unneeded syntactically)
     currentFrameNumber++;
     atLeastOneThreshHoldPassed = false;
-
-    //deallocate all currently allocated analysis frames in memory
-    cvReleaseImage(&_differenceIpl);
-    cvReleaseImage(&_differenceIplLessThan);
-    cvReleaseImage(&_greyDiffImage);
-    cvReleaseImage(&_greyDiffImageLessThan);
-    cvReleaseImage(&_currentColorImage);
-    cvReleaseImage(&_tempIpl);
-    _differenceBetweenFrames.deallocate();
-    _differenceBetweenFramesLessThan.deallocate();
 }
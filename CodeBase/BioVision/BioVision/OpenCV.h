@@ -22,9 +22,19 @@
 #include "opencv2/opencv.hpp"
 #include "opencv2/core/core.hpp"
 #include "QString"
+#include "RegionEngine.h"
+#include "TimeGlyphCache.h"
+#include "VideoIndex.h"
+#include "StageProfiler.h"
+#include <QThreadPool>
+#include <QSemaphore>
+
+class DifferenceImageBand;
 
 class OpenCV
 {
+    //runs one band of computeDifferenceImage() on the band thread pool
+    friend class DifferenceImageBand;
 
 public:
     OpenCV();
@@ -57,7 +67,7 @@ public:
         int totalDifferentPixels;
     };
 
-    //a vector of 10 regionsData structres will be used to store our analysis data and
+    //a vector with one regionsData structure per region will be used to store our analysis data and
     //pass it back to region results.
     struct regionData
     {
@@ -81,8 +91,13 @@ public:
         std::string colorName;
     };
 
-    //array of 11 different region colors
-    regionColors colorList[11];
+    //array of 10 different region colors, regions past the tenth reuse them in order
+    enum { NUMBER_OF_REGION_COLORS = 10 };
+    regionColors colorList[NUMBER_OF_REGION_COLORS];
+
+    regionColors getRegionColor(int regionNumber);
+
+    std::vector <regionData> createRegionData(std::vector < std::vector<int> > &regionCoordinates, std::vector<float> &percentOfImageChange);
 
     bool openVideoFile(std::string videoFilePath);
 
@@ -90,6 +105,8 @@ public:
 
     void collectVideoMetaData();
 
+    void setVideoFormat(double frameWidth, double frameHeight, double frameRate);
+
     void getFormattedVideoTime(int &hours, int &minutes, int &seconds, double currentVideoFrame, double frameRate);
 
     double getCurrentVideoFrame();
@@ -100,6 +117,8 @@ public:
 
     void setCurrentVideoTime(double newVideoTime);
 
+    bool isEndOfVideo(int frameNumber);
+
     //simple get functions
     double getNumberOfVideoFrames();
     double getVideoFrameRate();
@@ -108,11 +127,17 @@ public:
 
     void getFrameForAnalysis(cv::Mat& frameToAnalize);
 
+    bool skipFrameForAnalysis();
+
+    int skipToVideoFrame(int currentFrameNumber, int targetFrameNumber);
+
+    void getLumaFrameForAnalysis(const cv::Mat &frame, cv::Mat &lumaFrame);
+
     void setPreviewWindowOptions(int sizeSelected, int speedSelected);
 
     cv::Mat resizePreviewImage(cv::Mat previewImage);
 
-    void setAnalyzeOptions(bool isOutputImage, int imageSizeSelected);
+    void setAnalyzeOptions(bool isOutputImage, int imageSizeSelected, int jpegQuality);
 
     void setFrameAnalysisSize(std::vector < std::vector<int> > regionCoordinates, bool isFullFrameAnalysis);
 
@@ -130,27 +155,59 @@ public:
 
     void drawMotionRegionRectangle(int startPointX, int startPointY, int endPointX, int endPointY, int regionNumber, cv::Mat &differenceImage);
 
-    void evaluateRegionalChanges(int xPosition, int yPosition, std::vector <int> &regionPixleChanges, std::vector < std::vector<int> > &regionCoordinates);
-
-    void drawDifferencePixelOnFrame(int startPointX, int endPointX, int yAxisPoint, cv::Mat &currentImageCopy);
-
-    void drawTimeOnToImage(cv::Mat &currentImage);
+    void drawTimeOnToImage(cv::Mat &currentImage, double videoFramePosition);
 
     void initializeStartFrameAndFileName(std::string outFilePath, std::string vidFileName, double startFrame);
 
-    void initializePixelChangeVariables(int numberOfRegions, std::vector <OpenCV::regionData> &indexedRegionOutput, float percentOfImageChange[10], std::vector<int>* regionWidths, std::vector<int>* regionHeights);
+    void initializePixelChangeVariables(std::vector < std::vector<int> > &regionCoordinates, std::vector <OpenCV::regionData> &indexedRegionOutput, std::vector<float> &percentOfImageChange, std::vector<int>* regionWidths, std::vector<int>* regionHeights);
 
     void initializeFrameSizeSensitivityAndDrawSize(float userMotionSensitivity);
 
+    static float getRunningAverageWeight(float userSelectedSensitivity);
+
+    void setFrameStride(int frameStride);
+
+    void setAnalysisScale(int analysisScale);
+
+    int getAnalysisScale();
+
     void initializeMovingAverageFrame();
 
+    void setFixedPointBackground(bool isFixedPointBackground);
+
+    void setLumaAnalysis(bool isLumaAnalysis);
+
+    bool isLumaAnalysis();
+
+    void setAnalysisThreadCount(int threadCount);
+
+    int getAnalysisThreadCount();
+
     void deallocateFramesOnError();
 
-    QString analyzeCurrentFrame(int &currentFrameNumber, std::vector < std::vector<int> > &regionCoordinates, OpenCV::generalVideoData &videoInfo,
-                             std::vector <OpenCV::regionData> &indexedRegionOutput, bool isEditFrame);
+    int getFrameBufferAllocationsLastFrame();
+
+    void setStageProfiler(StageProfiler* stageProfiler);
+
+    StageProfiler* getStageProfiler();
+
+    bool analyzeFrame(const cv::Mat &frame, const cv::Mat &lumaFrame, double videoFramePosition, int frameNumber, std::vector < std::vector<int> > &regionCoordinates,
+                      OpenCV::generalVideoData &videoInfo, std::vector <OpenCV::regionData> &indexedRegionOutput, bool isEditFrame);
+
+    const cv::Mat& getFrameWithDifference();
+
+    int getLastFramePixelChanges(int regionNumber);
+
+    bool isOutputingImages();
+
+    std::string getOutputFilePath();
 
     void deallocateMovingAverageFrame();
 
+    void copyAnalysisState(cv::Mat &movingAverage, std::vector<int> &previousFramePixelChanges);
+
+    bool restoreAnalysisState(const cv::Mat &movingAverage, const std::vector<int> &previousFramePixelChanges);
+
     void previewAnalysis(int &currentFrameNumber, std::vector < std::vector<int> > &regionCoordinates, std::vector <regionData> &indexedRegionOutput, bool isEditFrame);
 
 private:
@@ -158,6 +215,9 @@ private:
     //VideoCapture openCV object, used to call all openCV video analysis functions
     cv::VideoCapture vidStream;
 
+    //exact frame count of the open video, empty if the video has no index
+    VideoIndex _videoIndex;
+
     //unchanging video attributes
     double _numberOfFramesInVideo;
     double _frameRate;
@@ -172,11 +232,10 @@ private:
     std::string _outputFilePath;
     std::string _videoFileName;
     double _analysisStartFrame;
-    std::vector <int> _regionPixelChanges;
-    int _previousFramePixelChanges[10];
     CvSize _imgSize;
-    int _pixelsThatMustChangePerRegion[10];
-    IplImage* _movingAverage;
+
+    //region table and per region changed pixel counting
+    RegionEngine _regionEngine;
 
     int _previewPlaybackSpeed;
     int _previewSizeX;
@@ -185,11 +244,25 @@ private:
     bool _isOutputingImages;
     int _outputImageSizeX;
     int _outputImageSizeY;
+    int _jpegQuality;
+    int _frameStride;
+
+    //frames are scaled down by this factor in width and height before they are analyzed, 1, 2, 4 or 8
+    enum { MAX_ANALYSIS_SCALE = 8 };
+    int _analysisScale;
+
+    //running average stored as 16 bit fixed point instead of 32 bit floats
+    bool _isFixedPointBackground;
+
+    //frames are analyzed on their single channel luma instead of their three color channels
+    bool _isLumaAnalysis;
 
-    int _xStartOfFrameAnalysisArea;
-    int _yStartOfFrameAnalysisArea;
-    int _xEndOfFrameAnalysisArea;
-    int _yEndOfFrameAnalysisArea;
+    //analyze the whole frame instead of only the pixels covered by regions
+    bool _isFullFrameAnalysis;
+
+    //pixels of the analyzed frame that are processed, as rectangles in row order that never share a pixel, and their bounding box
+    std::vector<cv::Rect> _analysisAreas;
+    cv::Rect _analysisBounds;
 
     //variables for drawing video times onto frame
     int _x1Time;
@@ -206,16 +279,66 @@ private:
     int _offsetMotionRect;
     int _pixelSize;
 
-    //variables that will hold frame data during an analysis
-    IplImage* _differenceIpl;
-    IplImage* _differenceIplLessThan;
-    IplImage* _greyDiffImage;
-    IplImage* _greyDiffImageLessThan;
-    IplImage* _currentColorImage;
-    IplImage* _tempIpl;
+    //round brush of _pixelSize that changed pixels are grown by, and the time glyphs, both set up once per resolution tier
+    cv::Mat _overlayBrush;
+    TimeGlyphCache _timeGlyphs;
 
+    //persistent frame buffer pool. Allocated once per analysis by initializeFrameSizeSensitivityAndDrawSize() and
+    //initializeMovingAverageFrame(), then reused by every analyzed frame
+    cv::Mat _currentVideoFrame;
+    cv::Mat _currentFrameWithDifference;
+    cv::Mat _movingAverage;
     cv::Mat _differenceBetweenFrames;
-    cv::Mat _differenceBetweenFramesLessThan;
+    cv::Mat _motionFlagRow;
+    cv::Mat _resizedPreviewFrame;
+    cv::Mat _scaledVideoFrame;
+    cv::Mat _overlayMask;
+
+    //debug data used to count pooled buffers that were allocated during a frame
+    enum { NUMBER_OF_POOLED_FRAME_BUFFERS = 8 };
+    const uchar* _frameBufferAddresses[NUMBER_OF_POOLED_FRAME_BUFFERS];
+    int _frameBufferAllocationsLastFrame;
+
+    //frame bands. Every frame is split into one horizontal band per analysis thread, band 0 runs on the analysis thread
+    //and the rest run on _bandThreadPool. The bands are fixed for the whole analysis so results never depend on timing
+    int _analysisThreadCount;
+    std::vector<int> _bandStartRows;
+    std::vector<DifferenceImageBand*> _bandWorkers;
+    QThreadPool _bandThreadPool;
+    QSemaphore _bandsFinished;
+
+    //frame being processed by the bands
+    const cv::Mat* _analyzedFrame;
+    bool _isEditFrame;
+
+    //stage times of each band of the current frame, added to the stage profiler once every band is done
+    struct bandTiming
+    {
+        int64 motionStartTicks;
+        int64 countingStartTicks;
+        int64 countingEndTicks;
+        Qt::HANDLE threadId;
+    };
+
+    std::vector<bandTiming> _bandTimings;
+
+    //times the stages of each frame, NULL when the analysis is not profiled
+    StageProfiler* _stageProfiler;
+
+    cv::Size getAnalysisFrameSize();
+    int toAnalysisCoordinate(int fullFrameCoordinate, int analysisFrameSize);
+    void allocateFrameBufferPool();
+    void releaseFrameBufferPool();
+    void recordFrameBufferAddresses();
+    int countFrameBufferAllocations();
+    void allocateFrameBands();
+    void releaseFrameBands();
+    void setAnalysisAreas(std::vector < std::vector<int> > &regionCoordinates, std::vector < std::vector<int> > &analysisRegionCoordinates, cv::Size analysisSize);
+    void computeDifferenceImage(const cv::Mat &frame, bool isEditFrame);
+    void computeDifferenceImageBand(int band);
+    void computeDifferenceRow(int row, int xStart, int width, unsigned char* flagRow);
+    void drawFrameWithDifference(const cv::Mat &frame, std::vector < std::vector<int> > &regionCoordinates, double videoFramePosition,
+                                 int xStart, int yStart, int xEnd, int yEnd);
 
     std::string _randomImageNameAddition;
 };
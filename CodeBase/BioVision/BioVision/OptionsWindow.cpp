@@ -24,6 +24,31 @@ OptionsWindow::OptionsWindow(WindowManager *windowManager, QWidget *parent) :
 
     ui->workspace->setText(_oldWorkspace);
 
+    // 0 lets each analysis use one thread per processor core.
+    ui->analysisThreads->setValue(_windowManager->getAnalysisThreadCount());
+
+    // 1 analyzes each video from start to finish, 0 splits it into one chunk per processor core.
+    ui->analysisChunks->setValue(_windowManager->getAnalysisChunkCount());
+
+    ui->jpegQuality->setValue(_windowManager->getJpegQuality());
+    ui->imageMemoryBudget->setValue(_windowManager->getImageMemoryBudget());
+
+    // 1 analyzes every frame, larger values screen every Nth frame and go back over the frames around each event.
+    ui->frameStride->setValue(_windowManager->getFrameStride());
+
+    // the scale is a power of two, item n of the list analyzes frames at 1/2^n of their resolution.
+    int analysisScaleIndex = 0;
+    while((2 << analysisScaleIndex) <= _windowManager->getAnalysisScale() && analysisScaleIndex < ui->analysisScale->count() - 1)
+        analysisScaleIndex++;
+    ui->analysisScale->setCurrentIndex(analysisScaleIndex);
+
+    ui->fixedPointBackground->setChecked(_windowManager->isFixedPointBackground());
+    ui->lumaAnalysis->setChecked(_windowManager->isLumaAnalysis());
+    ui->recordTimeline->setChecked(_windowManager->isRecordingTimeline());
+
+    // 0 runs one background job per processor core.
+    ui->concurrentJobs->setValue(_windowManager->getConcurrentJobCount());
+
     // Save the data.
     connect(ui->buttonBox, SIGNAL(accepted()), this, SLOT(saveSlot()));
 
@@ -44,7 +69,8 @@ OptionsWindow::~OptionsWindow()
  *
  * Checks to make sure it is not an empty string, then checks to be sure that the directory the user has input exists,
  * and then does a final prompt to make sure the user wants to change directories (this will prevent the old projects
- * from auto-loading).
+ * from auto-loading).  The prompt is skipped if the workspace did not change.  The analysis and image output options
+ * are saved along with the workspace.
  */
 void OptionsWindow::saveSlot()
 {
@@ -60,7 +86,16 @@ void OptionsWindow::saveSlot()
     else
     {
         QDir dir(ui->workspace->text());
-        if(dir.exists())
+        if(dir.exists() && ui->workspace->text() == _oldWorkspace)
+        {
+            // The workspace did not change, only the analysis options need saving.
+            _windowManager->saveAnalysisOptions(ui->analysisThreads->value(), ui->analysisChunks->value(), ui->jpegQuality->value(),
+                                                ui->imageMemoryBudget->value(), ui->frameStride->value(),
+                                                1 << ui->analysisScale->currentIndex(), ui->fixedPointBackground->isChecked(),
+                                                ui->lumaAnalysis->isChecked(), ui->recordTimeline->isChecked(), ui->concurrentJobs->value());
+            this->accept();
+        }
+        else if(dir.exists())
         {
             QMessageBox msg;
             msg.setStandardButtons(QMessageBox::Ok | QMessageBox::Cancel);
@@ -73,6 +108,11 @@ void OptionsWindow::saveSlot()
                 case QMessageBox::Ok:
                     // We want to overwrite the workspace.
                     _windowManager->saveOptions(ui->workspace->text());
+                    _windowManager->saveAnalysisOptions(ui->analysisThreads->value(), ui->analysisChunks->value(), ui->jpegQuality->value(),
+                                                        ui->imageMemoryBudget->value(), ui->frameStride->value(),
+                                                        1 << ui->analysisScale->currentIndex(), ui->fixedPointBackground->isChecked(),
+                                                        ui->lumaAnalysis->isChecked(), ui->recordTimeline->isChecked(), ui->concurrentJobs->value());
+                    _oldWorkspace = ui->workspace->text();
                     this->accept();
                 break;
 
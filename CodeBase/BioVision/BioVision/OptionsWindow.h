@@ -1,7 +1,10 @@
 /*!
  * \class OptionsWindow displays a dialog for the user that allows them to change BioVision settings.
  *
- * The only setting that can be changed right now is the location of the user's workspace.
+ * The settings that can be changed right now are the location of the user's workspace, the number of threads each
+ * analysis splits its frames across, the number of chunks each analysis splits its video into, the quality and
+ * memory budget of the images saved by an analysis, the frame stride used to screen long videos, the resolution frames
+ * are analyzed at, how the running average background is stored, and whether frames are analyzed on their luma alone.
  */
 
 #ifndef OPTIONSWINDOW_H
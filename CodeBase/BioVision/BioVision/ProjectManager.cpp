@@ -11,6 +11,17 @@ using namespace std;
  */
 ProjectManager::ProjectManager()
 {
+    _isOptionsLoaded = false;
+    _analysisThreadCount = 0;
+    _analysisChunkCount = 1;
+    _jpegQuality = 95;
+    _imageMemoryBudget = 256;
+    _frameStride = 1;
+    _analysisScale = 1;
+    _isFixedPointBackground = false;
+    _isLumaAnalysis = false;
+    _isRecordingTimeline = false;
+    _concurrentJobCount = 0;
 }
 
 /*!
@@ -131,27 +142,6 @@ std::vector<BvRegion*>* ProjectManager::getAllRegions(QString projName, QString
     return &(currentVideo->_listOfRegions);
 }
 
-/*!
- * \brief ProjectManager::checkRegionSize Checks to see if the size of a list of regions is less than or equal to 10.
- *
- * \param projName The name of a project.
- * \param vidName The name of a video.
- * \return  True if the size is less than or equal to 10, false otherwise.
- */
-bool ProjectManager::checkRegionSize(QString projName, QString vidName)
-{
-    vector<BvRegion*>* regions = getAllRegions(projName, vidName);
-
-    if(regions->size()<10)
-    {
-        return true;
-    }
-    else
-    {
-        return false;
-    }
-}
-
 /*!
  * ProjectManager::addProject adds a new project to the projects vector, if that project has a unique name.
  *
@@ -1459,6 +1449,383 @@ void ProjectManager::setWorkspaceDirectory(QString workspacePath)
     out.close();
 }
 
+/*!
+ * \brief ProjectManager::getAnalysisThreadCount gets the number of threads each analysis splits its frames across.  The
+ * options are read from the options.txt file the first time one of them is requested.
+ *
+ * \return The number of analysis threads, 0 means one thread per processor core.
+ */
+int ProjectManager::getAnalysisThreadCount()
+{
+    if(_isOptionsLoaded == false)
+        loadOptions();
+
+    return _analysisThreadCount;
+}
+
+/*!
+ * \brief ProjectManager::setAnalysisThreadCount sets the number of threads each analysis splits its frames across, and
+ * writes the options back to the options.txt file.
+ *
+ * \param threadCount The number of analysis threads, 0 uses one thread per processor core.
+ */
+void ProjectManager::setAnalysisThreadCount(int threadCount)
+{
+    if(_isOptionsLoaded == false)
+        loadOptions();
+
+    if(threadCount < 0)
+        threadCount = 0;
+
+    _analysisThreadCount = threadCount;
+
+    saveOptions();
+}
+
+/*!
+ * \brief ProjectManager::getAnalysisChunkCount gets the number of chunks each analysis splits its video into.
+ *
+ * \return The number of analysis chunks, 1 analyzes the video from start to finish, 0 means one chunk per processor core.
+ */
+int ProjectManager::getAnalysisChunkCount()
+{
+    if(_isOptionsLoaded == false)
+        loadOptions();
+
+    return _analysisChunkCount;
+}
+
+/*!
+ * \brief ProjectManager::setAnalysisChunkCount sets the number of chunks each analysis splits its video into, and writes
+ * the options back to the options.txt file.
+ *
+ * \param chunkCount The number of analysis chunks, 0 uses one chunk per processor core.
+ */
+void ProjectManager::setAnalysisChunkCount(int chunkCount)
+{
+    if(_isOptionsLoaded == false)
+        loadOptions();
+
+    if(chunkCount < 0)
+        chunkCount = 0;
+
+    _analysisChunkCount = chunkCount;
+
+    saveOptions();
+}
+
+/*!
+ * \brief ProjectManager::getJpegQuality gets the quality of the images saved by an analysis.
+ *
+ * \return The JPEG quality, from 0 to 100.
+ */
+int ProjectManager::getJpegQuality()
+{
+    if(_isOptionsLoaded == false)
+        loadOptions();
+
+    return _jpegQuality;
+}
+
+/*!
+ * \brief ProjectManager::setJpegQuality sets the quality of the images saved by an analysis, and writes the options back
+ * to the options.txt file.
+ *
+ * \param jpegQuality The JPEG quality, from 0 to 100.
+ */
+void ProjectManager::setJpegQuality(int jpegQuality)
+{
+    if(_isOptionsLoaded == false)
+        loadOptions();
+
+    if(jpegQuality < 0)
+        jpegQuality = 0;
+    else if(jpegQuality > 100)
+        jpegQuality = 100;
+
+    _jpegQuality = jpegQuality;
+
+    saveOptions();
+}
+
+/*!
+ * \brief ProjectManager::getImageMemoryBudget gets the most memory that flagged frames waiting to be saved may use.
+ *
+ * \return The memory budget in megabytes.
+ */
+int ProjectManager::getImageMemoryBudget()
+{
+    if(_isOptionsLoaded == false)
+        loadOptions();
+
+    return _imageMemoryBudget;
+}
+
+/*!
+ * \brief ProjectManager::setImageMemoryBudget sets the most memory that flagged frames waiting to be saved may use, and
+ * writes the options back to the options.txt file.
+ *
+ * \param megabytes The memory budget in megabytes.
+ */
+void ProjectManager::setImageMemoryBudget(int megabytes)
+{
+    if(_isOptionsLoaded == false)
+        loadOptions();
+
+    if(megabytes < 0)
+        megabytes = 0;
+
+    _imageMemoryBudget = megabytes;
+
+    saveOptions();
+}
+
+/*!
+ * \brief ProjectManager::getFrameStride gets the number of video frames between two analyzed frames when screening.
+ *
+ * \return The frame stride, 1 analyzes every frame.
+ */
+int ProjectManager::getFrameStride()
+{
+    if(_isOptionsLoaded == false)
+        loadOptions();
+
+    return _frameStride;
+}
+
+/*!
+ * \brief ProjectManager::setFrameStride sets the number of video frames between two analyzed frames when screening, and
+ * writes the options back to the options.txt file.
+ *
+ * \param frameStride The frame stride, values below 1 analyze every frame.
+ */
+void ProjectManager::setFrameStride(int frameStride)
+{
+    if(_isOptionsLoaded == false)
+        loadOptions();
+
+    if(frameStride < 1)
+        frameStride = 1;
+
+    _frameStride = frameStride;
+
+    saveOptions();
+}
+
+/*!
+ * \brief ProjectManager::getAnalysisScale gets how many times smaller in width and height frames are analyzed at.
+ *
+ * \return The analysis scale, 1 analyzes frames at full resolution.
+ */
+int ProjectManager::getAnalysisScale()
+{
+    if(_isOptionsLoaded == false)
+        loadOptions();
+
+    return _analysisScale;
+}
+
+/*!
+ * \brief ProjectManager::setAnalysisScale sets how many times smaller in width and height frames are analyzed at, and
+ * writes the options back to the options.txt file.
+ *
+ * \param analysisScale The analysis scale, 1, 2, 4 or 8.  Values below 1 analyze frames at full resolution.
+ */
+void ProjectManager::setAnalysisScale(int analysisScale)
+{
+    if(_isOptionsLoaded == false)
+        loadOptions();
+
+    if(analysisScale < 1)
+        analysisScale = 1;
+
+    _analysisScale = analysisScale;
+
+    saveOptions();
+}
+
+/*!
+ * \brief ProjectManager::isFixedPointBackground gets whether the running average background is kept as 16 bit fixed
+ * point instead of 32 bit floats.
+ *
+ * \return True for the fixed point background.
+ */
+bool ProjectManager::isFixedPointBackground()
+{
+    if(_isOptionsLoaded == false)
+        loadOptions();
+
+    return _isFixedPointBackground;
+}
+
+/*!
+ * \brief ProjectManager::setFixedPointBackground sets whether the running average background is kept as 16 bit fixed
+ * point, and writes the options back to the options.txt file.
+ *
+ * \param isFixedPointBackground True for the fixed point background, false for 32 bit floats.
+ */
+void ProjectManager::setFixedPointBackground(bool isFixedPointBackground)
+{
+    if(_isOptionsLoaded == false)
+        loadOptions();
+
+    _isFixedPointBackground = isFixedPointBackground;
+
+    saveOptions();
+}
+
+/*!
+ * \brief ProjectManager::isLumaAnalysis gets whether frames are analyzed on their luma instead of their three color
+ * channels.
+ *
+ * \return True for luma analysis.
+ */
+bool ProjectManager::isLumaAnalysis()
+{
+    if(_isOptionsLoaded == false)
+        loadOptions();
+
+    return _isLumaAnalysis;
+}
+
+/*!
+ * \brief ProjectManager::setLumaAnalysis sets whether frames are analyzed on their luma, and writes the options back to
+ * the options.txt file.
+ *
+ * \param isLumaAnalysis True for luma analysis, false to analyze all three color channels.
+ */
+void ProjectManager::setLumaAnalysis(bool isLumaAnalysis)
+{
+    if(_isOptionsLoaded == false)
+        loadOptions();
+
+    _isLumaAnalysis = isLumaAnalysis;
+
+    saveOptions();
+}
+
+/*!
+ * \brief ProjectManager::isRecordingTimeline gets whether a timeline of each analysis' stages is recorded.
+ *
+ * \return True if the timeline is recorded.
+ */
+bool ProjectManager::isRecordingTimeline()
+{
+    if(_isOptionsLoaded == false)
+        loadOptions();
+
+    return _isRecordingTimeline;
+}
+
+/*!
+ * \brief ProjectManager::setRecordingTimeline sets whether a timeline of each analysis' stages is recorded and saved with
+ * the run, and writes the options back to the options.txt file.
+ *
+ * \param isRecordingTimeline True to record the timeline.
+ */
+void ProjectManager::setRecordingTimeline(bool isRecordingTimeline)
+{
+    if(_isOptionsLoaded == false)
+        loadOptions();
+
+    _isRecordingTimeline = isRecordingTimeline;
+
+    saveOptions();
+}
+
+/*!
+ * \brief ProjectManager::getConcurrentJobCount gets the most background jobs (analyses, video copies) that run at the
+ * same time.
+ *
+ * \return The most jobs that run at the same time, 0 for one per processor core.
+ */
+int ProjectManager::getConcurrentJobCount()
+{
+    if(_isOptionsLoaded == false)
+        loadOptions();
+
+    return _concurrentJobCount;
+}
+
+/*!
+ * \brief ProjectManager::setConcurrentJobCount sets the most background jobs that run at the same time, and writes the
+ * options back to the options.txt file.
+ *
+ * \param concurrentJobCount The most jobs that run at the same time, 0 for one per processor core.
+ */
+void ProjectManager::setConcurrentJobCount(int concurrentJobCount)
+{
+    if(_isOptionsLoaded == false)
+        loadOptions();
+
+    _concurrentJobCount = concurrentJobCount;
+
+    saveOptions();
+}
+
+/*!
+ * \brief ProjectManager::loadOptions reads the analysis options from options.txt.  Each line holds an option name and its
+ * value separated by a space.  Options missing from the file (or a missing file on the first run) keep their defaults.
+ */
+void ProjectManager::loadOptions()
+{
+    ifstream in;
+    in.open("options.txt");
+
+    std::string optionName;
+    int optionValue;
+
+    while(in >> optionName >> optionValue)
+    {
+        if(optionName == "analysisThreadCount" && optionValue >= 0)
+            _analysisThreadCount = optionValue;
+        else if(optionName == "analysisChunkCount" && optionValue >= 0)
+            _analysisChunkCount = optionValue;
+        else if(optionName == "jpegQuality" && optionValue >= 0 && optionValue <= 100)
+            _jpegQuality = optionValue;
+        else if(optionName == "imageMemoryBudget" && optionValue >= 0)
+            _imageMemoryBudget = optionValue;
+        else if(optionName == "frameStride" && optionValue >= 1)
+            _frameStride = optionValue;
+        else if(optionName == "analysisScale" && optionValue >= 1)
+            _analysisScale = optionValue;
+        else if(optionName == "fixedPointBackground")
+            _isFixedPointBackground = (optionValue != 0);
+        else if(optionName == "lumaAnalysis")
+            _isLumaAnalysis = (optionValue != 0);
+        else if(optionName == "recordTimeline")
+            _isRecordingTimeline = (optionValue != 0);
+        else if(optionName == "concurrentJobCount" && optionValue >= 0)
+            _concurrentJobCount = optionValue;
+    }
+
+    in.close();
+
+    _isOptionsLoaded = true;
+}
+
+/*!
+ * \brief ProjectManager::saveOptions writes every analysis option to options.txt, one option per line.
+ */
+void ProjectManager::saveOptions()
+{
+    ofstream out;
+    out.open("options.txt");
+
+    out<<"analysisThreadCount "<<_analysisThreadCount<<endl;
+    out<<"analysisChunkCount "<<_analysisChunkCount<<endl;
+    out<<"jpegQuality "<<_jpegQuality<<endl;
+    out<<"imageMemoryBudget "<<_imageMemoryBudget<<endl;
+    out<<"frameStride "<<_frameStride<<endl;
+    out<<"analysisScale "<<_analysisScale<<endl;
+    out<<"fixedPointBackground "<<(_isFixedPointBackground ? 1 : 0)<<endl;
+    out<<"lumaAnalysis "<<(_isLumaAnalysis ? 1 : 0)<<endl;
+    out<<"recordTimeline "<<(_isRecordingTimeline ? 1 : 0)<<endl;
+    out<<"concurrentJobCount "<<_concurrentJobCount<<endl;
+
+    out.close();
+}
+
 /*!
  * \brief ProjectManager::projectToDirectory, if the decision is 1 it takes the project name and adds it to the vector ProjectNames
  * which is used to output file paths to the settings.txt file. If the decision is anything else it removes said project from
@@ -1594,7 +1961,7 @@ bool ProjectManager::checkForRun(QString projName, QString vidName, QString runN
 /*!
  * \brief outPutResults has two paramaters that affect what happens, overwrite tells the function whether or not
  * it needs to delete files in an already existing folder. images tells whether or not images need to be output to the folder
- * based on these there are 4 cases that copy the results and excel document from the tmp folder into the results folder
+ * based on these there are 4 cases that copy the results and excel document from the analysis' output folder into the results folder
  * with the appropiate names.
  *
  * \param projName The name of the project that contains the video
@@ -1602,10 +1969,11 @@ bool ProjectManager::checkForRun(QString projName, QString vidName, QString runN
  * \param runName The folder name of the current run
  * \param overRight Determines if function should overwrite existing data
  * \param images Determines if function should ocopy image data
+ * \param outputDirectory The directory the analysis wrote its results and images to
  *
  * \return Returns bool value telling the calling function if the directory already exists
  */
-bool ProjectManager::outputResults(QString projName, QString vidName, QString runName, bool overwrite, bool images)
+bool ProjectManager::outputResults(QString projName, QString vidName, QString runName, bool overwrite, bool images, QString outputDirectory)
 {
     QString path = _workspace + "\\" + projName + "\\" +vidName;
     if(_isWindows == false)
@@ -1681,11 +2049,15 @@ bool ProjectManager::outputResults(QString projName, QString vidName, QString ru
         if(_isWindows == false)
             destination = _workspace + "/" + projName + "/" +vidName + "/" + runName + "/" + runName +".txt";
 
-        _resultsFile.copy("tmp/tmp.txt", destination);
+        _resultsFile.copy(outputDirectory + "/tmp.txt", destination);
+
+        // The timeline of the analysis, only there if the options asked for it.
+        if(QFile::exists(outputDirectory + "/trace.json"))
+            _resultsFile.copy(outputDirectory + "/trace.json", destination.left(destination.length() - 4) + "-trace.json");
 
         if(images == true)
         {
-            QDir dir("tmp");
+            QDir dir(outputDirectory);
             dir.setNameFilters(QStringList() << "*.jpg");
             dir.setFilter(QDir::Files);
 
@@ -1700,7 +2072,7 @@ bool ProjectManager::outputResults(QString projName, QString vidName, QString ru
                     copyTo = _workspace + "/" + projName + "/" +vidName + "/" + runName + "/" + files.first();
                 }
 
-                _temp.copy("tmp/"+files.first(),copyTo);
+                _temp.copy(outputDirectory + "/" + files.first(),copyTo);
                 files.removeFirst();
             }
         }
@@ -1726,11 +2098,15 @@ bool ProjectManager::outputResults(QString projName, QString vidName, QString ru
            destination = _workspace + "/" + projName + "/" +vidName + "/" + runName + "/" + runName +".txt";
        }
 
-       _resultsFile.copy("tmp/tmp.txt", destination);
+       _resultsFile.copy(outputDirectory + "/tmp.txt", destination);
+
+       // The timeline of the analysis, only there if the options asked for it.
+       if(QFile::exists(outputDirectory + "/trace.json"))
+           _resultsFile.copy(outputDirectory + "/trace.json", destination.left(destination.length() - 4) + "-trace.json");
 
        if(images == true)
        {
-           QDir dir("tmp");
+           QDir dir(outputDirectory);
 
            dir.setNameFilters(QStringList() << "*.jpg");
            dir.setFilter(QDir::Files);
@@ -1744,7 +2120,7 @@ bool ProjectManager::outputResults(QString projName, QString vidName, QString ru
                if(_isWindows == false)
                    copyTo = _workspace + "/" + projName + "/" +vidName + "/" + runName + "/" + files.first();
 
-               _temp.copy("tmp/"+files.first(),copyTo);
+               _temp.copy(outputDirectory + "/" + files.first(),copyTo);
                files.removeFirst();
            }
        }
@@ -1754,13 +2130,15 @@ bool ProjectManager::outputResults(QString projName, QString vidName, QString ru
 
 /*!
  * \brief ProjectManager::getSizeOfImages gets the total size of the images that will be copied (all of the images in
- * the tmp folder).
+ * the analysis' output folder).
+ *
+ * \param outputDirectory The directory the analysis wrote its images to.
  *
- * \return a QString containing the number of the total size of all of the .jpg files in tmp.
+ * \return a QString containing the number of the total size of all of the .jpg files in the folder.
  */
-QString ProjectManager::getSizeOfImages()
+QString ProjectManager::getSizeOfImages(QString outputDirectory)
 {
-    QDir dir("tmp/");
+    QDir dir(outputDirectory);
     qint64 totalSize;
     QFileInfo image;
 
@@ -68,7 +68,6 @@ public:
 
     // Regions
     bool setRegion(QString projName, QString vidName, QString oldName, QString newName, int threshold, QString notes, int x, int y, int width, int height);
-    bool checkRegionSize(QString projName, QString vidName);
     void removeRegion(QString projName, QString vidName, QString regionName);
 
     /******** Workspace and directory management functions *********/
@@ -77,16 +76,38 @@ public:
     QString getWorkspaceDirectory();
     void setWorkspaceDirectory(QString workSpacePath);
 
+    // Get and set for the analysis options, stored in options.txt
+    int getAnalysisThreadCount();
+    void setAnalysisThreadCount(int threadCount);
+    int getAnalysisChunkCount();
+    void setAnalysisChunkCount(int chunkCount);
+    int getJpegQuality();
+    void setJpegQuality(int jpegQuality);
+    int getImageMemoryBudget();
+    void setImageMemoryBudget(int megabytes);
+    int getFrameStride();
+    void setFrameStride(int frameStride);
+    int getAnalysisScale();
+    void setAnalysisScale(int analysisScale);
+    bool isFixedPointBackground();
+    void setFixedPointBackground(bool isFixedPointBackground);
+    bool isLumaAnalysis();
+    void setLumaAnalysis(bool isLumaAnalysis);
+    bool isRecordingTimeline();
+    void setRecordingTimeline(bool isRecordingTimeline);
+    int getConcurrentJobCount();
+    void setConcurrentJobCount(int concurrentJobCount);
+
     // Hiding/Autoloading projects.
     void projectToDirectory(QString projectName, int decision);
     void autoLoadProjects();
 
     // Total Image size calculations (to let the user know how much space will be taken up if they copy the images)
-    QString getSizeOfImages();
+    QString getSizeOfImages(QString outputDirectory);
     QString convertToReadableSize(qint64);
 
     // Outputting Analyze results
-    bool outputResults(QString projName, QString vidName, QString runName, bool overwrite, bool images);
+    bool outputResults(QString projName, QString vidName, QString runName, bool overwrite, bool images, QString outputDirectory);
     bool checkForRun(QString projName, QString vidName, QString runName);
 
 private:
@@ -107,5 +128,41 @@ private:
 
     /*! If true, windows OS, if false, Unix */
     bool _isWindows;
+
+    /*! True once the analysis options have been read from options.txt */
+    bool _isOptionsLoaded;
+
+    /*! Number of threads each analysis splits its frames across, 0 uses one thread per processor core. */
+    int _analysisThreadCount;
+
+    /*! Number of chunks each analysis splits its video into, 0 uses one chunk per processor core. */
+    int _analysisChunkCount;
+
+    /*! Quality of the images saved by an analysis, from 0 to 100. */
+    int _jpegQuality;
+
+    /*! Most memory in megabytes that flagged frames waiting to be saved may use. */
+    int _imageMemoryBudget;
+
+    /*! Number of video frames between two analyzed frames when screening, 1 analyzes every frame. */
+    int _frameStride;
+
+    /*! How many times smaller in width and height frames are analyzed at, 1 for full resolution. */
+    int _analysisScale;
+
+    /*! Keeps the running average background as 16 bit fixed point instead of 32 bit floats. */
+    bool _isFixedPointBackground;
+
+    /*! Analyzes the luma of each frame instead of its three color channels. */
+    bool _isLumaAnalysis;
+
+    /*! Records a timeline of each analysis' stages, saved with the run for offline profiling. */
+    bool _isRecordingTimeline;
+
+    /*! The most background jobs that run at the same time, 0 for one per processor core. */
+    int _concurrentJobCount;
+
+    void loadOptions();
+    void saveOptions();
 };
 #endif // !defined(EA_71C866DB_142D_420b_88E1_54DFB25CB2AC__INCLUDED_)
@@ -0,0 +1,492 @@
+#include "RegionEngine.h"
+#include <algorithm>
+
+//largest number of regions that fit in the 16 bit label map, label 0 is reserved for "no region"
+static const unsigned int MAX_LABEL_MAP_REGIONS = 65534;
+
+/*!
+ * Default constructor, starts with no regions
+ */
+RegionEngine::RegionEngine()
+{
+    _isUsingLabelMap = false;
+    _frameWidth = 0;
+    _frameHeight = 0;
+
+    //count the whole frame as a single band until told otherwise
+    _bandCounts.resize(1);
+}
+
+/*!
+ * Destructor
+ */
+RegionEngine::~RegionEngine()
+{
+
+}
+
+/*!
+ * Stores the regions of an analysis and prepares the counting strategy used for them
+ *
+ * \param regionCoordinates: A vector containing one integer vector for every region. Each internal vector hold X1, Y1, X2 and Y2 coordinates of a region
+ * \param pixelsThatMustChange: The minimum number of changed pixels that flags each region
+ * \param frameWidth: Width of the frames that will be counted
+ * \param frameHeight: Height of the frames that will be counted
+ */
+void RegionEngine::setRegions(std::vector < std::vector<int> > &regionCoordinates, std::vector<int> &pixelsThatMustChange, int frameWidth, int frameHeight)
+{
+    unsigned int numberOfRegions = regionCoordinates.size();
+
+    _regionStartX.resize(numberOfRegions);
+    _regionStartY.resize(numberOfRegions);
+    _regionEndX.resize(numberOfRegions);
+    _regionEndY.resize(numberOfRegions);
+
+    for(unsigned int regionNum = 0; regionNum < numberOfRegions; regionNum++)
+    {
+        _regionStartX[regionNum] = regionCoordinates[regionNum][0];
+        _regionStartY[regionNum] = regionCoordinates[regionNum][1];
+        _regionEndX[regionNum] = regionCoordinates[regionNum][2];
+        _regionEndY[regionNum] = regionCoordinates[regionNum][3];
+    }
+
+    _pixelsThatMustChange = pixelsThatMustChange;
+    _pixelChanges.assign(numberOfRegions, 0);
+    _previousFramePixelChanges.assign(numberOfRegions, 0);
+
+    _frameWidth = frameWidth;
+    _frameHeight = frameHeight;
+
+    _isUsingLabelMap = (numberOfRegions <= MAX_LABEL_MAP_REGIONS) && !doRegionsOverlap();
+
+    if(_isUsingLabelMap == true)
+    {
+        buildLabelMap(frameWidth, frameHeight);
+    }
+    else
+    {
+        _labelMap.release();
+    }
+
+    allocateBandCounts();
+}
+
+/*!
+ * Sets the number of horizontal bands the frame will be counted in. Each band gets its own counters so that bands can be
+ * counted on different threads at the same time
+ *
+ * \param numberOfBands: The number of bands, at least 1
+ */
+void RegionEngine::setNumberOfBands(int numberOfBands)
+{
+    _bandCounts.resize(std::max(numberOfBands, 1));
+    allocateBandCounts();
+}
+
+/*!
+ * Get function for the number of bands
+ *
+ * \return Returns the number of bands the frame is counted in
+ */
+int RegionEngine::getNumberOfBands()
+{
+    return _bandCounts.size();
+}
+
+/*!
+ * Sizes the counters of every band for the current regions and counting strategy
+ */
+void RegionEngine::allocateBandCounts()
+{
+    //the label map counts by label, which has one extra entry for pixels outside every region
+    unsigned int countsPerBand = _regionStartX.size() + (_isUsingLabelMap ? 1 : 0);
+
+    for(unsigned int band = 0; band < _bandCounts.size(); band++)
+    {
+        _bandCounts[band].assign(countsPerBand, 0);
+    }
+
+    if(_isUsingLabelMap == false && _frameWidth > 0 && _frameHeight > 0)
+    {
+        _changedPixelTable.create(_frameHeight + (int)_bandCounts.size(), _frameWidth + 1, CV_32SC1);
+    }
+    else
+    {
+        _changedPixelTable.release();
+    }
+}
+
+/*!
+ * Get function for the number of regions
+ *
+ * \return Returns the number of regions in the region table
+ */
+int RegionEngine::getNumberOfRegions()
+{
+    return _regionStartX.size();
+}
+
+/*!
+ * Get function for the counting strategy
+ *
+ * \return Returns true if the label map is used for counting, false if the summed area table is used
+ */
+bool RegionEngine::isUsingLabelMap()
+{
+    return _isUsingLabelMap;
+}
+
+/*!
+ * Checks whether any two regions share a pixel. Regions are sorted by their left edge so only regions whose
+ * x ranges can still overlap are compared
+ *
+ * \return Returns true if at least one pixel belongs to more than one region
+ */
+bool RegionEngine::doRegionsOverlap()
+{
+    std::vector < std::pair<int, int> > regionsByStartX;
+
+    for(unsigned int regionNum = 0; regionNum < _regionStartX.size(); regionNum++)
+    {
+        regionsByStartX.push_back(std::make_pair(_regionStartX[regionNum], (int)regionNum));
+    }
+
+    std::sort(regionsByStartX.begin(), regionsByStartX.end());
+
+    for(unsigned int i = 0; i < regionsByStartX.size(); i++)
+    {
+        int first = regionsByStartX[i].second;
+
+        for(unsigned int j = i + 1; j < regionsByStartX.size(); j++)
+        {
+            int second = regionsByStartX[j].second;
+
+            //every remaining region starts to the right of this one
+            if(_regionStartX[second] > _regionEndX[first])
+            {
+                break;
+            }
+
+            if(_regionStartY[second] <= _regionEndY[first] && _regionStartY[first] <= _regionEndY[second])
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/*!
+ * Labels every pixel of the frame with the number of the region that contains it plus one, or 0 if no region does
+ *
+ * \param frameWidth: Width of the frames that will be counted
+ * \param frameHeight: Height of the frames that will be counted
+ */
+void RegionEngine::buildLabelMap(int frameWidth, int frameHeight)
+{
+    _labelMap.create(frameHeight, frameWidth, CV_16UC1);
+    _labelMap.setTo(cv::Scalar(0));
+
+    for(unsigned int regionNum = 0; regionNum < _regionStartX.size(); regionNum++)
+    {
+        //region end points are inclusive, clip them to the frame
+        int x1 = std::max(_regionStartX[regionNum], 0);
+        int y1 = std::max(_regionStartY[regionNum], 0);
+        int x2 = std::min(_regionEndX[regionNum] + 1, frameWidth);
+        int y2 = std::min(_regionEndY[regionNum] + 1, frameHeight);
+
+        if(x1 < x2 && y1 < y2)
+        {
+            _labelMap(cv::Rect(x1, y1, x2 - x1, y2 - y1)).setTo(cv::Scalar(regionNum + 1));
+        }
+    }
+}
+
+/*!
+ * Counts the changed pixels inside every region for the current frame. Only pixels inside the given area of the frame are
+ * counted, the same area the difference image was analyzed over. The whole area is counted as a single band on the
+ * calling thread
+ *
+ * \param differenceImage: The black and white difference image of the current frame
+ * \param xStart: The first column of the area to count
+ * \param yStart: The first row of the area to count
+ * \param xEnd: One past the last column of the area to count
+ * \param yEnd: One past the last row of the area to count
+ *
+ * \return Returns nothing, the counts are stored in _pixelChanges
+ */
+void RegionEngine::countChangedPixels(const cv::Mat &differenceImage, int xStart, int yStart, int xEnd, int yEnd)
+{
+    for(unsigned int band = 1; band < _bandCounts.size(); band++)
+    {
+        std::fill(_bandCounts[band].begin(), _bandCounts[band].end(), 0);
+    }
+
+    countChangedPixelsInBand(differenceImage, 0, xStart, yStart, xEnd, yEnd);
+
+    mergeBandCounts();
+}
+
+/*!
+ * Counts the changed pixels inside every region for one band of the current frame, into that band's own counters.
+ * Different bands may be counted at the same time from different threads, as long as their rows do not overlap
+ *
+ * \param differenceImage: The black and white difference image of the current frame
+ * \param band: The band being counted, from 0 to getNumberOfBands() - 1
+ * \param xStart: The first column of the area to count
+ * \param yStart: The first row of the band to count
+ * \param xEnd: One past the last column of the area to count
+ * \param yEnd: One past the last row of the band to count
+ *
+ * \return Returns nothing, the counts are stored until mergeBandCounts() is called
+ */
+void RegionEngine::countChangedPixelsInBand(const cv::Mat &differenceImage, int band, int xStart, int yStart, int xEnd, int yEnd)
+{
+    std::vector<int> &bandCounts = _bandCounts[band];
+    std::fill(bandCounts.begin(), bandCounts.end(), 0);
+
+    //keep the area inside the frame
+    xStart = std::max(xStart, 0);
+    yStart = std::max(yStart, 0);
+    xEnd = std::min(xEnd, differenceImage.cols);
+    yEnd = std::min(yEnd, differenceImage.rows);
+
+    //nothing of the area falls in this band
+    if(xStart >= xEnd || yStart >= yEnd || bandCounts.empty())
+    {
+        return;
+    }
+
+    if(_isUsingLabelMap == true)
+    {
+        countWithLabelMap(differenceImage, bandCounts, xStart, yStart, xEnd, yEnd);
+    }
+    else
+    {
+        countWithChangedPixelTable(differenceImage, band, bandCounts, xStart, yStart, xEnd, yEnd);
+    }
+}
+
+/*!
+ * Counts the changed pixels inside every region for one band of the current frame, like countChangedPixelsInBand(), but
+ * only over the rows of the band that fall in a list of areas that do not overlap. With the label map each area is swept
+ * on its own, so pixels between the areas are never visited. The summed area table needs one contiguous area, so it is
+ * built over the bounding box of the areas instead
+ *
+ * \param differenceImage: The black and white difference image of the current frame
+ * \param band: The band being counted, from 0 to getNumberOfBands() - 1
+ * \param areas: The areas to count, none of them may share a pixel
+ * \param yStart: The first row of the band to count
+ * \param yEnd: One past the last row of the band to count
+ *
+ * \return Returns nothing, the counts are stored until mergeBandCounts() is called
+ */
+void RegionEngine::countChangedPixelsInAreas(const cv::Mat &differenceImage, int band, const std::vector<cv::Rect> &areas, int yStart, int yEnd)
+{
+    if(_isUsingLabelMap == false)
+    {
+        int xStart = differenceImage.cols;
+        int xEnd = 0;
+
+        for(unsigned int area = 0; area < areas.size(); area++)
+        {
+            if(areas[area].y < yEnd && areas[area].y + areas[area].height > yStart)
+            {
+                xStart = std::min(xStart, areas[area].x);
+                xEnd = std::max(xEnd, areas[area].x + areas[area].width);
+            }
+        }
+
+        countChangedPixelsInBand(differenceImage, band, xStart, yStart, xEnd, yEnd);
+        return;
+    }
+
+    std::vector<int> &bandCounts = _bandCounts[band];
+    std::fill(bandCounts.begin(), bandCounts.end(), 0);
+
+    if(bandCounts.empty())
+    {
+        return;
+    }
+
+    for(unsigned int area = 0; area < areas.size(); area++)
+    {
+        //keep the area inside the band and the frame
+        int areaXStart = std::max(areas[area].x, 0);
+        int areaYStart = std::max(areas[area].y, std::max(yStart, 0));
+        int areaXEnd = std::min(areas[area].x + areas[area].width, differenceImage.cols);
+        int areaYEnd = std::min(areas[area].y + areas[area].height, std::min(yEnd, differenceImage.rows));
+
+        if(areaXStart < areaXEnd && areaYStart < areaYEnd)
+        {
+            countWithLabelMap(differenceImage, bandCounts, areaXStart, areaYStart, areaXEnd, areaYEnd);
+        }
+    }
+}
+
+/*!
+ * Adds the counters of every band together, in band order, giving the changed pixels of each region for the whole frame
+ *
+ * \return Returns nothing, the counts are stored in _pixelChanges
+ */
+void RegionEngine::mergeBandCounts()
+{
+    //label map counters are indexed by label, skip the "no region" label
+    unsigned int firstCount = _isUsingLabelMap ? 1 : 0;
+
+    for(unsigned int regionNum = 0; regionNum < _pixelChanges.size(); regionNum++)
+    {
+        int changedPixels = 0;
+
+        for(unsigned int band = 0; band < _bandCounts.size(); band++)
+        {
+            changedPixels += _bandCounts[band][regionNum + firstCount];
+        }
+
+        _pixelChanges[regionNum] = changedPixels;
+    }
+}
+
+/*!
+ * Label map counting, one sweep over the band adds every changed pixel to the counter of its region
+ */
+void RegionEngine::countWithLabelMap(const cv::Mat &differenceImage, std::vector<int> &bandCounts, int xStart, int yStart, int xEnd, int yEnd)
+{
+    int* labelCounts = &bandCounts[0];
+
+    for(int i = yStart; i < yEnd; i++)
+    {
+        const unsigned char* currentRow = differenceImage.ptr<unsigned char>(i);
+        const unsigned short* labelRow = _labelMap.ptr<unsigned short>(i);
+
+        for(int j = xStart; j < xEnd; j++)
+        {
+            labelCounts[labelRow[j]] += (currentRow[j] != 0);
+        }
+    }
+}
+
+/*!
+ * Summed area table counting. Each table entry holds the number of changed pixels of the band above and to the left of it,
+ * so the changed pixels inside a region are found with four lookups no matter how much motion the frame contains
+ */
+void RegionEngine::countWithChangedPixelTable(const cv::Mat &differenceImage, int band, std::vector<int> &bandCounts, int xStart, int yStart, int xEnd, int yEnd)
+{
+    int tableWidth = xEnd - xStart;
+
+    //table row of frame row i is i + band + 1, the row above the band's first row is always zero
+    int* previousTableRow = _changedPixelTable.ptr<int>(yStart + band);
+    for(int j = 0; j <= tableWidth; j++)
+    {
+        previousTableRow[j] = 0;
+    }
+
+    for(int i = yStart; i < yEnd; i++)
+    {
+        const unsigned char* currentRow = differenceImage.ptr<unsigned char>(i) + xStart;
+        int* tableRow = _changedPixelTable.ptr<int>(i + band + 1);
+
+        int changedPixelsInRow = 0;
+        tableRow[0] = 0;
+
+        for(int j = 0; j < tableWidth; j++)
+        {
+            changedPixelsInRow += (currentRow[j] != 0);
+            tableRow[j + 1] = previousTableRow[j + 1] + changedPixelsInRow;
+        }
+
+        previousTableRow = tableRow;
+    }
+
+    for(unsigned int regionNum = 0; regionNum < bandCounts.size(); regionNum++)
+    {
+        //clip the region to the counted band, in table coordinates
+        int x1 = std::max(_regionStartX[regionNum], xStart) - xStart;
+        int y1 = std::max(_regionStartY[regionNum], yStart) + band;
+        int x2 = std::min(_regionEndX[regionNum] + 1, xEnd) - xStart;
+        int y2 = std::min(_regionEndY[regionNum] + 1, yEnd) + band;
+
+        if(x1 < x2 && y1 < y2)
+        {
+            bandCounts[regionNum] = _changedPixelTable.at<int>(y2, x2) - _changedPixelTable.at<int>(y1, x2)
+                                  - _changedPixelTable.at<int>(y2, x1) + _changedPixelTable.at<int>(y1, x1);
+        }
+    }
+}
+
+/*!
+ * Checks if a region passed its threshold on the current frame. A region is flagged when enough of its pixels changed,
+ * the count differs from the previous frame, and at least one pixel changed
+ *
+ * \param regionNumber: The region to check
+ *
+ * \return Returns true if the region passed its threshold
+ */
+bool RegionEngine::isRegionOverThreshold(int regionNumber)
+{
+    return (_pixelsThatMustChange[regionNumber] <= _pixelChanges[regionNumber]) &&
+           (_pixelChanges[regionNumber] != _previousFramePixelChanges[regionNumber]) &&
+           (_pixelChanges[regionNumber] != 0);
+}
+
+/*!
+ * Stores this frame's counts as the previous frame's counts, and resets the counts for the next frame
+ */
+void RegionEngine::finishFrame()
+{
+    _previousFramePixelChanges.swap(_pixelChanges);
+    std::fill(_pixelChanges.begin(), _pixelChanges.end(), 0);
+}
+
+/*!
+ * Get function for a region's changed pixels on the current frame, valid after mergeBandCounts() and until finishFrame()
+ *
+ * \param regionNumber: Index of the region in the region table
+ *
+ * \return Returns the number of changed pixels inside the region
+ */
+int RegionEngine::getPixelChanges(int regionNumber)
+{
+    return _pixelChanges[regionNumber];
+}
+
+/*!
+ * Get function for a region's changed pixels on the previous frame
+ *
+ * \param regionNumber: Index of the region in the region table
+ *
+ * \return Returns the number of changed pixels inside the region on the last finished frame
+ */
+int RegionEngine::getPreviousPixelChanges(int regionNumber)
+{
+    return _previousFramePixelChanges[regionNumber];
+}
+
+/*!
+ * Get function for the changed pixels of every region on the previous frame
+ *
+ * \return Returns the counts indexed by region number
+ */
+const std::vector<int> &RegionEngine::getPreviousFramePixelChanges()
+{
+    return _previousFramePixelChanges;
+}
+
+/*!
+ * Set function for the changed pixels of every region on the previous frame, used to continue a stopped analysis
+ *
+ * \param previousFramePixelChanges: The counts indexed by region number
+ *
+ * \return Returns false if the number of counts does not match the number of regions, nothing is changed then
+ */
+bool RegionEngine::setPreviousFramePixelChanges(const std::vector<int> &previousFramePixelChanges)
+{
+    if(previousFramePixelChanges.size() != _previousFramePixelChanges.size())
+    {
+        return false;
+    }
+
+    _previousFramePixelChanges = previousFramePixelChanges;
+    return true;
+}
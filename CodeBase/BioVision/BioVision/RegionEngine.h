@@ -0,0 +1,98 @@
+/*!
+ * \class RegionEngine
+ *
+ * Holds every region of an analysis and counts the changed pixels that fall inside each of them.
+ *
+ * Region data is kept as a struct of arrays, one vector per field indexed by region number, so the per frame threshold
+ * checks walk contiguous memory no matter how many regions a video has.  There is no fixed limit on the number of regions.
+ *
+ * Counting uses one of two strategies, chosen once when the regions are set:
+ *
+ * Label map: when no two regions overlap, every pixel of the frame is labelled with the region it belongs to (0 for none),
+ * and a single sweep over the difference image adds each changed pixel to its region's counter.  The cost of a frame is the
+ * same for 1 region or 400.
+ *
+ * Summed area table: when regions overlap a pixel can belong to more than one region, so a summed area table of changed
+ * pixels is built instead and each region is counted with four lookups.
+ *
+ * The frame can be split into horizontal bands that are counted on different threads.  Every band writes to its own
+ * counters, which are summed by mergeBandCounts() once all bands are done, so the result does not depend on the number
+ * of bands or the order they finish in.
+ */
+
+#ifndef REGIONENGINE_H
+#define REGIONENGINE_H
+
+#include "opencv2/core/core.hpp"
+#include <vector>
+
+class RegionEngine
+{
+
+public:
+    RegionEngine();
+    ~RegionEngine();
+
+    void setRegions(std::vector < std::vector<int> > &regionCoordinates, std::vector<int> &pixelsThatMustChange, int frameWidth, int frameHeight);
+
+    int getNumberOfRegions();
+
+    bool isUsingLabelMap();
+
+    void countChangedPixels(const cv::Mat &differenceImage, int xStart, int yStart, int xEnd, int yEnd);
+
+    void setNumberOfBands(int numberOfBands);
+
+    int getNumberOfBands();
+
+    void countChangedPixelsInBand(const cv::Mat &differenceImage, int band, int xStart, int yStart, int xEnd, int yEnd);
+
+    void countChangedPixelsInAreas(const cv::Mat &differenceImage, int band, const std::vector<cv::Rect> &areas, int yStart, int yEnd);
+
+    void mergeBandCounts();
+
+    bool isRegionOverThreshold(int regionNumber);
+
+    void finishFrame();
+
+    int getPixelChanges(int regionNumber);
+
+    int getPreviousPixelChanges(int regionNumber);
+
+    const std::vector<int> &getPreviousFramePixelChanges();
+
+    bool setPreviousFramePixelChanges(const std::vector<int> &previousFramePixelChanges);
+
+private:
+    bool doRegionsOverlap();
+    void buildLabelMap(int frameWidth, int frameHeight);
+    void allocateBandCounts();
+    void countWithLabelMap(const cv::Mat &differenceImage, std::vector<int> &bandCounts, int xStart, int yStart, int xEnd, int yEnd);
+    void countWithChangedPixelTable(const cv::Mat &differenceImage, int band, std::vector<int> &bandCounts, int xStart, int yStart, int xEnd, int yEnd);
+
+    //region table, each vector is indexed by region number. Coordinates are inclusive, as drawn by the user
+    std::vector<int> _regionStartX;
+    std::vector<int> _regionStartY;
+    std::vector<int> _regionEndX;
+    std::vector<int> _regionEndY;
+    std::vector<int> _pixelsThatMustChange;
+    std::vector<int> _pixelChanges;
+    std::vector<int> _previousFramePixelChanges;
+
+    //size of the frames that will be counted
+    int _frameWidth;
+    int _frameHeight;
+
+    //region number + 1 of every pixel, 0 where no region is present
+    cv::Mat _labelMap;
+    bool _isUsingLabelMap;
+
+    //private counters of every band. With the label map they are indexed by label, so index 0 collects pixels outside
+    //every region, otherwise they are indexed by region number
+    std::vector < std::vector<int> > _bandCounts;
+
+    //summed area table of changed pixels, used when regions overlap. Every band gets its own zero row above its first
+    //frame row, so band n uses table rows (first row + n) to (last row + n + 1) and bands never share a table row
+    cv::Mat _changedPixelTable;
+};
+#endif
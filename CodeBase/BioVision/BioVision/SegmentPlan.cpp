@@ -0,0 +1,181 @@
+#include "SegmentPlan.h"
+#include <algorithm>
+#include <limits.h>
+
+/*!
+ * Default constructor, the plan includes no frames
+ */
+SegmentPlan::SegmentPlan()
+{
+
+}
+
+/*!
+ * Builds the plan of an analysis
+ *
+ * \param startFrame: The first frame of the analysis
+ * \param endFrame: The first frame after the analysis
+ * \param editPoints: Pairs of stop and resume times in seconds, used to leave out parts of the video
+ * \param frameRate: The frame rate of the video, used to turn the edit times into frame numbers
+ */
+SegmentPlan::SegmentPlan(int startFrame, int endFrame, const std::deque<int> &editPoints, double frameRate)
+{
+    if(startFrame < endFrame)
+    {
+        segment wholeAnalysis;
+        wholeAnalysis.firstFrame = startFrame;
+        wholeAnalysis.endFrame = endFrame;
+
+        _segments.push_back(wholeAnalysis);
+    }
+
+    for(unsigned int i = 0; i < editPoints.size(); i += 2)
+    {
+        //an edit time falls on the nearest frame
+        int stopFrame = (int)(editPoints[i] * frameRate + 0.5);
+        int resumeFrame = INT_MAX;
+
+        if(i + 1 < editPoints.size())
+        {
+            resumeFrame = (int)(editPoints[i + 1] * frameRate + 0.5);
+        }
+
+        excludeFrames(stopFrame, resumeFrame);
+    }
+}
+
+/*!
+ * Destructor
+ */
+SegmentPlan::~SegmentPlan()
+{
+
+}
+
+/*!
+ * Get function for the segments
+ *
+ * \return Returns the included frame ranges in frame order
+ */
+const std::vector<SegmentPlan::segment>& SegmentPlan::getSegments() const
+{
+    return _segments;
+}
+
+/*!
+ * Finds the segment a frame belongs to, or the first segment after it if the frame is left out
+ *
+ * \param frameNumber: The frame to look up
+ *
+ * \return Returns the index of the segment, or -1 if no segment ends after the frame
+ */
+int SegmentPlan::findSegment(int frameNumber) const
+{
+    for(unsigned int i = 0; i < _segments.size(); i++)
+    {
+        if(_segments[i].endFrame > frameNumber)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/*!
+ * Get function for the number of frames the plan includes
+ *
+ * \return Returns the total length of all segments in frames
+ */
+int SegmentPlan::getIncludedFrameCount() const
+{
+    int includedFrames = 0;
+
+    for(unsigned int i = 0; i < _segments.size(); i++)
+    {
+        includedFrames += _segments[i].endFrame - _segments[i].firstFrame;
+    }
+
+    return includedFrames;
+}
+
+/*!
+ * Counts the included frames in a range of frames
+ *
+ * \param firstFrame: The first frame of the range
+ * \param endFrame: The first frame after the range
+ *
+ * \return Returns the number of frames of the range that belong to a segment
+ */
+int SegmentPlan::countIncludedFrames(int firstFrame, int endFrame) const
+{
+    int includedFrames = 0;
+
+    for(unsigned int i = 0; i < _segments.size(); i++)
+    {
+        includedFrames += std::max(std::min(endFrame, _segments[i].endFrame) - std::max(firstFrame, _segments[i].firstFrame), 0);
+    }
+
+    return includedFrames;
+}
+
+/*!
+ * Gets the frame number of an included frame, counting only the frames the plan includes
+ *
+ * \param includedFrameIndex: 0 for the first included frame, up to getIncludedFrameCount()
+ *
+ * \return Returns the frame number. An index past the last included frame gives the end frame of the last segment
+ */
+int SegmentPlan::getIncludedFrame(int includedFrameIndex) const
+{
+    for(unsigned int i = 0; i < _segments.size(); i++)
+    {
+        int segmentFrames = _segments[i].endFrame - _segments[i].firstFrame;
+
+        if(includedFrameIndex < segmentFrames)
+        {
+            return _segments[i].firstFrame + std::max(includedFrameIndex, 0);
+        }
+
+        includedFrameIndex -= segmentFrames;
+    }
+
+    return _segments.empty() ? 0 : _segments.back().endFrame;
+}
+
+/*!
+ * Leaves a range of frames out of the plan, splitting the segment it falls inside of
+ *
+ * \param firstFrame: The first frame left out
+ * \param endFrame: The first frame after the range that is left out
+ */
+void SegmentPlan::excludeFrames(int firstFrame, int endFrame)
+{
+    if(firstFrame >= endFrame)
+    {
+        return;
+    }
+
+    std::vector<segment> remainingSegments;
+
+    for(unsigned int i = 0; i < _segments.size(); i++)
+    {
+        segment before = _segments[i];
+        before.endFrame = std::min(before.endFrame, firstFrame);
+
+        segment after = _segments[i];
+        after.firstFrame = std::max(after.firstFrame, endFrame);
+
+        if(before.firstFrame < before.endFrame)
+        {
+            remainingSegments.push_back(before);
+        }
+
+        if(after.firstFrame < after.endFrame)
+        {
+            remainingSegments.push_back(after);
+        }
+    }
+
+    _segments = remainingSegments;
+}
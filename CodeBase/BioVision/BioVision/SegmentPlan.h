@@ -0,0 +1,53 @@
+/*!
+ * \class SegmentPlan
+ *
+ * The frames of an analysis as a list of included frame ranges, built once from the start frame, the stop frame and the
+ * user's edit points before any frame is read.
+ *
+ * Edit points come in pairs of stop and resume times in seconds.  Every frame from the stop time up to the resume time is
+ * left out, and each range of frames that is left in is a segment.  The analysis reads the frames of each segment in
+ * order, jumps over the gap to the next segment with a single skip, and resets the running average on the first frame of
+ * every segment.  Frame numbers, the end of the analysis and progress all come from the plan, so the video stream is
+ * never asked for its position while frames are read.
+ *
+ * A stop time without a resume time leaves out the rest of the analysis.
+ */
+
+#ifndef SEGMENTPLAN_H
+#define SEGMENTPLAN_H
+
+#include <vector>
+#include <deque>
+
+class SegmentPlan
+{
+
+public:
+    //a range of frames that is analyzed, from its first frame up to but not including its end frame
+    struct segment
+    {
+        int firstFrame;
+        int endFrame;
+    };
+
+    SegmentPlan();
+    SegmentPlan(int startFrame, int endFrame, const std::deque<int> &editPoints, double frameRate);
+    ~SegmentPlan();
+
+    const std::vector<segment>& getSegments() const;
+
+    int findSegment(int frameNumber) const;
+
+    int getIncludedFrameCount() const;
+
+    int countIncludedFrames(int firstFrame, int endFrame) const;
+
+    int getIncludedFrame(int includedFrameIndex) const;
+
+private:
+    /*! Segments in frame order, never empty and never touching each other. */
+    std::vector<segment> _segments;
+
+    void excludeFrames(int firstFrame, int endFrame);
+};
+#endif
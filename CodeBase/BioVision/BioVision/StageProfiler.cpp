@@ -0,0 +1,254 @@
+#include "StageProfiler.h"
+#include <QFile>
+#include <QTextStream>
+#include <QMutexLocker>
+#include <algorithm>
+
+/*!
+ * Constructor, every total is 0 and tracing is off
+ */
+StageProfiler::StageProfiler()
+{
+    _isTracing = false;
+    _maxTraceEvents = DEFAULT_MAX_TRACE_EVENTS;
+
+    reset();
+}
+
+/*!
+ * Destructor
+ */
+StageProfiler::~StageProfiler()
+{
+
+}
+
+/*!
+ * Clears every total and trace event, and starts the trace timeline over
+ *
+ * \return Returns nothing
+ */
+void StageProfiler::reset()
+{
+    QMutexLocker locker(&_mutex);
+
+    for(int i = 0; i < NUMBER_OF_STAGES; i++)
+    {
+        _totals[i].ticks = 0;
+        _totals[i].calls = 0;
+    }
+
+    _startTicks = cv::getTickCount();
+
+    _traceEvents.clear();
+    _nextTraceEvent = 0;
+    _threadNumbers.clear();
+}
+
+/*!
+ * Adds one timing of a stage, run on the calling thread
+ *
+ * \param stage: The stage that was timed
+ * \param startTicks: cv::getTickCount() when the stage started
+ * \param endTicks: cv::getTickCount() when the stage ended
+ *
+ * \return Returns nothing
+ */
+void StageProfiler::addStageTime(int stage, int64 startTicks, int64 endTicks)
+{
+    addStageTime(stage, startTicks, endTicks, QThread::currentThreadId());
+}
+
+/*!
+ * Adds one timing of a stage, run on the given thread. Used to add the times of the frame bands from the thread that
+ * waited for them
+ *
+ * \param stage: The stage that was timed
+ * \param startTicks: cv::getTickCount() when the stage started
+ * \param endTicks: cv::getTickCount() when the stage ended
+ * \param threadId: QThread::currentThreadId() of the thread the stage ran on
+ *
+ * \return Returns nothing
+ */
+void StageProfiler::addStageTime(int stage, int64 startTicks, int64 endTicks, Qt::HANDLE threadId)
+{
+    QMutexLocker locker(&_mutex);
+
+    _totals[stage].ticks += endTicks - startTicks;
+    _totals[stage].calls++;
+
+    if(_isTracing == false)
+    {
+        return;
+    }
+
+    QHash<Qt::HANDLE, int>::const_iterator threadNumber = _threadNumbers.constFind(threadId);
+
+    if(threadNumber == _threadNumbers.constEnd())
+    {
+        threadNumber = _threadNumbers.insert(threadId, _threadNumbers.size() + 1);
+    }
+
+    traceEvent event;
+    event.startTicks = startTicks;
+    event.endTicks = endTicks;
+    event.stage = stage;
+    event.thread = threadNumber.value();
+
+    //once the limit is reached, the oldest event is replaced
+    if((int)_traceEvents.size() < _maxTraceEvents)
+    {
+        _traceEvents.push_back(event);
+    }
+    else
+    {
+        _traceEvents[_nextTraceEvent] = event;
+        _nextTraceEvent = (_nextTraceEvent + 1) % _maxTraceEvents;
+    }
+}
+
+/*!
+ * Get function for the time spent in each stage so far
+ *
+ * \return Returns the total of every stage, indexed by stage
+ */
+std::vector<StageProfiler::stageTotal> StageProfiler::getTotals()
+{
+    QMutexLocker locker(&_mutex);
+
+    return std::vector<stageTotal>(_totals, _totals + NUMBER_OF_STAGES);
+}
+
+/*!
+ * Turns the recording of trace events on or off. Events already recorded are kept until the next reset()
+ *
+ * \param isTracing: True to record an event for every timed stage
+ * \param maxTraceEvents: The number of most recent events kept
+ *
+ * \return Returns nothing
+ */
+void StageProfiler::setTracing(bool isTracing, int maxTraceEvents)
+{
+    QMutexLocker locker(&_mutex);
+
+    _isTracing = isTracing;
+
+    if(maxTraceEvents != _maxTraceEvents)
+    {
+        _maxTraceEvents = std::max(maxTraceEvents, 1);
+        _traceEvents.clear();
+        _nextTraceEvent = 0;
+    }
+
+    if(_isTracing == true)
+    {
+        _traceEvents.reserve(_maxTraceEvents);
+    }
+}
+
+/*!
+ * Checks if trace events are recorded
+ *
+ * \return Returns true if tracing is on
+ */
+bool StageProfiler::isTracing()
+{
+    QMutexLocker locker(&_mutex);
+
+    return _isTracing;
+}
+
+/*!
+ * Writes the recorded events as a Chrome trace, one complete event per timed stage with its time in microseconds since
+ * the last reset(), and one row per thread
+ *
+ * \param filePath: The path of the .json file to write
+ *
+ * \return Returns true if the file was written
+ */
+bool StageProfiler::exportTrace(QString filePath)
+{
+    QMutexLocker locker(&_mutex);
+
+    QFile traceFile(filePath);
+
+    if(traceFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate) == false)
+    {
+        return false;
+    }
+
+    QTextStream out(&traceFile);
+    double microsecondsPerTick = 1000000.0 / cv::getTickFrequency();
+
+    out << "{\"traceEvents\":[\n";
+
+    bool isFirstEvent = true;
+
+    //name the thread rows, the first thread to add a time is the analysis thread of the first chunk
+    for(QHash<Qt::HANDLE, int>::const_iterator i = _threadNumbers.constBegin(); i != _threadNumbers.constEnd(); ++i)
+    {
+        out << (isFirstEvent ? "" : ",\n")
+            << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i.value()
+            << ",\"args\":{\"name\":\"thread " << i.value() << "\"}}";
+
+        isFirstEvent = false;
+    }
+
+    //oldest event first, the ring starts at the next event to be replaced
+    for(unsigned int i = 0; i < _traceEvents.size(); i++)
+    {
+        const traceEvent &event = _traceEvents[(_nextTraceEvent + i) % _traceEvents.size()];
+
+        out << (isFirstEvent ? "" : ",\n")
+            << "{\"name\":\"" << getStageName(event.stage) << "\",\"cat\":\"analysis\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+            << ",\"ts\":" << QString::number((event.startTicks - _startTicks) * microsecondsPerTick, 'f', 3)
+            << ",\"dur\":" << QString::number((event.endTicks - event.startTicks) * microsecondsPerTick, 'f', 3) << "}";
+
+        isFirstEvent = false;
+    }
+
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    out.flush();
+
+    return traceFile.error() == QFile::NoError;
+}
+
+/*!
+ * Get function for the name of a stage, as shown in the status bar and the trace
+ *
+ * \param stage: The stage
+ *
+ * \return Returns the name of the stage
+ */
+QString StageProfiler::getStageName(int stage)
+{
+    switch(stage)
+    {
+    case DECODE:
+        return "decode";
+    case PREPARE:
+        return "scale";
+    case MOTION:
+        return "motion";
+    case COUNTING:
+        return "regions";
+    case OVERLAY:
+        return "overlay";
+    case IMAGE_WRITE:
+        return "jpeg";
+    default:
+        return "unknown";
+    }
+}
+
+/*!
+ * Converts a time in cv::getTickCount() ticks to seconds
+ *
+ * \param ticks: The time in ticks
+ *
+ * \return Returns the time in seconds
+ */
+double StageProfiler::ticksToSeconds(int64 ticks)
+{
+    return ticks / cv::getTickFrequency();
+}
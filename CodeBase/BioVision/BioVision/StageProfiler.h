@@ -0,0 +1,125 @@
+/*!
+ * \class StageProfiler
+ *
+ * Per job timings of each stage of the analysis pipeline: decoding, scaling, the running average and difference image,
+ * region counting, drawing flagged frames and saving them.  Every chunk, band and writer thread of a job adds its times
+ * to the same profiler, so the totals are CPU time summed over every thread, and can add up to more than the wall time
+ * of the job.
+ *
+ * Stages are timed with ScopedTimer, through the BV_TIME_STAGE() macro.  A timer given no profiler reads no clock, and
+ * building with BV_NO_STAGE_PROFILING defined (CONFIG += no_stage_profiling) removes every timer from the hot path.
+ * Qt 4 has no 64 bit atomics, so the totals are kept under a mutex.  It is taken once per stage per frame (the frame
+ * bands add their times once all of them are done), which is far below the cost of the stages themselves.
+ *
+ * With tracing turned on, every timed stage is also kept as an event, the most recent events up to a limit, and the
+ * events can be written as a Chrome trace (chrome://tracing or Perfetto) for a timeline of every thread.
+ */
+
+#ifndef STAGEPROFILER_H
+#define STAGEPROFILER_H
+
+#include "opencv2/core/core.hpp"
+#include <QMutex>
+#include <QHash>
+#include <QString>
+#include <QThread>
+#include <vector>
+
+class StageProfiler
+{
+
+public:
+    enum stage { DECODE, PREPARE, MOTION, COUNTING, OVERLAY, IMAGE_WRITE, NUMBER_OF_STAGES };
+
+    //time spent in one stage, in cv::getTickCount() ticks, and the number of times it was timed
+    struct stageTotal
+    {
+        int64 ticks;
+        int64 calls;
+    };
+
+    //times the scope it is declared in as one stage, does nothing without a profiler
+    class ScopedTimer
+    {
+
+    public:
+        ScopedTimer(StageProfiler* profiler, int stage)
+        {
+            _profiler = profiler;
+            _stage = stage;
+
+            if(_profiler != NULL)
+            {
+                _startTicks = cv::getTickCount();
+            }
+        }
+
+        ~ScopedTimer()
+        {
+            if(_profiler != NULL)
+            {
+                _profiler->addStageTime(_stage, _startTicks, cv::getTickCount());
+            }
+        }
+
+    private:
+        StageProfiler* _profiler;
+        int _stage;
+        int64 _startTicks;
+    };
+
+    StageProfiler();
+    ~StageProfiler();
+
+    void reset();
+
+    void addStageTime(int stage, int64 startTicks, int64 endTicks);
+    void addStageTime(int stage, int64 startTicks, int64 endTicks, Qt::HANDLE threadId);
+    std::vector<stageTotal> getTotals();
+
+    void setTracing(bool isTracing, int maxTraceEvents = DEFAULT_MAX_TRACE_EVENTS);
+    bool isTracing();
+    bool exportTrace(QString filePath);
+
+    static QString getStageName(int stage);
+    static double ticksToSeconds(int64 ticks);
+
+private:
+    //about 8 MB of events, a few minutes of a busy analysis
+    enum { DEFAULT_MAX_TRACE_EVENTS = 262144 };
+
+    //one timed stage on the timeline
+    struct traceEvent
+    {
+        int64 startTicks;
+        int64 endTicks;
+        int stage;
+        int thread;
+    };
+
+    QMutex _mutex;
+
+    stageTotal _totals[NUMBER_OF_STAGES];
+
+    /*! Tick count when the profiler was last reset, trace times are relative to it. */
+    int64 _startTicks;
+
+    bool _isTracing;
+
+    /*! The most recent events, used as a ring once it holds _maxTraceEvents events. */
+    std::vector<traceEvent> _traceEvents;
+    int _maxTraceEvents;
+    int _nextTraceEvent;
+
+    /*! Small numbers for the threads seen so far, in the order they first added a time. */
+    QHash<Qt::HANDLE, int> _threadNumbers;
+};
+
+//times the rest of the enclosing scope as one stage of a profiler, compiled out with BV_NO_STAGE_PROFILING
+#ifdef BV_NO_STAGE_PROFILING
+#define BV_TIME_STAGE(profiler, stage)
+#else
+#define BV_TIME_STAGE(profiler, stage) StageProfiler::ScopedTimer stageTimer((profiler), (stage))
+#endif
+
+#endif
@@ -1,7 +1,12 @@
 #include "ThreadManager.h"
+#include <QThread>
+#include <algorithm>
+
+//how often the progress of the running jobs is read and passed on to the progress bar, in milliseconds
+static const int PROGRESS_POLL_MILLISECONDS = 100;
 
 /*!
- * \brief ThreadManager::ThreadManager initializes the system to the param, _taskRunning to false, and _currentMessage to "".
+ * \brief ThreadManager::ThreadManager initializes the system to the param, with an empty queue and no pooled threads.
  *
  * \param system a reference to BvSystem for connecting some of system's slots to signals emitted by the thread.
  */
@@ -9,101 +14,531 @@ ThreadManager::ThreadManager(BvSystem* system)
 {
     _bvSystem = system;
 
-    // initialize task running to false.
-    _taskRunning = false;
+    _nextJobId = 1;
+
+    // 0 runs one job per processor core.
+    _maxConcurrentJobs = 0;
 
-    // initialize current message
-    _currentMessage = "";
+    _reportedProgress = -1;
+    _monitoredJobId = 0;
+
+    _progressTimer.setInterval(PROGRESS_POLL_MILLISECONDS);
+    connect(&_progressTimer, SIGNAL(timeout()), this, SLOT(pollProgressSlot()));
 }
 
 /*!
- * \brief ThreadManager::~ThreadManager default destructor.
+ * \brief ThreadManager::~ThreadManager stops the pooled threads that have no job.  Threads still running a job are left
+ * to finish it.
  */
 ThreadManager::~ThreadManager()
 {
+    for(int i = 0; i < _idleThreads.size(); i++)
+    {
+        _idleThreads[i]->quit();
+        _idleThreads[i]->wait();
+        delete _idleThreads[i];
+    }
+
+    qDeleteAll(_jobStatuses);
 }
 
 /*!
- * \brief ThreadManager::taskFinished is a slot that sets the _taskRunning variable to false.  It is called when the
- * finished signal is emitted by the thread, indicating the thread has ended.
+ * \brief ThreadManager::queueJob adds a job to the queue and starts it right away if it can run.  The ThreadManager
+ * takes ownership of the worker, it is deleted once its job is finished.
+ *
+ * \param worker The BvThreadWorker object that contains the slot we want to run on another thread.
+ * \param priority The priority of the job, it starts before every queued job of a lower priority.
+ *
+ * \return the id of the job, used to look up its status.
  */
-void ThreadManager::taskFinished()
+int ThreadManager::queueJob(BvThreadWorker *worker, jobPriority priority)
 {
-    _taskRunning = false;
+    job newJob;
+    newJob.worker = worker;
+    newJob.status = new JobStatus(_nextJobId, worker->getMessage(), priority, worker->getExclusiveResource());
+    newJob.thread = NULL;
+    newJob.isHandlingResult = false;
+    newJob.isWorkerFinished = false;
+    newJob.threadCount = worker->getThreadCount();
+
+    _nextJobId++;
+
+    // the worker checks its own cancellation token and writes its own counters.
+    worker->setJobControl(newJob.status->getJobControl());
+
+    _jobStatuses.insert(newJob.status->getJobId(), newJob.status);
+
+    // queue the job after every job of the same or a higher priority.
+    int queuePosition = 0;
+    while(queuePosition < _queuedJobs.size() && _queuedJobs[queuePosition].status->getPriority() >= priority)
+    {
+        queuePosition++;
+    }
+
+    _queuedJobs.insert(queuePosition, newJob);
+
+    startQueuedJobs();
+
+    return newJob.status->getJobId();
 }
 
 /*!
- * \brief ThreadManager::getCurrentTaskMessage returns the message of the currently running task.
+ * \brief ThreadManager::getJobStatus gets the status of a job.
  *
- * \return a message that the currently running task has set.
+ * \param jobId The id queueJob returned for the job.
+ *
+ * \return the status of the job, NULL if there is no job with that id.
+ */
+JobStatus* ThreadManager::getJobStatus(int jobId)
+{
+    return _jobStatuses.value(jobId, NULL);
+}
+
+/*!
+ * \brief ThreadManager::getQueuedJobMessage gets a message telling the user that a job is waiting for other jobs.
+ *
+ * \param jobId The id queueJob returned for the job.
+ *
+ * \return the message of the running task followed by a note that the job was queued, or the empty string if the job
+ * is not waiting.
+ */
+QString ThreadManager::getQueuedJobMessage(int jobId)
+{
+    JobStatus* status = getJobStatus(jobId);
+
+    if(status == NULL || status->getState() != JobStatus::QUEUED)
+    {
+        return "";
+    }
+
+    return getCurrentTaskMessage() + " The request has been queued and will start when the tasks ahead of it finish.";
+}
+
+/*!
+ * \brief ThreadManager::getCurrentTaskMessage returns the message of the current task.
+ *
+ * \return a message that the currently running task has set, the empty string if no task is running.
  */
 QString ThreadManager::getCurrentTaskMessage()
 {
-    return _currentMessage;
+    JobStatus* status = getCurrentTaskStatus();
+
+    if(status == NULL)
+    {
+        return "";
+    }
+
+    return status->getMessage();
 }
 
 /*!
- *  ThreadManager::startThread checks to see if a task is currently running, and if not, creates a QThread,
- *  moves the worker to that new thread, and then connects the start, progress, result, and cleanup signals.
+ * \brief ThreadManager::cancelJob cancels one job.  A queued job is taken off the queue and never starts, a running job
+ * is asked to stop through its JobControl and finishes on its own.  Other jobs are not affected.
  *
- * \param worker The BvThreadWorker object that contains the slot we want to run on another thread.
+ * \param jobId The id queueJob returned for the job.
+ */
+void ThreadManager::cancelJob(int jobId)
+{
+    JobStatus* status = getJobStatus(jobId);
+
+    if(status == NULL || status->getState() == JobStatus::FINISHED)
+    {
+        return;
+    }
+
+    status->getJobControl()->cancel();
+
+    for(int i = 0; i < _queuedJobs.size(); i++)
+    {
+        if(_queuedJobs[i].status == status)
+        {
+            // the worker never left this thread, it can be deleted right away.
+            delete _queuedJobs[i].worker;
+            _queuedJobs.removeAt(i);
+
+            status->setState(JobStatus::FINISHED);
+
+            _bvSystem->jobFinishedSlot(jobId);
+            break;
+        }
+    }
+}
+
+/*!
+ * \brief ThreadManager::cancelCurrentTask cancels the current task, the one the progress bar follows.  Queued jobs
+ * still start once it has stopped.
+ */
+void ThreadManager::cancelCurrentTask()
+{
+    JobStatus* status = getCurrentTaskStatus();
+
+    if(status != NULL)
+    {
+        cancelJob(status->getJobId());
+    }
+}
+
+/*!
+ * \brief ThreadManager::pauseCurrentTask pauses or resumes the current task, the one the progress bar follows, if its
+ * worker can be paused.  Other running jobs keep running.
+ *
+ * \param isPaused true to pause the task, false to resume it.
  *
- * \return true if the thread was started successfully- there are no other tasks running.  False otherwise.
+ * \return true if the current task was paused or resumed, false if no task is running or it cannot be paused.
  */
-bool ThreadManager::startThread(BvThreadWorker *worker)
+bool ThreadManager::pauseCurrentTask(bool isPaused)
 {
-    // If there is a task running, then return false- we can't run another one yet.
-    if(_taskRunning)
+    JobStatus* status = getCurrentTaskStatus();
+
+    if(status == NULL)
     {
         return false;
     }
-    // Otherwise, start the thread, and change _taskRunning to true, and return true.
+
+    int runningJobIndex = findRunningJob(status->getJobId());
+
+    if(runningJobIndex < 0 || _runningJobs[runningJobIndex].worker->isPausable() == false)
+    {
+        return false;
+    }
+
+    status->getJobControl()->setPaused(isPaused);
+
+    // show the pause at once, rather than on the next poll.
+    pollProgressSlot();
+
+    return true;
+}
+
+/*!
+ * \brief ThreadManager::setMaxConcurrentJobs sets the most jobs that run at the same time.  Jobs already running keep
+ * running, a higher limit starts queued jobs right away.
+ *
+ * \param maxConcurrentJobs The most jobs that run at the same time, 0 for one per processor core.
+ */
+void ThreadManager::setMaxConcurrentJobs(int maxConcurrentJobs)
+{
+    _maxConcurrentJobs = std::max(maxConcurrentJobs, 0);
+
+    startQueuedJobs();
+}
+
+/*!
+ * \brief ThreadManager::getMaxConcurrentJobs gets the most jobs that run at the same time.
+ *
+ * \return the most jobs that run at the same time, 0 for one per processor core.
+ */
+int ThreadManager::getMaxConcurrentJobs()
+{
+    return _maxConcurrentJobs;
+}
+
+/*!
+ * \brief ThreadManager::pollProgressSlot is called by the progress timer.  Reads the progress, rate and stage times of
+ * the current task and passes them on to the system when they have changed.  Once no job is running the progress bar
+ * and status bar are reset and the timer stops.
+ */
+void ThreadManager::pollProgressSlot()
+{
+    JobStatus* status = getCurrentTaskStatus();
+
+    int progress = 0;
+    QString statusText;
+    bool isPaused = false;
+
+    if(status != NULL)
+    {
+        progress = status->getJobControl()->getProgress();
+        isPaused = status->getJobControl()->isPaused();
+
+        // the rate and time left are measured from when a job becomes the current task.
+        if(status->getJobId() != _monitoredJobId)
+        {
+            _monitoredJobId = status->getJobId();
+            _throughputMonitor.start(status->getJobControl());
+        }
+
+        _throughputMonitor.update();
+        statusText = _throughputMonitor.getStatusText();
+    }
+    else
+    {
+        _progressTimer.stop();
+        _monitoredJobId = 0;
+        _throughputMonitor.start(NULL);
+    }
+
+    if(progress != _reportedProgress)
+    {
+        _reportedProgress = progress;
+        _bvSystem->progressUpdateSlot(progress);
+    }
+
+    if(statusText != _reportedStatus)
+    {
+        _reportedStatus = statusText;
+        _bvSystem->statusUpdateSlot(statusText, isPaused);
+    }
+}
+
+/*!
+ * \brief ThreadManager::jobResultSlot passes the result of a job on to the system.  The job is not finished until the
+ * system has handled its result, even if the worker finishes while the result is handled (the system may show a
+ * dialog and wait for the user).
+ *
+ * \param jobId The id of the job.
+ * \param result The result the worker sent.
+ */
+void ThreadManager::jobResultSlot(int jobId, Result* result)
+{
+    int runningJobIndex = findRunningJob(jobId);
+
+    if(runningJobIndex < 0)
+    {
+        return;
+    }
+
+    _runningJobs[runningJobIndex].isHandlingResult = true;
+
+    _bvSystem->handleResultSlot(jobId, result);
+
+    // other jobs may have started or finished while the result was handled, and this job may no longer be running.
+    runningJobIndex = findRunningJob(jobId);
+
+    if(runningJobIndex < 0)
+    {
+        return;
+    }
+
+    _runningJobs[runningJobIndex].isHandlingResult = false;
+
+    if(_runningJobs[runningJobIndex].isWorkerFinished)
+    {
+        finishJob(runningJobIndex);
+    }
+}
+
+/*!
+ * \brief ThreadManager::jobFinishedSlot is called when the worker of a job has finished.  Finishes the job, unless its
+ * result is still being handled.
+ *
+ * \param jobId The id of the job.
+ */
+void ThreadManager::jobFinishedSlot(int jobId)
+{
+    int runningJobIndex = findRunningJob(jobId);
+
+    if(runningJobIndex < 0)
+    {
+        return;
+    }
+
+    _runningJobs[runningJobIndex].isWorkerFinished = true;
+
+    if(_runningJobs[runningJobIndex].isHandlingResult == false)
+    {
+        finishJob(runningJobIndex);
+    }
+}
+
+/*!
+ * \brief ThreadManager::startQueuedJobs starts queued jobs, highest priority first, until the limit of running jobs is
+ * reached.  A job whose resource is held by a running job does not hold up the jobs behind it.  A job whose threads do
+ * not fit next to the threads of the running jobs reserves them, jobs behind it only start if their threads fit next to
+ * the reserved ones too, so a high priority analysis is not starved by smaller jobs of a lower priority.  A job that
+ * needs more threads than there are cores still runs, alone.
+ */
+void ThreadManager::startQueuedJobs()
+{
+    int threadBudget = std::max(QThread::idealThreadCount(), 1);
+    int jobLimit = _maxConcurrentJobs;
+
+    if(jobLimit <= 0)
+    {
+        jobLimit = threadBudget;
+    }
+
+    int queuePosition = 0;
+
+    //threads of queued jobs ahead that did not fit, held back for them
+    int reservedThreadCount = 0;
+
+    while(_runningJobs.size() < jobLimit && queuePosition < _queuedJobs.size())
+    {
+        if(_queuedJobs[queuePosition].status->isExclusive() && isResourceInUse(_queuedJobs[queuePosition].status->getExclusiveResource()))
+        {
+            queuePosition++;
+            continue;
+        }
+
+        if(_runningJobs.isEmpty() == false &&
+           getRunningThreadCount() + reservedThreadCount + _queuedJobs[queuePosition].threadCount > threadBudget)
+        {
+            reservedThreadCount += _queuedJobs[queuePosition].threadCount;
+            queuePosition++;
+            continue;
+        }
+
+        job queuedJob = _queuedJobs.takeAt(queuePosition);
+
+        startJob(queuedJob);
+    }
+}
+
+/*!
+ *  ThreadManager::startJob moves the worker of a job to a pooled thread, creating a new thread if none is idle, then
+ *  connects the start, progress, result, and cleanup signals and starts the worker.
+ *
+ * \param queuedJob The job to start, it is added to the running jobs.
+ */
+void ThreadManager::startJob(job &queuedJob)
+{
+    BvThreadWorker* worker = queuedJob.worker;
+    JobStatus* status = queuedJob.status;
+
+    if(_idleThreads.isEmpty())
+    {
+        // pooled threads run their event loop until the ThreadManager is destroyed.
+        queuedJob.thread = new QThread;
+        queuedJob.thread->start(/*QThread::HighPriority*/);
+    }
     else
     {
-        _taskRunning = true;
+        queuedJob.thread = _idleThreads.takeLast();
+    }
+
+    worker->moveToThread(queuedJob.thread);
 
-        // Update the current worker's task message so we can pass it back to BvSystem.
-        _currentMessage = worker->getMessage();
+    //Signal/slot for clearing the carousel before analyze begins.
+    connect(worker, SIGNAL(clearCarouselSignal()), _bvSystem, SLOT(clearCarouselSlot()));
 
-        QThread* thread = new QThread;
+    // Notifies the UI that an image has been written, and its filename.
+    connect(worker, SIGNAL(sendImageInfoSignal(QString, QString)), _bvSystem, SLOT(updateCarouselSlot(QString, QString)));
 
-        worker->moveToThread(thread);
+    //Dustin added: sends a signal from an analysis when an error is thrown to display error window in the MainWindow class
+    connect(worker, SIGNAL(displayErrorMessageSignal()), _bvSystem, SLOT(displayErrorWindowSlot()));
 
-        // Start the thread by connecting the started signal to our start slot.
-        connect(thread, SIGNAL(started()), worker, SLOT(startSlot()));
+    // Results and the end of the job go through the job's status, which tags them with the job id.
+    connect(worker, SIGNAL(sendResultSignal(Result*)), status, SLOT(resultSlot(Result*)));
+    connect(worker, SIGNAL(finished()), status, SLOT(finishedSlot()));
 
-        //Signal/slot for clearing the carousel before analyze begins.
-        connect(worker, SIGNAL(clearCarouselSignal()), _bvSystem, SLOT(clearCarouselSlot()));
+    connect(status, SIGNAL(resultSignal(int, Result*)), this, SLOT(jobResultSlot(int, Result*)));
+    connect(status, SIGNAL(finishedSignal(int)), this, SLOT(jobFinishedSlot(int)));
 
-        // Signal/slot for sending progress bar updates.  Will get called often.
-        connect(worker, SIGNAL(progressSignal(int)), _bvSystem, SLOT(progressUpdateSlot(int)));
+    // Mark the worker instance for deletion, it is deleted on its thread, which keeps running for the next job.
+    connect(worker, SIGNAL(finished()), worker, SLOT(deleteLater()));
 
-        // Notifies the UI that an image has been written, and its filename.
-        connect(worker, SIGNAL(sendImageInfoSignal(QString, QString)), _bvSystem, SLOT(updateCarouselSlot(QString, QString)));
+    status->setState(JobStatus::RUNNING);
 
-        //Dustin added: sends a signal from an analysis when an error is thrown to display error window in the MainWindow class
-        connect(worker, SIGNAL(displayErrorMessageSignal()), _bvSystem, SLOT(displayErrorWindowSlot()));
+    _runningJobs.append(queuedJob);
 
-        // Allow the thread to send updates via the updateSignal- connect it to a test thread slot on the main window.
-        connect(worker, SIGNAL(sendResultSignal(Result*)), _bvSystem, SLOT(handleResultSlot(Result*)));
+    // progress is read from the job's control while it runs.
+    if(_progressTimer.isActive() == false)
+    {
+        _progressTimer.start();
+    }
 
-        // Tell the thread to quit when the finished signal is emitted.
-        connect(worker, SIGNAL(finished()), thread, SLOT(quit()));
+    // Start the job on its thread.
+    QMetaObject::invokeMethod(worker, "startSlot", Qt::QueuedConnection);
+}
 
-        // Mark the worker instance for deletion.
-        connect(worker, SIGNAL(finished()), worker, SLOT(deleteLater()));
+/*!
+ * \brief ThreadManager::finishJob marks a job as finished, returns its thread to the pool, and starts the jobs that were
+ * waiting for it.
+ *
+ * \param runningJobIndex The index of the job in the running jobs.
+ */
+void ThreadManager::finishJob(int runningJobIndex)
+{
+    job finishedJob = _runningJobs.takeAt(runningJobIndex);
 
-        // Causes the thread to be deleted only after it has fully shut down.
-        connect(thread, SIGNAL(finished()), thread, SLOT(deleteLater()));
+    finishedJob.status->disconnect(this);
+    finishedJob.status->setState(JobStatus::FINISHED);
 
-        // Updates ThreadManager's _taskRunning value to false when the thread finishes.
-        connect(thread, SIGNAL(finished()), this, SLOT(taskFinished()));
+    _idleThreads.append(finishedJob.thread);
 
-        // If the terminate signal is emitted (from the destructor, before finished has a chance to emit) then we still delete the thread.
-        connect(thread, SIGNAL(terminated()), thread, SLOT(deleteLater()));
+    _bvSystem->jobFinishedSlot(finishedJob.status->getJobId());
 
-        thread->start(/*QThread::HighPriority*/);
+    startQueuedJobs();
+}
 
-        return _taskRunning;
+/*!
+ * \brief ThreadManager::findRunningJob finds a job among the running jobs.
+ *
+ * \param jobId The id of the job.
+ *
+ * \return the index of the job in the running jobs, -1 if it is not running.
+ */
+int ThreadManager::findRunningJob(int jobId)
+{
+    for(int i = 0; i < _runningJobs.size(); i++)
+    {
+        if(_runningJobs[i].status->getJobId() == jobId)
+        {
+            return i;
+        }
     }
+
+    return -1;
+}
+
+/*!
+ * \brief ThreadManager::getCurrentTaskStatus finds the current task, the first running analysis or preview analysis,
+ * or the first running job if neither is running.
+ *
+ * \return the status of the current task, NULL if no job is running.
+ */
+JobStatus* ThreadManager::getCurrentTaskStatus()
+{
+    for(int i = 0; i < _runningJobs.size(); i++)
+    {
+        if(_runningJobs[i].status->isExclusive())
+        {
+            return _runningJobs[i].status;
+        }
+    }
+
+    if(_runningJobs.isEmpty() == false)
+    {
+        return _runningJobs.first().status;
+    }
+
+    return NULL;
+}
+
+/*!
+ * \brief ThreadManager::isResourceInUse checks if a running job holds a resource.
+ *
+ * \param resource The resource, \see BvThreadWorker::getExclusiveResource().
+ *
+ * \return true if a running job holds the resource, false otherwise.
+ */
+bool ThreadManager::isResourceInUse(QString resource)
+{
+    for(int i = 0; i < _runningJobs.size(); i++)
+    {
+        if(_runningJobs[i].status->getExclusiveResource() == resource)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*!
+ * \brief ThreadManager::getRunningThreadCount counts the threads the running jobs keep busy.
+ *
+ * \return the sum of the thread counts of the running jobs.
+ */
+int ThreadManager::getRunningThreadCount()
+{
+    int threadCount = 0;
+
+    for(int i = 0; i < _runningJobs.size(); i++)
+    {
+        threadCount += _runningJobs[i].threadCount;
+    }
+
+    return threadCount;
 }
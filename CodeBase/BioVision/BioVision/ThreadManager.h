@@ -1,8 +1,23 @@
 /*!
  *  \class ThreadManager
  *
- *  ThreadManager is responsible for starting new threads when the bvSystem object asks for them and for making sure those
- * threads are finished properly.  It does so through signals and slots.
+ *  ThreadManager is responsible for running the background jobs the bvSystem object asks for and for making sure those
+ * jobs are finished properly.  It does so through signals and slots.
+ *
+ * Jobs are queued by priority, jobs of the same priority start in the order they were queued.  Up to a set number of
+ * jobs run at the same time, each on a thread of a pool of threads that are kept alive and reused from job to job.
+ * Jobs that write the same resource run one at a time: analyses of one video share its output directory, and preview
+ * analyses share the preview window.  Analyses of different videos, and other jobs such as video copies, run side by
+ * side, as long as the threads of the running jobs fit on the processor cores.  A job whose threads do not fit holds
+ * them in reserve, so the jobs queued behind it cannot keep taking the cores it waits for.  A job keeps its resource
+ * until its result has been handled, so the next analysis of a video cannot clear images that are still being saved.
+ *
+ * The current task can be paused if its worker is pausable.  Pausing only sets the pause token of the job's JobControl,
+ * the worker sees it and waits, holding on to its thread.
+ *
+ * Every job has a JobStatus, kept for the life of the ThreadManager, that tells whether the job is queued, running or
+ * finished, and holds the job's JobControl.  Jobs are cancelled through their own JobControl, and their progress is read
+ * from it by a timer at a fixed rate rather than signalled by the worker on every change.
  *
  * All threads are implemented with the QThread class, which is a cross-platform thread wrapping class.
  */
@@ -14,7 +29,12 @@ class BvSystem;
 
 #include "BvSystem.h"
 #include "BvThreadWorker.h"
+#include "JobStatus.h"
+#include "ThroughputMonitor.h"
 #include "QObject"
+#include <QTimer>
+#include <QList>
+#include <QMap>
 
 class ThreadManager : public QObject
 {
@@ -22,25 +42,87 @@ class ThreadManager : public QObject
     Q_OBJECT
 
 public:
+    //the order queued jobs start in
+    enum jobPriority {LOW_PRIORITY = 0, NORMAL_PRIORITY = 1, HIGH_PRIORITY = 2};
+
     ThreadManager(BvSystem* system);
     virtual ~ThreadManager();
 
     /*! A reference to the system so that we can connect signals back to it. */
     BvSystem* _bvSystem;
 
-    bool startThread(BvThreadWorker *worker);
+    int queueJob(BvThreadWorker *worker, jobPriority priority);
+
+    JobStatus* getJobStatus(int jobId);
+
+    QString getQueuedJobMessage(int jobId);
 
     QString getCurrentTaskMessage();
 
+    void cancelJob(int jobId);
+    void cancelCurrentTask();
+    bool pauseCurrentTask(bool isPaused);
+
+    void setMaxConcurrentJobs(int maxConcurrentJobs);
+    int getMaxConcurrentJobs();
+
 public Q_SLOTS:
-    void taskFinished();
+    void pollProgressSlot();
+    void jobResultSlot(int jobId, Result* result);
+    void jobFinishedSlot(int jobId);
 
 private:
-    /*! The currently running task's busy message. */
-    QString _currentMessage;
+    //a job waiting in the queue or running on a pooled thread
+    struct job
+    {
+        BvThreadWorker* worker;
+        JobStatus* status;
+        QThread* thread;
+        bool isHandlingResult;
+        bool isWorkerFinished;
+
+        /*! Threads the job keeps busy, \see BvThreadWorker::getThreadCount(). */
+        int threadCount;
+    };
+
+    /*! Jobs waiting to start, highest priority first. */
+    QList<job> _queuedJobs;
+
+    /*! Jobs that have started and are not finished yet. */
+    QList<job> _runningJobs;
+
+    /*! Pooled threads with a running event loop and no job. */
+    QList<QThread*> _idleThreads;
+
+    /*! The status of every job ever queued, by job id. */
+    QMap<int, JobStatus*> _jobStatuses;
+
+    /*! The id the next queued job gets. */
+    int _nextJobId;
+
+    /*! The most jobs that run at the same time, 0 for one per processor core. */
+    int _maxConcurrentJobs;
+
+    /*! Reads the progress of the running jobs while any job runs. */
+    QTimer _progressTimer;
+
+    /*! The progress last passed on to the system, -1 before any. */
+    int _reportedProgress;
+
+    /*! Rate, time left and stage breakdown of the current task, and the id of the job it measures, 0 for none. */
+    ThroughputMonitor _throughputMonitor;
+    int _monitoredJobId;
+
+    /*! The status text last passed on to the system. */
+    QString _reportedStatus;
 
-    /*! Whether a task is running right now or not. */
-    bool _taskRunning;
+    void startQueuedJobs();
+    void startJob(job &queuedJob);
+    void finishJob(int runningJobIndex);
 
+    int findRunningJob(int jobId);
+    bool isResourceInUse(QString resource);
+    int getRunningThreadCount();
+    JobStatus* getCurrentTaskStatus();
 };
 #endif // !defined(EA_3EDCA5F3_8ADE_465a_A0B1_0125E8E320BE__INCLUDED_)
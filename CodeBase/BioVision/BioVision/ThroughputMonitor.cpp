@@ -0,0 +1,249 @@
+#include "ThroughputMonitor.h"
+#include <QStringList>
+
+const double ThroughputMonitor::RATE_SMOOTHING = 0.3;
+
+/*!
+ * Constructor, no job is monitored until start() is called
+ */
+ThroughputMonitor::ThroughputMonitor()
+{
+    _jobControl = NULL;
+    _lastSampleMilliseconds = 0;
+    _lastSampleFramesDone = 0;
+    _firstSampleMilliseconds = -1;
+    _firstSampleProgress = 0;
+    _pausedMilliseconds = 0;
+    _isPaused = false;
+    _framesPerSecond = 0;
+    _secondsLeft = -1;
+}
+
+/*!
+ * Destructor
+ */
+ThroughputMonitor::~ThroughputMonitor()
+{
+
+}
+
+/*!
+ * Starts monitoring a job, its rate and time left are measured from now on
+ *
+ * \param jobControl: The counters of the job, must outlive the monitor or the next start()
+ *
+ * \return Returns nothing
+ */
+void ThroughputMonitor::start(JobControl* jobControl)
+{
+    _jobControl = jobControl;
+
+    _elapsedTime.start();
+    _lastSampleMilliseconds = 0;
+    _lastSampleFramesDone = (_jobControl != NULL) ? _jobControl->getFramesDone() : 0;
+    _firstSampleMilliseconds = -1;
+    _firstSampleProgress = 0;
+    _pausedMilliseconds = 0;
+    _isPaused = false;
+    _framesPerSecond = 0;
+    _secondsLeft = -1;
+}
+
+/*!
+ * Reads the job's counters and updates the rate and time left
+ *
+ * \return Returns nothing
+ */
+void ThroughputMonitor::update()
+{
+    if(_jobControl == NULL)
+    {
+        return;
+    }
+
+    int elapsedMilliseconds = _elapsedTime.elapsed();
+    int sampleMilliseconds = elapsedMilliseconds - _lastSampleMilliseconds;
+
+    //a paused job keeps its last rate and time left, the pause is left out of the next sample
+    _isPaused = _jobControl->isPaused();
+
+    if(_isPaused == true)
+    {
+        if(_firstSampleMilliseconds >= 0)
+        {
+            _pausedMilliseconds += sampleMilliseconds;
+        }
+
+        _lastSampleMilliseconds = elapsedMilliseconds;
+        return;
+    }
+
+    if(sampleMilliseconds < MIN_SAMPLE_MILLISECONDS)
+    {
+        return;
+    }
+
+    int framesDone = _jobControl->getFramesDone();
+
+    //analyses report 1% as soon as they start, which says nothing about their speed yet
+    int progress = _jobControl->getProgress();
+
+    //the first sample with progress is where the rate and time left are measured from, a resumed analysis already has
+    //the frames of its earlier run done by then
+    if(_firstSampleMilliseconds < 0)
+    {
+        if(framesDone > 0 || progress > 1)
+        {
+            _firstSampleMilliseconds = elapsedMilliseconds;
+            _firstSampleProgress = progress;
+        }
+
+        _lastSampleMilliseconds = elapsedMilliseconds;
+        _lastSampleFramesDone = framesDone;
+        return;
+    }
+
+    double sampleFramesPerSecond = (framesDone - _lastSampleFramesDone) * 1000.0 / sampleMilliseconds;
+
+    //the first sample is taken as it is, later ones are blended in
+    if(_framesPerSecond == 0)
+    {
+        _framesPerSecond = sampleFramesPerSecond;
+    }
+    else
+    {
+        _framesPerSecond += RATE_SMOOTHING * (sampleFramesPerSecond - _framesPerSecond);
+    }
+
+    _lastSampleMilliseconds = elapsedMilliseconds;
+    _lastSampleFramesDone = framesDone;
+
+    int activeMilliseconds = elapsedMilliseconds - _firstSampleMilliseconds - _pausedMilliseconds;
+
+    if(progress > _firstSampleProgress && progress < 100)
+    {
+        _secondsLeft = (int)((activeMilliseconds / 1000.0) * (100 - progress) / (progress - _firstSampleProgress) + 0.5);
+    }
+    else
+    {
+        _secondsLeft = -1;
+    }
+}
+
+/*!
+ * Get function for the analysis rate
+ *
+ * \return Returns the smoothed number of frames analyzed per second, 0 if no frames were analyzed yet
+ */
+double ThroughputMonitor::getFramesPerSecond()
+{
+    return _framesPerSecond;
+}
+
+/*!
+ * Get function for the time left
+ *
+ * \return Returns the estimated seconds until the job is done, -1 if it can not be estimated yet
+ */
+int ThroughputMonitor::getSecondsLeft()
+{
+    return _secondsLeft;
+}
+
+/*!
+ * Builds the share of the job's stage time spent in each stage, stages that took no time are left out
+ *
+ * \return Returns the stages and their share in percent, as "decode 22% motion 41% ...", or an empty string if no
+ *         stage was timed yet
+ */
+QString ThroughputMonitor::getStageBreakdown()
+{
+    if(_jobControl == NULL)
+    {
+        return "";
+    }
+
+    std::vector<StageProfiler::stageTotal> totals = _jobControl->getStageProfiler()->getTotals();
+
+    int64 totalTicks = 0;
+
+    for(unsigned int i = 0; i < totals.size(); i++)
+    {
+        totalTicks += totals[i].ticks;
+    }
+
+    if(totalTicks <= 0)
+    {
+        return "";
+    }
+
+    QStringList stageShares;
+
+    for(unsigned int i = 0; i < totals.size(); i++)
+    {
+        if(totals[i].ticks > 0)
+        {
+            int percent = (int)((totals[i].ticks * 100.0) / totalTicks + 0.5);
+            stageShares << StageProfiler::getStageName(i) + " " + QString::number(percent) + "%";
+        }
+    }
+
+    return stageShares.join(" ");
+}
+
+/*!
+ * Builds the status bar text of the job from its rate, time left and stage breakdown, leaving out what is not known yet
+ *
+ * \return Returns the text, as "312 fps | 2:41 left | decode 22% motion 41% ...", starting with "paused" while the job is
+ *         paused, or an empty string if nothing is known
+ */
+QString ThroughputMonitor::getStatusText()
+{
+    QStringList parts;
+
+    if(_isPaused == true)
+    {
+        parts << "paused";
+    }
+
+    if(_framesPerSecond > 0)
+    {
+        parts << QString::number(_framesPerSecond, 'f', (_framesPerSecond < 10) ? 1 : 0) + " fps";
+    }
+
+    if(_secondsLeft >= 0)
+    {
+        parts << formatDuration(_secondsLeft) + " left";
+    }
+
+    QString stageBreakdown = getStageBreakdown();
+
+    if(stageBreakdown.isEmpty() == false)
+    {
+        parts << stageBreakdown;
+    }
+
+    return parts.join(" | ");
+}
+
+/*!
+ * Formats a duration the way the status bar shows it
+ *
+ * \param seconds: The duration in seconds
+ *
+ * \return Returns the duration as m:ss, or h:mm:ss from an hour on
+ */
+QString ThroughputMonitor::formatDuration(int seconds)
+{
+    int hours = seconds / 3600;
+    int minutes = (seconds / 60) % 60;
+
+    QString secondsText = QString("%1").arg(seconds % 60, 2, 10, QChar('0'));
+
+    if(hours > 0)
+    {
+        return QString::number(hours) + ":" + QString("%1").arg(minutes, 2, 10, QChar('0')) + ":" + secondsText;
+    }
+
+    return QString::number(minutes) + ":" + secondsText;
+}
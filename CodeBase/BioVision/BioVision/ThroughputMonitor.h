@@ -0,0 +1,67 @@
+/*!
+ * \class ThroughputMonitor
+ *
+ * Turns the counters of a running job into the live numbers shown in the status bar: the analysis rate in frames per
+ * second, the time left, and the share of the job's time spent in each stage of the analysis pipeline.
+ *
+ * The monitor is sampled at the rate the job's progress is polled.  The rate is smoothed over the samples so a single
+ * slow write or seek does not make it jump, and the time left follows from the progress made since the job started.
+ * Jobs that analyze no frames, like video copies, only show the time left.
+ *
+ * Both are measured from the first sample where the job has made progress, so an analysis resumed from its checkpoints,
+ * which starts with the frames of its earlier run done, is not taken for a fast one.  Time spent paused is left out.
+ */
+
+#ifndef THROUGHPUTMONITOR_H
+#define THROUGHPUTMONITOR_H
+
+#include "JobControl.h"
+#include <QString>
+#include <QTime>
+
+class ThroughputMonitor
+{
+
+public:
+    ThroughputMonitor();
+    ~ThroughputMonitor();
+
+    void start(JobControl* jobControl);
+    void update();
+
+    double getFramesPerSecond();
+    int getSecondsLeft();
+    QString getStageBreakdown();
+    QString getStatusText();
+
+    static QString formatDuration(int seconds);
+
+private:
+    //the share of a new sample in the smoothed rate
+    static const double RATE_SMOOTHING;
+
+    //samples closer together than this are left for the next one, the frame counters only move every 100 ms
+    enum { MIN_SAMPLE_MILLISECONDS = 500 };
+
+    JobControl* _jobControl;
+
+    /*! Time since start(), and its value and the frames done at the last sample. */
+    QTime _elapsedTime;
+    int _lastSampleMilliseconds;
+    int _lastSampleFramesDone;
+
+    /*! Time and progress at the first sample with progress, -1 before it, and the time spent paused since. */
+    int _firstSampleMilliseconds;
+    int _firstSampleProgress;
+    int _pausedMilliseconds;
+
+    /*! Whether the job was paused at the last update. */
+    bool _isPaused;
+
+    /*! Smoothed analysis rate, 0 until the first frames are done. */
+    double _framesPerSecond;
+
+    /*! Time left in seconds, -1 until it can be estimated. */
+    int _secondsLeft;
+};
+#endif
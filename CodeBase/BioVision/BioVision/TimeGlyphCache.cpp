@@ -0,0 +1,162 @@
+#include "TimeGlyphCache.h"
+#include <algorithm>
+#include <cstring>
+
+const char* TimeGlyphCache::CACHED_CHARACTERS = "0123456789:";
+
+//empty border around each rasterized glyph, holds the anti-aliased edge of strokes that reach the glyph's bounds
+static const int GLYPH_PADDING = 3;
+
+//stroke thickness the time is drawn with
+static const int GLYPH_THICKNESS = 1;
+
+/*!
+ * Default constructor, no glyphs are cached until a font is set
+ */
+TimeGlyphCache::TimeGlyphCache()
+{
+    _fontFace = -1;
+    _fontScale = 0;
+}
+
+/*!
+ * Destructor
+ */
+TimeGlyphCache::~TimeGlyphCache()
+{
+
+}
+
+/*!
+ * Sets the font the text is drawn in, and rasterizes the glyph of every cached character if it changed
+ *
+ * \param fontFace: The openCV Hershey font face, as passed to putText
+ * \param fontScale: The font scale, as passed to putText
+ */
+void TimeGlyphCache::setFont(int fontFace, double fontScale)
+{
+    if(fontFace == _fontFace && fontScale == _fontScale && _glyphs.empty() == false)
+    {
+        return;
+    }
+
+    _fontFace = fontFace;
+    _fontScale = fontScale;
+
+    int numberOfCharacters = strlen(CACHED_CHARACTERS);
+    _glyphs.resize(numberOfCharacters);
+
+    for(int i = 0; i < numberOfCharacters; i++)
+    {
+        std::string character(1, CACHED_CHARACTERS[i]);
+
+        int baseLine = 0;
+        cv::Size textSize = cv::getTextSize(character, fontFace, fontScale, GLYPH_THICKNESS, &baseLine);
+
+        //draw the glyph white on black, the drawn intensity of each pixel is how much of it the glyph covers
+        _glyphs[i].coverage.create(textSize.height + baseLine + GLYPH_PADDING * 2, textSize.width + GLYPH_PADDING * 2, CV_8UC1);
+        _glyphs[i].coverage.setTo(cv::Scalar(0));
+
+        putText(_glyphs[i].coverage, character, cv::Point(GLYPH_PADDING, GLYPH_PADDING + textSize.height), fontFace, fontScale,
+                cv::Scalar(255), GLYPH_THICKNESS, CV_AA, false);
+
+        //position of the glyph image relative to the text origin, and how far the next character starts after this one
+        _glyphs[i].xOffset = -GLYPH_PADDING;
+        _glyphs[i].yOffset = -GLYPH_PADDING - textSize.height;
+        _glyphs[i].advance = textSize.width - GLYPH_THICKNESS;
+    }
+}
+
+/*!
+ * Draws a string in white onto an image, with the font set by setFont()
+ *
+ * \param image: 8 bit image to draw the text onto, passed by reference
+ * \param text: The text to draw
+ * \param origin: The bottom left corner of the text, as passed to putText
+ */
+void TimeGlyphCache::drawText(cv::Mat &image, const char* text, cv::Point origin)
+{
+    int x = origin.x;
+
+    for(int i = 0; text[i] != '\0'; i++)
+    {
+        int glyphIndex = getGlyphIndex(text[i]);
+
+        //a character without a cached glyph is drawn the slow way and advanced by its own width
+        if(glyphIndex < 0)
+        {
+            std::string character(1, text[i]);
+            putText(image, character, cv::Point(x, origin.y), _fontFace, _fontScale, cv::Scalar::all(255), GLYPH_THICKNESS, CV_AA, false);
+
+            int baseLine = 0;
+            x += cv::getTextSize(character, _fontFace, _fontScale, GLYPH_THICKNESS, &baseLine).width - GLYPH_THICKNESS;
+            continue;
+        }
+
+        const glyph &characterGlyph = _glyphs[glyphIndex];
+
+        blendGlyph(image, characterGlyph, x + characterGlyph.xOffset, origin.y + characterGlyph.yOffset);
+
+        x += characterGlyph.advance;
+    }
+}
+
+/*!
+ * Finds the cached glyph of a character
+ *
+ * \param character: The character to look up
+ *
+ * \return Returns the index of the character's glyph in _glyphs, or -1 if it is not cached
+ */
+int TimeGlyphCache::getGlyphIndex(char character)
+{
+    for(unsigned int i = 0; i < _glyphs.size(); i++)
+    {
+        if(CACHED_CHARACTERS[i] == character)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/*!
+ * Blends white into an image by the coverage of a glyph, the part of the glyph outside the image is skipped
+ *
+ * \param image: 8 bit image to draw the glyph onto, passed by reference
+ * \param characterGlyph: The glyph to draw
+ * \param x: Image column of the glyph image's left edge
+ * \param y: Image row of the glyph image's top edge
+ */
+void TimeGlyphCache::blendGlyph(cv::Mat &image, const glyph &characterGlyph, int x, int y)
+{
+    int channels = image.channels();
+
+    int firstRow = std::max(0, -y);
+    int endRow = std::min(characterGlyph.coverage.rows, image.rows - y);
+    int firstColumn = std::max(0, -x);
+    int endColumn = std::min(characterGlyph.coverage.cols, image.cols - x);
+
+    for(int i = firstRow; i < endRow; i++)
+    {
+        const unsigned char* coverageRow = characterGlyph.coverage.ptr<unsigned char>(i);
+        unsigned char* imageRow = image.ptr<unsigned char>(y + i) + x * channels;
+
+        for(int j = firstColumn; j < endColumn; j++)
+        {
+            int coverage = coverageRow[j];
+
+            if(coverage == 0)
+            {
+                continue;
+            }
+
+            for(int c = 0; c < channels; c++)
+            {
+                int value = imageRow[j * channels + c];
+                imageRow[j * channels + c] = (unsigned char)(value + ((255 - value) * coverage + 127) / 255);
+            }
+        }
+    }
+}
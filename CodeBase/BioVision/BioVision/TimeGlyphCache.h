@@ -0,0 +1,53 @@
+/*!
+ * \class TimeGlyphCache
+ *
+ * Draws the video time onto saved frames from glyphs that are rasterized once, instead of rasterizing the Hershey font
+ * strokes of every character on every frame.
+ *
+ * Each character a time string can hold ("0" to "9" and ":") is drawn once with putText, white on black, into its own
+ * single channel image.  That image is the coverage of the glyph, and drawing a character blends white into the frame
+ * with it, the same way the anti-aliased putText blends its strokes.  Characters are placed at the advance widths putText
+ * would use, which are whole pixels at every font size the time is drawn at, so the cached glyphs land on the same pixels.
+ *
+ * The cache only rebuilds when the font changes, so it is built once per resolution tier.
+ */
+
+#ifndef TIMEGLYPHCACHE_H
+#define TIMEGLYPHCACHE_H
+
+#include "opencv2/core/core.hpp"
+#include <vector>
+
+class TimeGlyphCache
+{
+
+public:
+    TimeGlyphCache();
+    ~TimeGlyphCache();
+
+    void setFont(int fontFace, double fontScale);
+
+    void drawText(cv::Mat &image, const char* text, cv::Point origin);
+
+private:
+    //characters that have a cached glyph, any other character is drawn with putText
+    static const char* CACHED_CHARACTERS;
+
+    struct glyph
+    {
+        cv::Mat coverage;
+        int xOffset;
+        int yOffset;
+        int advance;
+    };
+
+    int _fontFace;
+    double _fontScale;
+
+    /*! One glyph per character of CACHED_CHARACTERS, in the same order. */
+    std::vector<glyph> _glyphs;
+
+    int getGlyphIndex(char character);
+    void blendGlyph(cv::Mat &image, const glyph &characterGlyph, int x, int y);
+};
+#endif
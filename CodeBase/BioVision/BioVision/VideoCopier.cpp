@@ -1,4 +1,5 @@
 #include "VideoCopier.h"
+#include <QFileInfo>
 
 /*!
  * \brief VideoCopier::VideoCopier The constructor takes a project name, and then a path to the video and a path to copy the
@@ -14,6 +15,9 @@ VideoCopier::VideoCopier(QString projName, QString videoPath, QString newPath)
 
     _projName = projName;
 
+    // the copy keeps one thread busy reading and writing, so it counts against the cores analyses run on.
+    setThreadCount(1);
+
     // set the message that a video copier is running.
     setMessage("A video is currently being copied, please wait until this process finishes to run another request.");
 }
@@ -28,7 +32,8 @@ VideoCopier::~VideoCopier()
 
 /*!
  * \brief VideoCopier::startSlot is run on the other thread.  Calls the copyVideo function to perform the actual copying,
- * sends the result signal after that is finished, and then sends the finished signal to end the thread.
+ * sends the result signal after that is finished, and then sends the finished signal to end the thread.  The copy is
+ * indexed afterwards by a VideoIndexer job of its own.
  */
 void VideoCopier::startSlot()
 {
@@ -60,6 +65,8 @@ void VideoCopier::copyVideo()
         {
             _result->setData(_newFile.fileName());
             _result->setProject(_projName);
+
+            _jobControl->setKilobytesWritten((int)(QFileInfo(_newFile.fileName()).size() / 1024));
         }
         else
             _result->setData("error");
@@ -6,6 +6,8 @@
  * support progress emitting for that operation.  Therefore the only notification of a video being copied is if the user
  * tries to analyze or preview analyze while a video copy operation is still in progress, this class' message will be
  * displayed, alerting the user to the fact that a video is still copying.
+ *
+ * Once the copy's result has been handled, the video in the workspace is indexed by a separate VideoIndexer job.
  */
 
 #ifndef VIDEOCOPIER_H
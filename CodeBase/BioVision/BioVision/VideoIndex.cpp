@@ -0,0 +1,209 @@
+#include "VideoIndex.h"
+#include "opencv2/highgui/highgui.hpp"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QDataStream>
+
+//identifies an index file, "BVIX"
+static const quint32 INDEX_FILE_MAGIC = 0x42564958;
+
+//bumped whenever the file layout changes, older index files are ignored and rebuilt
+static const quint32 INDEX_FILE_VERSION = 2;
+
+//how many frames a build reads between two reports to its listener
+static const int BUILD_REPORT_FRAMES = 250;
+
+/*!
+ * Default constructor, no index is loaded
+ */
+VideoIndex::VideoIndex()
+{
+    _frameCount = 0;
+}
+
+/*!
+ * Destructor
+ */
+VideoIndex::~VideoIndex()
+{
+
+}
+
+/*!
+ * Gets the path of the sidecar file holding the index of a video. Videos are copied into their own folder inside the
+ * project folder, so the index goes into the folder above the video's if that is a project folder, holding a .bv file
+ * named after it
+ *
+ * \param videoFilePath: The path of the video
+ *
+ * \return Returns the path of the index file, next to the project's .bv file, or next to the video if it is not in a
+ *         project
+ */
+QString VideoIndex::getIndexFilePath(QString videoFilePath)
+{
+    QFileInfo videoInfo(videoFilePath);
+    QDir projectDirectory = videoInfo.absoluteDir();
+
+    if(projectDirectory.cdUp() && QFile::exists(projectDirectory.filePath(projectDirectory.dirName() + ".bv")))
+    {
+        return projectDirectory.filePath(videoInfo.fileName() + ".bvidx");
+    }
+
+    return videoFilePath + ".bvidx";
+}
+
+/*!
+ * Builds the index of a video by reading through every frame, and saves it to the video's sidecar file. Takes about
+ * as long as reading the video once, so it is run on a worker thread
+ *
+ * \param videoFilePath: The path of the video
+ * \param listener: Told how many frames have been read so far, and can stop the build, NULL for none
+ *
+ * \return Returns true if the index was built and saved. A video without frames, or a build that was stopped, gets no
+ *         index, and the video goes by the frame count of its header
+ */
+bool VideoIndex::build(QString videoFilePath, buildListener* listener)
+{
+    clear();
+
+    cv::VideoCapture capture(videoFilePath.toStdString());
+
+    if(capture.isOpened() == false)
+    {
+        return false;
+    }
+
+    int estimatedFrameCount = (int)capture.get(CV_CAP_PROP_FRAME_COUNT);
+    int frameCount = 0;
+
+    //grabbing reads a frame without converting it into an image
+    while(capture.grab())
+    {
+        frameCount++;
+
+        if(listener != NULL && frameCount % BUILD_REPORT_FRAMES == 0 && listener->framesCounted(frameCount, estimatedFrameCount) == false)
+        {
+            return false;
+        }
+    }
+
+    capture.release();
+
+    if(frameCount == 0)
+    {
+        return false;
+    }
+
+    _frameCount = frameCount;
+
+    return save(videoFilePath);
+}
+/*!
+ * Loads the index of a video from its sidecar file
+ *
+ * \param videoFilePath: The path of the video
+ *
+ * \return Returns true if an index was loaded. Returns false and leaves no index loaded if there is no index file, or if
+ *         it was built from a different version of the video
+ */
+bool VideoIndex::load(QString videoFilePath)
+{
+    clear();
+
+    QFile indexFile(getIndexFilePath(videoFilePath));
+
+    if(indexFile.open(QIODevice::ReadOnly) == false)
+    {
+        return false;
+    }
+
+    QDataStream in(&indexFile);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint64 videoFileSize = 0;
+    qint64 videoModifiedTime = 0;
+    quint32 frameCount = 0;
+
+    in >> magic >> version >> videoFileSize >> videoModifiedTime >> frameCount;
+
+    QFileInfo videoInfo(videoFilePath);
+
+    if(in.status() != QDataStream::Ok || magic != INDEX_FILE_MAGIC || version != INDEX_FILE_VERSION || frameCount == 0 ||
+       videoFileSize != videoInfo.size() || videoModifiedTime != videoInfo.lastModified().toMSecsSinceEpoch())
+    {
+        return false;
+    }
+
+    _frameCount = frameCount;
+
+    return true;
+}
+
+/*!
+ * Writes the index to the sidecar file of a video. The file is written under a temporary name first, so a reader never
+ * sees half an index
+ *
+ * \param videoFilePath: The path of the video the index was built from
+ *
+ * \return Returns true if the file was written
+ */
+bool VideoIndex::save(QString videoFilePath)
+{
+    QString indexFilePath = getIndexFilePath(videoFilePath);
+    QFile indexFile(indexFilePath + ".tmp");
+
+    if(indexFile.open(QIODevice::WriteOnly | QIODevice::Truncate) == false)
+    {
+        return false;
+    }
+
+    QFileInfo videoInfo(videoFilePath);
+
+    QDataStream out(&indexFile);
+
+    out << INDEX_FILE_MAGIC << INDEX_FILE_VERSION << (qint64)videoInfo.size() << (qint64)videoInfo.lastModified().toMSecsSinceEpoch()
+        << (quint32)_frameCount;
+
+    indexFile.close();
+
+    if(out.status() != QDataStream::Ok)
+    {
+        QFile::remove(indexFile.fileName());
+        return false;
+    }
+
+    QFile::remove(indexFilePath);
+
+    return QFile::rename(indexFile.fileName(), indexFilePath);
+}
+
+/*!
+ * Unloads the index
+ */
+void VideoIndex::clear()
+{
+    _frameCount = 0;
+}
+
+/*!
+ * Checks if an index is loaded
+ *
+ * \return Returns true if the frame count comes from an index
+ */
+bool VideoIndex::isLoaded()
+{
+    return _frameCount > 0;
+}
+
+/*!
+ * Get function for the exact number of frames in the video
+ *
+ * \return Returns the number of frames, 0 if no index is loaded
+ */
+int VideoIndex::getFrameCount()
+{
+    return _frameCount;
+}
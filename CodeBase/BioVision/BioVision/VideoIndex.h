@@ -0,0 +1,61 @@
+/*!
+ * \class VideoIndex
+ *
+ * The exact frame count of one video, kept in a sidecar file next to the .bv file of the video's project (the video's
+ * file name plus ".bvidx").  A video that is not in a project folder keeps its index next to the video itself.  The index
+ * is built in the background after a video is added to a project, by reading through every frame of the video once.
+ * OpenCV loads it whenever the video is opened, and never builds it, a video without an index goes by its header.
+ *
+ * The frame count reported by the video's header is an estimate, so progress based on it is off on our H.264 files, and
+ * a read can fail before or after the frame count it reports.  With the index the frame count is exact.  Seeks are not
+ * changed by the index: they are still the decoder's own seek by frame number, neither faster nor exact, and callers
+ * read back where the stream landed.
+ *
+ * The openCV capture API reports neither keyframe flags nor the presentation time stamps of the frames (the position in
+ * milliseconds it reports is the frame number divided by the nominal frame rate), so neither is stored.
+ *
+ * File layout, written with QDataStream: a magic number and version, the size and modification time of the video the
+ * index was built from (an index that no longer matches its video is ignored), and the frame count.
+ */
+
+#ifndef VIDEOINDEX_H
+#define VIDEOINDEX_H
+
+#include <QString>
+
+class VideoIndex
+{
+
+public:
+    //told how far a build has read every few hundred frames, on the thread running the build
+    class buildListener
+    {
+    public:
+        virtual ~buildListener() {}
+
+        //returns false to stop the build, nothing is saved
+        virtual bool framesCounted(int frameCount, int estimatedFrameCount) = 0;
+    };
+
+    VideoIndex();
+    ~VideoIndex();
+
+    static QString getIndexFilePath(QString videoFilePath);
+
+    bool build(QString videoFilePath, buildListener* listener = NULL);
+
+    bool load(QString videoFilePath);
+
+    void clear();
+
+    bool isLoaded();
+
+    int getFrameCount();
+
+private:
+    /*! The number of frames in the video, 0 when no index is loaded. */
+    int _frameCount;
+
+    bool save(QString videoFilePath);
+};
+#endif
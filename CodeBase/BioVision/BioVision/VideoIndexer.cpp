@@ -0,0 +1,75 @@
+#include "VideoIndexer.h"
+#include <algorithm>
+
+/*!
+ * \brief VideoIndexer::VideoIndexer The constructor takes the path of the video to index.  It also sets the busy message
+ * for this task, and the one thread it keeps busy decoding.
+ *
+ * \param videoPath The location of the video in the workspace.
+ */
+VideoIndexer::VideoIndexer(QString videoPath)
+{
+    _videoPath = videoPath;
+
+    // reading through the video keeps a core busy decoding, so it counts against the cores analyses run on.
+    setThreadCount(1);
+
+    // set the message that a video indexer is running.
+    setMessage("A video is currently being indexed.");
+}
+
+/*!
+ * \brief VideoIndexer::~VideoIndexer default destructor.
+ */
+VideoIndexer::~VideoIndexer()
+{
+    // everything here is statically allocated.
+}
+
+/*!
+ * \brief VideoIndexer::startSlot is run on the other thread.  Calls the indexVideo function, and then sends the finished
+ * signal to end the thread.
+ */
+void VideoIndexer::startSlot()
+{
+    indexVideo();
+
+    emit finished();
+}
+
+/*!
+ * \brief VideoIndexer::indexVideo builds the index of the video, next to the project's .bv file, unless an index that
+ * matches the video is already there.  A video that cannot be indexed is still in the project, it just goes by the
+ * frame count of its header.
+ */
+void VideoIndexer::indexVideo()
+{
+    VideoIndex videoIndex;
+
+    if(videoIndex.load(_videoPath) == false)
+    {
+        videoIndex.build(_videoPath, this);
+    }
+}
+
+/*!
+ * \brief VideoIndexer::framesCounted is called by the build every few hundred frames.  Passes on the progress of the
+ * build, based on the frame count of the video's header, and stops the build if the job was cancelled.
+ *
+ * \param frameCount The number of frames read so far.
+ * \param estimatedFrameCount The frame count of the video's header, 0 if it has none.
+ *
+ * \return false if the job was cancelled, true to go on.
+ */
+bool VideoIndexer::framesCounted(int frameCount, int estimatedFrameCount)
+{
+    _jobControl->setFramesDone(frameCount);
+
+    if(estimatedFrameCount > 0)
+    {
+        // the header's frame count is an estimate, the bar stays short of full until the build ends.
+        _jobControl->setProgress(std::min((int)((frameCount * 100LL) / estimatedFrameCount), 99));
+    }
+
+    return isCancelled() == false;
+}
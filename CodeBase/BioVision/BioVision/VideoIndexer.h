@@ -0,0 +1,37 @@
+/*!
+ * VideoIndexer.h builds the index of a video in the workspace (see VideoIndex).  It is a subclass of BvThreadWorker, so
+ * that it can run on another thread via the thread manager.
+ *
+ * The system queues one after a video has been copied into a project, at a low priority, so indexing reads through the
+ * video while nothing else is waiting and never holds up an analysis.  The job reports its progress and stops when it is
+ * cancelled, a video whose index was not built goes by the frame count of its header.  It sends no result.
+ */
+
+#ifndef VIDEOINDEXER_H
+#define VIDEOINDEXER_H
+
+#include "BvThreadWorker.h"
+#include "VideoIndex.h"
+#include <QString>
+
+class VideoIndexer : public BvThreadWorker, private VideoIndex::buildListener
+{
+
+public:
+    VideoIndexer(QString videoPath);
+    virtual ~VideoIndexer();
+
+    void indexVideo();
+
+public Q_SLOTS:
+    void startSlot();
+
+private:
+
+    /*! The video in the workspace to index */
+    QString _videoPath;
+
+    bool framesCounted(int frameCount, int estimatedFrameCount);
+
+};
+#endif
@@ -92,6 +92,112 @@ QString WindowManager::getWorkspace()
     return _bvSystem->getWorkspace();
 }
 
+/*!
+ * \brief WindowManager::getAnalysisThreadCount calls to system to retrieve the number of threads used by each analysis.
+ *
+ * \return the number of analysis threads, 0 means one thread per processor core.
+ */
+int WindowManager::getAnalysisThreadCount()
+{
+    return _bvSystem->getAnalysisThreadCount();
+}
+
+/*!
+ * \brief WindowManager::getAnalysisChunkCount calls to system to retrieve the number of chunks each analysis splits its
+ * video into.
+ *
+ * \return the number of analysis chunks, 0 means one chunk per processor core.
+ */
+int WindowManager::getAnalysisChunkCount()
+{
+    return _bvSystem->getAnalysisChunkCount();
+}
+
+/*!
+ * \brief WindowManager::getJpegQuality calls to system to retrieve the quality of the images saved by an analysis.
+ *
+ * \return the JPEG quality, from 0 to 100.
+ */
+int WindowManager::getJpegQuality()
+{
+    return _bvSystem->getJpegQuality();
+}
+
+/*!
+ * \brief WindowManager::getImageMemoryBudget calls to system to retrieve the most memory that flagged frames waiting to
+ * be saved may use.
+ *
+ * \return the memory budget in megabytes.
+ */
+int WindowManager::getImageMemoryBudget()
+{
+    return _bvSystem->getImageMemoryBudget();
+}
+
+/*!
+ * \brief WindowManager::getFrameStride calls to system to retrieve the number of video frames between two analyzed frames
+ * when screening.
+ *
+ * \return the frame stride, 1 analyzes every frame.
+ */
+int WindowManager::getFrameStride()
+{
+    return _bvSystem->getFrameStride();
+}
+
+/*!
+ * \brief WindowManager::getAnalysisScale calls to system to retrieve how many times smaller in width and height frames are
+ * analyzed at.
+ *
+ * \return the analysis scale, 1 analyzes frames at full resolution.
+ */
+int WindowManager::getAnalysisScale()
+{
+    return _bvSystem->getAnalysisScale();
+}
+
+/*!
+ * \brief WindowManager::isFixedPointBackground calls to system to retrieve whether the running average background is kept
+ * as 16 bit fixed point.
+ *
+ * \return true for the fixed point background.
+ */
+bool WindowManager::isFixedPointBackground()
+{
+    return _bvSystem->isFixedPointBackground();
+}
+
+/*!
+ * \brief WindowManager::isLumaAnalysis calls to system to retrieve whether frames are analyzed on their luma.
+ *
+ * \return true for luma analysis.
+ */
+bool WindowManager::isLumaAnalysis()
+{
+    return _bvSystem->isLumaAnalysis();
+}
+
+/*!
+ * \brief WindowManager::isRecordingTimeline calls to system to retrieve whether a timeline of each analysis is recorded.
+ *
+ * \return true if the timeline is recorded.
+ */
+bool WindowManager::isRecordingTimeline()
+{
+    return _bvSystem->isRecordingTimeline();
+}
+
+/*!
+ * \brief WindowManager::getConcurrentJobCount calls to system to retrieve the most background jobs that run at the same
+ * time.
+ *
+ * \return the most jobs that run at the same time, 0 for one per processor core.
+ */
+int WindowManager::getConcurrentJobCount()
+{
+    return _bvSystem->getConcurrentJobCount();
+}
+
 /*!
  * \brief WindowManager::saveOptions Calls to system to persist all of the options that the user specified in the
  * options window.  Right now this is only the workspace, but more may be added later.
@@ -103,6 +209,37 @@ void WindowManager::saveOptions(QString newWorkspacePath)
     _bvSystem->setWorkspace(newWorkspacePath);
 }
 
+/*!
+ * \brief WindowManager::saveAnalysisOptions Calls to system to persist the analysis options that the user specified in
+ * the options window.
+ *
+ * \param analysisThreadCount The number of threads each analysis splits its frames across, 0 for one per processor core.
+ * \param analysisChunkCount The number of chunks each analysis splits its video into, 0 for one per processor core.
+ * \param jpegQuality The quality of saved images, from 0 to 100.
+ * \param imageMemoryBudget The most memory in megabytes that flagged frames waiting to be saved may use.
+ * \param frameStride The number of video frames between two analyzed frames when screening, 1 analyzes every frame.
+ * \param analysisScale How many times smaller in width and height frames are analyzed at, 1, 2, 4 or 8.
+ * \param isFixedPointBackground True to keep the running average as 16 bit fixed point instead of 32 bit floats.
+ * \param isLumaAnalysis True to analyze the luma of each frame instead of its three color channels.
+ * \param isRecordingTimeline True to record a timeline of each analysis' stages and save it with the run.
+ * \param concurrentJobCount The most background jobs that run at the same time, 0 for one per processor core.
+ */
+void WindowManager::saveAnalysisOptions(int analysisThreadCount, int analysisChunkCount, int jpegQuality, int imageMemoryBudget, int frameStride,
+                                        int analysisScale, bool isFixedPointBackground,
+                                        bool isLumaAnalysis, bool isRecordingTimeline, int concurrentJobCount)
+{
+    _bvSystem->setAnalysisThreadCount(analysisThreadCount);
+    _bvSystem->setAnalysisChunkCount(analysisChunkCount);
+    _bvSystem->setJpegQuality(jpegQuality);
+    _bvSystem->setImageMemoryBudget(imageMemoryBudget);
+    _bvSystem->setFrameStride(frameStride);
+    _bvSystem->setAnalysisScale(analysisScale);
+    _bvSystem->setFixedPointBackground(isFixedPointBackground);
+    _bvSystem->setLumaAnalysis(isLumaAnalysis);
+    _bvSystem->setRecordingTimeline(isRecordingTimeline);
+    _bvSystem->setConcurrentJobCount(concurrentJobCount);
+}
+
 /*!
  * \brief WindowManager::getAllProjects gets all of the projects from BvSystem- returns them to MainWindow to display.
  *
@@ -166,8 +303,8 @@ void WindowManager::deleteRegion(QString projName, QString vidName, QString regi
 
 /*!
  * \brief WindowManager::setRegion This function is called from RegionWindow's save button.  This function sends the request
- * to edit/add a region to the system.  It handles associated errors as well (cannot have more than 10 regions, or if
- * the region's name already exists).  Calls to system to actually attempt adding the region.
+ * to edit/add a region to the system.  It handles associated errors as well (the region's name already exists).
+ * Calls to system to actually attempt adding the region.
  *
  * \param projName
  * \param vidName
@@ -182,30 +319,19 @@ void WindowManager::deleteRegion(QString projName, QString vidName, QString regi
  */
 void WindowManager::setRegion(QString projName, QString vidName, QString oldName, QString newName, int threshold, QString notes, int x, int y, int width, int height)
 {
-    // if there are less than 10 regions OR if this is an update, we can go ahead and try to add.
-    if(_bvSystem->checkNumberOfRegions(projName, vidName) || oldName!="")
+    // A problem occurred...  Display an error message and do not close the region window.
+    if(!_bvSystem->setRegion(projName, vidName, oldName, newName, threshold, notes, x, y, width, height))
     {
-        // A problem occurred...  Display an error message and do not close the region window.
-        if(!_bvSystem->setRegion(projName, vidName, oldName, newName, threshold, notes, x, y, width, height))
-        {
-            QMessageBox errorMsg;
-            errorMsg.setText("This region's name already exists.");
-            errorMsg.setInformativeText("Select a different name.");
-            errorMsg.exec();
-        }
-        // Successful!  Refresh project browser and close the region window.
-        else
-        {
-            _mainWindow->refreshProjectBrowser();
-            _regionWindow->close();
-        }
+        QMessageBox errorMsg;
+        errorMsg.setText("This region's name already exists.");
+        errorMsg.setInformativeText("Select a different name.");
+        errorMsg.exec();
     }
+    // Successful!  Refresh project browser and close the region window.
     else
     {
-        QMessageBox errorMsg;
-        errorMsg.setText("You can only have 10 regions per video.");
-        errorMsg.setInformativeText("Remove a region in order to add another one.");
-        errorMsg.exec();
+        _mainWindow->refreshProjectBrowser();
+        _regionWindow->close();
     }
 }
 
@@ -248,10 +374,21 @@ void WindowManager::updateProgress(int progress)
     _mainWindow->setProgress(progress);
 }
 
+/*!
+ * \brief WindowManager::updateStatus shows the live status of the current task in the main window's status bar.
+ *
+ * \param statusText the rate, time left and stage breakdown of the task, empty to clear the status bar.
+ * \param isPaused true while the task is paused.
+ */
+void WindowManager::updateStatus(QString statusText, bool isPaused)
+{
+    _mainWindow->setStatus(statusText, isPaused);
+}
+
 /*!
  * WindowManager::sendAnalyzeRequest passes a request for analyzing a video to the system, where it can be handled.
- * If the system returns a message (anything other than the empty string), this indicates that a task is already in progress,
- * so display a message notifying the user that they cannot analyze at this time.
+ * If the system returns a message (anything other than the empty string), this indicates that another task is in progress
+ * and the analysis has been queued behind it, so display a message notifying the user of that.
  *
  */
 void WindowManager::sendAnalyzeRequest(QString projName, QString vidName, int startSec, int endSec, std::deque<int> videoEditTimesInSeconds, int motionSensitivity, bool isPreviewSelected,
@@ -270,7 +407,7 @@ void WindowManager::sendAnalyzeRequest(QString projName, QString vidName, int st
 
 /*!
  * \brief WindowManager::sendVideoCopyRequest sends a request for a video to be copied to the workspace directory.
- * Like sendAnalyzeRequest, if the system returns a message, then the request has failed (another task is running)
+ * Like sendAnalyzeRequest, if the system returns a message, then the request has been queued behind other tasks
  * so it displays that message to alert the user of that.
  *
  * \param projName The name of the project that the video belongs to.
@@ -308,6 +445,18 @@ void WindowManager::cancelTask()
     _bvSystem->cancelTask();
 }
 
+/*!
+ * \brief WindowManager::pauseTask tells the system to pause or resume the current task.  Called from MainWindow.
+ *
+ * \param isPaused true to pause the task, false to resume it.
+ *
+ * \return true if the task was paused or resumed, false if it cannot be paused.
+ */
+bool WindowManager::pauseTask(bool isPaused)
+{
+    return _bvSystem->pauseTask(isPaused);
+}
+
 /*!
  * \brief WindowManager::displayVidCopyError Launches a QMessageBox that displays an error notifying the user that
  * the video was not able to be copied.
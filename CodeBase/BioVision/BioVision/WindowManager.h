@@ -37,6 +37,16 @@ public:
     //Methods
     void checkWorkspace();
     QString getWorkspace();
+    int getAnalysisThreadCount();
+    int getAnalysisChunkCount();
+    int getJpegQuality();
+    int getImageMemoryBudget();
+    int getFrameStride();
+    int getAnalysisScale();
+    bool isFixedPointBackground();
+    bool isLumaAnalysis();
+    bool isRecordingTimeline();
+    int getConcurrentJobCount();
 
     // Methods to launch dialogs & windows:
     void launchRegionWindow(QString projName, QString vidName, QString regionName, int videoTimeInMilliseconds, int newRegionNumber, int x=0, int y=0, int width=0, int height=0);
@@ -50,12 +60,14 @@ public:
     // Updating Progress
     void setSimpleAnalyzeMax(int max);
     void updateProgress(int progress);
+    void updateStatus(QString statusText, bool isPaused);
 
     // Analyze & threading tasks.
     void sendAnalyzeRequest(QString projName, QString vidName, int startSec, int stopSec, std::deque<int> videoEditTimesInSeconds, int motionSensitivity, bool isPreviewSelected,
                             int previewSpeed, int previewSize, int imageOutputSize, bool isOutputImages, bool isFullFrameAnalysis);
     void sendVideoCopyRequest(QString projName, QString videoPath, QString vidName);
     void cancelTask();
+    bool pauseTask(bool isPaused);
     void updateCarousel(QString imageName, QString imageIndex);
     void displayVidCopyError();
     void displayErrorWindow();
@@ -73,6 +85,8 @@ public:
     void hideProject(QString projName);
     bool removeProject(QString projName);
     void saveOptions(QString workspacePath);
+    void saveAnalysisOptions(int analysisThreadCount, int analysisChunkCount, int jpegQuality, int imageMemoryBudget, int frameStride, int analysisScale,
+                             bool isFixedPointBackground, bool isLumaAnalysis, bool isRecordingTimeline, int concurrentJobCount);
     void setRegion(QString projName, QString vidName, QString oldName, QString newName, int threshold, QString notes, int x=0, int y=0, int width=0, int height=0);
     bool saveExperimentData(QString projName, QString vidName, QString experimentName);
     void setOverwriteOldExperiment(bool overwrite);
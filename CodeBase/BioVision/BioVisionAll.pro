@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# Builds biovision-core, then the GUI, the batch analyzer, the unit test and the benchmarks that link it.
+#
+#-------------------------------------------------
+
+TEMPLATE = subdirs
+CONFIG += ordered
+
+SUBDIRS += \
+    BioVisionCore \
+    BioVision \
+    BioVisionCli \
+    Tests/AnalysisEngineTest \
+    Benchmarks/RegionScaling \
+    Benchmarks/AnalysisSuite \
+    Benchmarks/GoldenResults
@@ -0,0 +1,267 @@
+#include "BatchAnalysis.h"
+#include "Analyzer.h"
+#include "OpenCV.h"
+#include <QDir>
+#include <QFile>
+#include <fstream>
+#include <math.h>
+
+/*!
+ * Constructor, the analysis starts when the thread is started
+ *
+ * \param video: The video to analyze, with its regions and times
+ * \param options: The options to analyze it with
+ * \param outputDirectory: The run's own directory, created when the analysis starts
+ */
+BatchAnalysis::BatchAnalysis(const BatchProject::batchVideo &video, const analysisOptions &options, QString outputDirectory)
+{
+    _video = video;
+    _options = options;
+    _outputDirectory = outputDirectory;
+    _isResultReceived = false;
+    _isErrorThrown = false;
+}
+
+/*!
+ * Destructor
+ */
+BatchAnalysis::~BatchAnalysis()
+{
+
+}
+
+/*!
+ * Get function for the options the GUI starts with: the defaults of its options window, the middle of its sensitivity
+ * slider, and native size saved images
+ *
+ * \return Returns the default options of an analysis
+ */
+BatchAnalysis::analysisOptions BatchAnalysis::getDefaultOptions()
+{
+    analysisOptions options;
+
+    //the GUI's slider starts at 50, and the analysis gets it inverted
+    options.motionSensitivity = 99 - 50;
+    options.imageOutputSize = 1;
+    options.isOutputImages = true;
+    options.isFullFrameAnalysis = false;
+    options.analysisThreadCount = 0;
+    options.analysisChunkCount = 1;
+    options.jpegQuality = 95;
+    options.imageMemoryBudget = 256;
+    options.frameStride = 1;
+    options.analysisScale = 1;
+    options.isFixedPointBackground = false;
+    options.isLumaAnalysis = false;
+    options.isRecordingTimeline = false;
+    options.isResumingFromCheckpoint = true;
+    options.runName = "batch";
+
+    return options;
+}
+
+/*!
+ * Reads the analysis options saved by the GUI's options window.  Each line holds an option name and its value, options
+ * that are missing or out of range keep the value they had, as in ProjectManager::loadOptions().
+ *
+ * \param optionsFilePath: The path of options.txt
+ * \param options: The options to update
+ */
+void BatchAnalysis::loadOptions(QString optionsFilePath, analysisOptions &options)
+{
+    std::ifstream in;
+    in.open(optionsFilePath.toStdString().c_str());
+
+    std::string optionName;
+    int optionValue;
+
+    while(in >> optionName >> optionValue)
+    {
+        if(optionName == "analysisThreadCount" && optionValue >= 0)
+            options.analysisThreadCount = optionValue;
+        else if(optionName == "analysisChunkCount" && optionValue >= 0)
+            options.analysisChunkCount = optionValue;
+        else if(optionName == "jpegQuality" && optionValue >= 0 && optionValue <= 100)
+            options.jpegQuality = optionValue;
+        else if(optionName == "imageMemoryBudget" && optionValue >= 0)
+            options.imageMemoryBudget = optionValue;
+        else if(optionName == "frameStride" && optionValue >= 1)
+            options.frameStride = optionValue;
+        else if(optionName == "analysisScale" && optionValue >= 1)
+            options.analysisScale = optionValue;
+        else if(optionName == "fixedPointBackground")
+            options.isFixedPointBackground = (optionValue != 0);
+        else if(optionName == "lumaAnalysis")
+            options.isLumaAnalysis = (optionValue != 0);
+        else if(optionName == "recordTimeline")
+            options.isRecordingTimeline = (optionValue != 0);
+    }
+
+    in.close();
+}
+
+/*!
+ * Get function for the video of the analysis
+ *
+ * \return Returns the video with its regions and times
+ */
+const BatchProject::batchVideo& BatchAnalysis::getVideo()
+{
+    return _video;
+}
+
+/*!
+ * Get function for the directory the analysis writes to
+ *
+ * \return Returns the run's own directory
+ */
+QString BatchAnalysis::getOutputDirectory()
+{
+    return _outputDirectory;
+}
+
+/*!
+ * Get function for the cancellation token and progress counters of the analysis
+ *
+ * \return Returns the analysis' JobControl, it lives as long as this object
+ */
+JobControl* BatchAnalysis::getJobControl()
+{
+    return &_jobControl;
+}
+
+/*!
+ * Checks if the analysis finished and its results were written
+ *
+ * \return Returns true once the results text is in the output directory
+ */
+bool BatchAnalysis::isSucceeded()
+{
+    return _isResultReceived && !_isErrorThrown && _errorMessage.isEmpty();
+}
+
+/*!
+ * Get function for what went wrong
+ *
+ * \return Returns why the analysis failed, an empty string if it did not
+ */
+QString BatchAnalysis::getErrorMessage()
+{
+    if(_errorMessage.isEmpty() && !isSucceeded())
+    {
+        return "The analysis of '" + _video.filePath + "' did not finish.";
+    }
+
+    return _errorMessage;
+}
+
+/*!
+ * Connected to the result signal of the Analyzer, sent once the results text has been written
+ *
+ * \param result: The result of the analysis, which holds no data and is freed here
+ */
+void BatchAnalysis::resultSlot(Result* result)
+{
+    delete result;
+    _isResultReceived = true;
+}
+
+/*!
+ * Connected to the error signal of the Analyzer, sent when openCV fails while analyzing
+ */
+void BatchAnalysis::errorSlot()
+{
+    _isErrorThrown = true;
+    _errorMessage = "An error occurred while analyzing '" + _video.filePath + "'.";
+}
+
+/*!
+ * Runs the analysis on this thread, then names the results text after the run as the GUI does when it saves an
+ * experiment.  The Analyzer is created here so it and everything it creates belong to this thread.
+ */
+void BatchAnalysis::run()
+{
+    // Check to make sure the video has not been moved or deleted.
+    if(!QFile::exists(_video.filePath))
+    {
+        _errorMessage = "Video cannot be opened.  Was the video file at location '" + _video.filePath + "' moved or deleted?";
+        return;
+    }
+
+    //a stop time of 0 analyzes the whole video, as in the GUI
+    int stopSecond = _video.stopSecond;
+
+    if(stopSecond <= 0)
+    {
+        stopSecond = getVideoLengthInSeconds();
+    }
+
+    //the Analyzer frees the region data when it is deleted
+    Analyzer* analyzer = new Analyzer(new std::vector<int>(_video.xCoords), new std::vector<int>(_video.yCoords),
+                                      new std::vector<int>(_video.widths), new std::vector<int>(_video.heights),
+                                      new std::vector<int>(_video.thresholds), _video.filePath, _video.startSecond, stopSecond,
+                                      _video.editTimesInSeconds, _options.motionSensitivity, new std::vector<QString>(_video.regionNames),
+                                      _options.imageOutputSize, _options.isOutputImages, _options.isFullFrameAnalysis,
+                                      _options.analysisThreadCount, _options.analysisChunkCount, _options.jpegQuality,
+                                      _options.imageMemoryBudget, _options.frameStride, _options.analysisScale,
+                                      _options.isFixedPointBackground, _options.isLumaAnalysis);
+
+    analyzer->setJobControl(&_jobControl);
+    analyzer->setOutputDirectory(_outputDirectory);
+
+    //a run that was interrupted goes on from the checkpoints it left in the run directory
+    analyzer->setResumeFromCheckpoint(_options.isResumingFromCheckpoint);
+
+    //the timeline is written next to the results, also when the analysis fails
+    if(_options.isRecordingTimeline == true)
+    {
+        analyzer->setTraceFilePath(QDir(_outputDirectory).filePath(_options.runName + "-trace.json"));
+    }
+
+    connect(analyzer, SIGNAL(sendResultSignal(Result*)), this, SLOT(resultSlot(Result*)), Qt::DirectConnection);
+    connect(analyzer, SIGNAL(displayErrorMessageSignal()), this, SLOT(errorSlot()), Qt::DirectConnection);
+
+    analyzer->analyze();
+
+    delete analyzer;
+
+    if(_isResultReceived == false)
+    {
+        return;
+    }
+
+    QDir outputDirectory(_outputDirectory);
+    QString resultsFileName = _options.runName + ".txt";
+
+    if(!outputDirectory.rename("tmp.txt", resultsFileName))
+    {
+        _errorMessage = "The results of '" + _video.filePath + "' could not be written to '" + _outputDirectory + "'.";
+        return;
+    }
+
+    // Copy the excel file next to the results, if it is installed with the analyzer.
+    QFile::copy("macros.xlsm", outputDirectory.filePath(_options.runName + ".xlsm"));
+}
+
+/*!
+ * Gets the length of the video, used as the stop time when none is set
+ *
+ * \return Returns the length of the video in whole seconds, rounded up so the last frames are analyzed
+ */
+int BatchAnalysis::getVideoLengthInSeconds()
+{
+    OpenCV cvObject;
+    int lengthInSeconds = 0;
+
+    if(cvObject.openVideoFile(_video.filePath.toStdString()))
+    {
+        if(cvObject.getVideoFrameRate() > 0)
+        {
+            lengthInSeconds = (int)ceil(cvObject.getNumberOfVideoFrames() / cvObject.getVideoFrameRate());
+        }
+
+        cvObject.closeVideoFile();
+    }
+
+    return lengthInSeconds;
+}
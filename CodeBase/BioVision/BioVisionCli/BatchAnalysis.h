@@ -0,0 +1,88 @@
+/*!
+ * \class BatchAnalysis
+ *
+ * Runs one Analyzer on its own thread for the headless batch analyzer, and writes its results the way the GUI saves an
+ * experiment: the results text as <run name>.txt and the flagged frames as .JPGs, in the run's own directory.  Each
+ * analysis writes straight to that directory, so any number of them can run at the same time in one process.
+ *
+ * The analysis options are read from the same options.txt as the GUI's options window, and the choices the GUI makes in
+ * its main window (sensitivity, saved images) are set by the command line.
+ *
+ * Progress and events are read from the analysis' JobControl, as the ThreadManager does for the GUI.
+ */
+
+#ifndef BATCHANALYSIS_H
+#define BATCHANALYSIS_H
+
+#include "BatchProject.h"
+#include "JobControl.h"
+#include "Result.h"
+#include <QThread>
+#include <QString>
+
+class BatchAnalysis : public QThread
+{
+    Q_OBJECT
+
+public:
+    //the options every analysis of a batch runs with
+    struct analysisOptions
+    {
+        int motionSensitivity;
+        int imageOutputSize;
+        bool isOutputImages;
+        bool isFullFrameAnalysis;
+        int analysisThreadCount;
+        int analysisChunkCount;
+        int jpegQuality;
+        int imageMemoryBudget;
+        int frameStride;
+        int analysisScale;
+        bool isFixedPointBackground;
+        bool isLumaAnalysis;
+        bool isRecordingTimeline;
+        bool isResumingFromCheckpoint;
+        QString runName;
+    };
+
+    BatchAnalysis(const BatchProject::batchVideo &video, const analysisOptions &options, QString outputDirectory);
+    ~BatchAnalysis();
+
+    static analysisOptions getDefaultOptions();
+    static void loadOptions(QString optionsFilePath, analysisOptions &options);
+
+    const BatchProject::batchVideo& getVideo();
+    QString getOutputDirectory();
+    JobControl* getJobControl();
+
+    bool isSucceeded();
+    QString getErrorMessage();
+
+public Q_SLOTS:
+    void resultSlot(Result* result);
+    void errorSlot();
+
+protected:
+    void run();
+
+private:
+    BatchProject::batchVideo _video;
+    analysisOptions _options;
+
+    /*! The run's own directory, the Analyzer writes its images and results text here. */
+    QString _outputDirectory;
+
+    /*! Cancellation token and progress counters of the analysis. */
+    JobControl _jobControl;
+
+    /*! Set by the Analyzer's result signal, which it only sends when the analysis was not stopped. */
+    bool _isResultReceived;
+
+    /*! Set by the Analyzer's error signal when openCV fails while analyzing. */
+    bool _isErrorThrown;
+
+    QString _errorMessage;
+
+    int getVideoLengthInSeconds();
+};
+#endif
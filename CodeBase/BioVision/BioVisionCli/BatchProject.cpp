@@ -0,0 +1,225 @@
+#include "BatchProject.h"
+#include <QTime>
+#include <QFileInfo>
+#include <QStringList>
+#include <fstream>
+#include <sstream>
+#include <stdlib.h>
+
+/*!
+ * Default constructor, no videos and no regions
+ */
+BatchProject::BatchProject()
+{
+
+}
+
+/*!
+ * Destructor
+ */
+BatchProject::~BatchProject()
+{
+
+}
+
+/*!
+ * Reads every video of a .bv project file, with its regions, start, stop and edit times.  The file is read the same
+ * way ProjectManager::openProject() reads it, but nothing is added to the workspace.
+ *
+ * \param projectFilePath: The path of the .bv file
+ *
+ * \return Returns an error message if the file cannot be read, an empty string otherwise
+ */
+QString BatchProject::loadProject(QString projectFilePath)
+{
+    std::ifstream in(projectFilePath.toStdString().c_str());
+
+    if(!in.is_open())
+    {
+        return "Project file '" + projectFilePath + "' cannot be opened.";
+    }
+
+    std::string line;
+
+    // the metadata, project name and project path.
+    std::getline(in, line);
+    std::getline(in, line);
+    QString projectName = QString::fromStdString(line).trimmed();
+    std::getline(in, line);
+
+    std::getline(in, line);
+    int numberOfVideos = atoi(line.c_str());
+
+    for(int a = 0; a < numberOfVideos; a++)
+    {
+        batchVideo video;
+        video.projectName = projectName;
+
+        std::getline(in, line);
+        video.videoName = QString::fromStdString(line).trimmed();
+        std::getline(in, line);
+        video.filePath = QString::fromStdString(line).trimmed();
+
+        // the video threshold, number of frames, frame rate, height and width, which the analysis reads from the video.
+        for(int i = 0; i < 5; i++)
+        {
+            std::getline(in, line);
+        }
+
+        std::getline(in, line);
+        video.startSecond = timeToSeconds(QString::fromStdString(line));
+        std::getline(in, line);
+        video.stopSecond = timeToSeconds(QString::fromStdString(line));
+
+        std::getline(in, line);
+        int numberOfTimes = atoi(line.c_str());
+
+        for(int i = 0; i < numberOfTimes; i++)
+        {
+            std::getline(in, line);
+            video.editTimesInSeconds.push_back(timeToSeconds(QString::fromStdString(line)));
+        }
+
+        std::getline(in, line);
+        int numberOfRegions = atoi(line.c_str());
+
+        for(int b = 0; b < numberOfRegions; b++)
+        {
+            std::getline(in, line);
+            video.regionNames.push_back(QString::fromStdString(line).trimmed());
+            std::getline(in, line);
+            video.thresholds.push_back(atoi(line.c_str()));
+
+            // the region notes.
+            std::getline(in, line);
+
+            std::getline(in, line);
+            video.heights.push_back(atoi(line.c_str()));
+            std::getline(in, line);
+            video.widths.push_back(atoi(line.c_str()));
+            std::getline(in, line);
+            video.xCoords.push_back(atoi(line.c_str()));
+            std::getline(in, line);
+            video.yCoords.push_back(atoi(line.c_str()));
+        }
+
+        if(in.fail())
+        {
+            return "Project file '" + projectFilePath + "' ends before the data of all of its videos.";
+        }
+
+        _videos.push_back(video);
+    }
+
+    return "";
+}
+
+/*!
+ * Reads the regions that the videos added after it are analyzed with
+ *
+ * \param regionSpecFilePath: The path of the region spec file, one "name x y width height threshold" line per region
+ *
+ * \return Returns an error message if the file cannot be read or a line is malformed, an empty string otherwise
+ */
+QString BatchProject::loadRegionSpec(QString regionSpecFilePath)
+{
+    std::ifstream in(regionSpecFilePath.toStdString().c_str());
+
+    if(!in.is_open())
+    {
+        return "Region spec file '" + regionSpecFilePath + "' cannot be opened.";
+    }
+
+    batchVideo regionSpec;
+    std::string line;
+    int lineNumber = 0;
+
+    while(std::getline(in, line))
+    {
+        lineNumber++;
+
+        QString trimmedLine = QString::fromStdString(line).trimmed();
+        if(trimmedLine.isEmpty() || trimmedLine.startsWith("#"))
+        {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        std::string name;
+        int x, y, width, height, threshold;
+
+        if(!(fields >> name >> x >> y >> width >> height >> threshold) || width <= 0 || height <= 0)
+        {
+            return "Line " + QString::number(lineNumber) + " of region spec file '" + regionSpecFilePath + "' is not a valid region.";
+        }
+
+        regionSpec.regionNames.push_back(QString::fromStdString(name));
+        regionSpec.xCoords.push_back(x);
+        regionSpec.yCoords.push_back(y);
+        regionSpec.widths.push_back(width);
+        regionSpec.heights.push_back(height);
+        regionSpec.thresholds.push_back(threshold);
+    }
+
+    _regionSpec = regionSpec;
+
+    return "";
+}
+
+/*!
+ * Adds a video that is analyzed with the regions of the last region spec file
+ *
+ * \param videoFilePath: The path of the video
+ * \param startSecond: The video time to start analyzing at
+ * \param stopSecond: The video time to stop analyzing at, 0 analyzes to the end of the video
+ *
+ * \return Returns an error message if the video does not exist, an empty string otherwise
+ */
+QString BatchProject::addVideo(QString videoFilePath, int startSecond, int stopSecond)
+{
+    QFileInfo videoFile(videoFilePath);
+
+    if(!videoFile.exists())
+    {
+        return "Video file '" + videoFilePath + "' does not exist.";
+    }
+
+    batchVideo video = _regionSpec;
+    video.videoName = videoFile.completeBaseName();
+    video.filePath = videoFilePath;
+    video.startSecond = startSecond;
+    video.stopSecond = stopSecond;
+
+    _videos.push_back(video);
+
+    return "";
+}
+
+/*!
+ * Get function for the videos to analyze
+ *
+ * \return Returns every video read so far, in the order they were given
+ */
+const QList<BatchProject::batchVideo>& BatchProject::getVideos() const
+{
+    return _videos;
+}
+
+/*!
+ * Converts a time saved in a project file to seconds
+ *
+ * \param time: The time as hh:mm:ss
+ *
+ * \return Returns the time in seconds, 0 if it is not a valid time
+ */
+int BatchProject::timeToSeconds(QString time)
+{
+    QTime qTime = QTime::fromString(time.trimmed(), "hh:mm:ss");
+
+    if(!qTime.isValid())
+    {
+        return 0;
+    }
+
+    return (qTime.hour() * 3600) + (qTime.minute() * 60) + qTime.second();
+}
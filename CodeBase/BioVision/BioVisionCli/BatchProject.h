@@ -0,0 +1,61 @@
+/*!
+ * \class BatchProject
+ *
+ * The videos the headless batch analyzer runs, and the regions and times of each.  They are read from .bv project
+ * files, in the format ProjectManager saves, or given as video files sharing one region spec file.
+ *
+ * A region spec file holds one region per line: its name, x, y, width, height and threshold, separated by spaces.  Blank
+ * lines and lines starting with # are skipped.  A video without regions is analyzed as one region covering the frame,
+ * as in the GUI.
+ *
+ * Nothing here uses the GUI classes, projects are read straight into the data an Analyzer needs.
+ */
+
+#ifndef BATCHPROJECT_H
+#define BATCHPROJECT_H
+
+#include <QString>
+#include <QList>
+#include <vector>
+#include <deque>
+
+class BatchProject
+{
+
+public:
+    //one video to analyze, with the regions and times saved for it
+    struct batchVideo
+    {
+        QString projectName;
+        QString videoName;
+        QString filePath;
+        int startSecond;
+        int stopSecond;
+        std::deque<int> editTimesInSeconds;
+        std::vector<int> xCoords;
+        std::vector<int> yCoords;
+        std::vector<int> widths;
+        std::vector<int> heights;
+        std::vector<int> thresholds;
+        std::vector<QString> regionNames;
+    };
+
+    BatchProject();
+    ~BatchProject();
+
+    QString loadProject(QString projectFilePath);
+    QString loadRegionSpec(QString regionSpecFilePath);
+    QString addVideo(QString videoFilePath, int startSecond, int stopSecond);
+
+    const QList<batchVideo>& getVideos() const;
+
+private:
+    /*! Every video read so far, in the order they were given. */
+    QList<batchVideo> _videos;
+
+    /*! The regions of the last region spec file, given to the videos added after it. */
+    batchVideo _regionSpec;
+
+    static int timeToSeconds(QString time);
+};
+#endif
@@ -0,0 +1,33 @@
+#-------------------------------------------------
+#
+# Headless batch analyzer.
+# Runs the analysis of .bv projects or of videos with a region spec, several videos at the same time, without the GUI.
+# Links QtCore alone: no QtGui, Phonon, WebKit or Declarative.
+#
+#-------------------------------------------------
+
+QT       = core
+
+TARGET = biovision-cli
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+# the analysis engine and OpenCV
+include(../BioVisionCore/BioVisionCore.pri)
+
+SOURCES += main.cpp \
+    BatchProject.cpp \
+    BatchAnalysis.cpp \
+    ../BioVision/Analyzer.cpp \
+    ../BioVision/BvThreadWorker.cpp \
+    ../BioVision/JobControl.cpp \
+    ../BioVision/ThroughputMonitor.cpp
+
+HEADERS += \
+    BatchProject.h \
+    BatchAnalysis.h \
+    ../BioVision/Analyzer.h \
+    ../BioVision/BvThreadWorker.h \
+    ../BioVision/JobControl.h \
+    ../BioVision/ThroughputMonitor.h
@@ -0,0 +1,293 @@
+///////////////////////////////////////////////////////////
+//  main.cpp
+//  Headless batch analyzer
+///////////////////////////////////////////////////////////
+
+#include "BatchProject.h"
+#include "BatchAnalysis.h"
+#include "ThroughputMonitor.h"
+#include <QCoreApplication>
+#include <QStringList>
+#include <QDir>
+#include <QTime>
+#include <stdio.h>
+
+//how often finished analyses are collected and new ones started, in milliseconds
+static const unsigned long POLL_MILLISECONDS = 100;
+
+/*!
+ * Prints how to run the analyzer
+ */
+static void printUsage()
+{
+    printf("usage: biovision-cli [options] project.bv ...\n"
+           "       biovision-cli [options] --regions regions.txt video ...\n"
+           "\n"
+           "  --regions FILE      regions for the videos that follow, one \"name x y width height threshold\" per line\n"
+           "  --start SECONDS     start time of the videos that follow (default 0)\n"
+           "  --stop SECONDS      stop time of the videos that follow, 0 for the whole video (default 0)\n"
+           "  --output DIR        directory the results are written to (default results)\n"
+           "  --run NAME          name of the results of every video (default batch)\n"
+           "  --jobs N            videos analyzed at the same time, 0 for one per core (default 0)\n"
+           "  --options FILE      analysis options saved by the options window (default options.txt)\n"
+           "  --sensitivity N     sensitivity from 0 to 99, as on the sensitivity slider (default 50)\n"
+           "  --image-size SIZE   size of saved images: native, small or medium (default native)\n"
+           "  --no-images         do not save the flagged frames\n"
+           "  --full-frame        analyze the whole frame instead of the area holding the regions\n"
+           "  --trace             write a timeline of each analysis' stages next to its results, for chrome://tracing\n"
+           "  --no-resume         start every analysis over, instead of going on from the checkpoints of an interrupted run\n"
+           "  --threads N         threads each frame is split across, 0 for one per core (default 1)\n");
+}
+
+/*!
+ * Gets the directory the results of a video are written to, laid out like the GUI's workspace:
+ * <output>/<project>/<video>/<run name>
+ */
+static QString getRunDirectory(QString outputDirectory, const BatchProject::batchVideo &video, QString runName)
+{
+    QString runDirectory = outputDirectory;
+
+    if(!video.projectName.isEmpty())
+    {
+        runDirectory += "/" + video.projectName;
+    }
+
+    return runDirectory + "/" + video.videoName + "/" + runName;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication application(argc, argv);
+    QStringList arguments = application.arguments();
+
+    BatchProject batchProject;
+    BatchAnalysis::analysisOptions options = BatchAnalysis::getDefaultOptions();
+    QString optionsFilePath = "options.txt";
+    QString outputDirectory = "results";
+    int jobCount = 0;
+    int startSecond = 0;
+    int stopSecond = 0;
+
+    //several analyses run at the same time, each splits its frames across one thread unless asked otherwise
+    int analysisThreadCount = 1;
+
+    //read every option first, the options file must not override the command line
+    int sensitivity = 50;
+    int imageOutputSize = options.imageOutputSize;
+    bool isOutputImages = options.isOutputImages;
+    bool isFullFrameAnalysis = options.isFullFrameAnalysis;
+    bool isRecordingTimeline = false;
+    bool isResumingFromCheckpoint = true;
+    QString runName = options.runName;
+
+    for(int i = 1; i < arguments.size(); i++)
+    {
+        QString argument = arguments[i];
+        bool isValueMissing = (i + 1 >= arguments.size());
+        QString error;
+
+        if(argument == "--help" || argument == "-h")
+        {
+            printUsage();
+            return 0;
+        }
+        else if(argument == "--no-images")
+        {
+            isOutputImages = false;
+        }
+        else if(argument == "--full-frame")
+        {
+            isFullFrameAnalysis = true;
+        }
+        else if(argument == "--trace")
+        {
+            isRecordingTimeline = true;
+        }
+        else if(argument == "--no-resume")
+        {
+            isResumingFromCheckpoint = false;
+        }
+        else if(argument.startsWith("--") && isValueMissing)
+        {
+            error = "Option " + argument + " needs a value.";
+        }
+        else if(argument == "--regions")
+        {
+            error = batchProject.loadRegionSpec(arguments[++i]);
+        }
+        else if(argument == "--start")
+        {
+            startSecond = arguments[++i].toInt();
+        }
+        else if(argument == "--stop")
+        {
+            stopSecond = arguments[++i].toInt();
+        }
+        else if(argument == "--output")
+        {
+            outputDirectory = arguments[++i];
+        }
+        else if(argument == "--run")
+        {
+            runName = arguments[++i];
+        }
+        else if(argument == "--jobs")
+        {
+            jobCount = arguments[++i].toInt();
+        }
+        else if(argument == "--options")
+        {
+            optionsFilePath = arguments[++i];
+        }
+        else if(argument == "--sensitivity")
+        {
+            sensitivity = qBound(0, arguments[++i].toInt(), 99);
+        }
+        else if(argument == "--threads")
+        {
+            analysisThreadCount = qMax(arguments[++i].toInt(), 0);
+        }
+        else if(argument == "--image-size")
+        {
+            QString size = arguments[++i];
+
+            if(size == "native")
+                imageOutputSize = 1;
+            else if(size == "small")
+                imageOutputSize = 2;
+            else if(size == "medium")
+                imageOutputSize = 3;
+            else
+                error = "Unknown image size '" + size + "'.";
+        }
+        else if(argument.startsWith("--"))
+        {
+            error = "Unknown option " + argument + ".";
+        }
+        else if(argument.endsWith(".bv", Qt::CaseInsensitive))
+        {
+            error = batchProject.loadProject(argument);
+        }
+        else
+        {
+            error = batchProject.addVideo(argument, startSecond, stopSecond);
+        }
+
+        if(!error.isEmpty())
+        {
+            fprintf(stderr, "biovision-cli: %s\n", error.toLocal8Bit().constData());
+            return 2;
+        }
+    }
+
+    const QList<BatchProject::batchVideo> &videos = batchProject.getVideos();
+
+    if(videos.size() == 0)
+    {
+        printUsage();
+        return 2;
+    }
+
+    BatchAnalysis::loadOptions(optionsFilePath, options);
+    options.motionSensitivity = 99 - sensitivity;
+    options.imageOutputSize = imageOutputSize;
+    options.isOutputImages = isOutputImages;
+    options.isFullFrameAnalysis = isFullFrameAnalysis;
+    options.analysisThreadCount = analysisThreadCount;
+    options.isResumingFromCheckpoint = isResumingFromCheckpoint;
+    options.runName = runName;
+
+    //the option can also be turned on in the options window
+    if(isRecordingTimeline == true)
+    {
+        options.isRecordingTimeline = true;
+    }
+
+    if(jobCount <= 0)
+    {
+        jobCount = QThread::idealThreadCount();
+    }
+
+    //every analysis gets its own run directory, two videos with the same name would clear each other's output
+    QList<BatchAnalysis*> waitingAnalyses;
+    QStringList runDirectories;
+
+    for(int i = 0; i < videos.size(); i++)
+    {
+        QString runDirectory = getRunDirectory(outputDirectory, videos[i], runName);
+
+        if(runDirectories.contains(runDirectory))
+        {
+            fprintf(stderr, "biovision-cli: %s is analyzed twice, skipping it.\n", videos[i].filePath.toLocal8Bit().constData());
+            continue;
+        }
+
+        runDirectories.push_back(runDirectory);
+        waitingAnalyses.push_back(new BatchAnalysis(videos[i], options, runDirectory));
+    }
+
+    QList<BatchAnalysis*> runningAnalyses;
+    int failedCount = 0;
+    int analysisCount = waitingAnalyses.size();
+    QTime batchTime;
+    batchTime.start();
+
+    while(waitingAnalyses.size() > 0 || runningAnalyses.size() > 0)
+    {
+        //start analyses until the job count is reached
+        while(waitingAnalyses.size() > 0 && runningAnalyses.size() < jobCount)
+        {
+            BatchAnalysis* analysis = waitingAnalyses.takeFirst();
+            printf("started  %s\n", analysis->getVideo().filePath.toLocal8Bit().constData());
+            fflush(stdout);
+
+            analysis->start();
+            runningAnalyses.push_back(analysis);
+        }
+
+        runningAnalyses.first()->wait(POLL_MILLISECONDS);
+
+        //report and free the finished analyses
+        for(int i = runningAnalyses.size() - 1; i >= 0; i--)
+        {
+            BatchAnalysis* analysis = runningAnalyses[i];
+
+            if(analysis->isFinished() == false)
+            {
+                continue;
+            }
+
+            if(analysis->isSucceeded())
+            {
+                printf("finished %s: %d frames, %d events, %d KB written to %s\n",
+                       analysis->getVideo().filePath.toLocal8Bit().constData(),
+                       analysis->getJobControl()->getFramesDone(), analysis->getJobControl()->getEventsFound(),
+                       analysis->getJobControl()->getKilobytesWritten(),
+                       QDir::toNativeSeparators(analysis->getOutputDirectory()).toLocal8Bit().constData());
+
+                //where the analysis spent its time, summed over all of its threads
+                ThroughputMonitor throughputMonitor;
+                throughputMonitor.start(analysis->getJobControl());
+                QString stageBreakdown = throughputMonitor.getStageBreakdown();
+
+                if(stageBreakdown.isEmpty() == false)
+                {
+                    printf("         stages: %s\n", stageBreakdown.toLocal8Bit().constData());
+                }
+            }
+            else
+            {
+                failedCount++;
+                fprintf(stderr, "failed   %s\n", analysis->getErrorMessage().toLocal8Bit().constData());
+            }
+            fflush(stdout);
+
+            runningAnalyses.removeAt(i);
+            delete analysis;
+        }
+    }
+
+    printf("%d of %d videos analyzed in %.1f seconds\n", analysisCount - failedCount, analysisCount, batchTime.elapsed() / 1000.0);
+
+    return (failedCount == 0) ? 0 : 1;
+}
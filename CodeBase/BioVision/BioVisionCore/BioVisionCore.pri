@@ -0,0 +1,30 @@
+#-------------------------------------------------
+#
+# Builds a project against biovision-core: its headers, the library and OpenCV.
+# Include it from a project built in the same build tree as BioVisionCore.  Projects one directory further down, like
+# the benchmarks, set BIOVISION_TOP = ../.. before including it.
+#
+#-------------------------------------------------
+
+INCLUDEPATH += $$PWD/../BioVision
+DEPENDPATH += $$PWD/../BioVision
+win32:INCLUDEPATH += C:\opencv\build\include
+macx:INCLUDEPATH += /usr/local/include
+
+# must match the CONFIG biovision-core was built with
+no_stage_profiling: DEFINES += BV_NO_STAGE_PROFILING
+
+isEmpty(BIOVISION_TOP): BIOVISION_TOP = ..
+
+win32:CONFIG(release, debug|release): BIOVISION_CORE_DIR = $$OUT_PWD/$$BIOVISION_TOP/BioVisionCore/release
+else:win32:CONFIG(debug, debug|release): BIOVISION_CORE_DIR = $$OUT_PWD/$$BIOVISION_TOP/BioVisionCore/debug
+else: BIOVISION_CORE_DIR = $$OUT_PWD/$$BIOVISION_TOP/BioVisionCore
+
+LIBS += -L$$BIOVISION_CORE_DIR -lbiovision-core
+
+win32: PRE_TARGETDEPS += $$BIOVISION_CORE_DIR/biovision-core.lib
+else: PRE_TARGETDEPS += $$BIOVISION_CORE_DIR/libbiovision-core.a
+
+win32:LIBS += C:\opencv\build\x86\vc10\lib\*.lib
+macx:LIBS += /usr/local/lib/*.dylib
+unix:!macx:LIBS += -lopencv_core -lopencv_imgproc -lopencv_highgui
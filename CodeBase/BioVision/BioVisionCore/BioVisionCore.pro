@@ -0,0 +1,52 @@
+#-------------------------------------------------
+#
+# biovision-core, the video analysis engine as a static library.
+# Holds the analysis itself and its frame pipeline, and links QtCore and OpenCV alone.  The GUI, the batch analyzer and
+# the benchmarks are built against it with BioVisionCore.pri.
+#
+#-------------------------------------------------
+
+QT       = core
+
+TARGET = biovision-core
+TEMPLATE = lib
+CONFIG += staticlib
+
+INCLUDEPATH += ../BioVision
+win32:INCLUDEPATH += C:\opencv\build\include
+macx:INCLUDEPATH += /usr/local/include
+
+# build with CONFIG+=no_stage_profiling to take the stage timers out of the analysis, see StageProfiler
+no_stage_profiling: DEFINES += BV_NO_STAGE_PROFILING
+
+SOURCES += \
+    ../BioVision/AnalysisEngine.cpp \
+    ../BioVision/OpenCV.cpp \
+    ../BioVision/MotionKernel.cpp \
+    ../BioVision/RegionEngine.cpp \
+    ../BioVision/TimeGlyphCache.cpp \
+    ../BioVision/VideoIndex.cpp \
+    ../BioVision/SegmentPlan.cpp \
+    ../BioVision/FrameRing.cpp \
+    ../BioVision/FrameDecoder.cpp \
+    ../BioVision/AnalysisChunk.cpp \
+    ../BioVision/AnalysisCheckpoint.cpp \
+    ../BioVision/JpegWriterPool.cpp \
+    ../BioVision/StageProfiler.cpp \
+    ../BioVision/Result.cpp
+
+HEADERS += \
+    ../BioVision/AnalysisEngine.h \
+    ../BioVision/OpenCV.h \
+    ../BioVision/MotionKernel.h \
+    ../BioVision/RegionEngine.h \
+    ../BioVision/TimeGlyphCache.h \
+    ../BioVision/VideoIndex.h \
+    ../BioVision/SegmentPlan.h \
+    ../BioVision/FrameRing.h \
+    ../BioVision/FrameDecoder.h \
+    ../BioVision/AnalysisChunk.h \
+    ../BioVision/AnalysisCheckpoint.h \
+    ../BioVision/JpegWriterPool.h \
+    ../BioVision/StageProfiler.h \
+    ../BioVision/Result.h
@@ -0,0 +1,20 @@
+#-------------------------------------------------
+#
+# Analysis engine unit test.
+# Checks the region table, thresholds and flagged frames of AnalysisEngine on generated frames.  Links biovision-core
+# and OpenCV alone, and exits with 1 if a check fails.
+#
+#-------------------------------------------------
+
+QT       = core
+
+TARGET = AnalysisEngineTest
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+# the analysis engine and OpenCV
+BIOVISION_TOP = ../..
+include(../../BioVisionCore/BioVisionCore.pri)
+
+SOURCES += main.cpp
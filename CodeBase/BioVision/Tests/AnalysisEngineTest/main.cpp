@@ -0,0 +1,227 @@
+///////////////////////////////////////////////////////////
+//  main.cpp
+//  Analysis engine unit test
+///////////////////////////////////////////////////////////
+
+#include "AnalysisEngine.h"
+#include "opencv2/core/core.hpp"
+#include <stdio.h>
+
+//test frame size, two square regions side by side
+static const int FRAME_WIDTH = 200;
+static const int FRAME_HEIGHT = 100;
+
+//threshold of the left region in percent, 1000 of its 10000 pixels must change
+static const int LEFT_THRESHOLD = 10;
+
+//number of checks that failed
+static int failedChecks = 0;
+
+/*!
+ * Reports a check that failed
+ *
+ * \param isPassed: The result of the check
+ * \param description: What was checked, printed if it failed
+ * \param caseName: The settings the check was run with
+ */
+static void check(bool isPassed, const char* description, const char* caseName)
+{
+    if(isPassed == false)
+    {
+        printf("FAILED %s: %s\n", caseName, description);
+        failedChecks++;
+    }
+}
+
+//keeps the result of the last analyzed frame
+class lastResult : public AnalysisEngine::frameListener
+{
+public:
+    AnalysisEngine::frameResult result;
+
+    void frameAnalyzed(const AnalysisEngine::frameResult &frameResult)
+    {
+        result = frameResult;
+        result.frameWithDifference = NULL;
+    }
+};
+
+/*!
+ * Pushes a black frame with a white rectangle, every pixel of the rectangle is motion against a black average
+ *
+ * \return Returns false if the engine did not take the frame
+ */
+static bool pushRectangle(AnalysisEngine &engine, int frameNumber, cv::Rect rectangle, bool isEditFrame)
+{
+    cv::Mat frame(FRAME_HEIGHT, FRAME_WIDTH, CV_8UC3, cv::Scalar(0, 0, 0));
+
+    if(rectangle.area() > 0)
+    {
+        frame(rectangle).setTo(cv::Scalar(255, 255, 255));
+    }
+
+    return engine.pushFrame(frame, frameNumber, isEditFrame);
+}
+
+/*!
+ * Checks the region table built for drawn regions and for an empty region list
+ */
+static void testRegionTable()
+{
+    std::vector<AnalysisEngine::region> regions(2);
+    regions[0].x = 0;
+    regions[0].y = 0;
+    regions[0].width = 100;
+    regions[0].height = 100;
+    regions[0].threshold = LEFT_THRESHOLD;
+    regions[1].x = 100;
+    regions[1].y = 10;
+    regions[1].width = 50;
+    regions[1].height = 80;
+    regions[1].threshold = 0;
+
+    AnalysisEngine::regionTable table = AnalysisEngine::createRegionTable(regions, FRAME_WIDTH, FRAME_HEIGHT);
+
+    check(table.regionCoordinates.size() == 2 && table.regionWidths.size() == 2 && table.regionHeights.size() == 2 &&
+          table.percentChangeInRegion.size() == 2, "one entry per region", "region table");
+    check(table.regionCoordinates[1][0] == 100 && table.regionCoordinates[1][1] == 10 && table.regionCoordinates[1][2] == 150 &&
+          table.regionCoordinates[1][3] == 90, "coordinates are X1, Y1, X1 + width and Y1 + height", "region table");
+    check(table.regionWidths[1] == 50 && table.regionHeights[1] == 80, "sizes are the drawn sizes", "region table");
+    check(table.percentChangeInRegion[0] == LEFT_THRESHOLD / 100.0f && table.percentChangeInRegion[1] == 0,
+          "thresholds are a share of the region", "region table");
+
+    table = AnalysisEngine::createRegionTable(std::vector<AnalysisEngine::region>(), FRAME_WIDTH, FRAME_HEIGHT);
+
+    check(table.regionCoordinates.size() == 1, "no regions analyze one region", "whole frame");
+    check(table.regionCoordinates[0][0] == 0 && table.regionCoordinates[0][1] == 0 && table.regionCoordinates[0][2] == FRAME_WIDTH &&
+          table.regionCoordinates[0][3] == FRAME_HEIGHT, "the region covers the frame", "whole frame");
+    check(table.percentChangeInRegion[0] == 0, "the region passes on any change", "whole frame");
+}
+
+/*!
+ * Checks which frames pass the thresholds of two regions, the left one needing 1000 changed pixels and the right one any
+ * change, and the counts the engine keeps
+ *
+ * \param analysisSettings: The settings to analyze with, the changed pixel counts must not depend on them
+ * \param caseName: The name the settings are reported with
+ */
+static void testThresholds(const AnalysisEngine::settings &analysisSettings, const char* caseName)
+{
+    std::vector<AnalysisEngine::region> regions(2);
+    regions[0].x = 0;
+    regions[0].y = 0;
+    regions[0].width = 100;
+    regions[0].height = 100;
+    regions[0].threshold = LEFT_THRESHOLD;
+    regions[1].x = 100;
+    regions[1].y = 0;
+    regions[1].width = 100;
+    regions[1].height = 100;
+    regions[1].threshold = 0;
+
+    AnalysisEngine engine;
+    lastResult listener;
+
+    engine.openSource(FRAME_WIDTH, FRAME_HEIGHT, 30.0);
+    engine.setRegions(regions);
+    engine.setSettings(analysisSettings);
+    engine.setListener(&listener);
+
+    check(engine.start() == true, "the analysis starts", caseName);
+
+    //the first frame resets the average, nothing can pass on it
+    pushRectangle(engine, 0, cv::Rect(), false);
+    check(listener.result.isThreshHoldPassed == false, "the first frame is not flagged", caseName);
+
+    //800 changed pixels stay under the left region's threshold
+    pushRectangle(engine, 1, cv::Rect(20, 20, 40, 20), false);
+    check(listener.result.changedPixels[0] == 800, "800 pixels are counted in the left region", caseName);
+    check(listener.result.isRegionOverThreshHold[0] == false, "800 pixels do not pass a 1000 pixel threshold", caseName);
+    check(listener.result.isThreshHoldPassed == false, "a frame without a passing region is not flagged", caseName);
+
+    //an edit frame resets the average and the previous counts
+    pushRectangle(engine, 2, cv::Rect(), true);
+    check(listener.result.changedPixels[0] == 0 && listener.result.isThreshHoldPassed == false, "an edit frame is not flagged", caseName);
+
+    //1200 changed pixels pass it
+    pushRectangle(engine, 3, cv::Rect(20, 20, 40, 30), false);
+    check(listener.result.changedPixels[0] == 1200, "1200 pixels are counted in the left region", caseName);
+    check(listener.result.isRegionOverThreshHold[0] == true, "1200 pixels pass a 1000 pixel threshold", caseName);
+    check(listener.result.isRegionOverThreshHold[1] == false && listener.result.changedPixels[1] == 0, "the right region is untouched", caseName);
+    check(listener.result.isThreshHoldPassed == true, "a frame with a passing region is flagged", caseName);
+
+    //the same count as the previous frame does not pass again
+    pushRectangle(engine, 4, cv::Rect(20, 20, 40, 30), false);
+    check(listener.result.changedPixels[0] == 1200, "the unchanged rectangle is still above the average", caseName);
+    check(listener.result.isThreshHoldPassed == false, "a count equal to the previous frame's is not flagged", caseName);
+
+    //a 0 threshold passes on a single block of changed pixels
+    pushRectangle(engine, 5, cv::Rect(), true);
+    pushRectangle(engine, 6, cv::Rect(150, 50, 2, 2), false);
+    check(listener.result.changedPixels[1] == 4, "4 pixels are counted in the right region", caseName);
+    check(listener.result.isRegionOverThreshHold[1] == true && listener.result.isRegionOverThreshHold[0] == false,
+          "only the right region passes", caseName);
+    check(listener.result.frameNumber == 6, "results carry their frame number", caseName);
+
+    check(engine.getFramesAnalyzed() == 7, "every pushed frame is analyzed", caseName);
+    check(engine.getFramesFlagged() == 2, "two frames are flagged", caseName);
+    check(engine.getFramesOverThreshHold(0) == 1 && engine.getFramesOverThreshHold(1) == 1, "each region passes once", caseName);
+
+    //frames of another size are refused
+    cv::Mat smallFrame(FRAME_HEIGHT / 2, FRAME_WIDTH / 2, CV_8UC3, cv::Scalar(0, 0, 0));
+    check(engine.pushFrame(smallFrame, 7, false) == false, "a frame of another size is refused", caseName);
+
+    engine.finish();
+}
+
+/*!
+ * Checks that an analysis without regions flags any change of the frame
+ */
+static void testWholeFrame()
+{
+    AnalysisEngine engine;
+    lastResult listener;
+
+    engine.openSource(FRAME_WIDTH, FRAME_HEIGHT, 30.0);
+    engine.setListener(&listener);
+
+    check(engine.start() == true, "the analysis starts", "whole frame");
+    check(engine.getNumberOfRegions() == 1, "the whole frame is one region", "whole frame");
+
+    pushRectangle(engine, 0, cv::Rect(), false);
+    pushRectangle(engine, 1, cv::Rect(FRAME_WIDTH - 2, FRAME_HEIGHT - 2, 2, 2), false);
+
+    check(listener.result.changedPixels.size() == 1, "one region is reported", "whole frame");
+    check(listener.result.changedPixels[0] == 4, "changes in the frame's last row and column are counted", "whole frame");
+    check(listener.result.isThreshHoldPassed == true, "any change is flagged", "whole frame");
+}
+
+int main()
+{
+    testRegionTable();
+
+    AnalysisEngine::settings analysisSettings = AnalysisEngine::getDefaultSettings();
+    analysisSettings.analysisThreadCount = 1;
+    testThresholds(analysisSettings, "defaults");
+
+    analysisSettings.analysisThreadCount = 4;
+    testThresholds(analysisSettings, "4 threads");
+
+    analysisSettings.isFullFrameAnalysis = true;
+    testThresholds(analysisSettings, "full frame");
+
+    analysisSettings.isFullFrameAnalysis = false;
+    analysisSettings.analysisScale = 2;
+    testThresholds(analysisSettings, "half scale");
+
+    testWholeFrame();
+
+    if(failedChecks != 0)
+    {
+        printf("%d checks failed\n", failedChecks);
+        return 1;
+    }
+
+    printf("All checks passed\n");
+    return 0;
+}